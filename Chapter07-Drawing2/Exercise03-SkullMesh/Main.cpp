@@ -17,6 +17,7 @@
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
+#include "../../Common/MeshFile.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -694,54 +695,38 @@ void ShapesApp::BuildShapeGeometry()
 
 void ShapesApp::BuildSkullGeometry()
 {    
-    std::ifstream fileIn("Models/skull.txt");
-    if (!fileIn)
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(L"Models/skull.txt");
+    if (!mesh.IsValid())
     {
         throw std::runtime_error("Failed to open file: Models/skull.txt");
     }
-    
-    std::string ignore;
-    ignore.reserve(128);
 
-    int numVertices;
-    fileIn >> ignore >> numVertices;
-    ignore.clear();
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const std::span<const std::uint32_t> meshIndices = mesh.Indices();
 
-    // Vertex = (pos, color)
-    std::unique_ptr vertices = std::make_unique<std::pair<XMFLOAT3, XMFLOAT4>[]>(numVertices);
+    const int numVertices = int(meshVertices.size());
+    const int numIndices = int(meshIndices.size());
 
-    int numTriangles;
-    fileIn >> ignore >> numTriangles;
-    ignore.clear();
+    // The skull has less than 65536 vertices, so 16-bit indices are enough.
+    if (numVertices > std::numeric_limits<std::uint16_t>::max() + 1)
+    {
+        throw std::runtime_error("Too many vertices for 16-bit indices: Models/skull.txt");
+    }
 
-    const int numIndices = numTriangles * 3;
+    // Vertex = (pos, color)
+    std::unique_ptr vertices = std::make_unique<std::pair<XMFLOAT3, XMFLOAT4>[]>(numVertices);
     std::unique_ptr indices = std::make_unique<std::uint16_t[]>(numIndices);
 
-    constexpr long long kMaxStreamSize = std::numeric_limits<std::streamsize>::max();
-
-    // Skip three lines.
-    fileIn.ignore(kMaxStreamSize, '\n');
-    fileIn.ignore(kMaxStreamSize, '\n');
-    fileIn.ignore(kMaxStreamSize, '\n');
-
     constexpr XMFLOAT4 kRed(0.8f, 0.0f, 0.0f, 1.0f);
     for (int i = 0; i < numVertices; ++i)
     {
-        XMFLOAT3& pos = vertices[i].first;
-        XMFLOAT4& color = vertices[i].second;
-
-        fileIn >> pos.x >> pos.y >> pos.z;
-        fileIn.ignore(kMaxStreamSize, '\n');
-        color = kRed;
+        vertices[i].first = meshVertices[i].Position;
+        vertices[i].second = kRed;
     }
 
-    fileIn.ignore(kMaxStreamSize, '\n');
-    fileIn.ignore(kMaxStreamSize, '\n');
-    fileIn.ignore(kMaxStreamSize, '\n');
-    
     for (int i = 0; i < numIndices; ++i)
     {
-        fileIn >> indices[i];
+        indices[i] = std::uint16_t(meshIndices[i]);
     }
 
     std::unique_ptr skullGeo = std::make_unique<MeshGeometry>();
@@ -778,6 +763,7 @@ void ShapesApp::BuildSkullGeometry()
         .IndexCount = UINT(numIndices),
         .StartIndexLocation = 0,
         .BaseVertexLocation = 0,
+        .Bounds = mesh.Submeshes()[0].Box,
     };
     skullGeo->DrawArgs.emplace("skull", skull);
     mGeometries.emplace(skullGeo->Name, std::move(skullGeo));
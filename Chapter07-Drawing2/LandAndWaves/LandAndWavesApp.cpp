@@ -12,7 +12,7 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "FrameResource.h"
-#include "Waves.h"
+#include "../../Common/Waves.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -455,17 +455,13 @@ void LandAndWavesApp::UpdateWaves(const GameTimer& gt)
 	// Update the wave simulation.
 	mWaves->Update(gt.DeltaTime());
 
-	// Update the wave vertex buffer with the new solution.
-	auto currWavesVB = mCurrFrameResource->WavesVB.get();
-	for(int i = 0; i < mWaves->VertexCount(); ++i)
-	{
-		Vertex v;
-
-		v.Pos = mWaves->Position(i);
-        v.Color = XMFLOAT4(DirectX::Colors::Blue);
+	// Update the wave vertex buffer with the new solution.  Whole vertices are written,
+	// color included, so the upload heap only sees complete sequential writes.
+	Vertex waveVertex = {};
+	waveVertex.Color = XMFLOAT4(DirectX::Colors::Blue);
 
-		currWavesVB->CopyData(i, v);
-	}
+	auto currWavesVB = mCurrFrameResource->WavesVB.get();
+	mWaves->WriteVertices(currWavesVB->MappedElements(), waveVertex);
 
 	// Set the dynamic VB of the wave renderitem to the current frame VB.
 	mWavesRitem->Geo->VertexBufferGPU = currWavesVB->Resource();
@@ -16,7 +16,7 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "FrameResource.h"
-#include "Waves.h"
+#include "../../Common/Waves.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -532,15 +532,7 @@ void LitWavesApp::UpdateWaves(const GameTimer& gt)
 
 	// Update the wave vertex buffer with the new solution.
 	auto currWavesVB = mCurrFrameResource->WavesVB.get();
-	for(int i = 0; i < mWaves->VertexCount(); ++i)
-	{
-		Vertex v;
-
-		v.Pos = mWaves->Position(i);
-		v.Normal = mWaves->Normal(i);
-
-		currWavesVB->CopyData(i, v);
-	}
+	mWaves->WriteVertices(currWavesVB->MappedElements());
 
 	// Set the dynamic VB of the wave renderitem to the current frame VB.
 	mWavesRitem->Geo->VertexBufferGPU = currWavesVB->Resource();
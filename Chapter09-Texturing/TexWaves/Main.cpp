@@ -10,9 +10,10 @@
 #include "../../Common/d3dApp.h"
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
+#include "../../Common/UploadRingBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "FrameResource.h"
-#include "Waves.h"
+#include "../../Common/Waves.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -36,13 +37,8 @@ struct RenderItem
 
     XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 
-    // Dirty flag indicating the object data has changed and we need to update the constant buffer.
-    // Because we have an object cbuffer for each FrameResource, we have to apply the
-    // update to each FrameResource.  Thus, when we modify obect data we should set 
-    // NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-    int NumFramesDirty = gNumFrameResources;
-
-    // Index into GPU constant buffer corresponding to the ObjectCB for this render item.
+    // Index of this render item's constants in the object constants the frame
+    // allocates from the constant ring.
     UINT ObjCBIndex = 0;
 
     Material* Mat = nullptr;
@@ -111,6 +107,13 @@ private:
 private:
 
     std::vector<std::unique_ptr<FrameResource>> mFrameResources;
+
+    // Pass, object and material constants are allocated from this ring every frame
+    // and released once the GPU has finished the frame.
+    std::unique_ptr<UploadRingBuffer> mConstantRing;
+    D3D12_GPU_VIRTUAL_ADDRESS mPassCBAddress = 0;
+    D3D12_GPU_VIRTUAL_ADDRESS mObjectCBAddress = 0;
+    D3D12_GPU_VIRTUAL_ADDRESS mMaterialCBAddress = 0;
     FrameResource* mCurrFrameResource = nullptr;
     int mCurrFrameResourceIndex = 0;
 
@@ -254,6 +257,9 @@ void TexWavesApp::Update(const GameTimer& gt)
             CloseHandle(eventHandle);
     }
 
+    // Constants of frames the GPU has finished with can be overwritten.
+    mConstantRing->Retire(mFence->GetCompletedValue());
+
     AnimateMaterials(gt);
     UpdateObjectCBs(gt);
     UpdateMaterialCBs(gt);
@@ -298,8 +304,7 @@ void TexWavesApp::Draw(const GameTimer& gt)
 
     mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
 
-    auto passCB = mCurrFrameResource->PassCB->Resource();
-    mCommandList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
+    mCommandList->SetGraphicsRootConstantBufferView(2, mPassCBAddress);
 
     DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
 
@@ -323,6 +328,7 @@ void TexWavesApp::Draw(const GameTimer& gt)
 
     // Advance the fence value to mark commands up to this fence point.
     mCurrFrameResource->Fence = ++mCurrentFence;
+    mConstantRing->FinishFrame(mCurrentFence);
 
     // Add an instruction to the command queue to set a new fence point. 
     // Because we are on the GPU timeline, the new fence point won't be 
@@ -411,57 +417,48 @@ void TexWavesApp::AnimateMaterials(const GameTimer& gt)
 
     if (tv >= 1.0f)
         tv -= 1.0f;
-
-    // Material has changed, so need to update cbuffer.
-    waterMat->NumFramesDirty = gNumFrameResources;
 }
 
 void TexWavesApp::UpdateObjectCBs(const GameTimer& gt)
 {
-    auto currObjectCB = mCurrFrameResource->ObjectCB.get();
+    // The ring hands out fresh memory every frame, so all objects are written.
+    const UploadRingBuffer::Allocation objectCB =
+        mConstantRing->AllocateConstants<ObjectConstants>((UINT)mAllRitems.size());
+    mObjectCBAddress = objectCB.GpuAddress;
+
+    constexpr UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
     for (auto& e : mAllRitems)
     {
-        // Only update the cbuffer data if the constants have changed.  
-        // This needs to be tracked per frame resource.
-        if (e->NumFramesDirty > 0)
-        {
-            const XMMATRIX world = XMLoadFloat4x4(&e->World);
-            const XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
-
-            ObjectConstants objConstants;
-            XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-            XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
+        const XMMATRIX world = XMLoadFloat4x4(&e->World);
+        const XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
 
-            currObjectCB->CopyData(e->ObjCBIndex, objConstants);
+        ObjectConstants objConstants;
+        XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
+        XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
 
-            // Next FrameResource need to be updated too.
-            e->NumFramesDirty--;
-        }
+        memcpy(objectCB.CpuAddress + e->ObjCBIndex * objCBByteSize, &objConstants, sizeof(objConstants));
     }
 }
 
 void TexWavesApp::UpdateMaterialCBs(const GameTimer& gt)
 {
-    auto currMaterialCB = mCurrFrameResource->MaterialCB.get();
+    const UploadRingBuffer::Allocation materialCB =
+        mConstantRing->AllocateConstants<MaterialConstants>((UINT)mMaterials.size());
+    mMaterialCBAddress = materialCB.GpuAddress;
+
+    constexpr UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
     for (auto& [_, mat] : mMaterials)
     {
-        // Only update the cbuffer data if the constants have changed.  If the cbuffer
-        // data changes, it needs to be updated for each FrameResource.
-        if (mat->NumFramesDirty > 0)
-        {
-            const XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
-
-            MaterialConstants matConstants = {
-                .DiffuseAlbedo = mat->DiffuseAlbedo,
-                .FresnelR0 = mat->FresnelR0,
-                .Roughness = mat->Roughness
-            };
-            XMStoreFloat4x4(&matConstants.MatTransform, XMMatrixTranspose(matTransform));
-            currMaterialCB->CopyData(mat->MatCBIndex, matConstants);
-
-            // Next FrameResource need to be updated too.
-            mat->NumFramesDirty--;
-        }
+        const XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
+
+        MaterialConstants matConstants = {
+            .DiffuseAlbedo = mat->DiffuseAlbedo,
+            .FresnelR0 = mat->FresnelR0,
+            .Roughness = mat->Roughness
+        };
+        XMStoreFloat4x4(&matConstants.MatTransform, XMMatrixTranspose(matTransform));
+
+        memcpy(materialCB.CpuAddress + mat->MatCBIndex * matCBByteSize, &matConstants, sizeof(matConstants));
     }
 }
 
@@ -500,8 +497,7 @@ void TexWavesApp::UpdateMainPassCB(const GameTimer& gt)
     mMainPassCB.Lights[2].Direction = { 0.0f, -0.707f, -0.707f };
     mMainPassCB.Lights[2].Strength = { 0.2f, 0.2f, 0.2f };
 
-    auto currPassCB = mCurrFrameResource->PassCB.get();
-    currPassCB->CopyData(0, mMainPassCB);
+    mPassCBAddress = mConstantRing->PushConstants(mMainPassCB).GpuAddress;
 }
 
 void TexWavesApp::UpdateWaves(const GameTimer& gt)
@@ -525,21 +521,7 @@ void TexWavesApp::UpdateWaves(const GameTimer& gt)
 
     // Update the wave vertex buffer with the new solution.
     auto currWavesVB = mCurrFrameResource->WavesVB.get();
-    const float oneOverWidth = 1.0f / mWaves->Width();
-    const float oneOverDepth = 1.0f / mWaves->Depth();
-    Vertex v = {};
-    for (int i = 0; i < mWaves->VertexCount(); ++i)
-    {
-        v.Pos = mWaves->Position(i);
-        v.Normal = mWaves->Normal(i);
-
-        // Derive tex-coords from position by 
-        // mapping [-w/2,w/2] --> [0,1]
-        v.TexC.x = 0.5f + v.Pos.x * oneOverWidth;
-        v.TexC.y = 0.5f - v.Pos.z * oneOverDepth;
-
-        currWavesVB->CopyData(i, v);
-    }
+    mWaves->WriteVertices(currWavesVB->MappedElements());
 
     // Set the dynamic VB of the wave renderitem to the current frame VB.
     mWavesRitem->Geo->VertexBufferGPU = currWavesVB->Resource();
@@ -865,9 +847,18 @@ void TexWavesApp::BuildFrameResources()
 {
     for (int i = 0; i < gNumFrameResources; ++i)
     {
-        mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
-            1, (UINT)mAllRitems.size(), (UINT)mMaterials.size(), mWaves->VertexCount()));
+        mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(), mWaves->VertexCount()));
     }
+
+    // Room for the constants of every frame in flight plus the one being recorded.
+    // An allocation that would straddle the end of the ring starts over at the
+    // beginning, which can waste up to one frame's worth.
+    const UINT64 frameConstantsByteSize =
+        d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants)) +
+        UINT64(d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants))) * mAllRitems.size() +
+        UINT64(d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants))) * mMaterials.size();
+    mConstantRing = std::make_unique<UploadRingBuffer>(
+        md3dDevice.Get(), frameConstantsByteSize * (gNumFrameResources + 1));
 }
 
 void TexWavesApp::BuildMaterials()
@@ -955,8 +946,6 @@ void TexWavesApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std:
     constexpr UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
     constexpr UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
 
-    auto objectCB = mCurrFrameResource->ObjectCB->Resource();
-    auto matCB = mCurrFrameResource->MaterialCB->Resource();
 
     // For each render item...
     for (const RenderItem* const ri : ritems)
@@ -971,8 +960,8 @@ void TexWavesApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std:
         CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
         tex.Offset(ri->Mat->DiffuseSrvHeapIndex, mCbvSrvDescriptorSize);
 
-        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * objCBByteSize;
-        D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = matCB->GetGPUVirtualAddress() + ri->Mat->MatCBIndex * matCBByteSize;
+        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = mObjectCBAddress + ri->ObjCBIndex * objCBByteSize;
+        D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = mMaterialCBAddress + ri->Mat->MatCBIndex * matCBByteSize;
 
         cmdList->SetGraphicsRootDescriptorTable(0, tex);
         cmdList->SetGraphicsRootConstantBufferView(1, objCBAddress);
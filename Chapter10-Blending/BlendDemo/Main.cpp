@@ -11,8 +11,10 @@
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
+#include "../../Common/DepthSorter.h"
+#include "../../Common/CommandSink.h"
 #include "FrameResource.h"
-#include "Waves.h"
+#include "../../Common/Waves.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -55,6 +57,9 @@ struct RenderItem
     UINT IndexCount = 0;
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
+
+    // Local-space bounds of the geometry, used to sort the item by view depth.
+    BoundingBox Bounds;
 };
 
 enum class RenderLayer : int
@@ -86,6 +91,8 @@ private:
 
     void OnKeyboardInput(const GameTimer& gt);
     void UpdateCamera(const GameTimer& gt);
+    void SortRenderLayers();
+    void SortRenderLayer(RenderLayer layer, DepthSorter::Order order);
     void AnimateMaterials(const GameTimer& gt);
     void UpdateObjectCBs(const GameTimer& gt);
     void UpdateMaterialCBs(const GameTimer& gt);
@@ -103,7 +110,7 @@ private:
     void BuildFrameResources();
     void BuildMaterials();
     void BuildRenderItems();
-    void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
+    void DrawRenderItems(CommandSink& sink, const std::vector<RenderItem*>& ritems);
 
     std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
@@ -135,6 +142,13 @@ private:
     // Render items divided by PSO.
     std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+    // mRitemLayer in this frame's draw order.
+    std::vector<RenderItem*> mSortedRitemLayer[(int)RenderLayer::Count];
+
+    DepthSorter mDepthSorter;
+    std::vector<float> mSortDepths;
+    std::vector<std::uint32_t> mSortOrder;
+
     std::unique_ptr<Waves> mWaves;
 
     PassConstants mMainPassConstants;
@@ -248,6 +262,7 @@ void BlendApp::Update(const GameTimer& gt)
 {
     OnKeyboardInput(gt);
     UpdateCamera(gt);
+    SortRenderLayers();
 
     // Cycle through the circular frame resource array.
     mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
@@ -321,13 +336,15 @@ void BlendApp::Draw(const GameTimer& gt)
     auto passCB = mCurrFrameResource->PassCB->Resource();
     mCommandList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+    CommandListSink sink(mCommandList.Get());
 
-    mCommandList->SetPipelineState(mPSOs["alphaTested"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::AlphaTested]);
+    DrawRenderItems(sink, mSortedRitemLayer[(int)RenderLayer::Opaque]);
 
-    mCommandList->SetPipelineState(mPSOs["transparent"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Transparent]);
+    sink.SetPipelineState(mPSOs["alphaTested"].Get());
+    DrawRenderItems(sink, mSortedRitemLayer[(int)RenderLayer::AlphaTested]);
+
+    sink.SetPipelineState(mPSOs["transparent"].Get());
+    DrawRenderItems(sink, mSortedRitemLayer[(int)RenderLayer::Transparent]);
 
     // Indicate a state transition on the resource usage.
     transition = CD3DX12_RESOURCE_BARRIER::Transition(
@@ -422,6 +439,38 @@ void BlendApp::UpdateCamera(const GameTimer& gt)
     XMStoreFloat4x4(&mView, view);
 }
 
+void BlendApp::SortRenderLayers()
+{
+    // Opaque and alpha-tested items write depth, so drawing the nearest first lets the
+    // depth test reject the hidden pixels of the rest.  Transparent items blend over
+    // what is already drawn, so the farthest must come first.
+    SortRenderLayer(RenderLayer::Opaque, DepthSorter::Order::FrontToBack);
+    SortRenderLayer(RenderLayer::AlphaTested, DepthSorter::Order::FrontToBack);
+    SortRenderLayer(RenderLayer::Transparent, DepthSorter::Order::BackToFront);
+}
+
+void BlendApp::SortRenderLayer(const RenderLayer layer, const DepthSorter::Order order)
+{
+    const std::vector<RenderItem*>& ritems = mRitemLayer[(int)layer];
+    const XMMATRIX view = XMLoadFloat4x4(&mView);
+
+    mSortDepths.resize(ritems.size());
+    for (size_t i = 0; i < ritems.size(); ++i)
+    {
+        const XMMATRIX worldView = XMLoadFloat4x4(&ritems[i]->World) * view;
+        mSortDepths[i] = DepthSorter::ViewDepth(worldView, ritems[i]->Bounds);
+    }
+
+    mDepthSorter.Sort(mSortDepths, order, mSortOrder);
+
+    std::vector<RenderItem*>& sorted = mSortedRitemLayer[(int)layer];
+    sorted.resize(ritems.size());
+    for (size_t i = 0; i < mSortOrder.size(); ++i)
+    {
+        sorted[i] = ritems[mSortOrder[i]];
+    }
+}
+
 void BlendApp::AnimateMaterials(const GameTimer& gt)
 {
     // Scroll the water material texture coordinates.
@@ -554,19 +603,7 @@ void BlendApp::UpdateWaves(const GameTimer& gt)
 
     // Update the wave vertex buffer with the new solution.
     auto currWavesVB = mCurrFrameResource->WavesVB.get();
-    Vertex v = {};
-    for (int i = 0; i < mWaves->VertexCount(); ++i)
-    {
-        v.Pos = mWaves->Position(i);
-        v.Normal = mWaves->Normal(i);
-
-        // Derive tex-coords from position by 
-        // mapping [-w/2,w/2] --> [0,1]
-        v.TexC.x = 0.5f + v.Pos.x / mWaves->Width();
-        v.TexC.y = 0.5f - v.Pos.z / mWaves->Depth();
-
-        currWavesVB->CopyData(i, v);
-    }
+    mWaves->WriteVertices(currWavesVB->MappedElements());
 
     // Set the dynamic VB of the wave renderitem to the current frame VB.
     mWavesRitem->Geo->VertexBufferGPU = currWavesVB->Resource();
@@ -762,6 +799,7 @@ void BlendApp::BuildLandGeometry()
     submesh.IndexCount = (UINT)indices.size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
+    BoundingBox::CreateFromPoints(submesh.Bounds, vertices.size(), &vertices[0].Pos, sizeof(Vertex));
 
     geo->DrawArgs["grid"] = submesh;
 
@@ -819,6 +857,11 @@ void BlendApp::BuildWavesGeometry()
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
 
+    // The vertices move every frame, but the grid stays centered on the origin in the
+    // xz-plane.
+    submesh.Bounds.Center = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    submesh.Bounds.Extents = XMFLOAT3(0.5f * mWaves->Width(), 0.0f, 0.5f * mWaves->Depth());
+
     geo->DrawArgs["grid"] = submesh;
 
     mGeometries["waterGeo"] = std::move(geo);
@@ -866,6 +909,7 @@ void BlendApp::BuildBoxGeometry()
     submesh.IndexCount = (UINT)indices.size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
+    BoundingBox::CreateFromPoints(submesh.Bounds, vertices.size(), &vertices[0].Pos, sizeof(Vertex));
 
     geo->DrawArgs["box"] = submesh;
 
@@ -999,6 +1043,7 @@ void BlendApp::BuildRenderItems()
     ri.IndexCount = ri.Geo->DrawArgs["grid"].IndexCount;
     ri.StartIndexLocation = ri.Geo->DrawArgs["grid"].StartIndexLocation;
     ri.BaseVertexLocation = ri.Geo->DrawArgs["grid"].BaseVertexLocation;
+    ri.Bounds = ri.Geo->DrawArgs["grid"].Bounds;
     mAllRitems.push_back(ri);
     mWavesRitem = &mAllRitems.back();
     mRitemLayer[(int)RenderLayer::Transparent].push_back(mWavesRitem);
@@ -1014,6 +1059,7 @@ void BlendApp::BuildRenderItems()
     ri.IndexCount = ri.Geo->DrawArgs["grid"].IndexCount;
     ri.StartIndexLocation = ri.Geo->DrawArgs["grid"].StartIndexLocation;
     ri.BaseVertexLocation = ri.Geo->DrawArgs["grid"].BaseVertexLocation;
+    ri.Bounds = ri.Geo->DrawArgs["grid"].Bounds;
     mAllRitems.push_back(ri);
     mRitemLayer[(int)RenderLayer::Opaque].push_back(&mAllRitems.back());
 
@@ -1027,11 +1073,12 @@ void BlendApp::BuildRenderItems()
     ri.IndexCount = ri.Geo->DrawArgs["box"].IndexCount;
     ri.StartIndexLocation = ri.Geo->DrawArgs["box"].StartIndexLocation;
     ri.BaseVertexLocation = ri.Geo->DrawArgs["box"].BaseVertexLocation;
+    ri.Bounds = ri.Geo->DrawArgs["box"].Bounds;
     mAllRitems.push_back(ri);
     mRitemLayer[(int)RenderLayer::AlphaTested].push_back(&mAllRitems.back());
 }
 
-void BlendApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
+void BlendApp::DrawRenderItems(CommandSink& sink, const std::vector<RenderItem*>& ritems)
 {
     constexpr UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(
         sizeof(ObjectConstants));
@@ -1047,9 +1094,9 @@ void BlendApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::ve
         const D3D12_VERTEX_BUFFER_VIEW vertexView = ri->Geo->VertexBufferView();
         const D3D12_INDEX_BUFFER_VIEW indexView = ri->Geo->IndexBufferView();
 
-        cmdList->IASetVertexBuffers(0, 1, &vertexView);
-        cmdList->IASetIndexBuffer(&indexView);
-        cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
+        sink.IASetVertexBuffer(vertexView);
+        sink.IASetIndexBuffer(indexView);
+        sink.IASetPrimitiveTopology(ri->PrimitiveType);
 
         CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
         tex.Offset(ri->Mat->DiffuseSrvHeapIndex, mCbvSrvUavDescriptorSize);
@@ -1057,11 +1104,11 @@ void BlendApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::ve
         D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * objCBByteSize;
         D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = matCB->GetGPUVirtualAddress() + ri->Mat->MatCBIndex * matCBByteSize;
 
-        cmdList->SetGraphicsRootDescriptorTable(0, tex);
-        cmdList->SetGraphicsRootConstantBufferView(1, objCBAddress);
-        cmdList->SetGraphicsRootConstantBufferView(3, matCBAddress);
+        sink.SetGraphicsRootDescriptorTable(0, tex);
+        sink.SetGraphicsRootConstantBufferView(1, objCBAddress);
+        sink.SetGraphicsRootConstantBufferView(3, matCBAddress);
 
-        cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+        sink.DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
     }
 }
 
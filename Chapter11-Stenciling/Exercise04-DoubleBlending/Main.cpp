@@ -20,6 +20,7 @@
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
+#include "../../Common/MeshFile.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -880,55 +881,30 @@ void StencilApp::BuildRoomGeometry()
 
 void StencilApp::BuildSkullGeometry()
 {
-    std::ifstream fin("Models/skull.txt");
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(L"Models/skull.txt");
 
-    if (!fin)
+    if (!mesh.IsValid())
     {
         MessageBox(0, L"Models/skull.txt not found.", 0, 0);
         return;
     }
 
-    int vertexCount = 0;
-    int triangleCount = 0;
-    std::string ignore;
-    ignore.reserve(128);
-
-    fin >> ignore >> vertexCount;
-    fin >> ignore >> triangleCount;
-    ignore.clear();
-
-    constexpr auto kMaxStreamSize = std::numeric_limits<std::streamsize>::max();
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const UINT vertexCount = (UINT)meshVertices.size();
 
     std::unique_ptr vertices = std::make_unique<Vertex[]>(vertexCount);
-    for (int i = 0; i < vertexCount; ++i)
-    {
-        fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-        fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
-    }
-
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-
-    const int indicesCount = 3 * triangleCount;
-    std::unique_ptr indices = std::make_unique<std::uint32_t[]>(indicesCount);
-    for (int i = 0; i < triangleCount; ++i)
+    for (UINT i = 0; i < vertexCount; ++i)
     {
-        fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
+        vertices[i].Pos = meshVertices[i].Position;
+        vertices[i].Normal = meshVertices[i].Normal;
     }
 
-    fin.close();
-
     //
     // Pack the indices of all the meshes into one index buffer.
     //
 
-    const UINT vbByteSize = (UINT)vertexCount * sizeof(Vertex);
-    const UINT ibByteSize = (UINT)indicesCount * sizeof(std::int32_t);
+    const UINT vbByteSize = vertexCount * sizeof(Vertex);
+    const UINT ibByteSize = mesh.IndexBufferByteSize();
 
     MeshGeometry geo = {};
     geo.Name = "skullGeo";
@@ -937,9 +913,8 @@ void StencilApp::BuildSkullGeometry()
     CopyMemory(geo.VertexBufferCPU->GetBufferPointer(), vertices.get(), vbByteSize);
     vertices.reset();
 
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo.IndexBufferCPU));
-    CopyMemory(geo.IndexBufferCPU->GetBufferPointer(), indices.get(), ibByteSize);
-    indices.reset();
+    // Indices are used straight from the mapped file.
+    geo.IndexBufferCPU = mesh.IndexBlob();
 
     geo.VertexBufferGPU = d3dUtil::CreateDefaultBuffer(
         md3dDevice.Get(),
@@ -961,9 +936,10 @@ void StencilApp::BuildSkullGeometry()
     geo.IndexBufferByteSize = ibByteSize;
 
     SubmeshGeometry submesh;
-    submesh.IndexCount = (UINT)indicesCount;
+    submesh.IndexCount = (UINT)mesh.Indices().size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
+    submesh.Bounds = mesh.Submeshes()[0].Box;
 
     geo.DrawArgs["skull"] = submesh;
 
@@ -19,7 +19,7 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "FrameResource.h"
-#include "Waves.h"
+#include "../../Common/Waves.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -571,19 +571,7 @@ void BlendApp::UpdateWaves(const GameTimer& gt)
 
     // Update the wave vertex buffer with the new solution.
     auto currWavesVB = mCurrFrameResource->WavesVB.get();
-    Vertex v = {};
-    for (int i = 0; i < mWaves->VertexCount(); ++i)
-    {
-        v.Pos = mWaves->Position(i);
-        v.Normal = mWaves->Normal(i);
-
-        // Derive tex-coords from position by 
-        // mapping [-w/2,w/2] --> [0,1]
-        v.TexC.x = 0.5f + v.Pos.x / mWaves->Width();
-        v.TexC.y = 0.5f - v.Pos.z / mWaves->Depth();
-
-        currWavesVB->CopyData(i, v);
-    }
+    mWaves->WriteVertices(currWavesVB->MappedElements());
 
     // Set the dynamic VB of the wave renderitem to the current frame VB.
     mWavesRitem->Geo->VertexBufferGPU = currWavesVB->Resource();
@@ -18,6 +18,8 @@
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
+#include "../../Common/MeshFile.h"
+#include "../../Common/TransformHierarchy.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -35,10 +37,10 @@ struct RenderItem
 {
     RenderItem() = default;
 
-    // World matrix of the shape that describes the object's local space
-    // relative to the world space, which defines the position, orientation,
-    // and scale of the object in the world.
-    XMFLOAT4X4 World = MathHelper::Identity4x4();
+    // Node in StencilApp::mTransforms holding the world matrix of the shape that describes
+    // the object's local space relative to the world space, which defines the position,
+    // orientation, and scale of the object in the world.
+    std::uint32_t TransformNode = 0;
 
     XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 
@@ -139,6 +141,12 @@ private:
     // List of all the render items.
     std::vector<RenderItem> mAllRitems;
 
+    // World matrices of the render items.  The reflected and shadowed skulls hang below
+    // the mirror and shadow frames, which apply the reflection and shadow projection.
+    TransformHierarchy mTransforms;
+    std::uint32_t mMirrorFrameNode = 0;
+    std::uint32_t mShadowFrameNode = 0;
+
     // Render items divided by PSO.
     std::vector<RenderItem*> mRitemLayer[int(RenderLayer::Count)];
 
@@ -455,23 +463,19 @@ void StencilApp::OnKeyboardInput(const GameTimer& gt)
         mSkullTranslation.y, 
         mSkullTranslation.z);
     const XMMATRIX skullWorld = skullRotate * skullScale * skullOffset;
-    XMStoreFloat4x4(&mSkullRitem->World, skullWorld);
 
-    // Update reflection world matrix.
-    XMVECTOR mirrorPlane = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f); // xy plane
-    XMMATRIX R = XMMatrixReflect(mirrorPlane);
-    XMStoreFloat4x4(&mReflectedSkullRitem->World, skullWorld * R);
+    // The skull and its reflected and shadowed copies share the local matrix; the mirror
+    // and shadow frames above the copies supply the rest.
+    mTransforms.SetLocal(mSkullRitem->TransformNode, skullWorld);
+    mTransforms.SetLocal(mReflectedSkullRitem->TransformNode, skullWorld);
+    mTransforms.SetLocal(mShadowedSkullRitem->TransformNode, skullWorld);
 
-    // Update shadow world matrix.
+    // Update shadow frame.
     XMVECTOR shadowPlane = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f); // xz plane
     XMVECTOR toMainLight = -XMLoadFloat3(&mMainPassConstants.Lights[0].Direction);
     XMMATRIX S = XMMatrixShadow(shadowPlane, toMainLight);
     XMMATRIX shadowOffsetY = XMMatrixTranslation(0.0f, 0.001f, 0.0f);
-    XMStoreFloat4x4(&mShadowedSkullRitem->World, skullWorld * S * shadowOffsetY);
-
-    mSkullRitem->NumFramesDirty = gNumFrameResources;
-    mReflectedSkullRitem->NumFramesDirty = gNumFrameResources;
-    mShadowedSkullRitem->NumFramesDirty = gNumFrameResources;
+    mTransforms.SetLocal(mShadowFrameNode, S * shadowOffsetY);
 }
 
 void StencilApp::UpdateCamera(const GameTimer& gt)
@@ -501,13 +505,22 @@ void StencilApp::UpdateObjectCBs(const GameTimer& gt)
     ObjectConstants objConstants = {};
     XMMATRIX world;
     XMMATRIX texTransform;
+
+    // Recompute the world matrices under every node that changed, in one pass.
+    mTransforms.Update();
+
     for (RenderItem& e : mAllRitems)
     {
+        if (mTransforms.WorldChanged(e.TransformNode))
+        {
+            e.NumFramesDirty = gNumFrameResources;
+        }
+
         // Only update the cbuffer data if the constants have changed.  
         // This needs to be tracked per frame resource.
         if (e.NumFramesDirty > 0)
         {
-            world = XMLoadFloat4x4(&e.World);
+            world = mTransforms.World(e.TransformNode);
             texTransform = XMLoadFloat4x4(&e.TexTransform);
 
             XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
@@ -879,55 +892,30 @@ void StencilApp::BuildRoomGeometry()
 
 void StencilApp::BuildSkullGeometry()
 {
-    std::ifstream fin("Models/skull.txt");
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(L"Models/skull.txt");
 
-    if (!fin)
+    if (!mesh.IsValid())
     {
         MessageBox(0, L"Models/skull.txt not found.", 0, 0);
         return;
     }
 
-    int vertexCount = 0;
-    int triangleCount = 0;
-    std::string ignore;
-    ignore.reserve(128);
-
-    fin >> ignore >> vertexCount;
-    fin >> ignore >> triangleCount;
-    ignore.clear();
-
-    constexpr auto kMaxStreamSize = std::numeric_limits<std::streamsize>::max();
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const UINT vertexCount = (UINT)meshVertices.size();
 
     std::unique_ptr vertices = std::make_unique<Vertex[]>(vertexCount);
-    for (int i = 0; i < vertexCount; ++i)
+    for (UINT i = 0; i < vertexCount; ++i)
     {
-        fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-        fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
+        vertices[i].Pos = meshVertices[i].Position;
+        vertices[i].Normal = meshVertices[i].Normal;
     }
 
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-    fin.ignore(kMaxStreamSize, '\n');
-
-    const int indicesCount = 3 * triangleCount;
-    std::unique_ptr indices = std::make_unique<std::uint32_t[]>(indicesCount);
-    for (int i = 0; i < triangleCount; ++i)
-    {
-        fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
-    }
-
-    fin.close();
-
     //
     // Pack the indices of all the meshes into one index buffer.
     //
 
-    const UINT vbByteSize = (UINT)vertexCount * sizeof(Vertex);
-    const UINT ibByteSize = (UINT)indicesCount * sizeof(std::int32_t);
+    const UINT vbByteSize = vertexCount * sizeof(Vertex);
+    const UINT ibByteSize = mesh.IndexBufferByteSize();
 
     MeshGeometry geo = {};
     geo.Name = "skullGeo";
@@ -936,9 +924,8 @@ void StencilApp::BuildSkullGeometry()
     CopyMemory(geo.VertexBufferCPU->GetBufferPointer(), vertices.get(), vbByteSize);
     vertices.reset();
 
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo.IndexBufferCPU));
-    CopyMemory(geo.IndexBufferCPU->GetBufferPointer(), indices.get(), ibByteSize);
-    indices.reset();
+    // Indices are used straight from the mapped file.
+    geo.IndexBufferCPU = mesh.IndexBlob();
 
     geo.VertexBufferGPU = d3dUtil::CreateDefaultBuffer(
         md3dDevice.Get(),
@@ -960,9 +947,10 @@ void StencilApp::BuildSkullGeometry()
     geo.IndexBufferByteSize = ibByteSize;
 
     SubmeshGeometry submesh;
-    submesh.IndexCount = (UINT)indicesCount;
+    submesh.IndexCount = (UINT)mesh.Indices().size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
+    submesh.Bounds = mesh.Submeshes()[0].Box;
 
     geo.DrawArgs["skull"] = submesh;
 
@@ -1178,9 +1166,16 @@ void StencilApp::BuildMaterials()
 void StencilApp::BuildRenderItems()
 {
     mAllRitems.reserve(6);
+    mTransforms.Reserve(8);
+
+    XMVECTOR mirrorPlane = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f); // xy plane
+    mMirrorFrameNode = mTransforms.Add(XMMatrixReflect(mirrorPlane));
+
+    // Set by OnKeyboardInput from the light direction.
+    mShadowFrameNode = mTransforms.Add(XMMatrixIdentity());
 
     RenderItem floorRitem = {};
-    floorRitem.World = MathHelper::Identity4x4();
+    floorRitem.TransformNode = mTransforms.Add(XMMatrixIdentity());
     floorRitem.TexTransform = MathHelper::Identity4x4();
     floorRitem.ObjCBIndex = 0;
     floorRitem.Mat = &mMaterials["checkertile"];
@@ -1193,7 +1188,7 @@ void StencilApp::BuildRenderItems()
     mRitemLayer[(int)RenderLayer::Opaque].push_back(&mAllRitems.back());
 
     RenderItem wallsRitem = {};
-    wallsRitem.World = MathHelper::Identity4x4();
+    wallsRitem.TransformNode = mTransforms.Add(XMMatrixIdentity());
     wallsRitem.TexTransform = MathHelper::Identity4x4();
     wallsRitem.ObjCBIndex = 1;
     wallsRitem.Mat = &mMaterials["bricks"];
@@ -1206,7 +1201,7 @@ void StencilApp::BuildRenderItems()
     mRitemLayer[(int)RenderLayer::Opaque].push_back(&mAllRitems.back());
 
     RenderItem skullItem = {};
-    skullItem.World = MathHelper::Identity4x4();
+    skullItem.TransformNode = mTransforms.Add(XMMatrixIdentity());
     skullItem.TexTransform = MathHelper::Identity4x4();
     skullItem.ObjCBIndex = 2;
     skullItem.Mat = &mMaterials["skullMat"];
@@ -1223,6 +1218,7 @@ void StencilApp::BuildRenderItems()
     RenderItem reflectedSkullRitem = {};
     reflectedSkullRitem = skullItem;
     reflectedSkullRitem.ObjCBIndex = 3;
+    reflectedSkullRitem.TransformNode = mTransforms.Add(XMMatrixIdentity(), mMirrorFrameNode);
     mAllRitems.push_back(reflectedSkullRitem);
     mReflectedSkullRitem = &mAllRitems.back();
     mRitemLayer[(int)RenderLayer::Reflected].push_back(mReflectedSkullRitem);
@@ -1231,13 +1227,14 @@ void StencilApp::BuildRenderItems()
     RenderItem shadowedSkullRitem = {};
     shadowedSkullRitem = skullItem;
     shadowedSkullRitem.ObjCBIndex = 4;
+    shadowedSkullRitem.TransformNode = mTransforms.Add(XMMatrixIdentity(), mShadowFrameNode);
     shadowedSkullRitem.Mat = &mMaterials["shadowMat"];
     mAllRitems.push_back(shadowedSkullRitem);
     mShadowedSkullRitem = &mAllRitems.back();
     mRitemLayer[(int)RenderLayer::Shadow].push_back(mShadowedSkullRitem);
 
     RenderItem mirrorRitem = {};
-    mirrorRitem.World = MathHelper::Identity4x4();
+    mirrorRitem.TransformNode = mTransforms.Add(XMMatrixIdentity());
     mirrorRitem.TexTransform = MathHelper::Identity4x4();
     mirrorRitem.ObjCBIndex = 5;
     mirrorRitem.Mat = &mMaterials["icemirror"];
@@ -17,6 +17,10 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/MeshFile.h"
+#include "../../Common/FrustumCuller.h"
+#include "../../Common/InstanceCache.h"
+#include "../../Common/ThreadPool.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -126,6 +130,13 @@ struct RenderItem
     BoundingSphere Bounds;
     std::vector<InstanceData> Instances;
 
+    // Instances as they go into the instance buffer (transposed, with the inverse-transpose
+    // filled in) and their world-space bounds, in the same order.  Rebuilt from Instances
+    // by UpdateInstanceData when NumFramesDirty shows they changed, so static instances
+    // cost no matrix work per frame.
+    std::vector<InstanceData> GpuInstances;
+    FrustumCuller InstanceBounds;
+
     // DrawIndexedInstanced parameters.
     UINT IndexCount = 0;
     UINT VisibleInstanceCount = 0;
@@ -200,7 +211,14 @@ private:
 
     bool mFrustumCullingEnabled = true;
 
-    BoundingFrustum mCamFrustum;
+    // Instances culled per task.  A multiple of four, so every chunk starts on a
+    // FrustumCuller SIMD group.
+    static constexpr std::size_t InstanceChunkSize = 1024;
+
+    // Visible instance indices of each chunk and where each chunk's instances start
+    // in the instance buffer.  Reused every frame.
+    std::vector<std::vector<std::uint32_t>> mChunkVisibleIndices;
+    std::vector<std::size_t> mChunkOffsets;
 
     PassConstants mMainPassCB;
 
@@ -293,8 +311,6 @@ void InstancingAndCullingApp::OnResize()
     D3DApp::OnResize();
 
     mCamera.SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
-
-    BoundingFrustum::CreateFromMatrix(mCamFrustum, mCamera.GetProj());
 }
 
 void InstancingAndCullingApp::Update(const GameTimer& gt)
@@ -460,46 +476,75 @@ void InstancingAndCullingApp::AnimateMaterials(const GameTimer& gt)
 
 void InstancingAndCullingApp::UpdateInstanceData(const GameTimer&)
 {
-    const XMMATRIX view = mCamera.GetView();
-    XMVECTOR viewDeterminant = XMMatrixDeterminant(view);
-    const XMMATRIX invView = XMMatrixInverse(&viewDeterminant, view);
+    const XMMATRIX viewProj = XMMatrixMultiply(mCamera.GetView(), mCamera.GetProj());
+
+    ThreadPool& threadPool = ThreadPool::Default();
 
     auto* const currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
+    const std::span<InstanceData> mappedInstances = currInstanceBuffer->MappedElements();
     for (auto& ritem : mAllRitems)
     {
-        const auto& instanceData = ritem->Instances;
-        int visibleInstanceCount = 0;
-
-        for (auto& instData : instanceData)
+        // The instance buffer is rewritten every frame, so one refresh serves all the
+        // frame resources.
+        if (ritem->NumFramesDirty > 0)
         {
-            const XMMATRIX world = XMLoadFloat4x4(&instData.World);
-            XMVECTOR worldDeterminant = XMMatrixDeterminant(world);
-            const XMMATRIX invWorld = XMMatrixInverse(&worldDeterminant, world);
-
-            const XMMATRIX texTransform = XMLoadFloat4x4(&instData.TexTransform);
-
-            // View space to the object's local space.
-            const XMMATRIX viewToLocal = XMMatrixMultiply(invView, invWorld);
-
-            // Transform the camera frustum from view space to the object's local space.
-            BoundingFrustum localSpaceFrustum;
-            mCamFrustum.Transform(localSpaceFrustum, viewToLocal);
+            InstanceCache::Fill(std::span<const InstanceData>(ritem->Instances), ritem->Bounds,
+                ritem->GpuInstances, ritem->InstanceBounds);
+            ritem->NumFramesDirty = 0;
+        }
 
-            // Perform the box/frustum intersection test in local space.
-            if ((localSpaceFrustum.Contains(ritem->Bounds) != DirectX::DISJOINT) || 
-                (mFrustumCullingEnabled == false))
+        const auto& instanceData = ritem->Instances;
+        const std::size_t chunkCount = (instanceData.size() + InstanceChunkSize - 1) / InstanceChunkSize;
+        mChunkVisibleIndices.resize(chunkCount);
+        mChunkOffsets.resize(chunkCount);
+
+        // Cull every chunk into its own index list.  The bounds are kept in world space,
+        // so the test runs against the world-space frustum planes with no per-instance
+        // inverse or frustum transform.
+        threadPool.ParallelFor(0, instanceData.size(), InstanceChunkSize,
+            [&](const std::size_t first, const std::size_t last)
             {
-                InstanceData data;
-                XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
-                XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
-                data.MaterialIndex = instData.MaterialIndex;
-
-                // Write the instance data to structured buffer for the visible objects.
-                currInstanceBuffer->CopyData(visibleInstanceCount, data);
-                ++visibleInstanceCount;
-            }
+                std::vector<std::uint32_t>& visible = mChunkVisibleIndices[first / InstanceChunkSize];
+                visible.clear();
+
+                if (mFrustumCullingEnabled)
+                {
+                    ritem->InstanceBounds.Cull(viewProj, first, last, visible);
+                }
+                else
+                {
+                    for (std::size_t i = first; i < last; ++i)
+                    {
+                        visible.push_back(static_cast<std::uint32_t>(i));
+                    }
+                }
+            });
+
+        // Exclusive prefix sum of the chunk counts gives each chunk its output range.
+        std::size_t visibleCount = 0;
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            mChunkOffsets[chunk] = visibleCount;
+            visibleCount += mChunkVisibleIndices[chunk].size();
         }
 
+        // Write the instance data to structured buffer for the visible objects.  Each
+        // chunk fills its own range, so there is no contention and the result is in
+        // instance order however the chunks were scheduled.
+        threadPool.ParallelFor(0, chunkCount, 1,
+            [&](const std::size_t firstChunk, const std::size_t lastChunk)
+            {
+                for (std::size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+                {
+                    InstanceData* data = mappedInstances.data() + mChunkOffsets[chunk];
+                    for (const std::uint32_t index : mChunkVisibleIndices[chunk])
+                    {
+                        *data++ = ritem->GpuInstances[index];
+                    }
+                }
+            });
+
+        const auto visibleInstanceCount = static_cast<UINT>(visibleCount);
         ritem->VisibleInstanceCount = visibleInstanceCount;
         mMainWndCaption = std::format(
             L"Instancing and Culling Demo    {} objects visible out of {}",
@@ -762,29 +807,22 @@ void InstancingAndCullingApp::BuildShadersAndInputLayout()
 
 void InstancingAndCullingApp::BuildSkullGeometry()
 {
-    std::ifstream fin("Models/skull.txt");
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(L"Models/skull.txt");
 
-    if (!fin)
+    if (!mesh.IsValid())
     {
         MessageBox(0, L"Models/skull.txt not found.", 0, 0);
         return;
     }
 
-    UINT vcount = 0;
-    UINT tcount = 0;
-    std::string ignore;
-    ignore.reserve(512);
-
-    fin >> ignore >> vcount;
-    fin >> ignore >> tcount;
-    fin >> ignore >> ignore >> ignore >> ignore;
-    ignore.clear();
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const UINT vcount = (UINT)meshVertices.size();
 
     std::vector<Vertex> vertices(vcount);
     for (UINT i = 0; i < vcount; ++i)
     {
-        fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-        fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
+        vertices[i].Pos = meshVertices[i].Position;
+        vertices[i].Normal = meshVertices[i].Normal;
 
         XMVECTOR P = XMLoadFloat3(&vertices[i].Pos);
 
@@ -806,33 +844,15 @@ void InstancingAndCullingApp::BuildSkullGeometry()
         vertices[i].TexC = { u, v };
     }
 
-    BoundingSphere bounds;
-    BoundingSphere::CreateFromPoints(
-        bounds,
-        vertices.size(),
-        &vertices[0].Pos,
-        sizeof(vertices[0]));
-
-    fin >> ignore;
-    fin >> ignore;
-    fin >> ignore;
-    ignore.clear();
-    ignore.shrink_to_fit();
-
-    std::vector<std::int32_t> indices(3 * tcount);
-    for (UINT i = 0; i < tcount; ++i)
-    {
-        fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
-    }
-
-    fin.close();
+    // The bounds were computed when the mesh was converted.
+    const BoundingSphere bounds = mesh.Submeshes()[0].Sphere;
 
     //
     // Pack the indices of all the meshes into one index buffer.
     //
 
     const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-    const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
+    const UINT ibByteSize = mesh.IndexBufferByteSize();
 
     auto geo = std::make_unique<MeshGeometry2>();
     geo->Name = "skullGeo";
@@ -840,14 +860,14 @@ void InstancingAndCullingApp::BuildSkullGeometry()
     ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
     CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
 
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-    CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+    // Indices are used straight from the mapped file.
+    geo->IndexBufferCPU = mesh.IndexBlob();
 
     geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
         mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
 
     geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-        mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+        mCommandList.Get(), mesh.Indices().data(), ibByteSize, geo->IndexBufferUploader);
 
     geo->VertexByteStride = sizeof(Vertex);
     geo->VertexBufferByteSize = vbByteSize;
@@ -855,7 +875,7 @@ void InstancingAndCullingApp::BuildSkullGeometry()
     geo->IndexBufferByteSize = ibByteSize;
 
     SubmeshGeometry2 submesh;
-    submesh.IndexCount = (UINT)indices.size();
+    submesh.IndexCount = (UINT)mesh.Indices().size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
     submesh.Bounds = bounds;
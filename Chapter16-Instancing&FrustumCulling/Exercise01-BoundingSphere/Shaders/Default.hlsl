@@ -21,6 +21,7 @@
 struct InstanceData
 {
     float4x4 World;
+    float4x4 InvTransposeWorld;
     float4x4 TexTransform;
     uint MaterialIndex;
     uint InstPad0;
@@ -120,8 +121,8 @@ VertexOut VS(VertexIn vin, const uint instanceID : SV_InstanceID)
     float4 posW = mul(float4(vin.PosL, 1.0f), world);
     vout.PosW = posW.xyz;
 
-    // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
-    vout.NormalW = mul(vin.NormalL, (float3x3) world);
+    // The inverse-transpose keeps normals perpendicular under nonuniform scaling.
+    vout.NormalW = mul(vin.NormalL, (float3x3) instData.InvTransposeWorld);
 
     // Transform to homogeneous clip space.
     vout.PosH = mul(posW, gViewProj);
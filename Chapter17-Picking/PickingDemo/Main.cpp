@@ -12,6 +12,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/MeshFile.h"
+#include "../../Common/Picking.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -34,11 +36,19 @@ struct RenderItem
 
     BoundingBox Bounds;
 
+    // Triangle hierarchy of the drawn submesh, for picking.
+    const MeshBvh* Bvh = nullptr;
+
     // World matrix of the shape that describes the object's local space
     // relative to the world space, which defines the position, orientation,
     // and scale of the object in the world.
     XMFLOAT4X4 World = MathHelper::Identity4x4();
 
+    // Inverse of World for picking and its transpose for normals.  Change World through
+    // SetWorld so they are only recomputed when it changes.
+    XMFLOAT4X4 InvWorld = MathHelper::Identity4x4();
+    XMFLOAT4X4 InvTransposeWorld = MathHelper::Identity4x4();
+
     XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 
     // Dirty flag indicating the object data has changed and we need to update the constant buffer.
@@ -60,6 +70,14 @@ struct RenderItem
     UINT IndexCount = 0;
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
+
+    void SetWorld(FXMMATRIX world)
+    {
+        XMStoreFloat4x4(&World, world);
+        XMStoreFloat4x4(&InvWorld, XMMatrixInverse(nullptr, world));
+        XMStoreFloat4x4(&InvTransposeWorld, MathHelper::InverseTranspose(world));
+        NumFramesDirty = gNumFrameResources;
+    }
 };
 
 enum class RenderLayer : int
@@ -135,6 +153,13 @@ private:
 
     RenderItem* mPickedRitem = nullptr;
 
+    // Picking hierarchies by DrawArgs name.
+    std::unordered_map<std::string, MeshBvh> mMeshBvhs;
+
+    // Pickable render items and their picking data, rebuilt by Pick.
+    std::vector<RenderItem*> mPickRitems;
+    std::vector<Picking::Target> mPickTargets;
+
     PassConstants mMainPassCB;
 
     Camera mCamera;
@@ -410,10 +435,12 @@ void PickingApp::UpdateObjectCBs(const GameTimer& gt)
         if (e->NumFramesDirty > 0)
         {
             XMMATRIX world = XMLoadFloat4x4(&e->World);
+            XMMATRIX invTransposeWorld = XMLoadFloat4x4(&e->InvTransposeWorld);
             XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
 
             ObjectConstants objConstants;
             XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
+            XMStoreFloat4x4(&objConstants.InvTransposeWorld, XMMatrixTranspose(invTransposeWorld));
             XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
             objConstants.MaterialIndex = e->Mat->MatCBIndex;
 
@@ -584,65 +611,33 @@ void PickingApp::BuildShadersAndInputLayout()
 
 void PickingApp::BuildCarGeometry()
 {
-    std::ifstream fin("Models/car.txt");
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(L"Models/car.txt");
 
-    if (!fin)
+    if (!mesh.IsValid())
     {
         MessageBox(0, L"Models/car.txt not found.", 0, 0);
         return;
     }
 
-    UINT vcount = 0;
-    UINT tcount = 0;
-    std::string ignore;
-
-    fin >> ignore >> vcount;
-    fin >> ignore >> tcount;
-    fin >> ignore >> ignore >> ignore >> ignore;
-
-    XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
-    XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
-
-    XMVECTOR vMin = XMLoadFloat3(&vMinf3);
-    XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const UINT vcount = (UINT)meshVertices.size();
 
     std::vector<Vertex> vertices(vcount);
     for (UINT i = 0; i < vcount; ++i)
     {
-        fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-        fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
-
-        XMVECTOR P = XMLoadFloat3(&vertices[i].Pos);
+        vertices[i].Pos = meshVertices[i].Position;
+        vertices[i].Normal = meshVertices[i].Normal;
 
         vertices[i].TexC = { 0.0f, 0.0f };
-
-        vMin = XMVectorMin(vMin, P);
-        vMax = XMVectorMax(vMax, P);
     }
 
-    BoundingBox bounds;
-    XMStoreFloat3(&bounds.Center, 0.5f * (vMin + vMax));
-    XMStoreFloat3(&bounds.Extents, 0.5f * (vMax - vMin));
-
-    fin >> ignore;
-    fin >> ignore;
-    fin >> ignore;
-
-    std::vector<std::int32_t> indices(3 * tcount);
-    for (UINT i = 0; i < tcount; ++i)
-    {
-        fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
-    }
-
-    fin.close();
-
     //
     // Pack the indices of all the meshes into one index buffer.
     //
 
     const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 
-    const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
+    const UINT ibByteSize = mesh.IndexBufferByteSize();
 
     auto geo = std::make_unique<MeshGeometry>();
     geo->Name = "carGeo";
@@ -650,14 +645,14 @@ void PickingApp::BuildCarGeometry()
     ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
     CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
 
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-    CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+    // Indices are used straight from the mapped file.
+    geo->IndexBufferCPU = mesh.IndexBlob();
 
     geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
         mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
 
     geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-        mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+        mCommandList.Get(), mesh.Indices().data(), ibByteSize, geo->IndexBufferUploader);
 
     geo->VertexByteStride = sizeof(Vertex);
     geo->VertexBufferByteSize = vbByteSize;
@@ -665,13 +660,22 @@ void PickingApp::BuildCarGeometry()
     geo->IndexBufferByteSize = ibByteSize;
 
     SubmeshGeometry submesh;
-    submesh.IndexCount = (UINT)indices.size();
+    submesh.IndexCount = (UINT)mesh.Indices().size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
-    submesh.Bounds = bounds;
+    submesh.Bounds = mesh.Submeshes()[0].Box;
 
     geo->DrawArgs["car"] = submesh;
 
+    // Triangle hierarchy for Pick, built once from the system memory copies.
+    const auto* const vertexData = static_cast<const std::byte*>(geo->VertexBufferCPU->GetBufferPointer());
+    const auto* const indexData = static_cast<const std::uint32_t*>(geo->IndexBufferCPU->GetBufferPointer());
+    mMeshBvhs["car"].Build(
+        std::span(vertexData, geo->VertexBufferCPU->GetBufferSize()),
+        sizeof(Vertex),
+        std::span(indexData + submesh.StartIndexLocation, submesh.IndexCount),
+        submesh.BaseVertexLocation);
+
     mGeometries[geo->Name] = std::move(geo);
 }
 
@@ -770,12 +774,13 @@ void PickingApp::BuildMaterials()
 void PickingApp::BuildRenderItems()
 {
     auto carRitem = std::make_unique<RenderItem>();
-    XMStoreFloat4x4(&carRitem->World, XMMatrixTranslation(0.0f, 1.0f, 0.0f));
+    carRitem->SetWorld(XMMatrixTranslation(0.0f, 1.0f, 0.0f));
     carRitem->ObjCBIndex = 0;
     carRitem->Mat = mMaterials["gray0"].get();
     carRitem->Geo = mGeometries["carGeo"].get();
     carRitem->PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
     carRitem->Bounds = carRitem->Geo->DrawArgs["car"].Bounds;
+    carRitem->Bvh = &mMeshBvhs["car"];
     carRitem->IndexCount = carRitem->Geo->DrawArgs["car"].IndexCount;
     carRitem->StartIndexLocation = carRitem->Geo->DrawArgs["car"].StartIndexLocation;
     carRitem->BaseVertexLocation = carRitem->Geo->DrawArgs["car"].BaseVertexLocation;
@@ -892,97 +897,42 @@ std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> PickingApp::GetStaticSamplers()
 
 void PickingApp::Pick(int sx, int sy)
 {
-    XMFLOAT4X4 P = mCamera.GetProj4x4f();
-
-    // Compute picking ray in view space.
-    float vx = (+2.0f * sx / mClientWidth - 1.0f) / P(0, 0);
-    float vy = (-2.0f * sy / mClientHeight + 1.0f) / P(1, 1);
-
-    // Ray definition in view space.
-    XMVECTOR rayOrigin = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-    XMVECTOR rayDir = XMVectorSet(vx, vy, 1.0f, 0.0f);
-
-    XMMATRIX V = mCamera.GetView();
-    XMVECTOR viewDeterminant = XMMatrixDeterminant(V);
-    XMMATRIX invView = XMMatrixInverse(&viewDeterminant, V);
+    // The ray stays in view space; Picking moves a copy into each item's local space.
+    const Picking::Ray viewRay = Picking::ViewSpaceRay(sx, sy, mClientWidth, mClientHeight, mCamera.GetProj4x4f());
 
     // Assume nothing is picked to start, so the picked render-item is invisible.
     mPickedRitem->Visible = false;
 
     // Check if we picked an opaque render item.  A real app might keep a separate "picking list"
-    // of objects that can be selected.   
+    // of objects that can be selected.
+    mPickRitems.clear();
+    mPickTargets.clear();
     for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
     {
-        auto geo = ri->Geo;
-
         // Skip invisible render-items.
         if (ri->Visible == false)
             continue;
 
-        XMMATRIX W = XMLoadFloat4x4(&ri->World);
-        XMVECTOR worldDeterminant = XMMatrixDeterminant(W);
-        XMMATRIX invWorld = XMMatrixInverse(&worldDeterminant, W);
+        mPickRitems.push_back(ri);
+        mPickTargets.push_back(Picking::Target{ ri->InvWorld, ri->Bounds, ri->Bvh });
+    }
 
-        // Tranform ray to vi space of Mesh.
-        XMMATRIX toLocal = XMMatrixMultiply(invView, invWorld);
+    Picking::Hit hit;
+    if (Picking::Nearest(mCamera.GetInvView(), viewRay, mPickTargets, hit))
+    {
+        const RenderItem* ri = mPickRitems[hit.Target];
 
-        rayOrigin = XMVector3TransformCoord(rayOrigin, toLocal);
-        rayDir = XMVector3TransformNormal(rayDir, toLocal);
+        mPickedRitem->Visible = true;
+        mPickedRitem->IndexCount = 3;
+        mPickedRitem->BaseVertexLocation = ri->BaseVertexLocation;
 
-        // Make the ray direction unit length for the intersection tests.
-        rayDir = XMVector3Normalize(rayDir);
+        // Picked render item needs same world matrix as object picked.
+        mPickedRitem->World = ri->World;
+        mPickedRitem->InvWorld = ri->InvWorld;
+        mPickedRitem->InvTransposeWorld = ri->InvTransposeWorld;
+        mPickedRitem->NumFramesDirty = gNumFrameResources;
 
-        // If we hit the bounding box of the Mesh, then we might have picked a Mesh triangle,
-        // so do the ray/triangle tests.
-        //
-        // If we did not hit the bounding box, then it is impossible that we hit 
-        // the Mesh, so do not waste effort doing ray/triangle tests.
-        float tmin = 0.0f;
-        if (ri->Bounds.Intersects(rayOrigin, rayDir, tmin))
-        {
-            // NOTE: For the demo, we know what to cast the vertex/index data to.  If we were mixing
-            // formats, some metadata would be needed to figure out what to cast it to.
-            auto vertices = (Vertex*)geo->VertexBufferCPU->GetBufferPointer();
-            auto indices = (std::uint32_t*)geo->IndexBufferCPU->GetBufferPointer();
-            UINT triCount = ri->IndexCount / 3;
-
-            // Find the nearest ray/triangle intersection.
-            tmin = MathHelper::Infinity;
-            for (UINT i = 0; i < triCount; ++i)
-            {
-                // Indices for this triangle.
-                UINT i0 = indices[i * 3 + 0];
-                UINT i1 = indices[i * 3 + 1];
-                UINT i2 = indices[i * 3 + 2];
-
-                // Vertices for this triangle.
-                XMVECTOR v0 = XMLoadFloat3(&vertices[i0].Pos);
-                XMVECTOR v1 = XMLoadFloat3(&vertices[i1].Pos);
-                XMVECTOR v2 = XMLoadFloat3(&vertices[i2].Pos);
-
-                // We have to iterate over all the triangles in order to find the nearest intersection.
-                float t = 0.0f;
-                if (TriangleTests::Intersects(rayOrigin, rayDir, v0, v1, v2, t))
-                {
-                    if (t < tmin)
-                    {
-                        // This is the new nearest picked triangle.
-                        tmin = t;
-                        UINT pickedTriangle = i;
-
-                        mPickedRitem->Visible = true;
-                        mPickedRitem->IndexCount = 3;
-                        mPickedRitem->BaseVertexLocation = 0;
-
-                        // Picked render item needs same world matrix as object picked.
-                        mPickedRitem->World = ri->World;
-                        mPickedRitem->NumFramesDirty = gNumFrameResources;
-
-                        // Offset to the picked triangle in the mesh index buffer.
-                        mPickedRitem->StartIndexLocation = 3 * pickedTriangle;
-                    }
-                }
-            }
-        }
+        // Offset to the picked triangle in the mesh index buffer.
+        mPickedRitem->StartIndexLocation = ri->StartIndexLocation + 3 * hit.Triangle;
     }
 }
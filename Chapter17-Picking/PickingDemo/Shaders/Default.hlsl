@@ -51,6 +51,7 @@ SamplerState gsamAnisotropicClamp : register(s5);
 cbuffer cbPerObject : register(b0)
 {
     float4x4 gWorld;
+    float4x4 gInvTransposeWorld;
 	float4x4 gTexTransform;
 	uint gMaterialIndex;
 	uint gObjPad0;
@@ -110,8 +111,8 @@ VertexOut VS(VertexIn vin)
     float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
     vout.PosW = posW.xyz;
 
-    // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
-    vout.NormalW = mul(vin.NormalL, (float3x3)gWorld);
+    // The inverse-transpose keeps normals perpendicular under nonuniform scaling.
+    vout.NormalW = mul(vin.NormalL, (float3x3)gInvTransposeWorld);
 
     // Transform to homogeneous clip space.
     vout.PosH = mul(posW, gViewProj);
@@ -12,6 +12,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/MeshFile.h"
+#include "../../Common/DrawPackets.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -56,6 +58,9 @@ struct RenderItem
     UINT IndexCount = 0;
     UINT StartIndexLocation = 0;
     int BaseVertexLocation = 0;
+
+    // Orders the item's draw relative to the others (see DrawPacketQueue::MakeSortKey).
+    std::uint64_t SortKey = 0;
 };
 
 enum class RenderLayer : int
@@ -97,7 +102,8 @@ private:
     void BuildFrameResources();
     void BuildMaterials();
     void BuildRenderItems();
-    void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
+    void BuildSortKeys();
+    void DrawRenderItems(ID3D12GraphicsCommandList* cmdList);
 
     std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
@@ -123,6 +129,10 @@ private:
 
     // Render items divided by PSO.
     std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
+    std::array<ID3D12PipelineState*, (int)RenderLayer::Count> mLayerPSOs = {};
+
+    // The draws of every layer, sorted to bind each geometry once per layer.
+    DrawPacketQueue mDrawQueue;
 
     UINT mSkyTexHeapIndex = 0;
 
@@ -179,6 +189,7 @@ bool CubeMapApp::Initialize()
     BuildSkullGeometry();
     BuildMaterials();
     BuildRenderItems();
+    BuildSortKeys();
     BuildFrameResources();
     BuildPSOs();
 
@@ -296,10 +307,7 @@ void CubeMapApp::Draw(const GameTimer& gt)
     // The root signature knows how many descriptors are expected in the table.
     mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
-
-    mCommandList->SetPipelineState(mPSOs["sky"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
+    DrawRenderItems(mCommandList.Get());
 
     // Indicate a state transition on the resource usage.
     transition = CD3DX12_RESOURCE_BARRIER::Transition(
@@ -748,65 +756,30 @@ void CubeMapApp::BuildShapeGeometry()
 
 void CubeMapApp::BuildSkullGeometry()
 {
-    std::ifstream fin("Models/skull.txt");
-    if (!fin) [[unlikely]]
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(L"Models/skull.txt");
+    if (!mesh.IsValid()) [[unlikely]]
     {
         MessageBox(0, L"Models/skull.txt not found.", 0, 0);
         return;
     }
 
-    UINT vcount = 0;
-    UINT tcount = 0;
-    std::string ignore;
-    ignore.reserve(512);
-
-    fin >> ignore >> vcount;
-    fin >> ignore >> tcount;
-    fin >> ignore >> ignore >> ignore >> ignore;
-    ignore.clear();
-
-    constexpr XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
-    constexpr XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
-
-    XMVECTOR vMin = XMLoadFloat3(&vMinf3);
-    XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const UINT vcount = (UINT)meshVertices.size();
 
     std::vector<Vertex> vertices(vcount);
     for (UINT i = 0; i < vcount; ++i)
     {
-        fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-        fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
-
+        vertices[i].Pos = meshVertices[i].Position;
+        vertices[i].Normal = meshVertices[i].Normal;
         vertices[i].TexC = { 0.0f, 0.0f };
-
-        XMVECTOR P = XMLoadFloat3(&vertices[i].Pos);
-
-        vMin = XMVectorMin(vMin, P);
-        vMax = XMVectorMax(vMax, P);
     }
 
-    BoundingBox bounds;
-    XMStoreFloat3(&bounds.Center, 0.5f * (vMin + vMax));
-    XMStoreFloat3(&bounds.Extents, 0.5f * (vMax - vMin));
-
-    fin >> ignore;
-    fin >> ignore;
-    fin >> ignore;
-
-    std::vector<std::int32_t> indices(3 * tcount);
-    for (UINT i = 0; i < tcount; ++i)
-    {
-        fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
-    }
-
-    fin.close();
-
     //
     // Pack the indices of all the meshes into one index buffer.
     //
 
-    const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-    const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
+    const UINT vbByteSize = vcount * sizeof(Vertex);
+    const UINT ibByteSize = mesh.IndexBufferByteSize();
 
     auto geo = std::make_unique<MeshGeometry>();
     geo->Name = "skullGeo";
@@ -814,25 +787,26 @@ void CubeMapApp::BuildSkullGeometry()
     ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
     CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
 
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-    CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+    // Indices are used straight from the mapped file.
+    geo->IndexBufferCPU = mesh.IndexBlob();
 
     geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
         mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
 
     geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-        mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+        mCommandList.Get(), mesh.Indices().data(), ibByteSize, geo->IndexBufferUploader);
 
     geo->VertexByteStride = sizeof(Vertex);
     geo->VertexBufferByteSize = vbByteSize;
     geo->IndexFormat = DXGI_FORMAT_R32_UINT;
     geo->IndexBufferByteSize = ibByteSize;
 
+    // The bounds were computed when the mesh was converted.
     SubmeshGeometry submesh;
-    submesh.IndexCount = (UINT)indices.size();
+    submesh.IndexCount = (UINT)mesh.Indices().size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
-    submesh.Bounds = bounds;
+    submesh.Bounds = mesh.Submeshes()[0].Box;
 
     geo->DrawArgs["skull"] = submesh;
 
@@ -892,6 +866,9 @@ void CubeMapApp::BuildPSOs()
         mShaders["skyPS"]->GetBufferSize()
     };
     ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&skyPsoDesc, IID_PPV_ARGS(&mPSOs["sky"])));
+
+    mLayerPSOs[(int)RenderLayer::Opaque] = mPSOs["opaque"].Get();
+    mLayerPSOs[(int)RenderLayer::Sky] = mPSOs["sky"].Get();
 }
 
 void CubeMapApp::BuildFrameResources()
@@ -1077,28 +1054,62 @@ void CubeMapApp::BuildRenderItems()
     }
 }
 
-void CubeMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
+void CubeMapApp::BuildSortKeys()
+{
+    // Each layer has its own PSO, so the layer index doubles as the PSO id.  Geometries
+    // are numbered in the order they are first seen.
+    std::vector<const MeshGeometry*> geometries;
+
+    for (int layer = 0; layer < (int)RenderLayer::Count; ++layer)
+    {
+        for (RenderItem* ri : mRitemLayer[layer])
+        {
+            auto geometry = std::find(geometries.begin(), geometries.end(), ri->Geo);
+            if (geometry == geometries.end())
+            {
+                geometry = geometries.insert(geometries.end(), ri->Geo);
+            }
+
+            ri->SortKey = DrawPacketQueue::MakeSortKey(
+                layer,
+                layer,
+                (std::uint32_t)(geometry - geometries.begin()),
+                (std::uint32_t)ri->Mat->MatCBIndex);
+        }
+    }
+}
+
+void CubeMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList)
 {
     constexpr UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
 
     auto objectCB = mCurrFrameResource->ObjectCB->Resource();
 
+    mDrawQueue.Clear();
+
     // For each render item...
-    for (auto& ri : ritems)
+    for (int layer = 0; layer < (int)RenderLayer::Count; ++layer)
     {
-        const auto vertexView = ri->Geo->VertexBufferView();
-        const auto indexView = ri->Geo->IndexBufferView();
-
-        cmdList->IASetVertexBuffers(0, 1, &vertexView);
-        cmdList->IASetIndexBuffer(&indexView);
-        cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
-
-        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * objCBByteSize;
+        for (const RenderItem* ri : mRitemLayer[layer])
+        {
+            DrawPacket packet;
+            packet.Pso = mLayerPSOs[layer];
+            packet.VertexBuffer = ri->Geo->VertexBufferView();
+            packet.IndexBuffer = ri->Geo->IndexBufferView();
+            packet.PrimitiveType = ri->PrimitiveType;
+            packet.ObjectCB = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * objCBByteSize;
+            packet.IndexCount = ri->IndexCount;
+            packet.StartIndexLocation = ri->StartIndexLocation;
+            packet.BaseVertexLocation = ri->BaseVertexLocation;
+
+            mDrawQueue.Add(ri->SortKey, packet);
+        }
+    }
 
-        cmdList->SetGraphicsRootConstantBufferView(0, objCBAddress);
+    mDrawQueue.Sort();
 
-        cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
-    }
+    CommandListSink sink(cmdList);
+    mDrawQueue.Submit(sink);
 }
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> CubeMapApp::GetStaticSamplers()
@@ -12,6 +12,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/MeshFile.h"
+#include "../../Common/Profiler.h"
 #include "FrameResource.h"
 #include "ShadowMap.h"
 
@@ -271,6 +273,8 @@ void ShadowMapApp::Update(const GameTimer& gt)
     // If not, wait until the GPU has completed commands up to this fence point.
     if (mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
     {
+        PROFILE_SCOPE("Wait for frame resource");
+
         HANDLE eventHandle = CreateEventExW(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
         if (!eventHandle) [[unlikely]]
         {
@@ -391,7 +395,10 @@ void ShadowMapApp::Draw(const GameTimer& gt)
     mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
 
     // Swap the back and front buffers
-    ThrowIfFailed(mSwapChain->Present(0, 0));
+    {
+        PROFILE_SCOPE("Present");
+        ThrowIfFailed(mSwapChain->Present(0, 0));
+    }
     mCurrBackBufferIndex = mSwapChain->GetCurrentBackBufferIndex();
 
     // Advance the fence value to mark commands up to this fence point.
@@ -434,6 +441,8 @@ void ShadowMapApp::OnMouseMove(WPARAM btnState, int x, int y)
 
 void ShadowMapApp::OnKeyboardInput(const GameTimer& gt)
 {
+    PROFILE_SCOPE("OnKeyboardInput");
+
     const float dt = gt.DeltaTime();
 
     if (GetAsyncKeyState('W') & 0x8000)
@@ -453,11 +462,13 @@ void ShadowMapApp::OnKeyboardInput(const GameTimer& gt)
 
 void ShadowMapApp::AnimateMaterials(const GameTimer& gt)
 {
-
+    PROFILE_SCOPE("AnimateMaterials");
 }
 
 void ShadowMapApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateObjectCBs");
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -483,6 +494,8 @@ void ShadowMapApp::UpdateObjectCBs(const GameTimer& gt)
 
 void ShadowMapApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateMaterialBuffer");
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -511,6 +524,8 @@ void ShadowMapApp::UpdateMaterialBuffer(const GameTimer& gt)
 
 void ShadowMapApp::UpdateShadowTransform(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateShadowTransform");
+
     // Only the first "main" light casts a shadow.
     XMVECTOR lightDir = XMLoadFloat3(&mRotatedLightDirections[0]);
     XMVECTOR lightPos = -2.0f * mSceneBounds.Radius * lightDir;
@@ -551,6 +566,8 @@ void ShadowMapApp::UpdateShadowTransform(const GameTimer& gt)
 
 void ShadowMapApp::UpdateMainPassCB(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateMainPassCB");
+
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
     XMMATRIX viewProj = XMMatrixMultiply(view, proj);
@@ -593,6 +610,8 @@ void ShadowMapApp::UpdateMainPassCB(const GameTimer& gt)
 
 void ShadowMapApp::UpdateShadowPassCB(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateShadowPassCB");
+
     XMMATRIX view = XMLoadFloat4x4(&mLightView);
     XMMATRIX proj = XMLoadFloat4x4(&mLightProj);
     XMMATRIX viewProj = XMMatrixMultiply(view, proj);
@@ -970,40 +989,25 @@ void ShadowMapApp::BuildShapeGeometry()
 
 void ShadowMapApp::BuildSkullGeometry()
 {
-    std::ifstream fin("Models/skull.txt");
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(L"Models/skull.txt");
 
-    if (!fin)
+    if (!mesh.IsValid())
     {
         MessageBox(0, L"Models/skull.txt not found.", 0, 0);
         return;
     }
 
-    UINT vcount = 0;
-    UINT tcount = 0;
-    std::string ignore;
-    ignore.reserve(512);
-
-    fin >> ignore >> vcount;
-    fin >> ignore >> tcount;
-    fin >> ignore >> ignore >> ignore >> ignore;
-    ignore.clear();
-
-    constexpr XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
-    constexpr XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
-
-    XMVECTOR vMin = XMLoadFloat3(&vMinf3);
-    XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const UINT vcount = (UINT)meshVertices.size();
 
     std::vector<Vertex> vertices(vcount);
     for (UINT i = 0; i < vcount; ++i)
     {
-        fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-        fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
+        vertices[i].Pos = meshVertices[i].Position;
+        vertices[i].Normal = meshVertices[i].Normal;
 
         vertices[i].TexC = { 0.0f, 0.0f };
 
-        XMVECTOR P = XMLoadFloat3(&vertices[i].Pos);
-
         XMVECTOR N = XMLoadFloat3(&vertices[i].Normal);
 
         // Generate a tangent vector so normal mapping works.  We aren't applying
@@ -1021,33 +1025,14 @@ void ShadowMapApp::BuildSkullGeometry()
             XMVECTOR T = XMVector3Normalize(XMVector3Cross(N, up));
             XMStoreFloat3(&vertices[i].TangentU, T);
         }
-
-        vMin = XMVectorMin(vMin, P);
-        vMax = XMVectorMax(vMax, P);
-    }
-
-    BoundingBox bounds;
-    XMStoreFloat3(&bounds.Center, 0.5f * (vMin + vMax));
-    XMStoreFloat3(&bounds.Extents, 0.5f * (vMax - vMin));
-
-    fin >> ignore;
-    fin >> ignore;
-    fin >> ignore;
-
-    std::vector<std::int32_t> indices(3 * tcount);
-    for (UINT i = 0; i < tcount; ++i)
-    {
-        fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
     }
 
-    fin.close();
-
     //
     // Pack the indices of all the meshes into one index buffer.
     //
 
     const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-    const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
+    const UINT ibByteSize = mesh.IndexBufferByteSize();
 
     auto geo = std::make_unique<MeshGeometry>();
     geo->Name = "skullGeo";
@@ -1055,14 +1040,14 @@ void ShadowMapApp::BuildSkullGeometry()
     ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
     CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
 
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-    CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+    // Indices are used straight from the mapped file.
+    geo->IndexBufferCPU = mesh.IndexBlob();
 
     geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
         mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
 
     geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-        mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+        mCommandList.Get(), mesh.Indices().data(), ibByteSize, geo->IndexBufferUploader);
 
     geo->VertexByteStride = sizeof(Vertex);
     geo->VertexBufferByteSize = vbByteSize;
@@ -1070,10 +1055,10 @@ void ShadowMapApp::BuildSkullGeometry()
     geo->IndexBufferByteSize = ibByteSize;
 
     SubmeshGeometry submesh;
-    submesh.IndexCount = (UINT)indices.size();
+    submesh.IndexCount = (UINT)mesh.Indices().size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
-    submesh.Bounds = bounds;
+    submesh.Bounds = mesh.Submeshes()[0].Box;
 
     geo->DrawArgs["skull"] = submesh;
 
@@ -1413,6 +1398,8 @@ void ShadowMapApp::DrawRenderItems(
 
 void ShadowMapApp::DrawSceneToShadowMap()
 {
+    PROFILE_SCOPE("DrawSceneToShadowMap");
+
     const auto viewPort = mShadowMap->Viewport();
     const auto scissorRect = mShadowMap->ScissorRect();
 
@@ -3,15 +3,23 @@
 //***************************************************************************************
 
 #include <array>
+#include <cmath>
+#include <deque>
 #include <fstream>
+#include <span>
 #include <string>
 
 #include "../../Common/DDSTextureLoader.h"
 #include "../../Common/d3dApp.h"
+#include "../../Common/AssetCache.h"
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/MeshFile.h"
+#include "../../Common/Profiler.h"
+#include "../../Common/TextureLoader.h"
+#include "../../Common/TextureResidency.h"
 #include "FrameResource.h"
 #include "ShadowMap.h"
 #include "Ssao.h"
@@ -22,6 +30,58 @@ using namespace DirectX::PackedVector;
 
 constexpr int gNumFrameResources = 3;
 
+// The 2D texture SRVs in heap order, each with the texture it shows until its own
+// has loaded.  The sky cube map follows them.
+struct TextureSrv final
+{
+    const char* Name;
+    const char* Placeholder;
+};
+
+constexpr std::array<TextureSrv, 6> gTexture2DSrvs =
+{ {
+    { "bricksDiffuseMap", "defaultDiffuseMap" },
+    { "bricksNormalMap", "defaultNormalMap" },
+    { "tileDiffuseMap", "defaultDiffuseMap" },
+    { "tileNormalMap", "defaultNormalMap" },
+    { "defaultDiffuseMap", "defaultDiffuseMap" },
+    { "defaultNormalMap", "defaultNormalMap" }
+} };
+
+// Mip streaming.  A 2D texture with a mip chain is created with only the mips of at
+// most gStreamTailExtent texels at first; StreamTextureMips brings in the finer ones
+// as the camera gets close enough to see them and drops them again when the
+// residency budget runs out.
+constexpr bool gStreamTextureMips = true;
+constexpr std::uint32_t gStreamTailExtent = 64;
+constexpr std::uint64_t gTextureBudgetBytes = 1536 * 1024;
+
+// Each promotion recreates and uploads a texture, so only this many happen a frame;
+// the rest follow in later frames.
+constexpr std::uint32_t gMaxTexturePromotionsPerFrame = 2;
+
+// Size of the gTextureMaps table in Common.hlsl.  Each frame resource has its own
+// copy so that one frame can rewrite its texture SRVs while the GPU reads another's.
+constexpr UINT gTextureTableSize = 10;
+
+// Identifies a vertex layout, so that GetShared only hands out vertex buffers built
+// for the layout asked for.
+std::uint64_t VertexLayoutId(const std::span<const D3D12_INPUT_ELEMENT_DESC> layout)
+{
+    std::string key;
+    for (const D3D12_INPUT_ELEMENT_DESC& element : layout)
+    {
+        key += element.SemanticName;
+        for (const UINT value : { element.SemanticIndex, (UINT)element.Format, element.InputSlot, element.AlignedByteOffset })
+        {
+            key += ' ';
+            key += std::to_string(value);
+        }
+        key += ';';
+    }
+    return AssetCache::HashBytes(std::as_bytes(std::span(key)));
+}
+
 // Lightweight structure stores parameters to draw a shape.  This will
 // vary from app-to-app.
 struct RenderItem
@@ -36,6 +96,9 @@ struct RenderItem
 
     XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 
+    // Object space bounds of the geometry, used to pick the texture mips to stream.
+    BoundingBox Bounds;
+
     // Dirty flag indicating the object data has changed and we need to update the constant buffer.
     // Because we have an object cbuffer for each FrameResource, we have to apply the
     // update to each FrameResource.  Thus, when we modify obect data we should set 
@@ -91,12 +154,24 @@ private:
     void UpdateSsaoCB(const GameTimer& gt);
 
     void LoadTextures();
+    void UploadLoadedTextures();
+    std::shared_ptr<Texture> CreateSharedTexture(const LoadedTexture& loaded, std::size_t maxsize);
+    std::size_t RegisterStreamedTexture(const TextureLoader::TexturePtr& loaded);
+    void StreamTextureMips();
+    void ReplaceTexture(const std::string& name, std::shared_ptr<Texture> texMap);
+    void ReleaseRetiredTextures();
+    void WaitForFence(UINT64 fence);
+    void BeginTextureUploads();
+    void EndTextureUploads();
     void BuildRootSignature();
     void BuildSsaoRootSignature();
     void BuildDescriptorHeaps();
+    void BuildTextureTable(int frameIndex);
+    void BuildSkySrv();
     void BuildShadersAndInputLayout();
     void BuildShapeGeometry();
     void BuildSkullGeometry();
+    std::shared_ptr<MeshGeometry> CreateSkullGeometry(const MeshFile::MappedMesh& mesh);
     void BuildPSOs();
     void BuildFrameResources();
     void BuildMaterials();
@@ -122,9 +197,35 @@ private:
 
     ComPtr<ID3D12DescriptorHeap> mSrvDescriptorHeap = nullptr;
 
-    std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
+    std::unordered_map<std::string, std::shared_ptr<MeshGeometry>> mGeometries;
     std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
-    std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
+    std::unordered_map<std::string, std::shared_ptr<Texture>> mTextures;
+    TextureLoader mTextureLoader;
+
+    // Indexed by TextureResidency::TextureId.  Keeping the parsed files keeps them
+    // mapped for the mips that are not resident yet.
+    TextureResidency mTextureResidency{ gTextureBudgetBytes };
+    std::vector<TextureLoader::TexturePtr> mStreamedTextures;
+    std::unordered_map<std::string, TextureResidency::TextureId> mStreamedTextureIds;
+
+    // A replaced texture may still be sampled by the frames in flight, so it is kept
+    // until the GPU passes Fence.
+    struct RetiredTexture final
+    {
+        UINT64 Fence = 0;
+        std::shared_ptr<Texture> TexMap;
+    };
+    std::deque<RetiredTexture> mRetiredTextures;
+
+    // Signaled after each batch of texture uploads; the next batch reuses the
+    // allocator once the GPU has passed it.
+    UINT64 mTextureUploadFence = 0;
+
+    // Bumped whenever mTextures changes.  A frame rebuilds its texture table when the
+    // version it was built from is older.
+    std::uint64_t mTextureSrvVersion = 1;
+    std::array<std::uint64_t, gNumFrameResources> mTextureTableVersions = {};
+
     std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
     std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 
@@ -137,6 +238,7 @@ private:
     std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
     UINT mSkyTexHeapIndex = 0;
+    UINT mTextureTableHeapIndex = 0;
     UINT mShadowMapHeapIndex = 0;
     UINT mSsaoHeapIndexStart = 0;
     UINT mSsaoAmbientMapIndex = 0;
@@ -221,6 +323,8 @@ bool SsaoApp::Initialize()
 
     mCamera.SetPosition(0.0f, 2.0f, -15.0f);
 
+    mTextureResidency.SetMaxPromotionsPerFrame(gMaxTexturePromotionsPerFrame);
+
     mShadowMap = std::make_unique<ShadowMap>(
         md3dDevice.Get(),
         2048, 
@@ -295,6 +399,9 @@ void SsaoApp::OnResize()
 void SsaoApp::Update(const GameTimer& gt)
 {
     OnKeyboardInput(gt);
+    UploadLoadedTextures();
+    StreamTextureMips();
+    ReleaseRetiredTextures();
 
     // Cycle through the circular frame resource array.
     mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
@@ -304,6 +411,8 @@ void SsaoApp::Update(const GameTimer& gt)
     // If not, wait until the GPU has completed commands up to this fence point.
     if (mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
     {
+        PROFILE_SCOPE("Wait for frame resource");
+
         HANDLE eventHandle = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
         if (!eventHandle) [[unlikely]]
         {
@@ -354,6 +463,14 @@ void SsaoApp::Draw(const GameTimer& gt)
 
     mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
 
+    // The GPU is done with this frame resource, and so with its texture table.
+    if (mTextureTableVersions[mCurrFrameResourceIndex] != mTextureSrvVersion)
+    {
+        BuildTextureTable(mCurrFrameResourceIndex);
+        mTextureTableVersions[mCurrFrameResourceIndex] = mTextureSrvVersion;
+    }
+    const auto textureTable = GetGpuSrv(mTextureTableHeapIndex + mCurrFrameResourceIndex * gTextureTableSize);
+
     //
     // Shadow map pass.
     //
@@ -369,7 +486,7 @@ void SsaoApp::Draw(const GameTimer& gt)
     // Bind all the textures used in this scene.  Observe
     // that we only have to specify the first descriptor in the table.  
     // The root signature knows how many descriptors are expected in the table.
-    mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    mCommandList->SetGraphicsRootDescriptorTable(4, textureTable);
 
     DrawSceneToShadowMap();
 
@@ -424,7 +541,7 @@ void SsaoApp::Draw(const GameTimer& gt)
     // Bind all the textures used in this scene.  Observe
     // that we only have to specify the first descriptor in the table.  
     // The root signature knows how many descriptors are expected in the table.
-    mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    mCommandList->SetGraphicsRootDescriptorTable(4, textureTable);
 
     auto passCB = mCurrFrameResource->PassCB->Resource();
     mCommandList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
@@ -462,7 +579,10 @@ void SsaoApp::Draw(const GameTimer& gt)
     mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
 
     // Swap the back and front buffers
-    ThrowIfFailed(mSwapChain->Present(0, 0));
+    {
+        PROFILE_SCOPE("Present");
+        ThrowIfFailed(mSwapChain->Present(0, 0));
+    }
     mCurrBackBufferIndex = mSwapChain->GetCurrentBackBufferIndex();
 
     // Advance the fence value to mark commands up to this fence point.
@@ -505,6 +625,8 @@ void SsaoApp::OnMouseMove(WPARAM btnState, int x, int y)
 
 void SsaoApp::OnKeyboardInput(const GameTimer& gt)
 {
+    PROFILE_SCOPE("OnKeyboardInput");
+
     const float dt = gt.DeltaTime();
 
     if (GetAsyncKeyState('W') & 0x8000)
@@ -524,11 +646,13 @@ void SsaoApp::OnKeyboardInput(const GameTimer& gt)
 
 void SsaoApp::AnimateMaterials(const GameTimer& gt)
 {
-
+    PROFILE_SCOPE("AnimateMaterials");
 }
 
 void SsaoApp::UpdateObjectCBs(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateObjectCBs");
+
     auto currObjectCB = mCurrFrameResource->ObjectCB.get();
     for (auto& e : mAllRitems)
     {
@@ -554,6 +678,8 @@ void SsaoApp::UpdateObjectCBs(const GameTimer& gt)
 
 void SsaoApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateMaterialBuffer");
+
     auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
     for (auto& e : mMaterials)
     {
@@ -582,6 +708,8 @@ void SsaoApp::UpdateMaterialBuffer(const GameTimer& gt)
 
 void SsaoApp::UpdateShadowTransform(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateShadowTransform");
+
     // Only the first "main" light casts a shadow.
     XMVECTOR lightDir = XMLoadFloat3(&mRotatedLightDirections[0]);
     XMVECTOR lightPos = -2.0f * mSceneBounds.Radius * lightDir;
@@ -622,6 +750,8 @@ void SsaoApp::UpdateShadowTransform(const GameTimer& gt)
 
 void SsaoApp::UpdateMainPassCB(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateMainPassCB");
+
     XMMATRIX view = mCamera.GetView();
     XMMATRIX proj = mCamera.GetProj();
     XMMATRIX viewProj = XMMatrixMultiply(view, proj);
@@ -673,6 +803,8 @@ void SsaoApp::UpdateMainPassCB(const GameTimer& gt)
 
 void SsaoApp::UpdateShadowPassCB(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateShadowPassCB");
+
     XMMATRIX view = XMLoadFloat4x4(&mLightView);
     XMMATRIX proj = XMLoadFloat4x4(&mLightProj);
     XMMATRIX viewProj = XMMatrixMultiply(view, proj);
@@ -706,6 +838,8 @@ void SsaoApp::UpdateShadowPassCB(const GameTimer& gt)
 
 void SsaoApp::UpdateSsaoCB(const GameTimer& gt)
 {
+    PROFILE_SCOPE("UpdateSsaoCB");
+
     SsaoConstants ssaoCB;
 
     XMMATRIX P = mCamera.GetProj();
@@ -742,39 +876,259 @@ void SsaoApp::UpdateSsaoCB(const GameTimer& gt)
 
 void SsaoApp::LoadTextures()
 {
-    const std::array<std::string, 7> texNames =
+    // The placeholders are tiny and must exist before the first frame.
+    const std::array<std::string, 2> placeholderNames =
+    {
+        "defaultDiffuseMap",
+        "defaultNormalMap"
+    };
+
+    const std::array<std::wstring, 2> placeholderFilenames =
+    {
+        L"../../Textures/white1x1.dds",
+        L"../../Textures/default_nmap.dds"
+    };
+
+    for (int i = 0; i < (int)placeholderNames.size(); ++i)
+    {
+        auto texMap = std::make_unique<Texture>();
+        texMap->Name = placeholderNames[i];
+        texMap->Filename = placeholderFilenames[i];
+        ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
+            mCommandList.Get(), texMap->Filename.c_str(),
+            texMap->Resource, texMap->UploadHeap));
+
+        mTextures[texMap->Name] = std::move(texMap);
+    }
+
+    // The rest are read and parsed on the thread pool.  UploadLoadedTextures creates
+    // them as they come in; until then their SRVs show the placeholders.
+    const std::array<std::string, 5> texNames =
     {
         "bricksDiffuseMap",
         "bricksNormalMap",
         "tileDiffuseMap",
         "tileNormalMap",
-        "defaultDiffuseMap",
-        "defaultNormalMap",
         "skyCubeMap"
     };
 
-    const std::array<std::wstring, 7> texFilenames =
+    const std::array<std::wstring, 5> texFilenames =
     {
         L"../../Textures/bricks2.dds",
         L"../../Textures/bricks2_nmap.dds",
         L"../../Textures/tile.dds",
         L"../../Textures/tile_nmap.dds",
-        L"../../Textures/white1x1.dds",
-        L"../../Textures/default_nmap.dds",
         L"../../Textures/sunsetcube1024.dds"
     };
 
     for (int i = 0; i < (int)texNames.size(); ++i)
     {
-        auto texMap = std::make_unique<Texture>();
-        texMap->Name = texNames[i];
-        texMap->Filename = texFilenames[i];
-        ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-            mCommandList.Get(), texMap->Filename.c_str(),
-            texMap->Resource, texMap->UploadHeap));
+        mTextureLoader.Load(texNames[i], texFilenames[i]);
+    }
+}
 
-        mTextures[texMap->Name] = std::move(texMap);
+void SsaoApp::UploadLoadedTextures()
+{
+    if (mTextureLoader.Pending() == 0)
+        return;
+
+    PROFILE_SCOPE("UploadLoadedTextures");
+
+    bool recording = false;
+    bool skyLoaded = false;
+    mTextureLoader.Poll([this, &recording, &skyLoaded](const TextureLoader::TexturePtr& loaded)
+    {
+        // A texture that failed to load keeps showing its placeholder.
+        if (!loaded->Succeeded())
+        {
+            ::OutputDebugStringW((L"Could not load " + loaded->Filename + L"\n").c_str());
+            return;
+        }
+
+        if (!recording)
+        {
+            BeginTextureUploads();
+            recording = true;
+        }
+
+        // Streamed textures start out with their mip tail only.
+        const std::size_t maxsize = RegisterStreamedTexture(loaded);
+        ReplaceTexture(loaded->Name, CreateSharedTexture(*loaded, maxsize));
+        skyLoaded = skyLoaded || loaded->Name == "skyCubeMap";
+    });
+
+    if (recording)
+        EndTextureUploads();
+
+    // The sky SRV is not versioned per frame, so its one change, away from the null
+    // SRV, waits for the frames in flight.
+    if (skyLoaded)
+    {
+        FlushCommandQueue();
+        BuildSkySrv();
+    }
+}
+
+std::shared_ptr<Texture> SsaoApp::CreateSharedTexture(const LoadedTexture& loaded, const std::size_t maxsize)
+{
+    // Names whose files have the same contents share one GPU copy, and only the first
+    // of them records an upload.
+    return AssetCache::Default().GetShared<Texture>(md3dDevice.Get(), loaded.Asset->ContentId, maxsize, [&]
+    {
+        auto texMap = std::make_shared<Texture>();
+        texMap->Name = loaded.Name;
+        texMap->Filename = loaded.Filename;
+        ThrowIfFailed(DirectX::CreateDDSTextureFromParsed12(md3dDevice.Get(),
+            mCommandList.Get(), loaded.Texture(),
+            texMap->Resource, texMap->UploadHeap, maxsize));
+        return texMap;
+    });
+}
+
+std::size_t SsaoApp::RegisterStreamedTexture(const TextureLoader::TexturePtr& loaded)
+{
+    const DDSFile::Texture& dds = loaded->Texture();
+    const DDSFile::TextureDesc& desc = dds.Desc();
+
+    // Cube maps are not drawn by render items, so nothing would ask for their mips.
+    const std::uint32_t tailMip = dds.FirstMipWithin(gStreamTailExtent);
+    if (!gStreamTextureMips || desc.IsCubeMap || desc.Dimension != DDSFile::TextureDimension::Texture2D ||
+        tailMip == 0 || tailMip == desc.MipLevels)
+    {
+        return 0;
+    }
+
+    std::vector<std::uint64_t> mipBytes(desc.MipLevels);
+    for (std::uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+    {
+        mipBytes[mip] = dds.MipLevelSize(mip);
     }
+
+    const TextureResidency::TextureId id = mTextureResidency.Add(std::move(mipBytes), tailMip);
+    mStreamedTextures.push_back(loaded);
+    mStreamedTextureIds[loaded->Name] = id;
+
+    return dds.MipExtent(tailMip);
+}
+
+void SsaoApp::StreamTextureMips()
+{
+    if (mStreamedTextures.empty())
+        return;
+
+    PROFILE_SCOPE("StreamTextureMips");
+
+    // Ask for the mip whose texels come closest to one per pixel over each visible
+    // item, judging its screen size by its bounding sphere.
+    BoundingFrustum frustum(mCamera.GetProj());
+    frustum.Transform(frustum, XMMatrixInverse(nullptr, mCamera.GetView()));
+
+    const XMVECTOR eyePos = mCamera.GetPosition();
+    const float pixelsPerUnit = mClientHeight / (2.0f * tanf(0.5f * mCamera.GetFovY()));
+
+    for (const RenderItem* ri : mRitemLayer[(int)RenderLayer::Opaque])
+    {
+        BoundingBox bounds;
+        ri->Bounds.Transform(bounds, XMLoadFloat4x4(&ri->World));
+        if (frustum.Contains(bounds) == DISJOINT)
+            continue;
+
+        const float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Extents)));
+        const float distance = std::max(
+            XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Center) - eyePos)) - radius, mCamera.GetNearZ());
+        const float pixels = std::max(2.0f * radius * pixelsPerUnit / distance, 1.0f);
+
+        // The texture transforms here only scale.
+        const float repeat = std::max(ri->TexTransform(0, 0), ri->TexTransform(1, 1));
+
+        for (const int srvIndex : { ri->Mat->DiffuseSrvHeapIndex, ri->Mat->NormalSrvHeapIndex })
+        {
+            if (srvIndex < 0 || srvIndex >= (int)gTexture2DSrvs.size())
+                continue;
+
+            const auto it = mStreamedTextureIds.find(gTexture2DSrvs[srvIndex].Name);
+            if (it == mStreamedTextureIds.end())
+                continue;
+
+            const float texels = mStreamedTextures[it->second]->Texture().MipExtent(0) * repeat;
+            const float mip = floorf(log2f(texels / pixels));
+            mTextureResidency.Request(it->second, mip > 0.0f ? (std::uint32_t)mip : 0);
+        }
+    }
+
+    std::vector<TextureResidency::Change> changes;
+    mTextureResidency.EndFrame(changes);
+    if (changes.empty())
+        return;
+
+    // Each change recreates the texture with its new mip range.  The finer mips come
+    // straight from the mapped file, so a promotion costs one copy and no disk read.
+    // All of the frame's changes share one command list.
+    BeginTextureUploads();
+
+    for (const TextureResidency::Change& change : changes)
+    {
+        const LoadedTexture& streamed = *mStreamedTextures[change.Id];
+        ReplaceTexture(streamed.Name, CreateSharedTexture(streamed, streamed.Texture().MipExtent(change.NewMip)));
+    }
+
+    EndTextureUploads();
+}
+
+void SsaoApp::ReplaceTexture(const std::string& name, std::shared_ptr<Texture> texMap)
+{
+    // Every frame submitted so far may sample the old texture.
+    std::shared_ptr<Texture>& current = mTextures[name];
+    if (current != nullptr)
+        mRetiredTextures.push_back({ mCurrentFence, std::move(current) });
+
+    current = std::move(texMap);
+    ++mTextureSrvVersion;
+}
+
+void SsaoApp::ReleaseRetiredTextures()
+{
+    const UINT64 completed = mFence->GetCompletedValue();
+    while (!mRetiredTextures.empty() && mRetiredTextures.front().Fence <= completed)
+        mRetiredTextures.pop_front();
+}
+
+void SsaoApp::WaitForFence(const UINT64 fence)
+{
+    if (mFence->GetCompletedValue() >= fence)
+        return;
+
+    HANDLE eventHandle = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+    if (!eventHandle) [[unlikely]]
+    {
+        std::abort();
+    }
+    ThrowIfFailed(mFence->SetEventOnCompletion(fence, eventHandle));
+    WaitForSingleObject(eventHandle, INFINITE);
+    CloseHandle(eventHandle);
+}
+
+void SsaoApp::BeginTextureUploads()
+{
+    // The init allocator is reused for the copies, so the previous batch must be done
+    // with it.  A frame or more has gone by since, so this seldom waits.  The textures
+    // being replaced are retired rather than released, so frames in flight carry on.
+    WaitForFence(mTextureUploadFence);
+    ThrowIfFailed(mDirectCmdListAlloc->Reset());
+    ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
+}
+
+void SsaoApp::EndTextureUploads()
+{
+    // The copies run ahead of the next frame on the same queue, so there is no need to
+    // wait for them; the upload heaps live as long as the textures.  The frames pick
+    // up the new SRVs as they rebuild their texture tables.
+    ThrowIfFailed(mCommandList->Close());
+    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+    mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+
+    mTextureUploadFence = ++mCurrentFence;
+    ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), mTextureUploadFence));
 }
 
 void SsaoApp::BuildRootSignature()
@@ -783,7 +1137,7 @@ void SsaoApp::BuildRootSignature()
     texTable0.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 3, 0, 0);
 
     CD3DX12_DESCRIPTOR_RANGE texTable1 = {};
-    texTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 10, 3, 0);
+    texTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, gTextureTableSize, 3, 0);
 
     // Root parameter can be a table, root descriptor or root constants.
     CD3DX12_ROOT_PARAMETER slotRootParameter[5] = {};
@@ -906,52 +1260,15 @@ void SsaoApp::BuildDescriptorHeaps()
     // Create the SRV heap.
     //
     D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-    srvHeapDesc.NumDescriptors = 18;
+    // The texture tables of the frame resources, then the sky, shadow and SSAO maps
+    // and null SRVs.
+    srvHeapDesc.NumDescriptors = gNumFrameResources * gTextureTableSize + 12;
     srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
     srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
     ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvDescriptorHeap)));
 
-    //
-    // Fill out the heap with actual descriptors.
-    //
-    CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-
-    const std::array<ComPtr<ID3D12Resource>, 6> tex2DList =
-    {
-        mTextures["bricksDiffuseMap"]->Resource,
-        mTextures["bricksNormalMap"]->Resource,
-        mTextures["tileDiffuseMap"]->Resource,
-        mTextures["tileNormalMap"]->Resource,
-        mTextures["defaultDiffuseMap"]->Resource,
-        mTextures["defaultNormalMap"]->Resource
-    };
-
-    const auto& skyCubeMap = mTextures["skyCubeMap"]->Resource;
-
-    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MostDetailedMip = 0;
-    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-
-    for (UINT i = 0; i < (UINT)tex2DList.size(); ++i)
-    {
-        srvDesc.Format = tex2DList[i]->GetDesc().Format;
-        srvDesc.Texture2D.MipLevels = tex2DList[i]->GetDesc().MipLevels;
-        md3dDevice->CreateShaderResourceView(tex2DList[i].Get(), &srvDesc, hDescriptor);
-
-        // next descriptor
-        hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-    }
-
-    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-    srvDesc.TextureCube.MostDetailedMip = 0;
-    srvDesc.TextureCube.MipLevels = skyCubeMap->GetDesc().MipLevels;
-    srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
-    srvDesc.Format = skyCubeMap->GetDesc().Format;
-    md3dDevice->CreateShaderResourceView(skyCubeMap.Get(), &srvDesc, hDescriptor);
-
-    mSkyTexHeapIndex = (UINT)tex2DList.size();
+    mTextureTableHeapIndex = 0;
+    mSkyTexHeapIndex = gNumFrameResources * gTextureTableSize;
     mShadowMapHeapIndex = mSkyTexHeapIndex + 1;
     mSsaoHeapIndexStart = mShadowMapHeapIndex + 1;
     mSsaoAmbientMapIndex = mSsaoHeapIndexStart + 3;
@@ -959,9 +1276,18 @@ void SsaoApp::BuildDescriptorHeaps()
     mNullTexSrvIndex1 = mNullCubeSrvIndex + 1;
     mNullTexSrvIndex2 = mNullTexSrvIndex1 + 1;
 
+    BuildSkySrv();
+
     auto nullSrv = GetCpuSrv(mNullCubeSrvIndex);
     mNullSrv = GetGpuSrv(mNullCubeSrvIndex);
 
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.TextureCube.MostDetailedMip = 0;
+    srvDesc.TextureCube.MipLevels = 1;
+    srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
     md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, nullSrv);
     nullSrv.Offset(1, mCbvSrvUavDescriptorSize);
 
@@ -989,6 +1315,62 @@ void SsaoApp::BuildDescriptorHeaps()
         mRtvDescriptorSize);
 }
 
+void SsaoApp::BuildTextureTable(const int frameIndex)
+{
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+
+    const UINT tableStart = mTextureTableHeapIndex + frameIndex * gTextureTableSize;
+    for (UINT i = 0; i < (UINT)gTexture2DSrvs.size(); ++i)
+    {
+        auto it = mTextures.find(gTexture2DSrvs[i].Name);
+        if (it == mTextures.end())
+            it = mTextures.find(gTexture2DSrvs[i].Placeholder);
+
+        const auto& tex = it->second->Resource;
+        srvDesc.Format = tex->GetDesc().Format;
+        srvDesc.Texture2D.MipLevels = tex->GetDesc().MipLevels;
+        md3dDevice->CreateShaderResourceView(tex.Get(), &srvDesc, GetCpuSrv(tableStart + i));
+    }
+
+    // No material uses the rest of the table.
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.Texture2D.MipLevels = 1;
+    for (UINT i = (UINT)gTexture2DSrvs.size(); i < gTextureTableSize; ++i)
+    {
+        md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, GetCpuSrv(tableStart + i));
+    }
+}
+
+void SsaoApp::BuildSkySrv()
+{
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+
+    // Until the sky has loaded it samples as black through a null SRV.
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+    srvDesc.TextureCube.MostDetailedMip = 0;
+    srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+
+    const auto skyCubeMap = mTextures.find("skyCubeMap");
+    if (skyCubeMap != mTextures.end())
+    {
+        const auto& tex = skyCubeMap->second->Resource;
+        srvDesc.Format = tex->GetDesc().Format;
+        srvDesc.TextureCube.MipLevels = tex->GetDesc().MipLevels;
+        md3dDevice->CreateShaderResourceView(tex.Get(), &srvDesc, GetCpuSrv(mSkyTexHeapIndex));
+    }
+    else
+    {
+        srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        srvDesc.TextureCube.MipLevels = 1;
+        md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, GetCpuSrv(mSkyTexHeapIndex));
+    }
+}
+
 void SsaoApp::BuildShadersAndInputLayout()
 {
     constexpr D3D_SHADER_MACRO alphaTestDefines[] =
@@ -1164,6 +1546,13 @@ void SsaoApp::BuildShapeGeometry()
     geo->IndexFormat = DXGI_FORMAT_R16_UINT;
     geo->IndexBufferByteSize = ibByteSize;
 
+    // Bounds of the shapes, as generated.
+    BoundingBox::CreateFromPoints(boxSubmesh.Bounds, box.Vertices.size(), &box.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+    BoundingBox::CreateFromPoints(gridSubmesh.Bounds, grid.Vertices.size(), &grid.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+    BoundingBox::CreateFromPoints(sphereSubmesh.Bounds, sphere.Vertices.size(), &sphere.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+    BoundingBox::CreateFromPoints(cylinderSubmesh.Bounds, cylinder.Vertices.size(), &cylinder.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+    BoundingBox::CreateFromPoints(quadSubmesh.Bounds, quad.Vertices.size(), &quad.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+
     geo->DrawArgs["box"] = boxSubmesh;
     geo->DrawArgs["grid"] = gridSubmesh;
     geo->DrawArgs["sphere"] = sphereSubmesh;
@@ -1175,40 +1564,33 @@ void SsaoApp::BuildShapeGeometry()
 
 void SsaoApp::BuildSkullGeometry()
 {
-    std::ifstream fin("Models/skull.txt");
+    const AssetCache::Handle<MeshFile::MappedMesh> skull = MeshFile::LoadCached(L"Models/skull.txt");
 
-    if (!fin)
+    if (skull == nullptr)
     {
         MessageBoxW(0, L"Models/skull.txt not found.", 0, 0);
         return;
     }
 
-    UINT vcount = 0;
-    UINT tcount = 0;
-    std::string ignore;
-    ignore.reserve(512);
-
-    fin >> ignore >> vcount;
-    fin >> ignore >> tcount;
-    fin >> ignore >> ignore >> ignore >> ignore;
-    ignore.clear();
-
-    constexpr XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
-    constexpr XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
+    // Scenes showing the same model share its buffers, if they expand it to the same
+    // vertex layout.
+    mGeometries["skullGeo"] = AssetCache::Default().GetShared<MeshGeometry>(md3dDevice.Get(), skull->ContentId,
+        VertexLayoutId(mInputLayout), [&] { return CreateSkullGeometry(skull->Value); });
+}
 
-    XMVECTOR vMin = XMLoadFloat3(&vMinf3);
-    XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
+std::shared_ptr<MeshGeometry> SsaoApp::CreateSkullGeometry(const MeshFile::MappedMesh& mesh)
+{
+    const std::span<const MeshFile::Vertex> meshVertices = mesh.Vertices();
+    const UINT vcount = (UINT)meshVertices.size();
 
     std::vector<Vertex> vertices(vcount);
     for (UINT i = 0; i < vcount; ++i)
     {
-        fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-        fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
+        vertices[i].Pos = meshVertices[i].Position;
+        vertices[i].Normal = meshVertices[i].Normal;
 
         vertices[i].TexC = { 0.0f, 0.0f };
 
-        XMVECTOR P = XMLoadFloat3(&vertices[i].Pos);
-
         XMVECTOR N = XMLoadFloat3(&vertices[i].Normal);
 
         // Generate a tangent vector so normal mapping works.  We aren't applying
@@ -1226,50 +1608,30 @@ void SsaoApp::BuildSkullGeometry()
             XMVECTOR T = XMVector3Normalize(XMVector3Cross(N, up));
             XMStoreFloat3(&vertices[i].TangentU, T);
         }
-
-
-        vMin = XMVectorMin(vMin, P);
-        vMax = XMVectorMax(vMax, P);
     }
 
-    BoundingBox bounds;
-    XMStoreFloat3(&bounds.Center, 0.5f * (vMin + vMax));
-    XMStoreFloat3(&bounds.Extents, 0.5f * (vMax - vMin));
-
-    fin >> ignore;
-    fin >> ignore;
-    fin >> ignore;
-
-    std::vector<std::int32_t> indices(3 * tcount);
-    for (UINT i = 0; i < tcount; ++i)
-    {
-        fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
-    }
-
-    fin.close();
-
     //
     // Pack the indices of all the meshes into one index buffer.
     //
 
     const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 
-    const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
+    const UINT ibByteSize = mesh.IndexBufferByteSize();
 
-    auto geo = std::make_unique<MeshGeometry>();
+    auto geo = std::make_shared<MeshGeometry>();
     geo->Name = "skullGeo";
 
     ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
     CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
 
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-    CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+    // Indices are used straight from the mapped file.
+    geo->IndexBufferCPU = mesh.IndexBlob();
 
     geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
         mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
 
     geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-        mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+        mCommandList.Get(), mesh.Indices().data(), ibByteSize, geo->IndexBufferUploader);
 
     geo->VertexByteStride = sizeof(Vertex);
     geo->VertexBufferByteSize = vbByteSize;
@@ -1277,14 +1639,14 @@ void SsaoApp::BuildSkullGeometry()
     geo->IndexBufferByteSize = ibByteSize;
 
     SubmeshGeometry submesh;
-    submesh.IndexCount = (UINT)indices.size();
+    submesh.IndexCount = (UINT)mesh.Indices().size();
     submesh.StartIndexLocation = 0;
     submesh.BaseVertexLocation = 0;
-    submesh.Bounds = bounds;
+    submesh.Bounds = mesh.Submeshes()[0].Box;
 
     geo->DrawArgs["skull"] = submesh;
 
-    mGeometries[geo->Name] = std::move(geo);
+    return geo;
 }
 
 void SsaoApp::BuildPSOs()
@@ -1526,6 +1888,7 @@ void SsaoApp::BuildRenderItems()
     skyRitem->IndexCount = skyRitem->Geo->DrawArgs["sphere"].IndexCount;
     skyRitem->StartIndexLocation = skyRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
     skyRitem->BaseVertexLocation = skyRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+    skyRitem->Bounds = skyRitem->Geo->DrawArgs["sphere"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Sky].push_back(skyRitem.get());
     mAllRitems.push_back(std::move(skyRitem));
@@ -1540,6 +1903,7 @@ void SsaoApp::BuildRenderItems()
     quadRitem->IndexCount = quadRitem->Geo->DrawArgs["quad"].IndexCount;
     quadRitem->StartIndexLocation = quadRitem->Geo->DrawArgs["quad"].StartIndexLocation;
     quadRitem->BaseVertexLocation = quadRitem->Geo->DrawArgs["quad"].BaseVertexLocation;
+    quadRitem->Bounds = quadRitem->Geo->DrawArgs["quad"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Debug].push_back(quadRitem.get());
     mAllRitems.push_back(std::move(quadRitem));
@@ -1554,6 +1918,7 @@ void SsaoApp::BuildRenderItems()
     boxRitem->IndexCount = boxRitem->Geo->DrawArgs["box"].IndexCount;
     boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
     boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+    boxRitem->Bounds = boxRitem->Geo->DrawArgs["box"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Opaque].push_back(boxRitem.get());
     mAllRitems.push_back(std::move(boxRitem));
@@ -1568,6 +1933,7 @@ void SsaoApp::BuildRenderItems()
     skullRitem->IndexCount = skullRitem->Geo->DrawArgs["skull"].IndexCount;
     skullRitem->StartIndexLocation = skullRitem->Geo->DrawArgs["skull"].StartIndexLocation;
     skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs["skull"].BaseVertexLocation;
+    skullRitem->Bounds = skullRitem->Geo->DrawArgs["skull"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Opaque].push_back(skullRitem.get());
     mAllRitems.push_back(std::move(skullRitem));
@@ -1582,6 +1948,7 @@ void SsaoApp::BuildRenderItems()
     gridRitem->IndexCount = gridRitem->Geo->DrawArgs["grid"].IndexCount;
     gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
     gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+    gridRitem->Bounds = gridRitem->Geo->DrawArgs["grid"].Bounds;
 
     mRitemLayer[(int)RenderLayer::Opaque].push_back(gridRitem.get());
     mAllRitems.push_back(std::move(gridRitem));
@@ -1610,6 +1977,7 @@ void SsaoApp::BuildRenderItems()
         leftCylRitem->IndexCount = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
         leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
         leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+        leftCylRitem->Bounds = leftCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
         XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
         XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
@@ -1620,6 +1988,7 @@ void SsaoApp::BuildRenderItems()
         rightCylRitem->IndexCount = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
         rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
         rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+        rightCylRitem->Bounds = rightCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
         XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
         leftSphereRitem->TexTransform = MathHelper::Identity4x4();
@@ -1630,6 +1999,7 @@ void SsaoApp::BuildRenderItems()
         leftSphereRitem->IndexCount = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
         leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
         leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+        leftSphereRitem->Bounds = leftSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
         XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
         rightSphereRitem->TexTransform = MathHelper::Identity4x4();
@@ -1640,6 +2010,7 @@ void SsaoApp::BuildRenderItems()
         rightSphereRitem->IndexCount = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
         rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
         rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+        rightSphereRitem->Bounds = rightSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
         mRitemLayer[(int)RenderLayer::Opaque].push_back(leftCylRitem.get());
         mRitemLayer[(int)RenderLayer::Opaque].push_back(rightCylRitem.get());
@@ -1684,6 +2055,8 @@ void SsaoApp::DrawRenderItems(
 
 void SsaoApp::DrawSceneToShadowMap()
 {
+    PROFILE_SCOPE("DrawSceneToShadowMap");
+
     const auto viewPort = mShadowMap->Viewport();
     mCommandList->RSSetViewports(1, &viewPort);
     const auto scissorRect = mShadowMap->ScissorRect();
@@ -1730,6 +2103,8 @@ void SsaoApp::DrawSceneToShadowMap()
 
 void SsaoApp::DrawNormalsAndDepth()
 {
+    PROFILE_SCOPE("DrawNormalsAndDepth");
+
     mCommandList->RSSetViewports(1, &mScreenViewport);
     mCommandList->RSSetScissorRects(1, &mScissorRect);
 
@@ -3,6 +3,7 @@
 //***************************************************************************************
 
 #include "Ssao.h"
+#include "../../Common/Profiler.h"
 #include <DirectXPackedVector.h>
 
 using namespace DirectX;
@@ -191,6 +192,8 @@ void Ssao::ComputeSsao(
     FrameResource* currFrame,
     int blurCount)
 {
+    PROFILE_SCOPE("Ssao::ComputeSsao");
+
     cmdList->RSSetViewports(1, &mViewport);
     cmdList->RSSetScissorRects(1, &mScissorRect);
 
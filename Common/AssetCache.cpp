@@ -0,0 +1,299 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "AssetCache.h"
+
+#include <cstring>
+#include <cwctype>
+#include <filesystem>
+#include <vector>
+
+namespace
+{
+    constexpr std::uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+    constexpr std::uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr std::uint64_t Prime3 = 0x165667B19E3779F9ull;
+    constexpr std::uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+    constexpr std::uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+    constexpr std::uint64_t RotateLeft(const std::uint64_t value, const int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    std::uint64_t ReadWord(const std::byte* data)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        return word;
+    }
+
+    constexpr std::uint64_t Round(const std::uint64_t acc, const std::uint64_t word)
+    {
+        return RotateLeft(acc + word * Prime2, 31) * Prime1;
+    }
+
+    constexpr std::uint64_t MergeRound(const std::uint64_t acc, const std::uint64_t lane)
+    {
+        return (acc ^ Round(0, lane)) * Prime1 + Prime4;
+    }
+
+    constexpr std::size_t SampleEndBytes = 4096;
+    constexpr std::size_t SampleBlockBytes = 1024;
+    constexpr std::size_t SampleBlockCount = 16;
+    constexpr std::size_t SampleAllBytes = 64 * 1024;
+
+    bool SameBytes(const MappedFile& a, const MappedFile& b)
+    {
+        return a.Size() == b.Size() && (a.Data() == b.Data() || std::memcmp(a.Data(), b.Data(), std::size_t(a.Size())) == 0);
+    }
+}
+
+AssetCache& AssetCache::Default()
+{
+    static AssetCache cache;
+    return cache;
+}
+
+AssetCache::Stats AssetCache::GetStats()const
+{
+    std::lock_guard lock(mMutex);
+    return mStats;
+}
+
+void AssetCache::ResetStats()
+{
+    std::lock_guard lock(mMutex);
+    mStats = {};
+}
+
+void AssetCache::Trim()
+{
+    std::lock_guard lock(mMutex);
+
+    for (auto& [type, table] : mTables)
+    {
+        std::erase_if(table.ByPath, [](const auto& entry) { return entry.second.Asset.expired(); });
+        std::erase_if(table.ByContent, [](const auto& entry) { return entry.second.Asset.expired(); });
+    }
+    std::erase_if(mShared, [](const auto& entry) { return entry.second.expired(); });
+}
+
+AssetCache::Hash AssetCache::HashBytes(const std::span<const std::byte> bytes)
+{
+    const std::byte* data = bytes.data();
+    const std::byte* const end = data + bytes.size();
+
+    std::uint64_t hash;
+    if (bytes.size() >= 32)
+    {
+        // Four independent lanes keep the multipliers busy.
+        std::uint64_t lanes[4] = { Prime1 + Prime2, Prime2, 0, 0ull - Prime1 };
+        for (; end - data >= 32; data += 32)
+        {
+            lanes[0] = Round(lanes[0], ReadWord(data));
+            lanes[1] = Round(lanes[1], ReadWord(data + 8));
+            lanes[2] = Round(lanes[2], ReadWord(data + 16));
+            lanes[3] = Round(lanes[3], ReadWord(data + 24));
+        }
+
+        hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+        for (const std::uint64_t lane : lanes)
+        {
+            hash = MergeRound(hash, lane);
+        }
+    }
+    else
+    {
+        hash = Prime5;
+    }
+
+    hash += bytes.size();
+
+    for (; end - data >= 8; data += 8)
+    {
+        hash = RotateLeft(hash ^ Round(0, ReadWord(data)), 27) * Prime1 + Prime4;
+    }
+    for (; data < end; ++data)
+    {
+        hash = RotateLeft(hash ^ (std::uint64_t(*data) * Prime5), 11) * Prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+AssetCache::Hash AssetCache::SampleBytes(const std::span<const std::byte> bytes)
+{
+    const std::uint64_t size = bytes.size();
+
+    std::vector<std::byte> samples;
+    if (bytes.size() <= SampleAllBytes)
+    {
+        samples.assign(bytes.begin(), bytes.end());
+    }
+    else
+    {
+        samples.reserve(2 * SampleEndBytes + SampleBlockCount * SampleBlockBytes + sizeof(size));
+
+        const std::span<const std::byte> head = bytes.first(SampleEndBytes);
+        const std::span<const std::byte> tail = bytes.last(SampleEndBytes);
+        samples.insert(samples.end(), head.begin(), head.end());
+
+        // Evenly spaced over the bytes between head and tail.
+        const std::size_t middle = bytes.size() - 2 * SampleEndBytes;
+        const std::size_t stride = middle / SampleBlockCount;
+        for (std::size_t i = 0; i < SampleBlockCount; ++i)
+        {
+            const std::span<const std::byte> block = bytes.subspan(SampleEndBytes + i * stride, SampleBlockBytes);
+            samples.insert(samples.end(), block.begin(), block.end());
+        }
+
+        samples.insert(samples.end(), tail.begin(), tail.end());
+    }
+
+    const auto* sizeBytes = reinterpret_cast<const std::byte*>(&size);
+    samples.insert(samples.end(), sizeBytes, sizeBytes + sizeof(size));
+    return HashBytes(samples);
+}
+
+std::wstring AssetCache::NormalizePath(const std::wstring& filename)
+{
+    // Demos refer to the same file as "../../Textures/x.dds" and "Textures/x.dds"
+    // depending on their working directory.
+    std::error_code error;
+    const std::filesystem::path absolute = std::filesystem::absolute(filename, error);
+    std::wstring path = (error ? std::filesystem::path(filename) : absolute).lexically_normal().wstring();
+
+#ifdef _WIN32
+    // Windows paths are not case sensitive.
+    for (wchar_t& c : path)
+    {
+        c = towlower(c);
+    }
+#endif
+
+    return path;
+}
+
+AssetCache::FileStamp AssetCache::StampOf(const std::wstring& path)
+{
+    FileStamp stamp;
+
+    std::error_code error;
+    const std::uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+        return stamp;
+
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+    if (error)
+        return stamp;
+
+    stamp.Size = size;
+    stamp.WriteTime = writeTime;
+    return stamp;
+}
+
+std::shared_ptr<const void> AssetCache::FindByPath(const std::type_index type, const std::wstring& path, const FileStamp& stamp)
+{
+    std::lock_guard lock(mMutex);
+
+    Table& table = mTables[type];
+    const auto it = table.ByPath.find(path);
+    if (it == table.ByPath.end())
+        return nullptr;
+
+    // A file rewritten since it was loaded counts as a new one.
+    std::shared_ptr<const void> asset = it->second.Asset.lock();
+    if (asset == nullptr || it->second.Stamp != stamp)
+    {
+        table.ByPath.erase(it);
+        return nullptr;
+    }
+
+    ++mStats.PathHits;
+    mStats.BytesSaved += it->second.FileSize;
+    return asset;
+}
+
+std::shared_ptr<const void> AssetCache::Insert(
+    const std::type_index type,
+    const std::wstring& path,
+    const FileStamp& stamp,
+    std::shared_ptr<const void> asset,
+    std::shared_ptr<const MappedFile> file)
+{
+    // Outside the lock; the candidates it finds are then compared in full.
+    const Hash contentHash = SampleBytes(file->Bytes());
+
+    std::lock_guard lock(mMutex);
+
+    Table& table = mTables[type];
+
+    const auto [first, last] = table.ByContent.equal_range(contentHash);
+    for (auto it = first; it != last;)
+    {
+        std::shared_ptr<const void> existing = it->second.Asset.lock();
+        std::shared_ptr<const MappedFile> existingFile = it->second.File.lock();
+        if (existing == nullptr || existingFile == nullptr)
+        {
+            it = table.ByContent.erase(it);
+            continue;
+        }
+
+        if (SameBytes(*existingFile, *file))
+        {
+            ++mStats.ContentHits;
+            mStats.BytesSaved += file->Size();
+            table.ByPath[path] = { existing, file->Size(), stamp };
+            return existing;
+        }
+        ++it;
+    }
+
+    ++mStats.Misses;
+    mStats.BytesLoaded += file->Size();
+    table.ByPath[path] = { asset, file->Size(), stamp };
+    table.ByContent.emplace(contentHash, ContentEntry{ asset, file });
+    return asset;
+}
+
+std::shared_ptr<void> AssetCache::FindShared(const SharedKey& key)
+{
+    std::lock_guard lock(mMutex);
+
+    const auto it = mShared.find(key);
+    if (it == mShared.end())
+        return nullptr;
+
+    std::shared_ptr<void> object = it->second.lock();
+    if (object == nullptr)
+    {
+        mShared.erase(it);
+        return nullptr;
+    }
+
+    ++mStats.SharedHits;
+    return object;
+}
+
+std::shared_ptr<void> AssetCache::InsertShared(const SharedKey& key, std::shared_ptr<void> object)
+{
+    std::lock_guard lock(mMutex);
+
+    // Someone else may have built it meanwhile; theirs wins so there is only one.
+    std::weak_ptr<void>& entry = mShared[key];
+    if (std::shared_ptr<void> existing = entry.lock())
+    {
+        ++mStats.SharedHits;
+        return existing;
+    }
+
+    ++mStats.SharedMisses;
+    entry = object;
+    return object;
+}
@@ -0,0 +1,200 @@
+//***************************************************************************************
+// AssetCache.h
+//
+// Process-wide cache of the assets loaded from files, keyed by path and by content.  A
+// second load of the same path, or of another path with the same bytes, returns the
+// asset already loaded, so both share one mapping.  Objects built from an asset, such
+// as its GPU copy, can be shared the same way with GetShared.
+//
+// Handles are std::shared_ptr; the cache only keeps weak references, so an asset goes
+// away with its last handle.  A path hit checks the file's size and write time first,
+// so a file rewritten since, e.g. a model reconverted by MeshFile::LoadOrConvert, is
+// loaded again.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+
+#include "MappedFile.h"
+
+class AssetCache final
+{
+public:
+    using Hash = std::uint64_t;
+
+    template <class T>
+    struct Asset final
+    {
+        T Value;
+
+        // Shared by every load of the same bytes and by no other asset, so objects built
+        // from the content can be keyed on it.
+        std::uint64_t ContentId = 0;
+
+        // Path it was first loaded from.
+        std::wstring Filename;
+    };
+
+    template <class T>
+    using Handle = std::shared_ptr<const Asset<T>>;
+
+    struct Stats final
+    {
+        // Loads that found the path loaded already and did not touch the file.
+        std::uint64_t PathHits = 0;
+
+        // Loads of a new path whose bytes matched an asset loaded already.
+        std::uint64_t ContentHits = 0;
+
+        std::uint64_t Misses = 0;
+
+        // File bytes behind the misses.
+        std::uint64_t BytesLoaded = 0;
+
+        // File bytes the hits did not need a copy of.
+        std::uint64_t BytesSaved = 0;
+
+        // GetShared calls that found the object built already, and those that built it.
+        std::uint64_t SharedHits = 0;
+        std::uint64_t SharedMisses = 0;
+    };
+
+    AssetCache() = default;
+    AssetCache(const AssetCache& rhs) = delete;
+    AssetCache& operator=(const AssetCache& rhs) = delete;
+
+    static AssetCache& Default();
+
+    // Returns the T loaded from filename.  load(filename, value) fills value and returns
+    // the file the value was read from, or nullptr on failure, in which case Get returns
+    // nullptr too.  load is not called if the path is loaded already; if the file turns
+    // out to match an asset loaded from elsewhere, that asset is returned instead.
+    template <class T, class Load>
+    Handle<T> Get(const std::wstring& filename, Load&& load);
+
+    // Returns the T that make() built for the content with this id, calling make only
+    // if nobody holds one.  Objects are only shared within one scope, such as the
+    // device they were created on.  variant tells apart objects built differently from
+    // the same content, e.g. with fewer mips or another vertex layout.  Meant for GPU
+    // copies, so that duplicate loads share one upload as well as one mapping.
+    template <class T, class Make>
+    std::shared_ptr<T> GetShared(const void* scope, std::uint64_t contentId, std::uint64_t variant, Make&& make);
+
+    Stats GetStats()const;
+    void ResetStats();
+
+    // Drops the entries of assets that are gone.
+    void Trim();
+
+    // 64-bit hash of bytes in the style of xxHash64.  Not cryptographic.
+    static Hash HashBytes(std::span<const std::byte> bytes);
+
+    // Hash of the size of bytes and of samples of them: the first and last 4 KiB and
+    // 16 blocks of 1 KiB spread in between, or all of them up to 64 KiB.  What the cache
+    // looks up content by, so a miss reads 24 KiB of a file and not all of it.  Files
+    // that only differ elsewhere collide; the cache compares the bytes before it
+    // trusts a match.
+    static Hash SampleBytes(std::span<const std::byte> bytes);
+
+private:
+    struct FileStamp final
+    {
+        std::uint64_t Size = 0;
+        std::filesystem::file_time_type WriteTime;
+
+        bool operator==(const FileStamp& rhs)const = default;
+    };
+
+    struct PathEntry final
+    {
+        std::weak_ptr<const void> Asset;
+        std::uint64_t FileSize = 0;
+        FileStamp Stamp;
+    };
+
+    struct ContentEntry final
+    {
+        std::weak_ptr<const void> Asset;
+        std::weak_ptr<const MappedFile> File;
+    };
+
+    // Assets of one type.
+    struct Table final
+    {
+        std::unordered_map<std::wstring, PathEntry> ByPath;
+        std::unordered_multimap<Hash, ContentEntry> ByContent;
+    };
+
+    using SharedKey = std::tuple<std::type_index, const void*, std::uint64_t, std::uint64_t>;
+
+    static std::wstring NormalizePath(const std::wstring& filename);
+
+    // Size and write time of path, or a default stamp if it can not be read.
+    static FileStamp StampOf(const std::wstring& path);
+
+    std::shared_ptr<const void> FindByPath(std::type_index type, const std::wstring& path, const FileStamp& stamp);
+    std::shared_ptr<const void> Insert(std::type_index type, const std::wstring& path, const FileStamp& stamp,
+        std::shared_ptr<const void> asset, std::shared_ptr<const MappedFile> file);
+
+    std::shared_ptr<void> FindShared(const SharedKey& key);
+    std::shared_ptr<void> InsertShared(const SharedKey& key, std::shared_ptr<void> object);
+
+    mutable std::mutex mMutex;
+    std::unordered_map<std::type_index, Table> mTables;
+    std::map<SharedKey, std::weak_ptr<void>> mShared;
+    Stats mStats;
+    std::atomic<std::uint64_t> mNextContentId = 1;
+};
+
+template <class T, class Load>
+AssetCache::Handle<T> AssetCache::Get(const std::wstring& filename, Load&& load)
+{
+    const std::type_index type = typeid(T);
+    const std::wstring path = NormalizePath(filename);
+
+    // Stamped before the load, so a write during it makes the next load look again.
+    const FileStamp stamp = StampOf(path);
+    if (std::shared_ptr<const void> found = FindByPath(type, path, stamp))
+        return std::static_pointer_cast<const Asset<T>>(found);
+
+    // Loaded outside the lock so loader threads do not wait on each other.  Two threads
+    // loading the same path both get here; the second one ends up as a content hit.
+    auto asset = std::make_shared<Asset<T>>();
+    std::shared_ptr<const MappedFile> file = load(filename, asset->Value);
+    if (file == nullptr)
+        return nullptr;
+
+    // Unused if the content turns out to be loaded already.
+    asset->ContentId = mNextContentId++;
+    asset->Filename = filename;
+
+    return std::static_pointer_cast<const Asset<T>>(
+        Insert(type, path, stamp, std::move(asset), std::move(file)));
+}
+
+template <class T, class Make>
+std::shared_ptr<T> AssetCache::GetShared(const void* scope, const std::uint64_t contentId, const std::uint64_t variant, Make&& make)
+{
+    const SharedKey key(typeid(T), scope, contentId, variant);
+    if (std::shared_ptr<void> found = FindShared(key))
+        return std::static_pointer_cast<T>(found);
+
+    // Built outside the lock, since make may well load other assets.
+    std::shared_ptr<T> object = make();
+    if (object == nullptr)
+        return nullptr;
+
+    return std::static_pointer_cast<T>(InsertShared(key, std::move(object)));
+}
@@ -0,0 +1,883 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "BCEncoder.h"
+#include "DDSFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <emmintrin.h>
+
+using namespace BCEncoder;
+
+namespace
+{
+    //
+    // Color blocks (BC1, and the color half of BC3).
+    //
+
+    // RGB with 8-bit channels, kept in ints for the arithmetic.
+    struct Color final
+    {
+        int R = 0;
+        int G = 0;
+        int B = 0;
+    };
+
+    std::uint16_t To565(const Color& c)
+    {
+        const int r = (std::clamp(c.R, 0, 255) * 31 + 127) / 255;
+        const int g = (std::clamp(c.G, 0, 255) * 63 + 127) / 255;
+        const int b = (std::clamp(c.B, 0, 255) * 31 + 127) / 255;
+        return std::uint16_t((r << 11) | (g << 5) | b);
+    }
+
+    Color From565(const std::uint16_t c)
+    {
+        const int r = (c >> 11) & 31;
+        const int g = (c >> 5) & 63;
+        const int b = c & 31;
+        return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+    }
+
+    // The colors a decoder derives from the endpoints: four if color0 > color1,
+    // otherwise three and transparent black.
+    void BuildPalette(const std::uint16_t color0, const std::uint16_t color1, Color palette[4])
+    {
+        const Color c0 = From565(color0);
+        const Color c1 = From565(color1);
+        palette[0] = c0;
+        palette[1] = c1;
+        if (color0 > color1)
+        {
+            palette[2] = { (2 * c0.R + c1.R) / 3, (2 * c0.G + c1.G) / 3, (2 * c0.B + c1.B) / 3 };
+            palette[3] = { (c0.R + 2 * c1.R) / 3, (c0.G + 2 * c1.G) / 3, (c0.B + 2 * c1.B) / 3 };
+        }
+        else
+        {
+            palette[2] = { (c0.R + c1.R) / 2, (c0.G + c1.G) / 2, (c0.B + c1.B) / 2 };
+            palette[3] = {};
+        }
+    }
+
+    // The texels of a block widened to 16-bit RGB0, two texels per vector.
+    struct BlockRGB final
+    {
+        __m128i Texels[8];
+    };
+
+    BlockRGB UnpackRGB(const std::uint8_t texels[64])
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rgbMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+
+        BlockRGB block;
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + 16 * i));
+            block.Texels[2 * i] = _mm_and_si128(_mm_unpacklo_epi8(row, zero), rgbMask);
+            block.Texels[2 * i + 1] = _mm_and_si128(_mm_unpackhi_epi8(row, zero), rgbMask);
+        }
+        return block;
+    }
+
+    __m128i Broadcast(const Color& c)
+    {
+        return _mm_setr_epi16(short(c.R), short(c.G), short(c.B), 0, short(c.R), short(c.G), short(c.B), 0);
+    }
+
+    // _mm_madd_epi16 of two texels leaves R*R'+G*G' and B*B' per texel; this adds the
+    // halves of four texels (two vectors) into one vector.
+    __m128i SumHalves(const __m128i a, const __m128i b)
+    {
+        const __m128 fa = _mm_castsi128_ps(a);
+        const __m128 fb = _mm_castsi128_ps(b);
+        return _mm_add_epi32(
+            _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0))),
+            _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+
+    // Dot products of the texels with direction; texels 4i to 4i+3 land in out[i].
+    void DotProducts(const BlockRGB& block, const Color& direction, __m128i out[4])
+    {
+        const __m128i d = Broadcast(direction);
+        for (int i = 0; i < 4; ++i)
+        {
+            out[i] = SumHalves(_mm_madd_epi16(block.Texels[2 * i], d), _mm_madd_epi16(block.Texels[2 * i + 1], d));
+        }
+    }
+
+    // Squared distances of the texels to color, laid out like DotProducts.
+    void SquaredDistances(const BlockRGB& block, const Color& color, __m128i out[4])
+    {
+        const __m128i c = Broadcast(color);
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128i d0 = _mm_sub_epi16(block.Texels[2 * i], c);
+            const __m128i d1 = _mm_sub_epi16(block.Texels[2 * i + 1], c);
+            out[i] = SumHalves(_mm_madd_epi16(d0, d0), _mm_madd_epi16(d1, d1));
+        }
+    }
+
+    __m128i Select(const __m128i mask, const __m128i a, const __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    // Index of the nearest of the first count palette entries for each texel, two bits
+    // per texel.  Texels in the transparent mask get index 3 and add no error.
+    std::uint32_t SelectNearest(const BlockRGB& block, const Color palette[4], const int count,
+        const std::uint32_t transparent, std::uint32_t& error)
+    {
+        __m128i best[4];
+        __m128i index[4];
+        SquaredDistances(block, palette[0], best);
+        for (int i = 0; i < 4; ++i)
+        {
+            index[i] = _mm_setzero_si128();
+        }
+
+        for (int k = 1; k < count; ++k)
+        {
+            __m128i distance[4];
+            SquaredDistances(block, palette[k], distance);
+
+            const __m128i entry = _mm_set1_epi32(k);
+            for (int i = 0; i < 4; ++i)
+            {
+                const __m128i closer = _mm_cmplt_epi32(distance[i], best[i]);
+                best[i] = Select(closer, distance[i], best[i]);
+                index[i] = Select(closer, entry, index[i]);
+            }
+        }
+
+        alignas(16) std::uint32_t bestOut[16];
+        alignas(16) std::uint32_t indexOut[16];
+        for (int i = 0; i < 4; ++i)
+        {
+            _mm_store_si128(reinterpret_cast<__m128i*>(bestOut + 4 * i), best[i]);
+            _mm_store_si128(reinterpret_cast<__m128i*>(indexOut + 4 * i), index[i]);
+        }
+
+        std::uint32_t indices = 0;
+        error = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            if (transparent & (1u << t))
+            {
+                indices |= 3u << (2 * t);
+            }
+            else
+            {
+                indices |= indexOut[t] << (2 * t);
+                error += bestOut[t];
+            }
+        }
+        return indices;
+    }
+
+    // Four-color indices by projecting the texels onto the line through the endpoints
+    // and cutting it halfway between neighbouring palette entries.
+    std::uint32_t SelectByProjection(const BlockRGB& block, const Color palette[4])
+    {
+        const Color direction = { palette[0].R - palette[1].R, palette[0].G - palette[1].G, palette[0].B - palette[1].B };
+        const auto project = [&direction](const Color& c)
+        {
+            return c.R * direction.R + c.G * direction.G + c.B * direction.B;
+        };
+
+        // Along the direction the palette runs 1, 3, 2, 0.  The cuts are doubled to
+        // stay in integers, so the dot products are too.
+        const __m128i cut0 = _mm_set1_epi32(project(palette[1]) + project(palette[3]));
+        const __m128i cut1 = _mm_set1_epi32(project(palette[3]) + project(palette[2]));
+        const __m128i cut2 = _mm_set1_epi32(project(palette[2]) + project(palette[0]));
+
+        __m128i dots[4];
+        DotProducts(block, direction, dots);
+
+        alignas(16) std::int32_t positions[16];
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128i dot2 = _mm_add_epi32(dots[i], dots[i]);
+
+            // Each cut passed subtracts -1.
+            __m128i position = _mm_setzero_si128();
+            position = _mm_sub_epi32(position, _mm_cmpgt_epi32(dot2, cut0));
+            position = _mm_sub_epi32(position, _mm_cmpgt_epi32(dot2, cut1));
+            position = _mm_sub_epi32(position, _mm_cmpgt_epi32(dot2, cut2));
+            _mm_store_si128(reinterpret_cast<__m128i*>(positions + 4 * i), position);
+        }
+
+        constexpr std::uint32_t order[4] = { 1, 3, 2, 0 };
+        std::uint32_t indices = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            indices |= order[positions[t]] << (2 * t);
+        }
+        return indices;
+    }
+
+    // Per-channel bounds, with the box diagonal the texels run along and the ends
+    // pulled in by 1/16 of the range, as the extremes rarely sit on the best line.
+    void BoundingBoxEndpoints(const std::uint8_t texels[64], Color& c0, Color& c1)
+    {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels));
+        __m128i hi = lo;
+        for (int i = 1; i < 4; ++i)
+        {
+            const __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + 16 * i));
+            lo = _mm_min_epu8(lo, row);
+            hi = _mm_max_epu8(hi, row);
+        }
+        lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+        lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+        hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+        hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        const std::uint32_t minTexel = std::uint32_t(_mm_cvtsi128_si32(lo));
+        const std::uint32_t maxTexel = std::uint32_t(_mm_cvtsi128_si32(hi));
+        Color minColor = { int(minTexel & 0xFF), int((minTexel >> 8) & 0xFF), int((minTexel >> 16) & 0xFF) };
+        Color maxColor = { int(maxTexel & 0xFF), int((maxTexel >> 8) & 0xFF), int((maxTexel >> 16) & 0xFF) };
+
+        // Which diagonal: the signs of the covariance of red and of blue with green.
+        int sum[3] = {};
+        for (int t = 0; t < 16; ++t)
+        {
+            sum[0] += texels[4 * t];
+            sum[1] += texels[4 * t + 1];
+            sum[2] += texels[4 * t + 2];
+        }
+
+        int covRG = 0;
+        int covBG = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            const int g = 16 * texels[4 * t + 1] - sum[1];
+            covRG += (16 * texels[4 * t] - sum[0]) * g;
+            covBG += (16 * texels[4 * t + 2] - sum[2]) * g;
+        }
+
+        const auto inset = [](int& lo, int& hi)
+        {
+            const int amount = (hi - lo) >> 4;
+            lo += amount;
+            hi -= amount;
+        };
+        inset(minColor.R, maxColor.R);
+        inset(minColor.G, maxColor.G);
+        inset(minColor.B, maxColor.B);
+
+        c0 = maxColor;
+        c1 = minColor;
+        if (covRG < 0)
+            std::swap(c0.R, c1.R);
+        if (covBG < 0)
+            std::swap(c0.B, c1.B);
+    }
+
+    // The texels furthest apart along the principal axis of their covariance.
+    void PrincipalAxisEndpoints(const std::uint8_t texels[64], Color& c0, Color& c1)
+    {
+        float mean[3] = {};
+        for (int t = 0; t < 16; ++t)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                mean[c] += texels[4 * t + c];
+            }
+        }
+        for (float& m : mean)
+        {
+            m /= 16.0f;
+        }
+
+        // rr, rg, rb, gg, gb, bb
+        float cov[6] = {};
+        float lo[3] = { 255.0f, 255.0f, 255.0f };
+        float hi[3] = {};
+        for (int t = 0; t < 16; ++t)
+        {
+            const float r = texels[4 * t] - mean[0];
+            const float g = texels[4 * t + 1] - mean[1];
+            const float b = texels[4 * t + 2] - mean[2];
+            cov[0] += r * r;
+            cov[1] += r * g;
+            cov[2] += r * b;
+            cov[3] += g * g;
+            cov[4] += g * b;
+            cov[5] += b * b;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                lo[c] = std::min<float>(lo[c], texels[4 * t + c]);
+                hi[c] = std::max<float>(hi[c], texels[4 * t + c]);
+            }
+        }
+
+        // A few rounds of power iteration, starting from the box diagonal.
+        float axis[3] = { hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] };
+        for (int iteration = 0; iteration < 4; ++iteration)
+        {
+            const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+            const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+            const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+
+            const float largest = std::max({ std::fabs(x), std::fabs(y), std::fabs(z) });
+            if (largest < 1e-4f)
+                break;
+
+            axis[0] = x / largest;
+            axis[1] = y / largest;
+            axis[2] = z / largest;
+        }
+
+        // Flat blocks have no axis; fall back to luminance.
+        if (std::max({ std::fabs(axis[0]), std::fabs(axis[1]), std::fabs(axis[2]) }) < 1e-4f)
+        {
+            axis[0] = 0.299f;
+            axis[1] = 0.587f;
+            axis[2] = 0.114f;
+        }
+
+        int minTexel = 0;
+        int maxTexel = 0;
+        float minDot = FLT_MAX;
+        float maxDot = -FLT_MAX;
+        for (int t = 0; t < 16; ++t)
+        {
+            const float dot = texels[4 * t] * axis[0] + texels[4 * t + 1] * axis[1] + texels[4 * t + 2] * axis[2];
+            if (dot < minDot)
+            {
+                minDot = dot;
+                minTexel = t;
+            }
+            if (dot > maxDot)
+            {
+                maxDot = dot;
+                maxTexel = t;
+            }
+        }
+
+        c0 = { texels[4 * maxTexel], texels[4 * maxTexel + 1], texels[4 * maxTexel + 2] };
+        c1 = { texels[4 * minTexel], texels[4 * minTexel + 1], texels[4 * minTexel + 2] };
+    }
+
+    // Least-squares endpoints for fixed four-color indices.  Returns false if the
+    // indices do not pin down both endpoints.
+    bool RefineEndpoints(const std::uint8_t texels[64], const std::uint32_t indices, Color& c0, Color& c1)
+    {
+        // Share of color0 in each palette entry.
+        constexpr float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[3] = {};
+        float bx[3] = {};
+        for (int t = 0; t < 16; ++t)
+        {
+            const float a = weights[(indices >> (2 * t)) & 3];
+            const float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; ++c)
+            {
+                ax[c] += a * texels[4 * t + c];
+                bx[c] += b * texels[4 * t + c];
+            }
+        }
+
+        const float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f)
+            return false;
+
+        int e0[3];
+        int e1[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            e0[c] = std::clamp(int(std::lround((ax[c] * bb - bx[c] * ab) / det)), 0, 255);
+            e1[c] = std::clamp(int(std::lround((bx[c] * aa - ax[c] * ab) / det)), 0, 255);
+        }
+
+        c0 = { e0[0], e0[1], e0[2] };
+        c1 = { e1[0], e1[1], e1[2] };
+        return true;
+    }
+
+    struct ColorFit final
+    {
+        std::uint16_t Color0 = 0;
+        std::uint16_t Color1 = 0;
+        std::uint32_t Indices = 0;
+        std::uint32_t Error = 0;
+    };
+
+    // Orders the endpoints for the mode the block needs and picks the indices.
+    ColorFit FitIndices(const BlockRGB& block, std::uint16_t color0, std::uint16_t color1,
+        const Quality quality, const std::uint32_t transparent)
+    {
+        ColorFit fit;
+        Color palette[4];
+        if (transparent != 0)
+        {
+            // Three colors and transparent black need color0 <= color1.
+            if (color0 > color1)
+                std::swap(color0, color1);
+
+            BuildPalette(color0, color1, palette);
+            fit.Indices = SelectNearest(block, palette, 3, transparent, fit.Error);
+        }
+        else
+        {
+            if (color0 < color1)
+                std::swap(color0, color1);
+
+            BuildPalette(color0, color1, palette);
+            if (color0 == color1)
+            {
+                // Both endpoints the same: index 0 is the only color there is.
+                fit.Indices = SelectNearest(block, palette, 1, 0, fit.Error);
+            }
+            else if (quality == Quality::Fast)
+            {
+                fit.Indices = SelectByProjection(block, palette);
+            }
+            else
+            {
+                fit.Indices = SelectNearest(block, palette, 4, 0, fit.Error);
+            }
+        }
+
+        fit.Color0 = color0;
+        fit.Color1 = color1;
+        return fit;
+    }
+
+    void EncodeColorBlock(const std::uint8_t texels[64], const Quality quality, const bool allowTransparent, std::uint8_t* out)
+    {
+        std::uint8_t opaque[64];
+        std::memcpy(opaque, texels, sizeof(opaque));
+
+        std::uint32_t transparent = 0;
+        if (allowTransparent)
+        {
+            int firstOpaque = -1;
+            for (int t = 0; t < 16; ++t)
+            {
+                if (texels[4 * t + 3] < 128)
+                    transparent |= 1u << t;
+                else if (firstOpaque < 0)
+                    firstOpaque = t;
+            }
+
+            if (firstOpaque < 0)
+            {
+                // Nothing but transparent texels: three-color mode, every index 3.
+                std::memset(out, 0, 4);
+                std::memset(out + 4, 0xFF, 4);
+                return;
+            }
+
+            // Give the transparent texels an opaque color so they do not pull the endpoints.
+            for (int t = 0; t < 16; ++t)
+            {
+                if (transparent & (1u << t))
+                    std::memcpy(opaque + 4 * t, opaque + 4 * firstOpaque, 3);
+            }
+        }
+
+        const BlockRGB block = UnpackRGB(opaque);
+
+        Color c0;
+        Color c1;
+        if (quality == Quality::Fast)
+            BoundingBoxEndpoints(opaque, c0, c1);
+        else
+            PrincipalAxisEndpoints(opaque, c0, c1);
+
+        ColorFit fit = FitIndices(block, To565(c0), To565(c1), quality, transparent);
+
+        // Refit the endpoints to the indices and keep the result while it improves.
+        if (quality == Quality::High && transparent == 0)
+        {
+            for (int iteration = 0; iteration < 2 && fit.Error > 0; ++iteration)
+            {
+                if (!RefineEndpoints(opaque, fit.Indices, c0, c1))
+                    break;
+
+                const ColorFit refined = FitIndices(block, To565(c0), To565(c1), quality, transparent);
+                if (refined.Error >= fit.Error)
+                    break;
+                fit = refined;
+            }
+        }
+
+        std::memcpy(out, &fit.Color0, 2);
+        std::memcpy(out + 2, &fit.Color1, 2);
+        std::memcpy(out + 4, &fit.Indices, 4);
+    }
+
+    //
+    // Single-channel blocks (the alpha of BC3, each half of BC5).
+    //
+
+    // Eight values if a0 > a1, otherwise six and exact 0 and 255.
+    void BuildValuePalette(const int a0, const int a1, int palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int i = 2; i < 8; ++i)
+            {
+                palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+            }
+        }
+        else
+        {
+            for (int i = 2; i < 6; ++i)
+            {
+                palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    // Nearest palette entry for each value, three bits each; returns the squared error.
+    std::uint32_t FitValues(const std::uint8_t values[16], const int a0, const int a1, std::uint64_t& indices)
+    {
+        int palette[8];
+        BuildValuePalette(a0, a1, palette);
+
+        std::uint32_t error = 0;
+        indices = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            int bestIndex = 0;
+            int bestError = INT_MAX;
+            for (int i = 0; i < 8; ++i)
+            {
+                const int d = values[t] - palette[i];
+                if (d * d < bestError)
+                {
+                    bestError = d * d;
+                    bestIndex = i;
+                }
+            }
+            indices |= std::uint64_t(bestIndex) << (3 * t);
+            error += std::uint32_t(bestError);
+        }
+        return error;
+    }
+
+    void WriteValueBlock(const int a0, const int a1, const std::uint64_t indices, std::uint8_t* out)
+    {
+        out[0] = std::uint8_t(a0);
+        out[1] = std::uint8_t(a1);
+        for (int i = 0; i < 6; ++i)
+        {
+            out[2 + i] = std::uint8_t(indices >> (8 * i));
+        }
+    }
+
+    void EncodeValueBlock(const std::uint8_t values[16], const Quality quality, std::uint8_t* out)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+        __m128i lo = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+        lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 4));
+        lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 2));
+        lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 1));
+        __m128i hi = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+        hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 4));
+        hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 2));
+        hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 1));
+
+        const int minValue = _mm_cvtsi128_si32(lo) & 0xFF;
+        const int maxValue = _mm_cvtsi128_si32(hi) & 0xFF;
+
+        if (minValue == maxValue)
+        {
+            WriteValueBlock(minValue, minValue, 0, out);
+            return;
+        }
+
+        if (quality == Quality::Fast)
+        {
+            // Eight values spanning the range are evenly spaced, so the nearest one is a
+            // rounded division: position 0 is the minimum, 7 the maximum.
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i minVector = _mm_set1_epi32(minValue);
+            const __m128 scale = _mm_set1_ps(7.0f / float(maxValue - minValue));
+
+            const __m128i lo16 = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi16 = _mm_unpackhi_epi8(v, zero);
+            const __m128i quarters[4] =
+            {
+                _mm_unpacklo_epi16(lo16, zero),
+                _mm_unpackhi_epi16(lo16, zero),
+                _mm_unpacklo_epi16(hi16, zero),
+                _mm_unpackhi_epi16(hi16, zero)
+            };
+
+            __m128i positions[4];
+            for (int i = 0; i < 4; ++i)
+            {
+                positions[i] = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(quarters[i], minVector)), scale));
+            }
+
+            alignas(16) std::uint8_t packed[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(packed), _mm_packus_epi16(
+                _mm_packs_epi32(positions[0], positions[1]), _mm_packs_epi32(positions[2], positions[3])));
+
+            // Palette order is maximum, minimum, then from the maximum down.
+            std::uint64_t indices = 0;
+            for (int t = 0; t < 16; ++t)
+            {
+                std::uint64_t index = (8 - packed[t]) & 7;
+                if (index < 2)
+                    index ^= 1;
+                indices |= index << (3 * t);
+            }
+
+            WriteValueBlock(maxValue, minValue, indices, out);
+            return;
+        }
+
+        int bestA0 = maxValue;
+        int bestA1 = minValue;
+        std::uint64_t bestIndices = 0;
+        std::uint32_t bestError = UINT32_MAX;
+        const auto tryEndpoints = [&](const int a0, const int a1)
+        {
+            std::uint64_t indices;
+            const std::uint32_t error = FitValues(values, a0, a1, indices);
+            if (error < bestError)
+            {
+                bestA0 = a0;
+                bestA1 = a1;
+                bestIndices = indices;
+                bestError = error;
+            }
+        };
+
+        // Eight values, with the ends pulled in where that suits the values between.
+        const int slack = std::min((maxValue - minValue) / 16, 4);
+        for (int pullLo = 0; pullLo <= slack; ++pullLo)
+        {
+            for (int pullHi = 0; pullHi <= slack; ++pullHi)
+            {
+                tryEndpoints(maxValue - pullHi, minValue + pullLo);
+            }
+        }
+
+        // Six values between the others, for blocks that also hold exact 0 or 255.
+        int innerMin = 255;
+        int innerMax = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            if (values[t] != 0 && values[t] != 255)
+            {
+                innerMin = std::min<int>(innerMin, values[t]);
+                innerMax = std::max<int>(innerMax, values[t]);
+            }
+        }
+        if (innerMin <= innerMax)
+            tryEndpoints(innerMin, innerMax);
+        else
+            tryEndpoints(0, 255);
+
+        WriteValueBlock(bestA0, bestA1, bestIndices, out);
+    }
+
+    std::array<std::uint8_t, 16> Channel(const std::uint8_t texels[64], const int channel)
+    {
+        std::array<std::uint8_t, 16> values;
+        for (int t = 0; t < 16; ++t)
+        {
+            values[t] = texels[4 * t + channel];
+        }
+        return values;
+    }
+
+    // Next mip level by averaging 2x2 texels; an odd last row or column is averaged
+    // with itself.  sRGB values are averaged as stored.
+    std::vector<std::byte> Downsample(const Surface& surface, std::uint32_t& width, std::uint32_t& height)
+    {
+        width = std::max(surface.Width / 2, 1u);
+        height = std::max(surface.Height / 2, 1u);
+
+        std::vector<std::byte> next(std::size_t(width) * height * 4);
+        for (std::uint32_t y = 0; y < height; ++y)
+        {
+            const std::uint32_t y0 = std::min(2 * y, surface.Height - 1);
+            const std::uint32_t y1 = std::min(2 * y + 1, surface.Height - 1);
+            const auto* row0 = reinterpret_cast<const std::uint8_t*>(surface.Data + y0 * surface.RowPitch);
+            const auto* row1 = reinterpret_cast<const std::uint8_t*>(surface.Data + y1 * surface.RowPitch);
+            auto* dst = reinterpret_cast<std::uint8_t*>(next.data() + std::size_t(y) * width * 4);
+
+            for (std::uint32_t x = 0; x < width; ++x)
+            {
+                const std::uint32_t x0 = std::min(2 * x, surface.Width - 1);
+                const std::uint32_t x1 = std::min(2 * x + 1, surface.Width - 1);
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int sum = row0[4 * x0 + c] + row0[4 * x1 + c] + row1[4 * x0 + c] + row1[4 * x1 + c];
+                    dst[4 * x + c] = std::uint8_t((sum + 2) / 4);
+                }
+            }
+        }
+        return next;
+    }
+}
+
+std::size_t BCEncoder::BlockBytes(const Format format)
+{
+    return format == Format::BC1 ? 8 : 16;
+}
+
+DXGI_FORMAT BCEncoder::GetDXGIFormat(const Format format, const bool srgb)
+{
+    switch (format)
+    {
+        case Format::BC1:
+            return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+        case Format::BC3:
+            return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+        case Format::BC5:
+            return DXGI_FORMAT_BC5_UNORM;
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+std::size_t BCEncoder::EncodedSize(const Format format, const std::uint32_t width, const std::uint32_t height)
+{
+    const std::size_t blocksWide = std::max<std::size_t>(1, (std::size_t(width) + 3) / 4);
+    const std::size_t blocksHigh = std::max<std::size_t>(1, (std::size_t(height) + 3) / 4);
+    return blocksWide * blocksHigh * BlockBytes(format);
+}
+
+void BCEncoder::EncodeBlock(const Format format, const Quality quality, const std::uint8_t texels[64], std::byte* block)
+{
+    auto* out = reinterpret_cast<std::uint8_t*>(block);
+    switch (format)
+    {
+        case Format::BC1:
+            EncodeColorBlock(texels, quality, true, out);
+            break;
+
+        case Format::BC3:
+            EncodeValueBlock(Channel(texels, 3).data(), quality, out);
+            EncodeColorBlock(texels, quality, false, out + 8);
+            break;
+
+        case Format::BC5:
+            EncodeValueBlock(Channel(texels, 0).data(), quality, out);
+            EncodeValueBlock(Channel(texels, 1).data(), quality, out + 8);
+            break;
+    }
+}
+
+void BCEncoder::Encode(const Surface& surface, const Format format, const Quality quality, std::byte* dst, ThreadPool& pool)
+{
+    assert(surface.Width > 0 && surface.Height > 0);
+
+    const std::uint32_t blocksWide = (surface.Width + 3) / 4;
+    const std::uint32_t blocksHigh = (surface.Height + 3) / 4;
+    const std::size_t blockBytes = BlockBytes(format);
+
+    // Rows of blocks are independent.  A few per chunk keeps the shared counter quiet
+    // without starving workers on small mips.
+    pool.ParallelFor(0, blocksHigh, 4, [&](const std::size_t first, const std::size_t last)
+    {
+        std::uint8_t texels[64];
+        for (std::size_t by = first; by < last; ++by)
+        {
+            std::byte* out = dst + by * blocksWide * blockBytes;
+            for (std::uint32_t bx = 0; bx < blocksWide; ++bx)
+            {
+                for (std::uint32_t y = 0; y < 4; ++y)
+                {
+                    const std::uint32_t sy = std::min(std::uint32_t(by) * 4 + y, surface.Height - 1);
+                    const std::byte* row = surface.Data + sy * surface.RowPitch;
+                    for (std::uint32_t x = 0; x < 4; ++x)
+                    {
+                        const std::uint32_t sx = std::min(bx * 4 + x, surface.Width - 1);
+                        std::memcpy(texels + 4 * (4 * y + x), row + 4 * sx, 4);
+                    }
+                }
+
+                EncodeBlock(format, quality, texels, out);
+                out += blockBytes;
+            }
+        }
+    });
+}
+
+std::vector<std::byte> BCEncoder::EncodeDDS(const Surface& surface, const Format format, const Quality quality,
+    const bool generateMips, const bool srgb, ThreadPool& pool)
+{
+    if (surface.Data == nullptr || surface.Width == 0 || surface.Height == 0)
+        return {};
+
+    DDSFile::TextureDesc desc;
+    desc.Dimension = DDSFile::TextureDimension::Texture2D;
+    desc.Format = GetDXGIFormat(format, srgb);
+    desc.Width = surface.Width;
+    desc.Height = surface.Height;
+    desc.Depth = 1;
+    desc.ArraySize = 1;
+    desc.MipLevels = 1;
+    if (generateMips)
+    {
+        for (std::uint32_t size = std::max(surface.Width, surface.Height); size > 1; size /= 2)
+        {
+            ++desc.MipLevels;
+        }
+    }
+
+    std::size_t dataSize = 0;
+    for (std::uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+    {
+        dataSize += EncodedSize(format, std::max(surface.Width >> mip, 1u), std::max(surface.Height >> mip, 1u));
+    }
+
+    std::vector<std::byte> data(dataSize);
+    std::vector<std::byte> levelTexels;
+    Surface level = surface;
+    std::size_t offset = 0;
+    for (std::uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+    {
+        Encode(level, format, quality, data.data() + offset, pool);
+        offset += EncodedSize(format, level.Width, level.Height);
+
+        if (mip + 1 < desc.MipLevels)
+        {
+            std::uint32_t width;
+            std::uint32_t height;
+            levelTexels = Downsample(level, width, height);
+            level = { levelTexels.data(), width, height, std::size_t(width) * 4 };
+        }
+    }
+
+    return DDSFile::WriteImage(desc, data);
+}
+
+bool BCEncoder::WriteDDSFile(const std::wstring& filename, const std::span<const std::byte> image)
+{
+    if (image.empty())
+        return false;
+
+    std::ofstream file(std::filesystem::path(filename), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(image.data()), std::streamsize(image.size()));
+    return file.good();
+}
@@ -0,0 +1,77 @@
+//***************************************************************************************
+// BCEncoder.h
+//
+// CPU encoder for the block-compressed formats BC1 (RGB, 1-bit alpha), BC3 (RGBA) and
+// BC5 (two channels, e.g. the XY of a normal map) from R8G8B8A8 texels.  Blocks of
+// 4x4 texels are encoded independently with SSE2, and a surface is split over a
+// ThreadPool by rows of blocks.  EncodeDDS wraps the result, with a mip chain, in a
+// DDS image that DDSFile and DDSTextureLoader read like a file from disk.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <dxgiformat.h>
+
+#include "ThreadPool.h"
+
+namespace BCEncoder
+{
+    enum class Format
+    {
+        BC1,
+        BC3,
+        BC5,
+    };
+
+    enum class Quality
+    {
+        // Inset bounding-box endpoints; indices by projection onto the endpoint axis.
+        Fast,
+
+        // Principal-axis endpoints refined by least squares, indices by distance to
+        // every palette entry, and a search over alpha endpoints.
+        High,
+    };
+
+    // R8G8B8A8 texels, rows RowPitch bytes apart.
+    struct Surface final
+    {
+        const std::byte* Data = nullptr;
+        std::uint32_t Width = 0;
+        std::uint32_t Height = 0;
+        std::size_t RowPitch = 0;
+    };
+
+    // 8 for BC1, 16 for BC3 and BC5.
+    std::size_t BlockBytes(Format format);
+
+    DXGI_FORMAT GetDXGIFormat(Format format, bool srgb = false);
+
+    // Bytes of a width x height surface in format.
+    std::size_t EncodedSize(Format format, std::uint32_t width, std::uint32_t height);
+
+    // Encodes 16 RGBA texels in row order into one block of BlockBytes(format) bytes.
+    // BC1 makes texels with alpha below 128 transparent; BC5 encodes red and green.
+    void EncodeBlock(Format format, Quality quality, const std::uint8_t texels[64], std::byte* block);
+
+    // Encodes surface into dst, which holds EncodedSize bytes.  Blocks that overhang
+    // the right or bottom edge repeat the last column or row.
+    void Encode(const Surface& surface, Format format, Quality quality, std::byte* dst,
+        ThreadPool& pool = ThreadPool::Default());
+
+    // DDS image of surface in format.  With generateMips the mip chain down to 1x1 is
+    // built by averaging 2x2 texels and encoded too.  Returns an empty image if the
+    // surface has no texels.
+    std::vector<std::byte> EncodeDDS(const Surface& surface, Format format, Quality quality,
+        bool generateMips, bool srgb = false, ThreadPool& pool = ThreadPool::Default());
+
+    // Writes an image from EncodeDDS, for converting textures offline.  An empty image
+    // is not written.
+    bool WriteDDSFile(const std::wstring& filename, std::span<const std::byte> image);
+}
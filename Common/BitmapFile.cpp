@@ -0,0 +1,83 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "BitmapFile.h"
+#include "MappedFile.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr std::size_t FileHeaderSize = 14;
+    constexpr std::size_t InfoHeaderSize = 40;
+    constexpr std::uint32_t BI_RGB = 0;
+
+    // Refuses images whose texels would not fit in memory anyway.
+    constexpr std::uint32_t MaxExtent = 1u << 16;
+
+    template <class T>
+    T Read(const std::byte* data, const std::size_t offset)
+    {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+}
+
+bool BitmapFile::Load(const std::wstring& filename, Image& image)
+{
+    const std::shared_ptr<MappedFile> file = MappedFile::Open(filename);
+    if (file == nullptr || file->Size() < FileHeaderSize + InfoHeaderSize)
+        return false;
+
+    const std::byte* data = file->Data();
+    if (Read<char>(data, 0) != 'B' || Read<char>(data, 1) != 'M')
+        return false;
+
+    const std::uint32_t pixelOffset = Read<std::uint32_t>(data, 10);
+    const std::uint32_t infoSize = Read<std::uint32_t>(data, 14);
+    const std::int32_t width = Read<std::int32_t>(data, 18);
+    const std::int32_t height = Read<std::int32_t>(data, 22);
+    const std::uint16_t planes = Read<std::uint16_t>(data, 26);
+    const std::uint16_t bitCount = Read<std::uint16_t>(data, 28);
+    const std::uint32_t compression = Read<std::uint32_t>(data, 30);
+
+    if (infoSize < InfoHeaderSize || planes != 1 || compression != BI_RGB)
+        return false;
+    if (bitCount != 24 && bitCount != 32)
+        return false;
+
+    // A negative height means the rows are stored top first.
+    const bool topDown = height < 0;
+    const std::uint32_t rows = topDown ? 0u - std::uint32_t(height) : std::uint32_t(height);
+    if (width <= 0 || std::uint32_t(width) > MaxExtent || rows == 0 || rows > MaxExtent)
+        return false;
+
+    // Rows are padded to 4 bytes.
+    const std::size_t texelBytes = bitCount / 8;
+    const std::size_t rowPitch = (std::size_t(width) * texelBytes + 3) & ~std::size_t(3);
+    if (pixelOffset > file->Size() || rowPitch * rows > file->Size() - pixelOffset)
+        return false;
+
+    image.Width = std::uint32_t(width);
+    image.Height = rows;
+    image.Texels.resize(std::size_t(image.Width) * image.Height * 4);
+
+    for (std::uint32_t y = 0; y < rows; ++y)
+    {
+        const std::byte* src = data + pixelOffset + rowPitch * (topDown ? y : rows - 1 - y);
+        std::byte* dst = image.Texels.data() + std::size_t(y) * image.Width * 4;
+        for (std::uint32_t x = 0; x < image.Width; ++x)
+        {
+            // Stored as BGR(A).
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = texelBytes == 4 ? src[3] : std::byte(0xFF);
+            src += texelBytes;
+            dst += 4;
+        }
+    }
+
+    return true;
+}
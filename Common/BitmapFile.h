@@ -0,0 +1,29 @@
+//***************************************************************************************
+// BitmapFile.h
+//
+// Reader for the uncompressed .bmp images in Textures (the tree sprites), so they can
+// be block compressed with BCEncoder.  Only 24- and 32-bit BI_RGB bitmaps are read.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace BitmapFile
+{
+    // R8G8B8A8 texels, top row first, Width * 4 bytes a row.
+    struct Image final
+    {
+        std::uint32_t Width = 0;
+        std::uint32_t Height = 0;
+        std::vector<std::byte> Texels;
+    };
+
+    // Reads filename into image.  The fourth byte of a 32-bit texel is taken as alpha,
+    // as the tree sprites store it there; 24-bit images are opaque.  Returns false if
+    // the file is missing, truncated or in another format.
+    bool Load(const std::wstring& filename, Image& image);
+}
@@ -157,6 +157,12 @@ XMMATRIX Camera::GetView()const
     return XMLoadFloat4x4(&mView);
 }
 
+XMMATRIX Camera::GetInvView()const
+{
+    assert(!mViewDirty);
+    return XMLoadFloat4x4(&mInvView);
+}
+
 XMMATRIX Camera::GetProj()const
 {
     return XMLoadFloat4x4(&mProj);
@@ -272,6 +278,13 @@ void Camera::UpdateViewMatrix()
         mView(2, 3) = 0.0f;
         mView(3, 3) = 1.0f;
 
+        // The basis is orthonormal, so the inverse is just the camera axes and position.
+        mInvView = XMFLOAT4X4(
+            mRight.x, mRight.y, mRight.z, 0.0f,
+            mUp.x, mUp.y, mUp.z, 0.0f,
+            mLook.x, mLook.y, mLook.z, 0.0f,
+            mPosition.x, mPosition.y, mPosition.z, 1.0f);
+
         mViewDirty = false;
     }
 }
@@ -60,6 +60,9 @@ public:
     DirectX::XMFLOAT4X4 GetView4x4f()const;
     DirectX::XMFLOAT4X4 GetProj4x4f()const;
 
+    // View space to world space.  Kept with the view matrix, so it costs no inversion.
+    DirectX::XMMATRIX GetInvView()const;
+
     // Strafe/Walk the camera a distance d.
     void Strafe(float d);
     void Walk(float d);
@@ -74,6 +77,7 @@ public:
 private:
     // Cache View/Proj matrices.
     DirectX::XMFLOAT4X4 mView = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 mInvView = MathHelper::Identity4x4();
     DirectX::XMFLOAT4X4 mProj = MathHelper::Identity4x4();
 
     // Camera coordinate system with coordinates relative to world space.
@@ -0,0 +1,111 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "CommandRecorder.h"
+
+namespace
+{
+    // Forwards one recorded command to a sink.
+    struct Replayer final
+    {
+        CommandSink& Sink;
+
+        void operator()(const RecordedCommands::SetPipelineState& c)const
+        {
+            Sink.SetPipelineState(c.Pso);
+        }
+
+        void operator()(const RecordedCommands::IASetVertexBuffer& c)const
+        {
+            Sink.IASetVertexBuffer(c.View);
+        }
+
+        void operator()(const RecordedCommands::IASetIndexBuffer& c)const
+        {
+            Sink.IASetIndexBuffer(c.View);
+        }
+
+        void operator()(const RecordedCommands::IASetPrimitiveTopology& c)const
+        {
+            Sink.IASetPrimitiveTopology(c.Topology);
+        }
+
+        void operator()(const RecordedCommands::SetGraphicsRootDescriptorTable& c)const
+        {
+            Sink.SetGraphicsRootDescriptorTable(c.RootParameterIndex, c.BaseDescriptor);
+        }
+
+        void operator()(const RecordedCommands::SetGraphicsRootConstantBufferView& c)const
+        {
+            Sink.SetGraphicsRootConstantBufferView(c.RootParameterIndex, c.Address);
+        }
+
+        void operator()(const RecordedCommands::DrawIndexedInstanced& c)const
+        {
+            Sink.DrawIndexedInstanced(
+                c.IndexCountPerInstance,
+                c.InstanceCount,
+                c.StartIndexLocation,
+                c.BaseVertexLocation,
+                c.StartInstanceLocation);
+        }
+    };
+}
+
+void CommandRecorder::Replay(CommandSink& sink)const
+{
+    const Replayer replayer{ sink };
+    for (const RecordedCommand& command : mCommands)
+    {
+        std::visit(replayer, command);
+    }
+}
+
+void CommandRecorder::SetPipelineState(ID3D12PipelineState* const pso)
+{
+    mCommands.emplace_back(RecordedCommands::SetPipelineState{ pso });
+}
+
+void CommandRecorder::IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+    mCommands.emplace_back(RecordedCommands::IASetVertexBuffer{ view });
+}
+
+void CommandRecorder::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+    mCommands.emplace_back(RecordedCommands::IASetIndexBuffer{ view });
+}
+
+void CommandRecorder::IASetPrimitiveTopology(const D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+    mCommands.emplace_back(RecordedCommands::IASetPrimitiveTopology{ topology });
+}
+
+void CommandRecorder::SetGraphicsRootDescriptorTable(
+    const UINT rootParameterIndex,
+    const D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)
+{
+    mCommands.emplace_back(RecordedCommands::SetGraphicsRootDescriptorTable{ rootParameterIndex, baseDescriptor });
+}
+
+void CommandRecorder::SetGraphicsRootConstantBufferView(
+    const UINT rootParameterIndex,
+    const D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    mCommands.emplace_back(RecordedCommands::SetGraphicsRootConstantBufferView{ rootParameterIndex, address });
+}
+
+void CommandRecorder::DrawIndexedInstanced(
+    const UINT indexCountPerInstance,
+    const UINT instanceCount,
+    const UINT startIndexLocation,
+    const INT baseVertexLocation,
+    const UINT startInstanceLocation)
+{
+    mCommands.emplace_back(RecordedCommands::DrawIndexedInstanced{
+        indexCountPerInstance,
+        instanceCount,
+        startIndexLocation,
+        baseVertexLocation,
+        startInstanceLocation });
+}
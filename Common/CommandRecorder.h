@@ -0,0 +1,95 @@
+//***************************************************************************************
+// CommandRecorder.h
+//
+// CommandSink that stores the commands it receives as a flat stream.  A recorded
+// frame can be inspected, compared with another frame, or replayed later into any
+// other sink, including a real command list.
+//***************************************************************************************
+
+#pragma once
+
+#include "CommandSink.h"
+
+#include <variant>
+#include <vector>
+
+namespace RecordedCommands
+{
+    struct SetPipelineState final
+    {
+        ID3D12PipelineState* Pso = nullptr;
+    };
+
+    struct IASetVertexBuffer final
+    {
+        D3D12_VERTEX_BUFFER_VIEW View = {};
+    };
+
+    struct IASetIndexBuffer final
+    {
+        D3D12_INDEX_BUFFER_VIEW View = {};
+    };
+
+    struct IASetPrimitiveTopology final
+    {
+        D3D12_PRIMITIVE_TOPOLOGY Topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    };
+
+    struct SetGraphicsRootDescriptorTable final
+    {
+        UINT RootParameterIndex = 0;
+        D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor = {};
+    };
+
+    struct SetGraphicsRootConstantBufferView final
+    {
+        UINT RootParameterIndex = 0;
+        D3D12_GPU_VIRTUAL_ADDRESS Address = 0;
+    };
+
+    struct DrawIndexedInstanced final
+    {
+        UINT IndexCountPerInstance = 0;
+        UINT InstanceCount = 0;
+        UINT StartIndexLocation = 0;
+        INT BaseVertexLocation = 0;
+        UINT StartInstanceLocation = 0;
+    };
+}
+
+using RecordedCommand = std::variant<
+    RecordedCommands::SetPipelineState,
+    RecordedCommands::IASetVertexBuffer,
+    RecordedCommands::IASetIndexBuffer,
+    RecordedCommands::IASetPrimitiveTopology,
+    RecordedCommands::SetGraphicsRootDescriptorTable,
+    RecordedCommands::SetGraphicsRootConstantBufferView,
+    RecordedCommands::DrawIndexedInstanced>;
+
+class CommandRecorder final : public CommandSink
+{
+public:
+    // Drops the recorded commands but keeps their storage for the next frame.
+    void Clear() { mCommands.clear(); }
+
+    const std::vector<RecordedCommand>& Commands()const { return mCommands; }
+
+    // Issues the recorded commands, in order, to sink.
+    void Replay(CommandSink& sink)const;
+
+    void SetPipelineState(ID3D12PipelineState* pso)override;
+    void IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)override;
+    void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)override;
+    void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)override;
+    void SetGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)override;
+    void SetGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address)override;
+    void DrawIndexedInstanced(
+        UINT indexCountPerInstance,
+        UINT instanceCount,
+        UINT startIndexLocation,
+        INT baseVertexLocation,
+        UINT startInstanceLocation)override;
+
+private:
+    std::vector<RecordedCommand> mCommands;
+};
@@ -0,0 +1,157 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "CommandSink.h"
+
+#include <cassert>
+
+CommandListSink::CommandListSink(ID3D12GraphicsCommandList* const cmdList)
+    : mCmdList(cmdList)
+{
+    assert(mCmdList != nullptr);
+}
+
+void CommandListSink::SetPipelineState(ID3D12PipelineState* const pso)
+{
+    mCmdList->SetPipelineState(pso);
+}
+
+void CommandListSink::IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+    mCmdList->IASetVertexBuffers(0, 1, &view);
+}
+
+void CommandListSink::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+    mCmdList->IASetIndexBuffer(&view);
+}
+
+void CommandListSink::IASetPrimitiveTopology(const D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+    mCmdList->IASetPrimitiveTopology(topology);
+}
+
+void CommandListSink::SetGraphicsRootDescriptorTable(
+    const UINT rootParameterIndex,
+    const D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)
+{
+    mCmdList->SetGraphicsRootDescriptorTable(rootParameterIndex, baseDescriptor);
+}
+
+void CommandListSink::SetGraphicsRootConstantBufferView(
+    const UINT rootParameterIndex,
+    const D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    mCmdList->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+}
+
+void CommandListSink::DrawIndexedInstanced(
+    const UINT indexCountPerInstance,
+    const UINT instanceCount,
+    const UINT startIndexLocation,
+    const INT baseVertexLocation,
+    const UINT startInstanceLocation)
+{
+    mCmdList->DrawIndexedInstanced(
+        indexCountPerInstance,
+        instanceCount,
+        startIndexLocation,
+        baseVertexLocation,
+        startInstanceLocation);
+}
+
+CommandCounter::CommandCounter()
+{
+    Reset();
+}
+
+void CommandCounter::Reset()
+{
+    mCalls = {};
+    mRedundant = {};
+
+    mPsoBound = false;
+    mVertexBufferBound = false;
+    mIndexBufferBound = false;
+    mTopologyBound = false;
+    mRootParameterBound.fill(false);
+}
+
+void CommandCounter::SetPipelineState(ID3D12PipelineState* const pso)
+{
+    ++mCalls.PipelineStates;
+    if (mPsoBound && mPso == pso)
+        ++mRedundant.PipelineStates;
+
+    mPsoBound = true;
+    mPso = pso;
+}
+
+void CommandCounter::IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+    ++mCalls.VertexBuffers;
+    if (mVertexBufferBound && mVertexBuffer == view)
+        ++mRedundant.VertexBuffers;
+
+    mVertexBufferBound = true;
+    mVertexBuffer = view;
+}
+
+void CommandCounter::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+    ++mCalls.IndexBuffers;
+    if (mIndexBufferBound && mIndexBuffer == view)
+        ++mRedundant.IndexBuffers;
+
+    mIndexBufferBound = true;
+    mIndexBuffer = view;
+}
+
+void CommandCounter::IASetPrimitiveTopology(const D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+    ++mCalls.PrimitiveTopologies;
+    if (mTopologyBound && mTopology == topology)
+        ++mRedundant.PrimitiveTopologies;
+
+    mTopologyBound = true;
+    mTopology = topology;
+}
+
+void CommandCounter::SetGraphicsRootDescriptorTable(
+    const UINT rootParameterIndex,
+    const D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)
+{
+    ++mCalls.RootDescriptorTables;
+    if (BindRootParameter(rootParameterIndex, baseDescriptor.ptr))
+        ++mRedundant.RootDescriptorTables;
+}
+
+void CommandCounter::SetGraphicsRootConstantBufferView(
+    const UINT rootParameterIndex,
+    const D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    ++mCalls.RootConstantBufferViews;
+    if (BindRootParameter(rootParameterIndex, address))
+        ++mRedundant.RootConstantBufferViews;
+}
+
+bool CommandCounter::BindRootParameter(const UINT rootParameterIndex, const UINT64 value)
+{
+    assert(rootParameterIndex < kMaxRootParameters);
+
+    const bool redundant = mRootParameterBound[rootParameterIndex] && mRootParameters[rootParameterIndex] == value;
+
+    mRootParameterBound[rootParameterIndex] = true;
+    mRootParameters[rootParameterIndex] = value;
+    return redundant;
+}
+
+void CommandCounter::DrawIndexedInstanced(
+    const UINT /*indexCountPerInstance*/,
+    const UINT /*instanceCount*/,
+    const UINT /*startIndexLocation*/,
+    const INT /*baseVertexLocation*/,
+    const UINT /*startInstanceLocation*/)
+{
+    ++mCalls.Draws;
+}
@@ -0,0 +1,166 @@
+//***************************************************************************************
+// CommandSink.h
+//
+// The handful of graphics commands the demos issue per draw, behind an interface so
+// the same drawing code can record into a real command list, or run without a device
+// into a counter, a recorder (CommandRecorder.h) or nothing at all.  CommandCounter
+// also notices binds that set the state that is already bound, which is how the
+// effect of state sorting is measured.
+//
+// Only the D3D12 type declarations are needed, so this does not pull in d3dUtil.h and
+// builds on other platforms against the DirectX-Headers package, as the Tests do.
+//***************************************************************************************
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+#include <d3d12.h>
+
+class CommandSink
+{
+public:
+    virtual ~CommandSink() = default;
+
+    virtual void SetPipelineState(ID3D12PipelineState* pso) = 0;
+    virtual void IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view) = 0;
+    virtual void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view) = 0;
+    virtual void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) = 0;
+    virtual void SetGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor) = 0;
+    virtual void SetGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) = 0;
+    virtual void DrawIndexedInstanced(
+        UINT indexCountPerInstance,
+        UINT instanceCount,
+        UINT startIndexLocation,
+        INT baseVertexLocation,
+        UINT startInstanceLocation) = 0;
+};
+
+// Forwards every command to a graphics command list.
+class CommandListSink final : public CommandSink
+{
+public:
+    explicit CommandListSink(ID3D12GraphicsCommandList* cmdList);
+
+    void SetPipelineState(ID3D12PipelineState* pso)override;
+    void IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)override;
+    void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)override;
+    void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)override;
+    void SetGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)override;
+    void SetGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address)override;
+    void DrawIndexedInstanced(
+        UINT indexCountPerInstance,
+        UINT instanceCount,
+        UINT startIndexLocation,
+        INT baseVertexLocation,
+        UINT startInstanceLocation)override;
+
+private:
+    ID3D12GraphicsCommandList* mCmdList = nullptr;
+};
+
+// Counts commands, and among the binds those that change nothing.  It starts, like a
+// freshly reset command list, with nothing bound.
+class CommandCounter final : public CommandSink
+{
+public:
+    struct Counts final
+    {
+        std::uint64_t PipelineStates = 0;
+        std::uint64_t VertexBuffers = 0;
+        std::uint64_t IndexBuffers = 0;
+        std::uint64_t PrimitiveTopologies = 0;
+        std::uint64_t RootDescriptorTables = 0;
+        std::uint64_t RootConstantBufferViews = 0;
+        std::uint64_t Draws = 0;
+
+        std::uint64_t Binds()const
+        {
+            return PipelineStates + VertexBuffers + IndexBuffers + PrimitiveTopologies +
+                RootDescriptorTables + RootConstantBufferViews;
+        }
+    };
+
+    CommandCounter();
+
+    // Zeroes the counts and forgets the bound state.
+    void Reset();
+
+    const Counts& Calls()const { return mCalls; }
+    const Counts& Redundant()const { return mRedundant; }
+
+    void SetPipelineState(ID3D12PipelineState* pso)override;
+    void IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)override;
+    void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)override;
+    void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)override;
+    void SetGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)override;
+    void SetGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address)override;
+    void DrawIndexedInstanced(
+        UINT indexCountPerInstance,
+        UINT instanceCount,
+        UINT startIndexLocation,
+        INT baseVertexLocation,
+        UINT startInstanceLocation)override;
+
+private:
+    // A root signature holds at most 64 DWORDs, so root parameter indices are below 64.
+    static constexpr std::size_t kMaxRootParameters = 64;
+
+    // Records value as bound to the root parameter.  Returns true if it already was.
+    bool BindRootParameter(UINT rootParameterIndex, UINT64 value);
+
+    Counts mCalls;
+    Counts mRedundant;
+
+    bool mPsoBound = false;
+    bool mVertexBufferBound = false;
+    bool mIndexBufferBound = false;
+    bool mTopologyBound = false;
+
+    ID3D12PipelineState* mPso = nullptr;
+    D3D12_VERTEX_BUFFER_VIEW mVertexBuffer = {};
+    D3D12_INDEX_BUFFER_VIEW mIndexBuffer = {};
+    D3D12_PRIMITIVE_TOPOLOGY mTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+
+    // Root descriptor tables and root CBVs share the parameter indices; each index is
+    // one or the other, so one value per index is enough for both.
+    std::array<bool, kMaxRootParameters> mRootParameterBound = {};
+    std::array<UINT64, kMaxRootParameters> mRootParameters = {};
+};
+
+// Discards every command, for timing the code that records them.
+class NullCommandSink final : public CommandSink
+{
+public:
+    void SetPipelineState(ID3D12PipelineState*)override {}
+    void IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW&)override {}
+    void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW&)override {}
+    void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY)override {}
+    void SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE)override {}
+    void SetGraphicsRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS)override {}
+    void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT)override {}
+};
+
+inline bool operator==(const D3D12_VERTEX_BUFFER_VIEW& lhs, const D3D12_VERTEX_BUFFER_VIEW& rhs) noexcept
+{
+    return lhs.BufferLocation == rhs.BufferLocation &&
+        lhs.SizeInBytes == rhs.SizeInBytes &&
+        lhs.StrideInBytes == rhs.StrideInBytes;
+}
+
+inline bool operator==(const D3D12_INDEX_BUFFER_VIEW& lhs, const D3D12_INDEX_BUFFER_VIEW& rhs) noexcept
+{
+    return lhs.BufferLocation == rhs.BufferLocation &&
+        lhs.SizeInBytes == rhs.SizeInBytes &&
+        lhs.Format == rhs.Format;
+}
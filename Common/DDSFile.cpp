@@ -0,0 +1,878 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "DDSFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace DDSFile;
+
+#ifndef MAKEFOURCC
+#define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+namespace
+{
+    constexpr std::uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+    constexpr std::uint32_t DDS_FOURCC = 0x00000004;    // DDPF_FOURCC
+    constexpr std::uint32_t DDS_RGB = 0x00000040;       // DDPF_RGB
+    constexpr std::uint32_t DDS_LUMINANCE = 0x00020000; // DDPF_LUMINANCE
+    constexpr std::uint32_t DDS_ALPHA = 0x00000002;     // DDPF_ALPHA
+
+    constexpr std::uint32_t DDS_HEADER_FLAGS_VOLUME = 0x00800000; // DDSD_DEPTH
+    constexpr std::uint32_t DDS_HEIGHT = 0x00000002;              // DDSD_HEIGHT
+
+    // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT, DDSD_MIPMAPCOUNT and DDSD_LINEARSIZE.
+    constexpr std::uint32_t DDS_HEADER_FLAGS_TEXTURE = 0x00001007;
+    constexpr std::uint32_t DDS_HEADER_FLAGS_MIPMAP = 0x00020000;
+    constexpr std::uint32_t DDS_HEADER_FLAGS_LINEARSIZE = 0x00080000;
+
+    // DDSCAPS_TEXTURE, and DDSCAPS_COMPLEX | DDSCAPS_MIPMAP.
+    constexpr std::uint32_t DDS_SURFACE_FLAGS_TEXTURE = 0x00001000;
+    constexpr std::uint32_t DDS_SURFACE_FLAGS_MIPMAP = 0x00400008;
+
+    constexpr std::uint32_t DDS_CUBEMAP = 0x00000200;          // DDSCAPS2_CUBEMAP
+    constexpr std::uint32_t DDS_CUBEMAP_ALLFACES = 0x0000fe00; // DDSCAPS2_CUBEMAP | all six faces
+
+    constexpr std::uint32_t DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7;
+
+    // D3D11_RESOURCE_DIMENSION and D3D11_RESOURCE_MISC_TEXTURECUBE as stored in the DX10 header.
+    constexpr std::uint32_t DDS_DIMENSION_TEXTURE1D = 2;
+    constexpr std::uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+    constexpr std::uint32_t DDS_DIMENSION_TEXTURE3D = 4;
+    constexpr std::uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+    // Hardware limits (D3D12_REQ_*).  We do not trust DDS metadata larger than these.
+    constexpr std::uint32_t MaxMipLevels = 15;
+    constexpr std::uint32_t MaxTexture1DSize = 16384;
+    constexpr std::uint32_t MaxTexture2DSize = 16384;
+    constexpr std::uint32_t MaxTextureCubeSize = 16384;
+    constexpr std::uint32_t MaxTexture3DSize = 2048;
+    constexpr std::uint32_t MaxArraySize = 2048;
+
+    bool HasDXT10Header(const Header& header)
+    {
+        return (header.ddspf.flags & DDS_FOURCC) && MAKEFOURCC('D', 'X', '1', '0') == header.ddspf.fourCC;
+    }
+
+    const HeaderDXT10& GetDXT10Header(const Header& header)
+    {
+        return *reinterpret_cast<const HeaderDXT10*>(reinterpret_cast<const std::byte*>(&header) + sizeof(Header));
+    }
+
+    // Fills everything but the alpha mode from the headers.
+    Result Describe(const Header& header, TextureDesc& desc)
+    {
+        desc.Width = header.width;
+        desc.Height = header.height;
+        desc.Depth = header.depth;
+        desc.MipLevels = std::max<std::uint32_t>(header.mipMapCount, 1);
+        desc.ArraySize = 1;
+        desc.IsCubeMap = false;
+
+        if (HasDXT10Header(header))
+        {
+            const HeaderDXT10& d3d10ext = GetDXT10Header(header);
+
+            desc.ArraySize = d3d10ext.arraySize;
+            if (desc.ArraySize == 0)
+                return Result::InvalidData;
+
+            switch (d3d10ext.dxgiFormat)
+            {
+                case DXGI_FORMAT_AI44:
+                case DXGI_FORMAT_IA44:
+                case DXGI_FORMAT_P8:
+                case DXGI_FORMAT_A8P8:
+                    return Result::NotSupported;
+
+                default:
+                    if (BitsPerPixel(d3d10ext.dxgiFormat) == 0)
+                        return Result::NotSupported;
+            }
+
+            desc.Format = d3d10ext.dxgiFormat;
+
+            switch (d3d10ext.resourceDimension)
+            {
+                case DDS_DIMENSION_TEXTURE1D:
+                    if ((header.flags & DDS_HEIGHT) && desc.Height != 1)
+                        return Result::InvalidData;
+                    desc.Dimension = TextureDimension::Texture1D;
+                    desc.Height = desc.Depth = 1;
+                    break;
+
+                case DDS_DIMENSION_TEXTURE2D:
+                    if (d3d10ext.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)
+                    {
+                        // Checked here rather than against MaxArraySize later, as the
+                        // product could wrap around to something that passes.
+                        if (desc.ArraySize > UINT32_MAX / 6)
+                            return Result::NotSupported;
+                        desc.ArraySize *= 6;
+                        desc.IsCubeMap = true;
+                    }
+                    desc.Dimension = TextureDimension::Texture2D;
+                    desc.Depth = 1;
+                    break;
+
+                case DDS_DIMENSION_TEXTURE3D:
+                    if (!(header.flags & DDS_HEADER_FLAGS_VOLUME))
+                        return Result::InvalidData;
+                    if (desc.ArraySize > 1)
+                        return Result::NotSupported;
+                    desc.Dimension = TextureDimension::Texture3D;
+                    break;
+
+                default:
+                    return Result::NotSupported;
+            }
+        }
+        else
+        {
+            desc.Format = GetDXGIFormat(header.ddspf);
+            if (desc.Format == DXGI_FORMAT_UNKNOWN)
+                return Result::NotSupported;
+
+            if (header.flags & DDS_HEADER_FLAGS_VOLUME)
+            {
+                desc.Dimension = TextureDimension::Texture3D;
+            }
+            else
+            {
+                if (header.caps2 & DDS_CUBEMAP)
+                {
+                    if ((header.caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                        return Result::NotSupported;
+                    desc.ArraySize = 6;
+                    desc.IsCubeMap = true;
+                }
+
+                desc.Dimension = TextureDimension::Texture2D;
+                desc.Depth = 1;
+            }
+        }
+
+        if (desc.Width == 0 || desc.Height == 0 || desc.Depth == 0)
+            return Result::InvalidData;
+
+        if (desc.MipLevels > MaxMipLevels)
+            return Result::NotSupported;
+
+        bool withinLimits = false;
+        switch (desc.Dimension)
+        {
+            case TextureDimension::Texture1D:
+                withinLimits = desc.ArraySize <= MaxArraySize && desc.Width <= MaxTexture1DSize;
+                break;
+
+            case TextureDimension::Texture2D:
+            {
+                // ArraySize already counts the faces of cube maps.
+                const std::uint32_t maxSize = desc.IsCubeMap ? MaxTextureCubeSize : MaxTexture2DSize;
+                withinLimits = desc.ArraySize <= MaxArraySize && desc.Width <= maxSize && desc.Height <= maxSize;
+                break;
+            }
+
+            case TextureDimension::Texture3D:
+                withinLimits = desc.ArraySize == 1 &&
+                    desc.Width <= MaxTexture3DSize &&
+                    desc.Height <= MaxTexture3DSize &&
+                    desc.Depth <= MaxTexture3DSize;
+                break;
+        }
+
+        return withinLimits ? Result::Ok : Result::NotSupported;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Return the BPP for a particular format
+//--------------------------------------------------------------------------------------
+std::size_t DDSFile::BitsPerPixel(const DXGI_FORMAT format)
+{
+    switch (format)
+    {
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT:
+        case DXGI_FORMAT_R32G32B32A32_SINT:
+            return 128;
+
+        case DXGI_FORMAT_R32G32B32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+        case DXGI_FORMAT_R32G32B32_UINT:
+        case DXGI_FORMAT_R32G32B32_SINT:
+            return 96;
+
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R16G16B16A16_UINT:
+        case DXGI_FORMAT_R16G16B16A16_SNORM:
+        case DXGI_FORMAT_R16G16B16A16_SINT:
+        case DXGI_FORMAT_R32G32_TYPELESS:
+        case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_R32G32_UINT:
+        case DXGI_FORMAT_R32G32_SINT:
+        case DXGI_FORMAT_R32G8X24_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+        case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+        case DXGI_FORMAT_Y416:
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            return 64;
+
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R10G10B10A2_UINT:
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_R8G8B8A8_UINT:
+        case DXGI_FORMAT_R8G8B8A8_SNORM:
+        case DXGI_FORMAT_R8G8B8A8_SINT:
+        case DXGI_FORMAT_R16G16_TYPELESS:
+        case DXGI_FORMAT_R16G16_FLOAT:
+        case DXGI_FORMAT_R16G16_UNORM:
+        case DXGI_FORMAT_R16G16_UINT:
+        case DXGI_FORMAT_R16G16_SNORM:
+        case DXGI_FORMAT_R16G16_SINT:
+        case DXGI_FORMAT_R32_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT:
+        case DXGI_FORMAT_R32_FLOAT:
+        case DXGI_FORMAT_R32_UINT:
+        case DXGI_FORMAT_R32_SINT:
+        case DXGI_FORMAT_R24G8_TYPELESS:
+        case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+        case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+        case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        case DXGI_FORMAT_AYUV:
+        case DXGI_FORMAT_Y410:
+        case DXGI_FORMAT_YUY2:
+            return 32;
+
+        case DXGI_FORMAT_P010:
+        case DXGI_FORMAT_P016:
+            return 24;
+
+        case DXGI_FORMAT_R8G8_TYPELESS:
+        case DXGI_FORMAT_R8G8_UNORM:
+        case DXGI_FORMAT_R8G8_UINT:
+        case DXGI_FORMAT_R8G8_SNORM:
+        case DXGI_FORMAT_R8G8_SINT:
+        case DXGI_FORMAT_R16_TYPELESS:
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_D16_UNORM:
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_R16_UINT:
+        case DXGI_FORMAT_R16_SNORM:
+        case DXGI_FORMAT_R16_SINT:
+        case DXGI_FORMAT_B5G6R5_UNORM:
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+        case DXGI_FORMAT_A8P8:
+        case DXGI_FORMAT_B4G4R4A4_UNORM:
+            return 16;
+
+        case DXGI_FORMAT_NV12:
+        case DXGI_FORMAT_420_OPAQUE:
+        case DXGI_FORMAT_NV11:
+            return 12;
+
+        case DXGI_FORMAT_R8_TYPELESS:
+        case DXGI_FORMAT_R8_UNORM:
+        case DXGI_FORMAT_R8_UINT:
+        case DXGI_FORMAT_R8_SNORM:
+        case DXGI_FORMAT_R8_SINT:
+        case DXGI_FORMAT_A8_UNORM:
+        case DXGI_FORMAT_AI44:
+        case DXGI_FORMAT_IA44:
+        case DXGI_FORMAT_P8:
+            return 8;
+
+        case DXGI_FORMAT_R1_UNORM:
+            return 1;
+
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return 4;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return 8;
+
+        default:
+            return 0;
+    }}
+
+//--------------------------------------------------------------------------------------
+// Get surface information for a particular format
+//--------------------------------------------------------------------------------------
+SurfaceInfo DDSFile::GetSurfaceInfo(const std::size_t width, const std::size_t height, const DXGI_FORMAT format)
+{
+    bool bc = false;
+    bool packed = false;
+    bool planar = false;
+    std::size_t bpe = 0;
+    switch (format)
+    {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            bc = true;
+            bpe = 8;
+            break;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            bc = true;
+            bpe = 16;
+            break;
+
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_YUY2:
+            packed = true;
+            bpe = 4;
+            break;
+
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            packed = true;
+            bpe = 8;
+            break;
+
+        case DXGI_FORMAT_NV12:
+        case DXGI_FORMAT_420_OPAQUE:
+            planar = true;
+            bpe = 2;
+            break;
+
+        case DXGI_FORMAT_P010:
+        case DXGI_FORMAT_P016:
+            planar = true;
+            bpe = 4;
+            break;
+
+        default:
+            break;
+    }
+
+    SurfaceInfo info;
+    if (bc)
+    {
+        const std::size_t numBlocksWide = width > 0 ? std::max<std::size_t>(1, (width + 3) / 4) : 0;
+        const std::size_t numBlocksHigh = height > 0 ? std::max<std::size_t>(1, (height + 3) / 4) : 0;
+        info.RowBytes = numBlocksWide * bpe;
+        info.NumRows = numBlocksHigh;
+        info.NumBytes = info.RowBytes * numBlocksHigh;
+    }
+    else if (packed)
+    {
+        info.RowBytes = ((width + 1) >> 1) * bpe;
+        info.NumRows = height;
+        info.NumBytes = info.RowBytes * height;
+    }
+    else if (format == DXGI_FORMAT_NV11)
+    {
+        info.RowBytes = ((width + 3) >> 2) * 4;
+        info.NumRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+        info.NumBytes = info.RowBytes * info.NumRows;
+    }
+    else if (planar)
+    {
+        info.RowBytes = ((width + 1) >> 1) * bpe;
+        info.NumBytes = (info.RowBytes * height) + ((info.RowBytes * height + 1) >> 1);
+        info.NumRows = height + ((height + 1) >> 1);
+    }
+    else
+    {
+        const std::size_t bpp = BitsPerPixel(format);
+        info.RowBytes = (width * bpp + 7) / 8; // round up to nearest byte
+        info.NumRows = height;
+        info.NumBytes = info.RowBytes * height;
+    }
+
+    return info;
+}
+
+//--------------------------------------------------------------------------------------
+#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
+
+DXGI_FORMAT DDSFile::GetDXGIFormat(const PixelFormat& ddpf)
+{
+    if (ddpf.flags & DDS_RGB)
+    {
+        // Note that sRGB formats are written using the "DX10" extended header
+
+        switch (ddpf.RGBBitCount)
+        {
+            case 32:
+                if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                {
+                    return DXGI_FORMAT_R8G8B8A8_UNORM;
+                }
+
+                if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
+                {
+                    return DXGI_FORMAT_B8G8R8A8_UNORM;
+                }
+
+                if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
+                {
+                    return DXGI_FORMAT_B8G8R8X8_UNORM;
+                }
+
+                // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+
+                // Note that many common DDS reader/writers (including D3DX) swap the
+                // the RED/BLUE masks for 10:10:10:2 formats. We assume
+                // below that the 'backwards' header mask is being used since it is most
+                // likely written by D3DX. The more robust solution is to use the 'DX10'
+                // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+
+                // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+                if (ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
+                {
+                    return DXGI_FORMAT_R10G10B10A2_UNORM;
+                }
+
+                // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+                if (ISBITMASK(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+                {
+                    return DXGI_FORMAT_R16G16_UNORM;
+                }
+
+                if (ISBITMASK(0xffffffff, 0x00000000, 0x00000000, 0x00000000))
+                {
+                    // Only 32-bit color channel format in D3D9 was R32F
+                    return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
+                }
+                break;
+
+            case 24:
+                // No 24bpp DXGI formats aka D3DFMT_R8G8B8
+                break;
+
+            case 16:
+                if (ISBITMASK(0x7c00, 0x03e0, 0x001f, 0x8000))
+                {
+                    return DXGI_FORMAT_B5G5R5A1_UNORM;
+                }
+                if (ISBITMASK(0xf800, 0x07e0, 0x001f, 0x0000))
+                {
+                    return DXGI_FORMAT_B5G6R5_UNORM;
+                }
+
+                // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+                if (ISBITMASK(0x0f00, 0x00f0, 0x000f, 0xf000))
+                {
+                    return DXGI_FORMAT_B4G4R4A4_UNORM;
+                }
+
+                // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+                // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+                break;
+        }
+    }
+    else if (ddpf.flags & DDS_LUMINANCE)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x00000000))
+            {
+                return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+        }
+
+        if (16 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
+            {
+                return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+            if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
+            {
+                return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+        }
+    }
+    else if (ddpf.flags & DDS_ALPHA)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            return DXGI_FORMAT_A8_UNORM;
+        }
+    }
+    else if (ddpf.flags & DDS_FOURCC)
+    {
+        if (MAKEFOURCC('D', 'X', 'T', '1') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC1_UNORM;
+        }
+        if (MAKEFOURCC('D', 'X', 'T', '3') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC('D', 'X', 'T', '5') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        // While pre-multiplied alpha isn't directly supported by the DXGI formats,
+        // they are basically the same as these BC formats so they can be mapped
+        if (MAKEFOURCC('D', 'X', 'T', '2') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC('D', 'X', 'T', '4') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        if (MAKEFOURCC('A', 'T', 'I', '1') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC('B', 'C', '4', 'U') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC('B', 'C', '4', 'S') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_SNORM;
+        }
+
+        if (MAKEFOURCC('A', 'T', 'I', '2') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC('B', 'C', '5', 'U') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC('B', 'C', '5', 'S') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_SNORM;
+        }
+
+        // BC6H and BC7 are written using the "DX10" extended header
+
+        if (MAKEFOURCC('R', 'G', 'B', 'G') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_R8G8_B8G8_UNORM;
+        }
+        if (MAKEFOURCC('G', 'R', 'G', 'B') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_G8R8_G8B8_UNORM;
+        }
+
+        if (MAKEFOURCC('Y', 'U', 'Y', '2') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_YUY2;
+        }
+
+        // Check for D3DFORMAT enums being set here
+        switch (ddpf.fourCC)
+        {
+            case 36: // D3DFMT_A16B16G16R16
+                return DXGI_FORMAT_R16G16B16A16_UNORM;
+
+            case 110: // D3DFMT_Q16W16V16U16
+                return DXGI_FORMAT_R16G16B16A16_SNORM;
+
+            case 111: // D3DFMT_R16F
+                return DXGI_FORMAT_R16_FLOAT;
+
+            case 112: // D3DFMT_G16R16F
+                return DXGI_FORMAT_R16G16_FLOAT;
+
+            case 113: // D3DFMT_A16B16G16R16F
+                return DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+            case 114: // D3DFMT_R32F
+                return DXGI_FORMAT_R32_FLOAT;
+
+            case 115: // D3DFMT_G32R32F
+                return DXGI_FORMAT_R32G32_FLOAT;
+
+            case 116: // D3DFMT_A32B32G32R32F
+                return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        }
+    }
+
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+#undef ISBITMASK
+
+AlphaMode DDSFile::GetAlphaMode(const Header& header)
+{
+    if (header.ddspf.flags & DDS_FOURCC)
+    {
+        if (HasDXT10Header(header))
+        {
+            const auto mode = static_cast<AlphaMode>(GetDXT10Header(header).miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK);
+            switch (mode)
+            {
+                case AlphaMode::Straight:
+                case AlphaMode::Premultiplied:
+                case AlphaMode::Opaque:
+                case AlphaMode::Custom:
+                    return mode;
+
+                default:
+                    break;
+            }
+        }
+        else if ((MAKEFOURCC('D', 'X', 'T', '2') == header.ddspf.fourCC)
+            || (MAKEFOURCC('D', 'X', 'T', '4') == header.ddspf.fourCC))
+        {
+            return AlphaMode::Premultiplied;
+        }
+    }
+
+    return AlphaMode::Unknown;
+}
+
+Result DDSFile::ReadHeader(const std::span<const std::byte> image, const Header*& header, std::span<const std::byte>& bitData)
+{
+    // Need at least enough data to fill the header and magic number to be a valid DDS
+    if (image.size() < sizeof(std::uint32_t) + sizeof(Header))
+        return Result::InvalidData;
+
+    // DDS files always start with the same magic number ("DDS ")
+    std::uint32_t magic = 0;
+    std::memcpy(&magic, image.data(), sizeof(magic));
+    if (magic != DDS_MAGIC)
+        return Result::InvalidData;
+
+    const auto* hdr = reinterpret_cast<const Header*>(image.data() + sizeof(std::uint32_t));
+    if (hdr->size != sizeof(Header) || hdr->ddspf.size != sizeof(PixelFormat))
+        return Result::InvalidData;
+
+    std::size_t offset = sizeof(std::uint32_t) + sizeof(Header);
+    if (HasDXT10Header(*hdr))
+    {
+        // Must be long enough for both headers and magic value
+        if (image.size() < offset + sizeof(HeaderDXT10))
+            return Result::InvalidData;
+
+        offset += sizeof(HeaderDXT10);
+    }
+
+    header = hdr;
+    bitData = image.subspan(offset);
+    return Result::Ok;
+}
+
+Result DDSFile::Parse(const std::span<const std::byte> image, Texture& texture)
+{
+    texture = {};
+
+    const Header* header = nullptr;
+    std::span<const std::byte> bitData;
+    Result result = ReadHeader(image, header, bitData);
+    if (result != Result::Ok)
+        return result;
+
+    TextureDesc desc;
+    result = Describe(*header, desc);
+    if (result != Result::Ok)
+        return result;
+
+    desc.Alpha = GetAlphaMode(*header);
+
+    // Array slices follow each other, each with its full mip chain.
+    std::vector<Subresource> subresources;
+    subresources.reserve(std::size_t(desc.ArraySize) * desc.MipLevels);
+
+    std::size_t offset = 0;
+    for (std::uint32_t slice = 0; slice < desc.ArraySize; ++slice)
+    {
+        std::uint32_t width = desc.Width;
+        std::uint32_t height = desc.Height;
+        std::uint32_t depth = desc.Depth;
+        for (std::uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+        {
+            const SurfaceInfo surface = GetSurfaceInfo(width, height, desc.Format);
+            const std::size_t size = surface.NumBytes * depth;
+            if (size > bitData.size() - offset)
+                return Result::Truncated;
+
+            Subresource& subresource = subresources.emplace_back();
+            subresource.Data = bitData.data() + offset;
+            subresource.RowPitch = surface.RowBytes;
+            subresource.SlicePitch = surface.NumBytes;
+            subresource.Width = width;
+            subresource.Height = height;
+            subresource.Depth = depth;
+            offset += size;
+
+            width = std::max<std::uint32_t>(width >> 1, 1);
+            height = std::max<std::uint32_t>(height >> 1, 1);
+            depth = std::max<std::uint32_t>(depth >> 1, 1);
+        }
+    }
+
+    texture.mDesc = desc;
+    texture.mSubresources = std::move(subresources);
+    texture.mDataSize = offset;
+    return Result::Ok;
+}
+
+std::size_t DDSFile::Texture::MipLevelSize(const std::uint32_t mip)const
+{
+    std::size_t size = 0;
+    for (std::uint32_t slice = 0; slice < mDesc.ArraySize; ++slice)
+    {
+        const Subresource& subresource = GetSubresource(mip, slice);
+        size += subresource.SlicePitch * subresource.Depth;
+    }
+    return size;
+}
+
+std::uint32_t DDSFile::Texture::MipExtent(const std::uint32_t mip)const
+{
+    const Subresource& subresource = GetSubresource(mip, 0);
+    return std::max({ subresource.Width, subresource.Height, subresource.Depth });
+}
+
+std::uint32_t DDSFile::Texture::FirstMipWithin(const std::size_t maxExtent)const
+{
+    std::uint32_t mip = 0;
+    while (mip < mDesc.MipLevels && MipExtent(mip) > maxExtent)
+        ++mip;
+    return mip;
+}
+
+std::vector<std::byte> DDSFile::WriteImage(const TextureDesc& desc, const std::span<const std::byte> data)
+{
+    if (desc.Dimension != TextureDimension::Texture2D || desc.ArraySize != 1 || desc.IsCubeMap ||
+        desc.MipLevels == 0 || BitsPerPixel(desc.Format) == 0)
+    {
+        return {};
+    }
+
+    std::size_t dataSize = 0;
+    for (std::uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+    {
+        dataSize += GetSurfaceInfo(std::max(desc.Width >> mip, 1u), std::max(desc.Height >> mip, 1u), desc.Format).NumBytes;
+    }
+    if (data.size() != dataSize)
+        return {};
+
+    Header header = {};
+    header.size = sizeof(Header);
+    header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_LINEARSIZE;
+    header.height = desc.Height;
+    header.width = desc.Width;
+    header.pitchOrLinearSize = std::uint32_t(GetSurfaceInfo(desc.Width, desc.Height, desc.Format).NumBytes);
+    header.depth = 1;
+    header.mipMapCount = desc.MipLevels;
+    header.ddspf.size = sizeof(PixelFormat);
+    header.ddspf.flags = DDS_FOURCC;
+    header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+    header.caps = DDS_SURFACE_FLAGS_TEXTURE;
+    if (desc.MipLevels > 1)
+    {
+        header.flags |= DDS_HEADER_FLAGS_MIPMAP;
+        header.caps |= DDS_SURFACE_FLAGS_MIPMAP;
+    }
+
+    HeaderDXT10 headerDXT10 = {};
+    headerDXT10.dxgiFormat = desc.Format;
+    headerDXT10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+    headerDXT10.arraySize = 1;
+    headerDXT10.miscFlags2 = std::uint32_t(desc.Alpha) & DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+
+    std::vector<std::byte> image(sizeof(DDS_MAGIC) + sizeof(Header) + sizeof(HeaderDXT10) + data.size());
+    std::byte* out = image.data();
+    std::memcpy(out, &DDS_MAGIC, sizeof(DDS_MAGIC));
+    out += sizeof(DDS_MAGIC);
+    std::memcpy(out, &header, sizeof(Header));
+    out += sizeof(Header);
+    std::memcpy(out, &headerDXT10, sizeof(HeaderDXT10));
+    out += sizeof(HeaderDXT10);
+    std::memcpy(out, data.data(), data.size());
+
+    return image;
+}
+
+AssetCache::Handle<DDSFile::Texture> DDSFile::LoadCached(const std::wstring& filename, Result& result, AssetCache& cache)
+{
+    result = Result::Ok;
+    return cache.Get<Texture>(filename, [&result](const std::wstring& path, Texture& texture)
+    {
+        result = Load(path, texture);
+        return texture.File();
+    });
+}
+
+Result DDSFile::Load(const std::wstring& filename, Texture& texture)
+{
+    texture = {};
+
+    std::shared_ptr<const MappedFile> file = MappedFile::Open(filename);
+    if (file == nullptr)
+        return Result::OpenFailed;
+
+    const Result result = Parse(file->Bytes(), texture);
+    if (result == Result::Ok)
+        texture.mFile = std::move(file);
+    return result;
+}
@@ -0,0 +1,216 @@
+//***************************************************************************************
+// DDSFile.h
+//
+// Device-independent DDS parsing.  Validates the header, works out the format,
+// dimension and mip/array layout, and describes every subresource with a view that
+// points straight into the memory-mapped file, so no texel is read or copied until
+// the upload.  Nothing here needs a device; DDSTextureLoader turns the views into
+// D3D12_SUBRESOURCE_DATA.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <dxgiformat.h>
+
+#include "AssetCache.h"
+#include "MappedFile.h"
+
+namespace DDSFile
+{
+    //
+    // On-disk structures.  See DDS.h in the 'Texconv' sample and the 'DirectXTex' library.
+    //
+
+#pragma pack(push, 1)
+
+    struct PixelFormat final
+    {
+        std::uint32_t size;
+        std::uint32_t flags;
+        std::uint32_t fourCC;
+        std::uint32_t RGBBitCount;
+        std::uint32_t RBitMask;
+        std::uint32_t GBitMask;
+        std::uint32_t BBitMask;
+        std::uint32_t ABitMask;
+    };
+
+    struct Header final
+    {
+        std::uint32_t size;
+        std::uint32_t flags;
+        std::uint32_t height;
+        std::uint32_t width;
+        std::uint32_t pitchOrLinearSize;
+        std::uint32_t depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+        std::uint32_t mipMapCount;
+        std::uint32_t reserved1[11];
+        PixelFormat ddspf;
+        std::uint32_t caps;
+        std::uint32_t caps2;
+        std::uint32_t caps3;
+        std::uint32_t caps4;
+        std::uint32_t reserved2;
+    };
+
+    struct HeaderDXT10 final
+    {
+        DXGI_FORMAT dxgiFormat;
+        std::uint32_t resourceDimension;
+        std::uint32_t miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+        std::uint32_t arraySize;
+        std::uint32_t miscFlags2;
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(PixelFormat) == 32);
+    static_assert(sizeof(Header) == 124);
+    static_assert(sizeof(HeaderDXT10) == 20);
+
+    enum class Result
+    {
+        Ok,
+        OpenFailed,
+        InvalidData,
+        NotSupported,
+        // The file ends before the last subresource does.
+        Truncated,
+    };
+
+    enum class TextureDimension
+    {
+        Texture1D,
+        Texture2D,
+        Texture3D,
+    };
+
+    // Same values as DirectX::DDS_ALPHA_MODE.
+    enum class AlphaMode
+    {
+        Unknown = 0,
+        Straight = 1,
+        Premultiplied = 2,
+        Opaque = 3,
+        Custom = 4,
+    };
+
+    struct TextureDesc final
+    {
+        TextureDimension Dimension = TextureDimension::Texture2D;
+        DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+        std::uint32_t Width = 0;
+        std::uint32_t Height = 0;
+        std::uint32_t Depth = 0;
+        std::uint32_t MipLevels = 0;
+
+        // Six per cube for cube maps.
+        std::uint32_t ArraySize = 0;
+
+        bool IsCubeMap = false;
+        AlphaMode Alpha = AlphaMode::Unknown;
+    };
+
+    // One mip level of one array slice.  A 3D subresource is Depth slices of
+    // SlicePitch bytes each.
+    struct Subresource final
+    {
+        const std::byte* Data = nullptr;
+        std::size_t RowPitch = 0;
+        std::size_t SlicePitch = 0;
+        std::uint32_t Width = 0;
+        std::uint32_t Height = 0;
+        std::uint32_t Depth = 0;
+    };
+
+    struct SurfaceInfo final
+    {
+        std::size_t NumBytes = 0;
+        std::size_t RowBytes = 0;
+        std::size_t NumRows = 0;
+    };
+
+    // Bits per pixel of format, or 0 for formats DDS files can not hold.  Block
+    // compressed formats report the average (4 or 8).
+    std::size_t BitsPerPixel(DXGI_FORMAT format);
+
+    // Size of one width x height surface of format as laid out in a DDS file.
+    SurfaceInfo GetSurfaceInfo(std::size_t width, std::size_t height, DXGI_FORMAT format);
+
+    // Format described by a legacy (non DX10) pixel format, or DXGI_FORMAT_UNKNOWN.
+    DXGI_FORMAT GetDXGIFormat(const PixelFormat& pixelFormat);
+
+    AlphaMode GetAlphaMode(const Header& header);
+
+    // Checks the magic number and header sizes of a DDS image and locates the texel
+    // data that follows the headers.
+    Result ReadHeader(std::span<const std::byte> image, const Header*& header, std::span<const std::byte>& bitData);
+
+    // Validated description of a DDS image.  The views point into the image, which
+    // stays alive as long as the texture does if it was mapped by Load.
+    class Texture final
+    {
+    public:
+        Texture() = default;
+
+        bool IsValid()const { return !mSubresources.empty(); }
+
+        const TextureDesc& Desc()const { return mDesc; }
+
+        // In D3D12 subresource order: all mips of array slice 0, then of slice 1, ...
+        std::span<const Subresource> Subresources()const { return mSubresources; }
+
+        const Subresource& GetSubresource(std::uint32_t mip, std::uint32_t arraySlice)const
+        {
+            return mSubresources[std::size_t(arraySlice) * mDesc.MipLevels + mip];
+        }
+
+        // Bytes of texel data the subresources cover.
+        std::size_t DataSize()const { return mDataSize; }
+
+        // The mapping the views point into; nullptr if the caller owns the image.
+        const std::shared_ptr<const MappedFile>& File()const { return mFile; }
+
+        // Bytes of mip level mip over all array slices.
+        std::size_t MipLevelSize(std::uint32_t mip)const;
+
+        // Largest of the width, height and depth of mip level mip.
+        std::uint32_t MipExtent(std::uint32_t mip)const;
+
+        // Most detailed mip whose extent is at most maxExtent, or MipLevels if none is.
+        // A streamer creates the resource from this mip on with maxsize = maxExtent.
+        std::uint32_t FirstMipWithin(std::size_t maxExtent)const;
+
+    private:
+        friend Result Parse(std::span<const std::byte> image, Texture& texture);
+        friend Result Load(const std::wstring& filename, Texture& texture);
+
+        std::shared_ptr<const MappedFile> mFile;
+        TextureDesc mDesc;
+        std::vector<Subresource> mSubresources;
+        std::size_t mDataSize = 0;
+    };
+
+    // Parses an image owned by the caller, which must outlive the views.
+    Result Parse(std::span<const std::byte> image, Texture& texture);
+
+    // Maps filename and parses it.
+    Result Load(const std::wstring& filename, Texture& texture);
+
+    // DDS image, with the DX10 header, of a 2D texture with one array slice.  data holds
+    // the mips one after the other, most detailed first, each laid out as
+    // GetSurfaceInfo describes.  Returns an empty image if data does not match desc.
+    std::vector<std::byte> WriteImage(const TextureDesc& desc, std::span<const std::byte> data);
+
+    // Load through cache, so every load of the same file, or of a copy of it, shares
+    // one mapping.  Returns nullptr and sets result on failure.
+    AssetCache::Handle<Texture> LoadCached(const std::wstring& filename, Result& result,
+        AssetCache& cache = AssetCache::Default());
+}
@@ -26,6 +26,7 @@
 #include <d3d11_1.h>
 
 #include "d3dx12.h"
+#include "DDSFile.h"
 
 #pragma warning(push)
 #pragma warning(disable : 4005)
@@ -76,6 +77,19 @@ namespace DirectX
 		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 		                                 );
 
+	// Creates the texture from a file DDSFile has already parsed, for example on a
+	// loader thread.  The views must stay valid until this returns.
+	HRESULT CreateDDSTextureFromParsed12(_In_ ID3D12Device* device,
+		                                 _In_ ID3D12GraphicsCommandList* cmdList,
+		                                 _In_ const DDSFile::Texture& dds,
+		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
+		                                 _In_ size_t maxsize = 0
+		                                 );
+
+	// HRESULT the loaders return for a DDSFile failure.
+	HRESULT HResultFromDDSFileResult(_In_ DDSFile::Result result);
+
     HRESULT CreateDDSTextureFromFile( _In_ ID3D11Device* d3dDevice,
                                       _In_z_ const wchar_t* szFileName,
                                       _Outptr_opt_ ID3D11Resource** texture,
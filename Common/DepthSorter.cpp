@@ -0,0 +1,58 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "DepthSorter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace DirectX;
+
+float DepthSorter::ViewDepth(FXMMATRIX worldView, const BoundingBox& localBox)
+{
+    const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&localBox.Center), worldView);
+    return XMVectorGetZ(center);
+}
+
+void DepthSorter::Sort(std::span<const float> depths, const Order order, std::vector<std::uint32_t>& sorted)
+{
+    const std::size_t count = depths.size();
+
+    sorted.resize(count);
+    std::iota(sorted.begin(), sorted.end(), 0u);
+    if (count < 2)
+        return;
+
+    // The range is taken over the finite depths only, and every depth is clamped to it
+    // before the conversion to an integer, which is undefined for NaN and infinity.
+    float minDepth = std::numeric_limits<float>::max();
+    float maxDepth = std::numeric_limits<float>::lowest();
+    for (const float depth : depths)
+    {
+        if (std::isfinite(depth))
+        {
+            minDepth = std::min(minDepth, depth);
+            maxDepth = std::max(maxDepth, depth);
+        }
+    }
+    if (minDepth > maxDepth)
+        minDepth = maxDepth = 0.0f;
+
+    const float range = maxDepth - minDepth;
+    const float scale = range > 0.0f ? 65535.0f / range : 0.0f;
+
+    // Back to front is front to back on inverted keys, which keeps ties stable too.
+    const std::uint16_t flip = order == Order::BackToFront ? 0xffff : 0;
+
+    mKeys.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float depth = std::isnan(depths[i]) ? maxDepth : std::clamp(depths[i], minDepth, maxDepth);
+        const float quantized = std::min((depth - minDepth) * scale, 65535.0f);
+        mKeys[i] = static_cast<std::uint16_t>(static_cast<std::uint16_t>(quantized) ^ flip);
+    }
+
+    mSorter.Sort(mKeys, sorted);
+}
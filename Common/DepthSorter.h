@@ -0,0 +1,45 @@
+//***************************************************************************************
+// DepthSorter.h
+//
+// Orders render items by view-space depth with a radix sort (RadixSort.h) on depths
+// quantized to 16 bits over the range of the current frame.  Used front to back for
+// opaque items, so nearer surfaces fill the depth buffer first and hide the pixels
+// behind them, and back to front for transparent items, which blend correctly only
+// when drawn over what lies behind them.
+//***************************************************************************************
+
+#pragma once
+
+#include "RadixSort.h"
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class DepthSorter final
+{
+public:
+    enum class Order
+    {
+        FrontToBack,
+        BackToFront
+    };
+
+    // View-space depth of the center of localBox, which is in object space; worldView
+    // is the object's world matrix times the view matrix.
+    static float ViewDepth(DirectX::FXMMATRIX worldView, const DirectX::BoundingBox& localBox);
+
+    // Replaces sorted with the indices of depths in draw order.  Depths that quantize
+    // to the same value keep their relative order, so coplanar items do not swap
+    // places from frame to frame.  Infinite depths sort with the nearest or farthest
+    // finite ones and NaNs with the farthest, so a degenerate matrix cannot upset the
+    // order of the other items.
+    void Sort(std::span<const float> depths, Order order, std::vector<std::uint32_t>& sorted);
+
+private:
+    std::vector<std::uint16_t> mKeys;
+    RadixSorter<std::uint16_t> mSorter;
+};
@@ -0,0 +1,116 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "DrawPackets.h"
+
+#include <cassert>
+#include <numeric>
+
+namespace
+{
+    constexpr std::uint64_t Field(const std::uint32_t value, const int bits, const int shift)
+    {
+        return (std::uint64_t(value) & ((std::uint64_t(1) << bits) - 1)) << shift;
+    }
+}
+
+std::uint64_t DrawPacketQueue::MakeSortKey(
+    const std::uint32_t layer,
+    const std::uint32_t pso,
+    const std::uint32_t geometry,
+    const std::uint32_t material,
+    const std::uint32_t depth)
+{
+    static_assert(LayerBits + PsoBits + GeometryBits + MaterialBits + DepthBits == 64);
+
+    assert(layer < (1u << LayerBits) && pso < (1u << PsoBits));
+    assert(geometry < (1u << GeometryBits) && material < (1u << MaterialBits) && depth < (1u << DepthBits));
+
+    constexpr int depthShift = 0;
+    constexpr int materialShift = depthShift + DepthBits;
+    constexpr int geometryShift = materialShift + MaterialBits;
+    constexpr int psoShift = geometryShift + GeometryBits;
+    constexpr int layerShift = psoShift + PsoBits;
+
+    return Field(layer, LayerBits, layerShift) |
+        Field(pso, PsoBits, psoShift) |
+        Field(geometry, GeometryBits, geometryShift) |
+        Field(material, MaterialBits, materialShift) |
+        Field(depth, DepthBits, depthShift);
+}
+
+DrawPacketQueue::DrawPacketQueue(const UINT objectCBRootParameter)
+    : mObjectCBRootParameter(objectCBRootParameter)
+{
+}
+
+void DrawPacketQueue::Clear()
+{
+    mKeys.clear();
+    mPackets.clear();
+    mOrder.clear();
+}
+
+void DrawPacketQueue::Reserve(const std::size_t count)
+{
+    mKeys.reserve(count);
+    mPackets.reserve(count);
+    mOrder.reserve(count);
+}
+
+void DrawPacketQueue::Add(const std::uint64_t sortKey, const DrawPacket& packet)
+{
+    mOrder.push_back(static_cast<std::uint32_t>(mPackets.size()));
+    mKeys.push_back(sortKey);
+    mPackets.push_back(packet);
+}
+
+void DrawPacketQueue::Sort()
+{
+    // Radix sorted, which is stable.  A frame's keys usually differ in only a few
+    // bytes, so most of the passes are skipped.
+    mSortKeys.assign(mKeys.begin(), mKeys.end());
+    std::iota(mOrder.begin(), mOrder.end(), 0u);
+    mSorter.Sort(mSortKeys, mOrder);
+}
+
+void DrawPacketQueue::Submit(CommandSink& sink, const bool skipRedundantState)const
+{
+    const DrawPacket* previous = nullptr;
+
+    for (const std::uint32_t index : mOrder)
+    {
+        const DrawPacket& packet = mPackets[index];
+        const bool bindAll = !skipRedundantState || previous == nullptr;
+
+        if (bindAll || packet.Pso != previous->Pso)
+        {
+            sink.SetPipelineState(packet.Pso);
+        }
+        if (bindAll || !(packet.VertexBuffer == previous->VertexBuffer))
+        {
+            sink.IASetVertexBuffer(packet.VertexBuffer);
+        }
+        if (bindAll || !(packet.IndexBuffer == previous->IndexBuffer))
+        {
+            sink.IASetIndexBuffer(packet.IndexBuffer);
+        }
+        if (bindAll || packet.PrimitiveType != previous->PrimitiveType)
+        {
+            sink.IASetPrimitiveTopology(packet.PrimitiveType);
+        }
+        if (bindAll || packet.ObjectCB != previous->ObjectCB)
+        {
+            sink.SetGraphicsRootConstantBufferView(mObjectCBRootParameter, packet.ObjectCB);
+        }
+
+        sink.DrawIndexedInstanced(
+            packet.IndexCount,
+            packet.InstanceCount,
+            packet.StartIndexLocation,
+            packet.BaseVertexLocation,
+            0);
+
+        previous = &packet;
+    }
+}
@@ -0,0 +1,87 @@
+//***************************************************************************************
+// DrawPackets.h
+//
+// Draws collected as self-contained packets with a 64-bit sort key, radix-sorted so
+// packets that share a layer, pipeline state and geometry end up next to each other,
+// and then submitted binding only the state that differs from the previous packet.
+//
+// A packet carries a pipeline state, geometry and one object constant buffer, which is
+// what CubeMap binds per draw; CubeMap is the only demo that draws through the queue.
+// The other demos keep their DrawRenderItems loops, since they also bind material
+// constants and texture tables per item.  BlendDemo issues its draws through a
+// CommandSink too, so they can be counted, but binds them itself.
+//***************************************************************************************
+
+#pragma once
+
+#include "CommandSink.h"
+#include "RadixSort.h"
+
+#include <cstdint>
+#include <vector>
+
+// Everything needed to issue one DrawIndexedInstanced.
+struct DrawPacket final
+{
+    ID3D12PipelineState* Pso = nullptr;
+    D3D12_VERTEX_BUFFER_VIEW VertexBuffer = {};
+    D3D12_INDEX_BUFFER_VIEW IndexBuffer = {};
+    D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+    // Per-object constants, bound to the queue's object constant buffer root parameter.
+    D3D12_GPU_VIRTUAL_ADDRESS ObjectCB = 0;
+
+    UINT IndexCount = 0;
+    UINT InstanceCount = 1;
+    UINT StartIndexLocation = 0;
+    int BaseVertexLocation = 0;
+};
+
+class DrawPacketQueue final
+{
+public:
+    // Field widths of the sort key, most significant first.  Layers are drawn in order;
+    // within a layer, packets are grouped by pipeline state, then geometry, then
+    // material, and Depth orders the packets that share all three.
+    static constexpr int LayerBits = 4;
+    static constexpr int PsoBits = 12;
+    static constexpr int GeometryBits = 16;
+    static constexpr int MaterialBits = 16;
+    static constexpr int DepthBits = 16;
+
+    static std::uint64_t MakeSortKey(
+        std::uint32_t layer,
+        std::uint32_t pso,
+        std::uint32_t geometry,
+        std::uint32_t material,
+        std::uint32_t depth = 0);
+
+    explicit DrawPacketQueue(UINT objectCBRootParameter = 0);
+
+    void Clear();
+    void Reserve(std::size_t count);
+
+    std::size_t Size()const { return mPackets.size(); }
+
+    void Add(std::uint64_t sortKey, const DrawPacket& packet);
+
+    // Orders the packets by key.  Packets with equal keys keep the order they were
+    // added in.  Without a Sort, Submit draws in the order of Add.
+    void Sort();
+
+    // Issues the packets.  State that is already bound from the previous packet is not
+    // set again unless skipRedundantState is false, which reproduces a loop that binds
+    // everything for every draw.
+    void Submit(CommandSink& sink, bool skipRedundantState = true)const;
+
+private:
+    UINT mObjectCBRootParameter = 0;
+
+    std::vector<std::uint64_t> mKeys;
+    std::vector<DrawPacket> mPackets;
+
+    // Packet indices in draw order, and the keys in that order.
+    std::vector<std::uint32_t> mOrder;
+    std::vector<std::uint64_t> mSortKeys;
+    RadixSorter<std::uint64_t> mSorter;
+};
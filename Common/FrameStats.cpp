@@ -0,0 +1,86 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <ostream>
+
+namespace
+{
+    // Nearest-rank percentile of sorted, which is not empty.
+    float Percentile(const std::vector<float>& sorted, const float percent)
+    {
+        const auto rank = static_cast<std::size_t>(std::ceil(percent / 100.0f * sorted.size()));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+}
+
+FrameStats::FrameStats(const std::size_t capacity)
+    : mFrameMs(capacity, 0.0f)
+{
+    assert(capacity > 0);
+}
+
+void FrameStats::Clear()
+{
+    mTotalFrames = 0;
+}
+
+void FrameStats::AddFrame(const float seconds)
+{
+    mFrameMs[mTotalFrames % mFrameMs.size()] = seconds * 1000.0f;
+    ++mTotalFrames;
+}
+
+std::size_t FrameStats::FrameCount()const
+{
+    return static_cast<std::size_t>(std::min<std::uint64_t>(mTotalFrames, mFrameMs.size()));
+}
+
+FrameStats::Summary FrameStats::Summarize()const
+{
+    Summary summary;
+    summary.FrameCount = FrameCount();
+    if (summary.FrameCount == 0)
+        return summary;
+
+    // The remembered frames are the last FrameCount ones, so the first of them is
+    // frame number mTotalFrames - FrameCount.
+    const std::uint64_t firstFrame = mTotalFrames - summary.FrameCount;
+
+    double totalMs = 0.0;
+    std::vector<float> sorted;
+    sorted.reserve(summary.FrameCount);
+    for (std::uint64_t frame = firstFrame; frame < mTotalFrames; ++frame)
+    {
+        const float ms = mFrameMs[frame % mFrameMs.size()];
+        if (sorted.empty() || ms > summary.MaxMs)
+        {
+            summary.MaxMs = ms;
+            summary.WorstFrame = frame;
+        }
+        totalMs += ms;
+        sorted.push_back(ms);
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+
+    summary.MinMs = sorted.front();
+    summary.AvgMs = static_cast<float>(totalMs / summary.FrameCount);
+    summary.P50Ms = Percentile(sorted, 50.0f);
+    summary.P95Ms = Percentile(sorted, 95.0f);
+    summary.P99Ms = Percentile(sorted, 99.0f);
+    return summary;
+}
+
+void FrameStats::WriteCsv(std::ostream& out)const
+{
+    out << "frame,ms\n";
+    for (std::uint64_t frame = mTotalFrames - FrameCount(); frame < mTotalFrames; ++frame)
+    {
+        out << frame << ',' << mFrameMs[frame % mFrameMs.size()] << '\n';
+    }
+}
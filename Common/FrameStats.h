@@ -0,0 +1,57 @@
+//***************************************************************************************
+// FrameStats.h
+//
+// Keeps the durations of the most recent frames in a ring buffer and summarizes
+// them with percentiles and the worst frame as well as the mean.  A stutter every
+// few hundred frames barely moves the average but shows up in p99 and the maximum.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+class FrameStats final
+{
+public:
+    struct Summary final
+    {
+        // Frames the summary covers, at most the capacity.
+        std::size_t FrameCount = 0;
+
+        float MinMs = 0.0f;
+        float AvgMs = 0.0f;
+        float P50Ms = 0.0f;
+        float P95Ms = 0.0f;
+        float P99Ms = 0.0f;
+        float MaxMs = 0.0f;
+
+        // Number of the slowest frame, counted from the first frame ever added.
+        std::uint64_t WorstFrame = 0;
+    };
+
+    // Remembers the last capacity frames.
+    explicit FrameStats(std::size_t capacity = 1024);
+
+    void Clear();
+
+    void AddFrame(float seconds);
+
+    std::size_t Capacity()const { return mFrameMs.size(); }
+    std::size_t FrameCount()const;
+
+    // Frames added since construction or the last Clear, including those that no
+    // longer fit in the buffer.
+    std::uint64_t TotalFrames()const { return mTotalFrames; }
+
+    Summary Summarize()const;
+
+    // Writes "frame,ms" and one line per remembered frame, oldest first.
+    void WriteCsv(std::ostream& out)const;
+
+private:
+    std::vector<float> mFrameMs;
+    std::uint64_t mTotalFrames = 0;
+};
@@ -0,0 +1,193 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr std::size_t kLanes = 4;
+
+    constexpr std::size_t PaddedCount(const std::size_t count)
+    {
+        return (count + kLanes - 1) / kLanes * kLanes;
+    }
+
+    XMVECTOR LoadLanes(const std::vector<float>& values, const std::size_t first)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[first]));
+    }
+}
+
+void FrustumCuller::Clear()
+{
+    Resize(0);
+}
+
+void FrustumCuller::Reserve(const std::size_t count)
+{
+    const std::size_t padded = PaddedCount(count);
+    for (std::vector<float>* values : { &mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ, &mRadius })
+    {
+        values->reserve(padded);
+    }
+}
+
+std::uint32_t FrustumCuller::Add(const BoundingBox& worldBox)
+{
+    const auto index = static_cast<std::uint32_t>(mCount);
+    Resize(mCount + 1);
+    Set(index, worldBox);
+    return index;
+}
+
+std::uint32_t FrustumCuller::Add(const BoundingSphere& worldSphere)
+{
+    const auto index = static_cast<std::uint32_t>(mCount);
+    Resize(mCount + 1);
+    Set(index, worldSphere);
+    return index;
+}
+
+void FrustumCuller::Set(const std::uint32_t index, const BoundingBox& worldBox)
+{
+    Store(index, worldBox.Center, worldBox.Extents, 0.0f);
+}
+
+void FrustumCuller::Set(const std::uint32_t index, const BoundingSphere& worldSphere)
+{
+    Store(index, worldSphere.Center, XMFLOAT3(0.0f, 0.0f, 0.0f), worldSphere.Radius);
+}
+
+void FrustumCuller::Store(
+    const std::uint32_t index,
+    const XMFLOAT3& center,
+    const XMFLOAT3& extents,
+    const float radius)
+{
+    assert(index < mCount);
+
+    mCenterX[index] = center.x;
+    mCenterY[index] = center.y;
+    mCenterZ[index] = center.z;
+    mExtentX[index] = extents.x;
+    mExtentY[index] = extents.y;
+    mExtentZ[index] = extents.z;
+    mRadius[index] = radius;
+}
+
+void FrustumCuller::Resize(const std::size_t count)
+{
+    const std::size_t padded = PaddedCount(count);
+    for (std::vector<float>* values : { &mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ, &mRadius })
+    {
+        values->resize(padded, 0.0f);
+    }
+    mCount = count;
+}
+
+void FrustumCuller::ExtractPlanes(FXMMATRIX viewProj, XMFLOAT4 planes[6])
+{
+    // Rows of the transpose are the columns of viewProj, so row i dotted with a
+    // world-space point gives that point's clip-space coordinate i.  A point is inside
+    // when -w <= x <= w, -w <= y <= w and 0 <= z <= w.
+    const XMMATRIX m = XMMatrixTranspose(viewProj);
+
+    const XMVECTOR clipPlanes[6] =
+    {
+        XMVectorAdd(m.r[3], m.r[0]),      // left
+        XMVectorSubtract(m.r[3], m.r[0]), // right
+        XMVectorAdd(m.r[3], m.r[1]),      // bottom
+        XMVectorSubtract(m.r[3], m.r[1]), // top
+        m.r[2],                           // near
+        XMVectorSubtract(m.r[3], m.r[2])  // far
+    };
+
+    for (int i = 0; i < 6; ++i)
+    {
+        XMStoreFloat4(&planes[i], XMPlaneNormalize(clipPlanes[i]));
+    }
+}
+
+void FrustumCuller::Cull(FXMMATRIX viewProj, std::vector<std::uint32_t>& visible)const
+{
+    Cull(viewProj, 0, mCount, visible);
+}
+
+void FrustumCuller::Cull(
+    FXMMATRIX viewProj,
+    const std::size_t first,
+    const std::size_t last,
+    std::vector<std::uint32_t>& visible)const
+{
+    assert(first % kLanes == 0);
+    assert(first <= last && last <= mCount);
+
+    XMFLOAT4 planes[6];
+    ExtractPlanes(viewProj, planes);
+
+    // Plane components and their absolute values, replicated across the lanes.
+    struct PlaneLanes final
+    {
+        XMVECTOR X, Y, Z, W;
+        XMVECTOR AbsX, AbsY, AbsZ;
+    };
+
+    PlaneLanes lanes[6];
+    for (int i = 0; i < 6; ++i)
+    {
+        lanes[i].X = XMVectorReplicate(planes[i].x);
+        lanes[i].Y = XMVectorReplicate(planes[i].y);
+        lanes[i].Z = XMVectorReplicate(planes[i].z);
+        lanes[i].W = XMVectorReplicate(planes[i].w);
+        lanes[i].AbsX = XMVectorReplicate(std::abs(planes[i].x));
+        lanes[i].AbsY = XMVectorReplicate(std::abs(planes[i].y));
+        lanes[i].AbsZ = XMVectorReplicate(std::abs(planes[i].z));
+    }
+
+    const XMVECTOR zero = XMVectorZero();
+
+    for (std::size_t group = first; group < last; group += kLanes)
+    {
+        const XMVECTOR cx = LoadLanes(mCenterX, group);
+        const XMVECTOR cy = LoadLanes(mCenterY, group);
+        const XMVECTOR cz = LoadLanes(mCenterZ, group);
+        const XMVECTOR ex = LoadLanes(mExtentX, group);
+        const XMVECTOR ey = LoadLanes(mExtentY, group);
+        const XMVECTOR ez = LoadLanes(mExtentZ, group);
+        const XMVECTOR radius = LoadLanes(mRadius, group);
+
+        // A volume is outside when it lies entirely behind one plane: the signed
+        // distance of its center plus its reach along the plane normal is negative.
+        XMVECTOR inside = XMVectorTrueInt();
+        for (const PlaneLanes& plane : lanes)
+        {
+            XMVECTOR distance = XMVectorMultiplyAdd(plane.X, cx, plane.W);
+            distance = XMVectorMultiplyAdd(plane.Y, cy, distance);
+            distance = XMVectorMultiplyAdd(plane.Z, cz, distance);
+
+            XMVECTOR reach = XMVectorMultiplyAdd(plane.AbsX, ex, radius);
+            reach = XMVectorMultiplyAdd(plane.AbsY, ey, reach);
+            reach = XMVectorMultiplyAdd(plane.AbsZ, ez, reach);
+
+            inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorAdd(distance, reach), zero));
+        }
+
+        std::uint32_t mask[kLanes];
+        XMStoreInt4(mask, inside);
+
+        const std::size_t laneCount = std::min(kLanes, last - group);
+        for (std::size_t lane = 0; lane < laneCount; ++lane)
+        {
+            if (mask[lane] != 0)
+            {
+                visible.push_back(static_cast<std::uint32_t>(group + lane));
+            }
+        }
+    }
+}
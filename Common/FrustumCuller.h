@@ -0,0 +1,65 @@
+//***************************************************************************************
+// FrustumCuller.h
+//
+// World-space bounding volumes kept in structure-of-arrays form and culled against
+// the six camera frustum planes four at a time.  Storing the bounds in world space
+// means the per-frame work is only the plane tests: nothing is inverted or
+// transformed per object.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+#include <cstdint>
+#include <vector>
+
+class FrustumCuller final
+{
+public:
+    void Clear();
+    void Reserve(std::size_t count);
+
+    std::size_t Size()const { return mCount; }
+
+    // Adds world-space bounds and returns their index.  Indices are assigned in order.
+    std::uint32_t Add(const DirectX::BoundingBox& worldBox);
+    std::uint32_t Add(const DirectX::BoundingSphere& worldSphere);
+
+    // Replaces the bounds at index, e.g. after the object moved.
+    void Set(std::uint32_t index, const DirectX::BoundingBox& worldBox);
+    void Set(std::uint32_t index, const DirectX::BoundingSphere& worldSphere);
+
+    // Appends to visible, in ascending order, the index of every volume that is at
+    // least partly inside the frustum of viewProj (world space to D3D clip space).
+    void Cull(DirectX::FXMMATRIX viewProj, std::vector<std::uint32_t>& visible)const;
+
+    // Same, for the volumes in [first, last) only, so a large set can be culled in
+    // chunks on several threads.  first must be a multiple of four.
+    void Cull(
+        DirectX::FXMMATRIX viewProj,
+        std::size_t first,
+        std::size_t last,
+        std::vector<std::uint32_t>& visible)const;
+
+    // Normalized world-space planes of viewProj's frustum, pointing inwards, in the
+    // order left, right, bottom, top, near, far.
+    static void ExtractPlanes(DirectX::FXMMATRIX viewProj, DirectX::XMFLOAT4 planes[6]);
+
+private:
+    void Resize(std::size_t count);
+    void Store(std::uint32_t index, const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents, float radius);
+
+    std::size_t mCount = 0;
+
+    // Boxes have Radius 0 and spheres have zero Extents, so both go through one test.
+    // The arrays are padded to a multiple of four so the last group can be loaded whole.
+    std::vector<float> mCenterX;
+    std::vector<float> mCenterY;
+    std::vector<float> mCenterZ;
+    std::vector<float> mExtentX;
+    std::vector<float> mExtentY;
+    std::vector<float> mExtentZ;
+    std::vector<float> mRadius;
+};
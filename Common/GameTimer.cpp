@@ -3,14 +3,19 @@
 
 #include "GameTimer.h"
 
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
+namespace
+{
+	double Seconds(const std::chrono::steady_clock::duration d)
+	{
+		return std::chrono::duration<double>(d).count();
+	}
+}
 
 GameTimer::GameTimer()
 {
-	LARGE_INTEGER countsPerSec;
-	QueryPerformanceFrequency(&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec.QuadPart;
+	mBaseTime = Clock::now();
+	mPrevTime = mBaseTime;
+	mCurrTime = mBaseTime;
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
@@ -28,7 +33,7 @@ float GameTimer::TotalTime()const
 
 	if( mStopped )
 	{
-		return (float)(((mStopTime - mPausedTime)-mBaseTime)*mSecondsPerCount);
+		return (float)Seconds((mStopTime - mPausedTime)-mBaseTime);
 	}
 
 	// The distance mCurrTime - mBaseTime includes paused time,
@@ -43,7 +48,7 @@ float GameTimer::TotalTime()const
 	
 	else
 	{
-		return (float)(((mCurrTime-mPausedTime)-mBaseTime)*mSecondsPerCount);
+		return (float)Seconds((mCurrTime-mPausedTime)-mBaseTime);
 	}
 }
 
@@ -54,12 +59,13 @@ float GameTimer::DeltaTime()const
 
 void GameTimer::Reset()
 {
-	LARGE_INTEGER currTime;
-	QueryPerformanceCounter(&currTime);
+	const Clock::time_point currTime = Clock::now();
 
-	mBaseTime = currTime.QuadPart;
-	mPrevTime = currTime.QuadPart;
-	mStopTime = 0;
+	mBaseTime = currTime;
+	mPrevTime = currTime;
+	mCurrTime = currTime;
+	mPausedTime = Clock::duration::zero();
+	mStopTime = {};
 	mStopped  = false;
 }
 
@@ -73,12 +79,11 @@ void GameTimer::Start()
 
 	if( mStopped )
 	{
-		LARGE_INTEGER startTime;
-		QueryPerformanceCounter(&startTime);
-		mPausedTime += (startTime.QuadPart - mStopTime);	
+		const Clock::time_point startTime = Clock::now();
+		mPausedTime += (startTime - mStopTime);
 
-		mPrevTime = startTime.QuadPart;
-		mStopTime = 0;
+		mPrevTime = startTime;
+		mStopTime = {};
 		mStopped  = false;
 	}
 }
@@ -87,10 +92,7 @@ void GameTimer::Stop()
 {
 	if( !mStopped )
 	{
-		LARGE_INTEGER currTime;
-		QueryPerformanceCounter(&currTime);
-
-		mStopTime = currTime.QuadPart;
+		mStopTime = Clock::now();
 		mStopped  = true;
 	}
 }
@@ -103,19 +105,17 @@ void GameTimer::Tick()
 		return;
 	}
 
-	LARGE_INTEGER currTime;
-	QueryPerformanceCounter(&currTime);
-	mCurrTime = currTime.QuadPart;
+	mCurrTime = Clock::now();
 
 	// Time difference between this frame and the previous.
-	mDeltaTime = (mCurrTime - mPrevTime)*mSecondsPerCount;
+	mDeltaTime = Seconds(mCurrTime - mPrevTime);
 
 	// Prepare for next frame.
 	mPrevTime = mCurrTime;
 
-	// Force nonnegative.  The DXSDK's CDXUTTimer mentions that if the 
-	// processor goes into a power save mode or we get shuffled to another
-	// processor, then mDeltaTime can be negative.
+	// Force nonnegative.  steady_clock never goes backwards, but the DXSDK's
+	// CDXUTTimer mentions that raw performance counters can when the processor
+	// goes into a power save mode or we get shuffled to another processor.
 	if(mDeltaTime < 0.0)
 	{
 		mDeltaTime = 0.0;
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <chrono>
+
+// Uses std::chrono::steady_clock, which is monotonic and, on Windows, backed by
+// QueryPerformanceCounter.
 class GameTimer final
 {
 public:
@@ -18,14 +22,15 @@ public:
 	void Tick();  // Call every frame.
 
 private:
-	double mSecondsPerCount = 0.0;
+	using Clock = std::chrono::steady_clock;
+
 	double mDeltaTime = -1.0;
 
-	__int64 mBaseTime = 0;
-	__int64 mPausedTime = 0;
-	__int64 mStopTime = 0;
-	__int64 mPrevTime = 0;
-	__int64 mCurrTime = 0;
+	Clock::time_point mBaseTime;
+	Clock::duration mPausedTime = Clock::duration::zero();
+	Clock::time_point mStopTime;
+	Clock::time_point mPrevTime;
+	Clock::time_point mCurrTime;
 
 	bool mStopped = false;
 };
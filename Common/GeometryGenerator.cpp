@@ -4,6 +4,11 @@
 
 #include "GeometryGenerator.h"
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
 
 using namespace DirectX;
 using GeometryGenerator::MeshData;
@@ -43,14 +48,31 @@ namespace
         return v;
     }
 
-    void Subdivide(MeshData& meshData)
+    // Key of the edge (a, b), independent of the direction the edge is traversed.
+    constexpr std::uint64_t EdgeKey(std::uint32_t a, std::uint32_t b)
     {
-        const std::vector<Vertex> verticesCopy = meshData.Vertices;
-        const std::vector<std::uint32_t> indicesCopy = meshData.Indices32;
-
-        meshData.Vertices.clear();
-        meshData.Indices32.clear();
+        return a < b ?
+            (std::uint64_t(a) << 32) | b :
+            (std::uint64_t(b) << 32) | a;
+    }
 
+    // Deepest subdivision the generators perform.  Welding makes a level cheaper, but
+    // each one still quadruples the triangles: level 8 of the geosphere already has
+    // 1.3M triangles and 655K vertices (29 MB), so deeper requests are clamped rather
+    // than left to exhaust memory.  It also keeps the indices well within 32 bits.
+    constexpr std::uint32_t MaxSubdivisions = 8;
+
+    // Splits every triangle of the index list into four.  The existing vertices keep
+    // their indices and every edge midpoint is created once by appendMidpoint(a, b),
+    // which must append the midpoint of vertices a and b to the vertex storage.
+    // Triangles sharing an edge look its midpoint up in the edge table, so the result
+    // stays welded: a closed mesh with T triangles gains exactly 3T/2 vertices.
+    template <typename AppendMidpoint>
+    void SubdivideIndices(
+        std::vector<std::uint32_t>& indices,
+        std::uint32_t vertexCount,
+        AppendMidpoint&& appendMidpoint)
+    {
         //       v1
         //       *
         //      / \
@@ -61,50 +83,214 @@ namespace
 		// *-----*-----*
         // v0    m2     v2
 
+        const std::vector<std::uint32_t> indicesCopy = std::move(indices);
+        indices.clear();
+
         const std::uint32_t numTris = std::uint32_t(indicesCopy.size() / 3);
-        meshData.Vertices.reserve(6ull * numTris); 
-        meshData.Indices32.reserve(12ull * numTris);
+        indices.reserve(12ull * numTris);
+
+        std::unordered_map<std::uint64_t, std::uint32_t> midpoints;
+        midpoints.reserve(3ull * numTris / 2 + 3);
+
+        const auto getMidpoint = [&](std::uint32_t a, std::uint32_t b)
+        {
+            const auto [it, inserted] = midpoints.try_emplace(EdgeKey(a, b), vertexCount);
+            if (inserted)
+            {
+                appendMidpoint(a, b);
+                ++vertexCount;
+            }
+
+            return it->second;
+        };
 
         for (std::uint32_t i = 0; i < numTris; ++i)
         {
-            const Vertex v0 = verticesCopy[indicesCopy[i * 3 + 0]];
-            const Vertex v1 = verticesCopy[indicesCopy[i * 3 + 1]];
-            const Vertex v2 = verticesCopy[indicesCopy[i * 3 + 2]];
+            const std::uint32_t v0 = indicesCopy[i * 3 + 0];
+            const std::uint32_t v1 = indicesCopy[i * 3 + 1];
+            const std::uint32_t v2 = indicesCopy[i * 3 + 2];
 
             //
-            // Generate the midpoints.
+            // Look up or generate the midpoints.
             //
 
-            const Vertex m0 = MidPoint(v0, v1);
-            const Vertex m1 = MidPoint(v1, v2);
-            const Vertex m2 = MidPoint(v0, v2);
+            const std::uint32_t m0 = getMidpoint(v0, v1);
+            const std::uint32_t m1 = getMidpoint(v1, v2);
+            const std::uint32_t m2 = getMidpoint(v0, v2);
 
             //
             // Add new geometry.
             //
 
-            meshData.Vertices.push_back(v0); // 0
-            meshData.Vertices.push_back(v1); // 1
-            meshData.Vertices.push_back(v2); // 2
-            meshData.Vertices.push_back(m0); // 3
-            meshData.Vertices.push_back(m1); // 4
-            meshData.Vertices.push_back(m2); // 5
+            indices.push_back(v0);
+            indices.push_back(m0);
+            indices.push_back(m2);
+
+            indices.push_back(m0);
+            indices.push_back(m1);
+            indices.push_back(m2);
+
+            indices.push_back(m2);
+            indices.push_back(m1);
+            indices.push_back(v2);
+
+            indices.push_back(m0);
+            indices.push_back(v1);
+            indices.push_back(m1);
+        }
+    }
+
+    void Subdivide(MeshData& meshData)
+    {
+        const std::size_t numTris = meshData.Indices32.size() / 3;
+        meshData.Vertices.reserve(meshData.Vertices.size() + 3 * numTris / 2 + 3);
+
+        SubdivideIndices(
+            meshData.Indices32,
+            std::uint32_t(meshData.Vertices.size()),
+            [&meshData](std::uint32_t a, std::uint32_t b)
+            {
+                // Evaluate before push_back; it may reallocate the vertices.
+                const Vertex m = MidPoint(meshData.Vertices[a], meshData.Vertices[b]);
+                meshData.Vertices.push_back(m);
+            });
+    }
+
+    //
+    // Index builders shared by the MeshData and MeshDataSoA generators.
+    //
+
+    void AppendSphereIndices(
+        std::uint32_t sliceCount,
+        std::uint32_t stackCount,
+        std::vector<std::uint32_t>& indices)
+    {
+        //
+        // Compute indices for top stack.  The top stack was written first to the vertex buffer
+        // and connects the top pole to the first ring.
+        //
+
+        indices.reserve(indices.size() + (sliceCount + 1ull) * 3);
+        for (std::uint32_t i = 1; i <= sliceCount; ++i)
+        {
+            indices.push_back(0);
+            indices.push_back(i + 1);
+            indices.push_back(i);
+        }
+
+        //
+        // Compute indices for inner stacks (not connected to poles).
+        //
+
+        // Offset the indices to the index of the first vertex in the first ring.
+        // This is just skipping the top pole vertex.
+        std::uint32_t baseIndex = 1;
+        std::uint32_t ringVertexCount = sliceCount + 1;
+        indices.reserve(indices.size() + ((stackCount - 2ull) * sliceCount * 6ull));
+
+        for (std::uint32_t i = 0; i < stackCount - 2; ++i)
+        {
+            for (std::uint32_t j = 0; j < sliceCount; ++j)
+            {
+                indices.push_back(baseIndex + i * ringVertexCount + j);
+                indices.push_back(baseIndex + i * ringVertexCount + j + 1);
+                indices.push_back(baseIndex + (i + 1) * ringVertexCount + j);
+
+                indices.push_back(baseIndex + (i + 1) * ringVertexCount + j);
+                indices.push_back(baseIndex + i * ringVertexCount + j + 1);
+                indices.push_back(baseIndex + (i + 1) * ringVertexCount + j + 1);
+            }
+        }
+
+        //
+        // Compute indices for bottom stack.  The bottom stack was written last to the vertex buffer
+        // and connects the bottom pole to the bottom ring.
+        //
+
+        // South pole vertex was added last.
+        std::uint32_t southPoleIndex = 1 + (stackCount - 1) * ringVertexCount;
+
+        // Offset the indices to the index of the first vertex in the last ring.
+        baseIndex = southPoleIndex - ringVertexCount;
 
-            meshData.Indices32.push_back(i * 6 + 0);
-            meshData.Indices32.push_back(i * 6 + 3);
-            meshData.Indices32.push_back(i * 6 + 5);
+        indices.reserve(indices.size() + sliceCount * 3ull);
+        for (std::uint32_t i = 0; i < sliceCount; ++i)
+        {
+            indices.push_back(southPoleIndex);
+            indices.push_back(baseIndex + i);
+            indices.push_back(baseIndex + i + 1);
+        }
+    }
+
+    void AppendCylinderIndices(
+        std::uint32_t sliceCount,
+        std::uint32_t stackCount,
+        std::vector<std::uint32_t>& indices)
+    {
+        // Add one because we duplicate the first and last vertex per ring
+        // since the texture coordinates are different.
+        std::uint32_t ringVertexCount = sliceCount + 1;
+
+        // Compute indices for each stack.
+        indices.reserve(indices.size() + sliceCount * 6ull * stackCount);
+        for (std::uint32_t i = 0; i < stackCount; ++i)
+        {
+            for (std::uint32_t j = 0; j < sliceCount; ++j)
+            {
+                indices.push_back(i * ringVertexCount + j);
+                indices.push_back((i + 1) * ringVertexCount + j);
+                indices.push_back((i + 1) * ringVertexCount + j + 1);
+
+                indices.push_back(i * ringVertexCount + j);
+                indices.push_back((i + 1) * ringVertexCount + j + 1);
+                indices.push_back(i * ringVertexCount + j + 1);
+            }
+        }
+    }
 
-            meshData.Indices32.push_back(i * 6 + 3);
-            meshData.Indices32.push_back(i * 6 + 4);
-            meshData.Indices32.push_back(i * 6 + 5);
+    // The cap is a ring of sliceCount + 1 vertices starting at baseIndex followed by
+    // the center vertex.  The top cap faces +y, the bottom cap faces -y.
+    void AppendCylinderCapIndices(
+        std::uint32_t baseIndex,
+        std::uint32_t sliceCount,
+        bool topCap,
+        std::vector<std::uint32_t>& indices)
+    {
+        const std::uint32_t centerIndex = baseIndex + sliceCount + 1;
+        indices.reserve(indices.size() + sliceCount * 3ull);
+        for (std::uint32_t i = 0; i < sliceCount; ++i)
+        {
+            indices.push_back(centerIndex);
+            indices.push_back(topCap ? baseIndex + i + 1 : baseIndex + i);
+            indices.push_back(topCap ? baseIndex + i : baseIndex + i + 1);
+        }
+    }
 
-            meshData.Indices32.push_back(i * 6 + 5);
-            meshData.Indices32.push_back(i * 6 + 4);
-            meshData.Indices32.push_back(i * 6 + 2);
+    void AppendGridIndices(
+        std::uint32_t m,
+        std::uint32_t n,
+        std::vector<std::uint32_t>& indices)
+    {
+        const std::size_t first = indices.size();
+        const std::uint32_t faceCount = (m - 1) * (n - 1) * 2;
+        indices.resize(first + faceCount * 3ull); // 3 indices per face
 
-            meshData.Indices32.push_back(i * 6 + 3);
-            meshData.Indices32.push_back(i * 6 + 1);
-            meshData.Indices32.push_back(i * 6 + 4);
+        // Iterate over each quad and compute indices.
+        std::size_t k = first;
+        for (std::uint32_t i = 0; i < m - 1; ++i)
+        {
+            for (std::uint32_t j = 0; j < n - 1; ++j)
+            {
+                indices[k] = i * n + j;
+                indices[k + 1] = i * n + j + 1;
+                indices[k + 2] = (i + 1) * n + j;
+
+                indices[k + 3] = (i + 1) * n + j;
+                indices[k + 4] = i * n + j + 1;
+                indices[k + 5] = (i + 1) * n + j + 1;
+
+                k += 6; // next quad
+            }
         }
     }
 
@@ -123,7 +309,7 @@ namespace
 
         // Duplicate cap ring vertices because the texture coordinates and normals differ.
 
-        meshData.Vertices.resize(meshData.Vertices.size() + sliceCount + 2);
+        meshData.Vertices.reserve(meshData.Vertices.size() + sliceCount + 2);
         for (std::uint32_t i = 0; i <= sliceCount; ++i)
         {
             float x = topRadius * cosf(i * dTheta);
@@ -140,15 +326,7 @@ namespace
         // Cap center vertex.
         meshData.Vertices.push_back(Vertex(0.0f, y, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
 
-        // Index of center vertex.
-        std::uint32_t centerIndex = (std::uint32_t)meshData.Vertices.size() - 1;
-        meshData.Indices32.reserve(meshData.Indices32.size() + sliceCount * 3ull);
-        for (std::uint32_t i = 0; i < sliceCount; ++i)
-        {
-            meshData.Indices32.push_back(centerIndex);
-            meshData.Indices32.push_back(baseIndex + i + 1);
-            meshData.Indices32.push_back(baseIndex + i);
-        }
+        AppendCylinderCapIndices(baseIndex, sliceCount, true, meshData.Indices32);
     }
 
     void BuildCylinderBottomCap(
@@ -185,15 +363,7 @@ namespace
         // Cap center vertex.
         meshData.Vertices.push_back(Vertex(0.0f, y, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
 
-        // Cache the index of center vertex.
-        std::uint32_t centerIndex = (std::uint32_t)meshData.Vertices.size() - 1;
-        meshData.Indices32.reserve(meshData.Indices32.size() + sliceCount * 3ull);
-        for (std::uint32_t i = 0; i < sliceCount; ++i)
-        {
-            meshData.Indices32.push_back(centerIndex);
-            meshData.Indices32.push_back(baseIndex + i);
-            meshData.Indices32.push_back(baseIndex + i + 1);
-        }
+        AppendCylinderCapIndices(baseIndex, sliceCount, false, meshData.Indices32);
     }
 }
 
@@ -288,7 +458,7 @@ GeometryGenerator::MeshData GeometryGenerator::CreateBox(
     meshData.Indices32.assign(&i[0], &i[36]);
 
     // Put a cap on the number of subdivisions.
-    numSubdivisions = std::min<std::uint32_t>(numSubdivisions, 6u);
+    numSubdivisions = std::min(numSubdivisions, MaxSubdivisions);
 
     for (std::uint32_t x = 0; x < numSubdivisions; ++x)
     {
@@ -358,62 +528,7 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(
 
     meshData.Vertices.push_back(bottomVertex);
 
-    //
-    // Compute indices for top stack.  The top stack was written first to the vertex buffer
-    // and connects the top pole to the first ring.
-    //
-
-    meshData.Indices32.reserve((sliceCount + 1ull) * 3);
-    for (std::uint32_t i = 1; i <= sliceCount; ++i)
-    {
-        meshData.Indices32.push_back(0);
-        meshData.Indices32.push_back(i + 1);
-        meshData.Indices32.push_back(i);
-    }
-
-    //
-    // Compute indices for inner stacks (not connected to poles).
-    //
-
-    // Offset the indices to the index of the first vertex in the first ring.
-    // This is just skipping the top pole vertex.
-    std::uint32_t baseIndex = 1;
-    std::uint32_t ringVertexCount = sliceCount + 1;
-    meshData.Indices32.reserve(
-        meshData.Indices32.size() + ((stackCount - 2ull) * sliceCount * 6ull));
-    
-    for (std::uint32_t i = 0; i < stackCount - 2; ++i)
-    {
-        for (std::uint32_t j = 0; j < sliceCount; ++j)
-        {
-            meshData.Indices32.push_back(baseIndex + i * ringVertexCount + j);
-            meshData.Indices32.push_back(baseIndex + i * ringVertexCount + j + 1);
-            meshData.Indices32.push_back(baseIndex + (i + 1) * ringVertexCount + j);
-
-            meshData.Indices32.push_back(baseIndex + (i + 1) * ringVertexCount + j);
-            meshData.Indices32.push_back(baseIndex + i * ringVertexCount + j + 1);
-            meshData.Indices32.push_back(baseIndex + (i + 1) * ringVertexCount + j + 1);
-        }
-    }
-
-    //
-    // Compute indices for bottom stack.  The bottom stack was written last to the vertex buffer
-    // and connects the bottom pole to the bottom ring.
-    //
-
-    // South pole vertex was added last.
-    std::uint32_t southPoleIndex = (std::uint32_t)meshData.Vertices.size() - 1;
-
-    // Offset the indices to the index of the first vertex in the last ring.
-    baseIndex = southPoleIndex - ringVertexCount;
-
-    meshData.Indices32.reserve(meshData.Indices32.size() + sliceCount * 3ull);
-    for (std::uint32_t i = 0; i < sliceCount; ++i)
-    {
-        meshData.Indices32.push_back(southPoleIndex);
-        meshData.Indices32.push_back(baseIndex + i);
-        meshData.Indices32.push_back(baseIndex + i + 1);
-    }
+    AppendSphereIndices(sliceCount, stackCount, meshData.Indices32);
 
     return meshData;
 }
@@ -426,7 +541,7 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(
     MeshData meshData;
 
     // Put a cap on the number of subdivisions.
-    numSubdivisions = std::min<std::uint32_t>(numSubdivisions, 6u);
+    numSubdivisions = std::min(numSubdivisions, MaxSubdivisions);
 
     // Approximate a sphere by tessellating an icosahedron.
 
@@ -571,25 +686,7 @@ GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(
         }
     }
 
-    // Add one because we duplicate the first and last vertex per ring
-    // since the texture coordinates are different.
-    std::uint32_t ringVertexCount = sliceCount + 1;
-
-    // Compute indices for each stack.
-    meshData.Indices32.reserve(sliceCount * 6ull * stackCount);
-    for (std::uint32_t i = 0; i < stackCount; ++i)
-    {
-        for (std::uint32_t j = 0; j < sliceCount; ++j)
-        {
-            meshData.Indices32.push_back(i * ringVertexCount + j);
-            meshData.Indices32.push_back((i + 1) * ringVertexCount + j);
-            meshData.Indices32.push_back((i + 1) * ringVertexCount + j + 1);
-
-            meshData.Indices32.push_back(i * ringVertexCount + j);
-            meshData.Indices32.push_back((i + 1) * ringVertexCount + j + 1);
-            meshData.Indices32.push_back(i * ringVertexCount + j + 1);
-        }
-    }
+    AppendCylinderIndices(sliceCount, stackCount, meshData.Indices32);
 
     BuildCylinderTopCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
     BuildCylinderBottomCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
@@ -606,7 +703,6 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGrid(
     MeshData meshData;
 
     std::uint32_t vertexCount = m * n;
-    std::uint32_t faceCount = (m - 1) * (n - 1) * 2;
 
     //
     // Create the vertices.
@@ -643,25 +739,7 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGrid(
     // Create the indices.
     //
 
-    meshData.Indices32.resize(faceCount * 3ull); // 3 indices per face
-
-    // Iterate over each quad and compute indices.
-    std::uint32_t k = 0;
-    for (std::uint32_t i = 0; i < m - 1; ++i)
-    {
-        for (std::uint32_t j = 0; j < n - 1; ++j)
-        {
-            meshData.Indices32[k] = i * n + j;
-            meshData.Indices32[k + 1] = i * n + j + 1;
-            meshData.Indices32[k + 2] = (i + 1) * n + j;
-
-            meshData.Indices32[k + 3] = (i + 1) * n + j;
-            meshData.Indices32[k + 4] = i * n + j + 1;
-            meshData.Indices32[k + 5] = (i + 1) * n + j + 1;
-
-            k += 6; // next quad
-        }
-    }
+    AppendGridIndices(m, n, meshData.Indices32);
 
     return meshData;
 }
@@ -713,3 +791,603 @@ GeometryGenerator::MeshData GeometryGenerator::CreateQuad(
 
     return meshData;
 }
+
+//
+// Struct-of-arrays generators.
+//
+
+namespace
+{
+    using GeometryGenerator::Float2Stream;
+    using GeometryGenerator::Float3Stream;
+    using GeometryGenerator::MeshDataSoA;
+
+    // Number of vertices evaluated per DirectXMath vector.
+    constexpr std::size_t kLanes = 4;
+
+    // Lane offsets (0, 1, 2, 3) added to the index of the first vertex of a batch.
+    const XMVECTORF32 kLaneOffsets = { { { 0.0f, 1.0f, 2.0f, 3.0f } } };
+
+    // Loads count (<= 4) consecutive floats; the missing lanes are zero.
+    XMVECTOR XM_CALLCONV LoadLanes(const float* src, std::size_t count)
+    {
+        if (count == kLanes)
+            return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(src));
+
+        float tmp[kLanes] = {};
+        std::memcpy(tmp, src, count * sizeof(float));
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(tmp));
+    }
+
+    // Stores the first count (<= 4) lanes of v.
+    void XM_CALLCONV StoreLanes(float* dst, FXMVECTOR v, std::size_t count)
+    {
+        if (count == kLanes)
+        {
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(dst), v);
+            return;
+        }
+
+        float tmp[kLanes];
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(tmp), v);
+        std::memcpy(dst, tmp, count * sizeof(float));
+    }
+
+    void XM_CALLCONV StoreLanes(
+        Float3Stream& stream, std::size_t i,
+        FXMVECTOR x, FXMVECTOR y, FXMVECTOR z,
+        std::size_t count)
+    {
+        StoreLanes(&stream.X[i], x, count);
+        StoreLanes(&stream.Y[i], y, count);
+        StoreLanes(&stream.Z[i], z, count);
+    }
+
+    void XM_CALLCONV StoreLanes(
+        Float2Stream& stream, std::size_t i,
+        FXMVECTOR x, FXMVECTOR y,
+        std::size_t count)
+    {
+        StoreLanes(&stream.X[i], x, count);
+        StoreLanes(&stream.Y[i], y, count);
+    }
+
+    // Returns (first, first + 1, first + 2, first + 3) as floats.
+    XMVECTOR XM_CALLCONV LaneIndices(std::size_t first)
+    {
+        return XMVectorAdd(XMVectorReplicate(float(first)), kLaneOffsets);
+    }
+
+    // Evaluates a ring of sliceCount + 1 vertices at height y with the given radius,
+    // starting at vertex base.  Shared by the cylinder stacks and caps, which differ
+    // only in their normals, tangents and texture coordinates.
+    template <typename Attributes>
+    void BuildRingSoA(
+        MeshDataSoA& meshData,
+        std::size_t base,
+        float radius,
+        float y,
+        std::uint32_t sliceCount,
+        Attributes&& attributes)
+    {
+        const std::size_t ringVertexCount = sliceCount + 1ull;
+        const XMVECTOR dTheta = XMVectorReplicate(XM_2PI / sliceCount);
+        const XMVECTOR r = XMVectorReplicate(radius);
+
+        std::fill_n(meshData.Positions.Y.begin() + base, ringVertexCount, y);
+
+        for (std::size_t j = 0; j < ringVertexCount; j += kLanes)
+        {
+            const std::size_t count = std::min(kLanes, ringVertexCount - j);
+            const XMVECTOR slice = LaneIndices(j);
+
+            XMVECTOR s;
+            XMVECTOR c;
+            XMVectorSinCos(&s, &c, XMVectorMultiply(slice, dTheta));
+
+            const XMVECTOR x = XMVectorMultiply(r, c);
+            const XMVECTOR z = XMVectorMultiply(r, s);
+            StoreLanes(&meshData.Positions.X[base + j], x, count);
+            StoreLanes(&meshData.Positions.Z[base + j], z, count);
+
+            attributes(base + j, count, slice, s, c, x, z);
+        }
+    }
+
+    void BuildCylinderCapSoA(
+        MeshDataSoA& meshData,
+        std::size_t base,
+        float radius,
+        float height,
+        std::uint32_t sliceCount,
+        bool topCap)
+    {
+        const std::size_t ringVertexCount = sliceCount + 1ull;
+        const float y = (topCap ? 0.5f : -0.5f) * height;
+        const float ny = topCap ? 1.0f : -1.0f;
+
+        // Scale down by the height to try and make top cap texture coord area
+        // proportional to base.
+        const XMVECTOR invHeight = XMVectorReplicate(1.0f / height);
+        const XMVECTOR half = XMVectorReplicate(0.5f);
+
+        BuildRingSoA(meshData, base, radius, y, sliceCount,
+            [&](std::size_t i, std::size_t count, FXMVECTOR, FXMVECTOR, FXMVECTOR, GXMVECTOR x, HXMVECTOR z)
+            {
+                StoreLanes(meshData.TexCs, i,
+                    XMVectorMultiplyAdd(x, invHeight, half),
+                    XMVectorMultiplyAdd(z, invHeight, half),
+                    count);
+            });
+
+        std::fill_n(meshData.Normals.X.begin() + base, ringVertexCount, 0.0f);
+        std::fill_n(meshData.Normals.Y.begin() + base, ringVertexCount, ny);
+        std::fill_n(meshData.Normals.Z.begin() + base, ringVertexCount, 0.0f);
+        std::fill_n(meshData.TangentUs.X.begin() + base, ringVertexCount, 1.0f);
+        std::fill_n(meshData.TangentUs.Y.begin() + base, ringVertexCount, 0.0f);
+        std::fill_n(meshData.TangentUs.Z.begin() + base, ringVertexCount, 0.0f);
+
+        // Cap center vertex.
+        meshData.SetVertex(base + ringVertexCount,
+            Vertex(0.0f, y, 0.0f, 0.0f, ny, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
+    }
+
+    void ResizeStream(Float3Stream& stream, std::size_t count)
+    {
+        stream.X.resize(count);
+        stream.Y.resize(count);
+        stream.Z.resize(count);
+    }
+
+    void ResizeStream(Float2Stream& stream, std::size_t count)
+    {
+        stream.X.resize(count);
+        stream.Y.resize(count);
+    }
+
+    // Row k holds the kth of the count (<= 4) vertices starting at first: (x, y, z, 0).
+    XMMATRIX TransposeLanes(const Float3Stream& stream, std::size_t first, std::size_t count)
+    {
+        XMMATRIX lanes;
+        lanes.r[0] = LoadLanes(&stream.X[first], count);
+        lanes.r[1] = LoadLanes(&stream.Y[first], count);
+        lanes.r[2] = LoadLanes(&stream.Z[first], count);
+        lanes.r[3] = XMVectorZero();
+        return XMMatrixTranspose(lanes);
+    }
+
+    // Stores the first count rows as T (XMFLOAT3 or XMFLOAT2), stride bytes apart.
+    template <typename T>
+    void StoreRows(std::byte* dst, std::size_t stride, const XMMATRIX& rows, std::size_t count)
+    {
+        for (std::size_t k = 0; k < count; ++k, dst += stride)
+        {
+            if constexpr (std::is_same_v<T, XMFLOAT3>)
+                XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(dst), rows.r[k]);
+            else
+                XMStoreFloat2(reinterpret_cast<XMFLOAT2*>(dst), rows.r[k]);
+        }
+    }
+}
+
+void GeometryGenerator::MeshDataSoA::ResizeVertices(std::size_t count)
+{
+    ResizeStream(Positions, count);
+    ResizeStream(Normals, count);
+    ResizeStream(TangentUs, count);
+    ResizeStream(TexCs, count);
+}
+
+void GeometryGenerator::MeshDataSoA::SetVertex(std::size_t i, const Vertex& v)
+{
+    Positions.X[i] = v.Position.x;
+    Positions.Y[i] = v.Position.y;
+    Positions.Z[i] = v.Position.z;
+    Normals.X[i] = v.Normal.x;
+    Normals.Y[i] = v.Normal.y;
+    Normals.Z[i] = v.Normal.z;
+    TangentUs.X[i] = v.TangentU.x;
+    TangentUs.Y[i] = v.TangentU.y;
+    TangentUs.Z[i] = v.TangentU.z;
+    TexCs.X[i] = v.TexC.x;
+    TexCs.Y[i] = v.TexC.y;
+}
+
+GeometryGenerator::Vertex GeometryGenerator::MeshDataSoA::GetVertex(std::size_t i)const
+{
+    return Vertex(
+        Positions.X[i], Positions.Y[i], Positions.Z[i],
+        Normals.X[i], Normals.Y[i], Normals.Z[i],
+        TangentUs.X[i], TangentUs.Y[i], TangentUs.Z[i],
+        TexCs.X[i], TexCs.Y[i]);
+}
+
+void GeometryGenerator::MeshDataSoA::Interleave(
+    std::span<std::byte> dst,
+    const VertexLayout& layout,
+    std::size_t firstVertex)const
+{
+    const std::size_t vertexCount = dst.size() / layout.Stride;
+    assert(firstVertex + vertexCount <= VertexCount());
+
+    const XMVECTOR zero = XMVectorZero();
+    std::byte* out = dst.data();
+
+    for (std::size_t i = 0; i < vertexCount; i += kLanes)
+    {
+        const std::size_t first = firstVertex + i;
+        const std::size_t count = std::min(kLanes, vertexCount - i);
+
+        if (layout.PositionOffset >= 0)
+        {
+            const XMMATRIX rows = TransposeLanes(Positions, first, count);
+            StoreRows<XMFLOAT3>(out + layout.PositionOffset, layout.Stride, rows, count);
+        }
+        if (layout.NormalOffset >= 0)
+        {
+            const XMMATRIX rows = TransposeLanes(Normals, first, count);
+            StoreRows<XMFLOAT3>(out + layout.NormalOffset, layout.Stride, rows, count);
+        }
+        if (layout.TangentUOffset >= 0)
+        {
+            const XMMATRIX rows = TransposeLanes(TangentUs, first, count);
+            StoreRows<XMFLOAT3>(out + layout.TangentUOffset, layout.Stride, rows, count);
+        }
+        if (layout.TexCOffset >= 0)
+        {
+            XMMATRIX lanes;
+            lanes.r[0] = LoadLanes(&TexCs.X[first], count);
+            lanes.r[1] = LoadLanes(&TexCs.Y[first], count);
+            lanes.r[2] = zero;
+            lanes.r[3] = zero;
+            StoreRows<XMFLOAT2>(out + layout.TexCOffset, layout.Stride, XMMatrixTranspose(lanes), count);
+        }
+
+        out += kLanes * layout.Stride;
+    }
+}
+
+GeometryGenerator::MeshData GeometryGenerator::MeshDataSoA::ToMeshData()const
+{
+    MeshData meshData;
+    meshData.Vertices.resize(VertexCount());
+    Interleave(std::span<Vertex>(meshData.Vertices));
+    meshData.Indices32 = Indices32;
+
+    return meshData;
+}
+
+GeometryGenerator::MeshDataSoA GeometryGenerator::CreateSphereSoA(
+    const float radius,
+    const std::uint32_t sliceCount,
+    const std::uint32_t stackCount)
+{
+    MeshDataSoA meshData;
+
+    const std::size_t ringVertexCount = sliceCount + 1ull;
+    meshData.ResizeVertices((stackCount - 1ull) * ringVertexCount + 2);
+
+    // Poles, see CreateSphere.
+    meshData.SetVertex(0,
+        Vertex(0.0f, +radius, 0.0f, 0.0f, +1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+    meshData.SetVertex(meshData.VertexCount() - 1,
+        Vertex(0.0f, -radius, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+
+    const float phiStep = XM_PI / stackCount;
+    const XMVECTOR thetaStep = XMVectorReplicate(2.0f * XM_PI / sliceCount);
+    const XMVECTOR invSliceCount = XMVectorReplicate(1.0f / sliceCount);
+
+    // Compute vertices for each stack ring (do not count the poles as rings).
+    for (std::uint32_t i = 1; i <= stackCount - 1; ++i)
+    {
+        const float phi = i * phiStep;
+
+        float sinPhi;
+        float cosPhi;
+        XMScalarSinCos(&sinPhi, &cosPhi, phi);
+
+        const std::size_t base = 1 + (i - 1ull) * ringVertexCount;
+        const XMVECTOR sinPhiV = XMVectorReplicate(sinPhi);
+        const XMVECTOR radiusSinPhi = XMVectorReplicate(radius * sinPhi);
+
+        // The y components are constant around the ring.
+        std::fill_n(meshData.Positions.Y.begin() + base, ringVertexCount, radius * cosPhi);
+        std::fill_n(meshData.Normals.Y.begin() + base, ringVertexCount, cosPhi);
+        std::fill_n(meshData.TangentUs.Y.begin() + base, ringVertexCount, 0.0f);
+        std::fill_n(meshData.TexCs.Y.begin() + base, ringVertexCount, phi / XM_PI);
+
+        for (std::size_t j = 0; j < ringVertexCount; j += kLanes)
+        {
+            const std::size_t count = std::min(kLanes, ringVertexCount - j);
+            const XMVECTOR slice = LaneIndices(j);
+
+            XMVECTOR sinTheta;
+            XMVECTOR cosTheta;
+            XMVectorSinCos(&sinTheta, &cosTheta, XMVectorMultiply(slice, thetaStep));
+
+            // spherical to cartesian
+            StoreLanes(&meshData.Positions.X[base + j], XMVectorMultiply(radiusSinPhi, cosTheta), count);
+            StoreLanes(&meshData.Positions.Z[base + j], XMVectorMultiply(radiusSinPhi, sinTheta), count);
+
+            // The position is radius * normal.
+            StoreLanes(&meshData.Normals.X[base + j], XMVectorMultiply(sinPhiV, cosTheta), count);
+            StoreLanes(&meshData.Normals.Z[base + j], XMVectorMultiply(sinPhiV, sinTheta), count);
+
+            // Partial derivative of P with respect to theta, normalized.  sin(phi) > 0
+            // away from the poles, so it reduces to (-sin(theta), 0, cos(theta)).
+            StoreLanes(&meshData.TangentUs.X[base + j], XMVectorNegate(sinTheta), count);
+            StoreLanes(&meshData.TangentUs.Z[base + j], cosTheta, count);
+
+            StoreLanes(&meshData.TexCs.X[base + j], XMVectorMultiply(slice, invSliceCount), count);
+        }
+    }
+
+    AppendSphereIndices(sliceCount, stackCount, meshData.Indices32);
+
+    return meshData;
+}
+
+GeometryGenerator::MeshDataSoA GeometryGenerator::CreateGeosphereSoA(
+    float radius,
+    std::uint32_t numSubdivisions)
+{
+    MeshDataSoA meshData;
+
+    // Put a cap on the number of subdivisions.
+    numSubdivisions = std::min(numSubdivisions, MaxSubdivisions);
+
+    // Approximate a sphere by tessellating an icosahedron.
+
+    const float X = 0.525731f;
+    const float Z = 0.850651f;
+
+    constexpr float pos[12][3] =
+    {
+        { -X, 0.0f, Z },  { X, 0.0f, Z },
+        { -X, 0.0f, -Z }, { X, 0.0f, -Z },
+        { 0.0f, Z, X },   { 0.0f, Z, -X },
+        { 0.0f, -Z, X },  { 0.0f, -Z, -X },
+        { Z, X, 0.0f },   { -Z, X, 0.0f },
+        { Z, -X, 0.0f },  { -Z, -X, 0.0f }
+    };
+
+    constexpr std::uint32_t k[60] =
+    {
+        1,4,0,  4,9,0,  4,5,9,  8,5,4,  1,8,4,
+        1,10,8, 10,3,8, 8,3,5,  3,2,5,  3,7,2,
+        3,10,7, 10,6,7, 6,11,7, 6,0,11, 6,1,0,
+        10,1,6, 11,0,9, 2,11,9, 5,2,9,  11,2,7
+    };
+
+    // Only the positions are subdivided; every other attribute is derived from
+    // the projected position below.
+    Float3Stream& p = meshData.Positions;
+    for (const auto& v : pos)
+    {
+        p.X.push_back(v[0]);
+        p.Y.push_back(v[1]);
+        p.Z.push_back(v[2]);
+    }
+
+    meshData.Indices32.assign(&k[0], &k[60]);
+
+    std::size_t vertexCount = 12;
+    for (std::uint32_t i = 0; i < numSubdivisions; ++i)
+    {
+        const std::size_t newVertexCount = vertexCount + 3 * meshData.Indices32.size() / 6;
+        p.X.reserve(newVertexCount);
+        p.Y.reserve(newVertexCount);
+        p.Z.reserve(newVertexCount);
+
+        SubdivideIndices(
+            meshData.Indices32,
+            std::uint32_t(vertexCount),
+            [&p](std::uint32_t a, std::uint32_t b)
+            {
+                p.X.push_back(0.5f * (p.X[a] + p.X[b]));
+                p.Y.push_back(0.5f * (p.Y[a] + p.Y[b]));
+                p.Z.push_back(0.5f * (p.Z[a] + p.Z[b]));
+            });
+
+        vertexCount = p.X.size();
+    }
+
+    meshData.ResizeVertices(vertexCount);
+
+    // Project vertices onto sphere and scale.
+    const XMVECTOR r = XMVectorReplicate(radius);
+    const XMVECTOR zero = XMVectorZero();
+    const XMVECTOR one = XMVectorSplatOne();
+    const XMVECTOR twoPi = XMVectorReplicate(XM_2PI);
+    const XMVECTOR invTwoPi = XMVectorReplicate(1.0f / XM_2PI);
+    const XMVECTOR invPi = XMVectorReplicate(1.0f / XM_PI);
+
+    for (std::size_t i = 0; i < vertexCount; i += kLanes)
+    {
+        const std::size_t count = std::min(kLanes, vertexCount - i);
+
+        const XMVECTOR px = LoadLanes(&p.X[i], count);
+        const XMVECTOR py = LoadLanes(&p.Y[i], count);
+        const XMVECTOR pz = LoadLanes(&p.Z[i], count);
+
+        // Project onto unit sphere.  The missing lanes of a partial batch are zero
+        // and produce garbage that is never stored.
+        const XMVECTOR lengthSq = XMVectorMultiplyAdd(px, px,
+            XMVectorMultiplyAdd(py, py, XMVectorMultiply(pz, pz)));
+        const XMVECTOR invLength = XMVectorReciprocalSqrt(lengthSq);
+
+        const XMVECTOR nx = XMVectorMultiply(px, invLength);
+        const XMVECTOR ny = XMVectorMultiply(py, invLength);
+        const XMVECTOR nz = XMVectorMultiply(pz, invLength);
+
+        StoreLanes(meshData.Normals, i, nx, ny, nz, count);
+
+        // Project onto sphere.
+        StoreLanes(meshData.Positions, i,
+            XMVectorMultiply(r, nx), XMVectorMultiply(r, ny), XMVectorMultiply(r, nz), count);
+
+        // Derive texture coordinates from spherical coordinates.
+        XMVECTOR theta = XMVectorATan2(nz, nx);
+
+        // Put in [0, 2pi].
+        theta = XMVectorAdd(theta, XMVectorSelect(zero, twoPi, XMVectorLess(theta, zero)));
+
+        const XMVECTOR phi = XMVectorACos(XMVectorClamp(ny, XMVectorNegate(one), one));
+
+        StoreLanes(meshData.TexCs, i,
+            XMVectorMultiply(theta, invTwoPi), XMVectorMultiply(phi, invPi), count);
+
+        // Partial derivative of P with respect to theta, normalized.  It vanishes at
+        // the poles, where the tangent is left zero like XMVector3Normalize does.
+        XMVECTOR sinTheta;
+        XMVECTOR cosTheta;
+        XMVectorSinCos(&sinTheta, &cosTheta, theta);
+
+        const XMVECTOR sinPhi = XMVectorSin(phi);
+        const XMVECTOR tx = XMVectorNegate(XMVectorMultiply(sinPhi, sinTheta));
+        const XMVECTOR tz = XMVectorMultiply(sinPhi, cosTheta);
+        const XMVECTOR tLength = XMVectorSqrt(XMVectorMultiplyAdd(tx, tx, XMVectorMultiply(tz, tz)));
+        const XMVECTOR nonZero = XMVectorGreater(tLength, zero);
+
+        StoreLanes(meshData.TangentUs, i,
+            XMVectorSelect(zero, XMVectorDivide(tx, tLength), nonZero),
+            zero,
+            XMVectorSelect(zero, XMVectorDivide(tz, tLength), nonZero),
+            count);
+    }
+
+    return meshData;
+}
+
+GeometryGenerator::MeshDataSoA GeometryGenerator::CreateCylinderSoA(
+    float bottomRadius,
+    float topRadius,
+    float height,
+    std::uint32_t sliceCount,
+    std::uint32_t stackCount)
+{
+    MeshDataSoA meshData;
+
+    const std::size_t ringVertexCount = sliceCount + 1ull;
+    const std::size_t ringCount = stackCount + 1ull;
+
+    // Stack rings followed by the top and bottom caps (ring + center vertex each).
+    meshData.ResizeVertices(ringCount * ringVertexCount + 2 * (ringVertexCount + 1));
+
+    //
+    // Build Stacks.
+    //
+
+    const float stackHeight = height / stackCount;
+
+    // Amount to increment radius as we move up each stack level from bottom to top.
+    const float radiusStep = (topRadius - bottomRadius) / stackCount;
+
+    // The normal is cross(T, B) with T = (-s, 0, c) and B = (dr*c, -h, dr*s), see
+    // CreateCylinder.  That is (h*c, dr, h*s), whose length does not depend on the
+    // angle, so it is normalized with one scale for the whole mesh.
+    const float dr = bottomRadius - topRadius;
+    const float invNormalLength = 1.0f / std::sqrt(height * height + dr * dr);
+    const XMVECTOR normalScale = XMVectorReplicate(height * invNormalLength);
+    const XMVECTOR invSliceCount = XMVectorReplicate(1.0f / sliceCount);
+
+    for (std::size_t i = 0; i < ringCount; ++i)
+    {
+        const std::size_t base = i * ringVertexCount;
+        const float y = -0.5f * height + i * stackHeight;
+        const float r = bottomRadius + i * radiusStep;
+
+        BuildRingSoA(meshData, base, r, y, sliceCount,
+            [&](std::size_t first, std::size_t count, FXMVECTOR slice, FXMVECTOR s, FXMVECTOR c, GXMVECTOR, HXMVECTOR)
+            {
+                StoreLanes(&meshData.TexCs.X[first], XMVectorMultiply(slice, invSliceCount), count);
+
+                // This is unit length.
+                StoreLanes(&meshData.TangentUs.X[first], XMVectorNegate(s), count);
+                StoreLanes(&meshData.TangentUs.Z[first], c, count);
+
+                StoreLanes(&meshData.Normals.X[first], XMVectorMultiply(normalScale, c), count);
+                StoreLanes(&meshData.Normals.Z[first], XMVectorMultiply(normalScale, s), count);
+            });
+
+        std::fill_n(meshData.TexCs.Y.begin() + base, ringVertexCount, 1.0f - (float)i / stackCount);
+        std::fill_n(meshData.TangentUs.Y.begin() + base, ringVertexCount, 0.0f);
+        std::fill_n(meshData.Normals.Y.begin() + base, ringVertexCount, dr * invNormalLength);
+    }
+
+    AppendCylinderIndices(sliceCount, stackCount, meshData.Indices32);
+
+    const std::uint32_t topBase = std::uint32_t(ringCount * ringVertexCount);
+    const std::uint32_t bottomBase = std::uint32_t(topBase + ringVertexCount + 1);
+
+    BuildCylinderCapSoA(meshData, topBase, topRadius, height, sliceCount, true);
+    AppendCylinderCapIndices(topBase, sliceCount, true, meshData.Indices32);
+
+    BuildCylinderCapSoA(meshData, bottomBase, bottomRadius, height, sliceCount, false);
+    AppendCylinderCapIndices(bottomBase, sliceCount, false, meshData.Indices32);
+
+    return meshData;
+}
+
+GeometryGenerator::MeshDataSoA GeometryGenerator::CreateGridSoA(
+    float width,
+    float depth,
+    std::uint32_t m,
+    std::uint32_t n)
+{
+    MeshDataSoA meshData;
+    meshData.ResizeVertices(std::size_t(m) * n);
+
+    //
+    // Create the vertices.
+    //
+
+    const float halfWidth = 0.5f * width;
+    const float halfDepth = 0.5f * depth;
+
+    const float dz = depth / (m - 1);
+    const float dv = 1.0f / (m - 1);
+
+    const XMVECTOR dx = XMVectorReplicate(width / (n - 1));
+    const XMVECTOR du = XMVectorReplicate(1.0f / (n - 1));
+    const XMVECTOR minX = XMVectorReplicate(-halfWidth);
+
+    // Every row has the same x and u coordinates; evaluate the first row and copy it.
+    for (std::size_t j = 0; j < n; j += kLanes)
+    {
+        const std::size_t count = std::min<std::size_t>(kLanes, n - j);
+        const XMVECTOR column = LaneIndices(j);
+
+        StoreLanes(&meshData.Positions.X[j], XMVectorMultiplyAdd(column, dx, minX), count);
+        StoreLanes(&meshData.TexCs.X[j], XMVectorMultiply(column, du), count);
+    }
+
+    for (std::uint32_t i = 0; i < m; ++i)
+    {
+        const std::size_t base = std::size_t(i) * n;
+        if (i > 0)
+        {
+            std::copy_n(meshData.Positions.X.begin(), n, meshData.Positions.X.begin() + base);
+            std::copy_n(meshData.TexCs.X.begin(), n, meshData.TexCs.X.begin() + base);
+        }
+
+        std::fill_n(meshData.Positions.Z.begin() + base, n, halfDepth - i * dz);
+        std::fill_n(meshData.TexCs.Y.begin() + base, n, i * dv);
+    }
+
+    std::fill(meshData.Positions.Y.begin(), meshData.Positions.Y.end(), 0.0f);
+    std::fill(meshData.Normals.X.begin(), meshData.Normals.X.end(), 0.0f);
+    std::fill(meshData.Normals.Y.begin(), meshData.Normals.Y.end(), 1.0f);
+    std::fill(meshData.Normals.Z.begin(), meshData.Normals.Z.end(), 0.0f);
+    std::fill(meshData.TangentUs.X.begin(), meshData.TangentUs.X.end(), 1.0f);
+    std::fill(meshData.TangentUs.Y.begin(), meshData.TangentUs.Y.end(), 0.0f);
+    std::fill(meshData.TangentUs.Z.begin(), meshData.TangentUs.Z.end(), 0.0f);
+
+    //
+    // Create the indices.
+    //
+
+    AppendGridIndices(m, n, meshData.Indices32);
+
+    return meshData;
+}
@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include <DirectXMath.h>
@@ -76,6 +78,80 @@ namespace GeometryGenerator
         std::vector<uint16> mIndices16;
     };
 
+    // One float array per component, so a DirectXMath vector holds the same
+    // component of four consecutive vertices.
+    struct Float3Stream final
+    {
+        std::vector<float> X;
+        std::vector<float> Y;
+        std::vector<float> Z;
+    };
+
+    struct Float2Stream final
+    {
+        std::vector<float> X;
+        std::vector<float> Y;
+    };
+
+    ///<summary>
+    /// Struct-of-arrays counterpart of MeshData, filled by the *SoA generators four
+    /// vertices at a time.  Convert to the interleaved Vertex layout only when the
+    /// data is uploaded, e.g. by interleaving straight into a mapped buffer.
+    ///</summary>
+    struct MeshDataSoA final
+    {
+        // Where each attribute goes in a vertex of Stride bytes; -1 skips it.
+        struct VertexLayout final
+        {
+            std::size_t Stride = 0;
+            std::ptrdiff_t PositionOffset = -1;
+            std::ptrdiff_t NormalOffset = -1;
+            std::ptrdiff_t TangentUOffset = -1;
+            std::ptrdiff_t TexCOffset = -1;
+        };
+
+        Float3Stream Positions;
+        Float3Stream Normals;
+        Float3Stream TangentUs;
+        Float2Stream TexCs;
+        std::vector<uint32> Indices32;
+
+        std::size_t VertexCount()const { return Positions.X.size(); }
+
+        void ResizeVertices(std::size_t count);
+        void SetVertex(std::size_t i, const Vertex& v);
+        Vertex GetVertex(std::size_t i)const;
+
+        // Writes the vertices [firstVertex, firstVertex + dst.size() / layout.Stride)
+        // into dst, typically a mapped upload buffer.  Four vertices at a time, each
+        // attribute is transposed from its streams into the four vertices; the bytes
+        // outside the attributes are left as they are.
+        void Interleave(std::span<std::byte> dst, const VertexLayout& layout, std::size_t firstVertex = 0)const;
+
+        // Same, with the layout taken from VertexT's Pos (or Position) and, if present,
+        // Normal, TangentU and TexC members.
+        template<typename VertexT>
+        void Interleave(std::span<VertexT> dst, std::size_t firstVertex = 0)const
+        {
+            VertexLayout layout;
+            layout.Stride = sizeof(VertexT);
+            if constexpr (requires(VertexT v) { v.Pos; })
+                layout.PositionOffset = offsetof(VertexT, Pos);
+            else
+                layout.PositionOffset = offsetof(VertexT, Position);
+            if constexpr (requires(VertexT v) { v.Normal; })
+                layout.NormalOffset = offsetof(VertexT, Normal);
+            if constexpr (requires(VertexT v) { v.TangentU; })
+                layout.TangentUOffset = offsetof(VertexT, TangentU);
+            if constexpr (requires(VertexT v) { v.TexC; })
+                layout.TexCOffset = offsetof(VertexT, TexC);
+
+            Interleave(std::as_writable_bytes(dst), layout, firstVertex);
+        }
+
+        MeshData ToMeshData()const;
+    };
+
     ///<summary>
     /// Creates a box centered at the origin with the given dimensions, where each
     /// face has m rows and n columns of vertices.
@@ -107,6 +183,16 @@ namespace GeometryGenerator
     ///</summary>
     MeshData CreateGrid(float width, float depth, uint32 m, uint32 n);
 
+    ///<summary>
+    /// SIMD versions of the generators above.  They produce the same vertices and
+    /// indices as their MeshData counterparts (up to float rounding), but evaluate
+    /// four vertices per DirectXMath vector operation.
+    ///</summary>
+    MeshDataSoA CreateSphereSoA(float radius, uint32 sliceCount, uint32 stackCount);
+    MeshDataSoA CreateGeosphereSoA(float radius, uint32 numSubdivisions);
+    MeshDataSoA CreateCylinderSoA(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount);
+    MeshDataSoA CreateGridSoA(float width, float depth, uint32 m, uint32 n);
+
     ///<summary>
     /// Creates a quad aligned with the screen.  This is useful for postprocessing and screen effects.
     ///</summary>
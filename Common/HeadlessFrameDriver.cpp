@@ -0,0 +1,97 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "HeadlessFrameDriver.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+namespace
+{
+    void Accumulate(CommandCounter::Counts& total, const CommandCounter::Counts& frame)
+    {
+        total.PipelineStates += frame.PipelineStates;
+        total.VertexBuffers += frame.VertexBuffers;
+        total.IndexBuffers += frame.IndexBuffers;
+        total.PrimitiveTopologies += frame.PrimitiveTopologies;
+        total.RootDescriptorTables += frame.RootDescriptorTables;
+        total.RootConstantBufferViews += frame.RootConstantBufferViews;
+        total.Draws += frame.Draws;
+    }
+}
+
+void HeadlessFrameDriver::AddPhase(std::string name, Phase phase)
+{
+    assert(phase);
+
+    PhaseStats stats;
+    stats.Name = std::move(name);
+    mStats.push_back(std::move(stats));
+    mPhases.push_back(std::move(phase));
+}
+
+void HeadlessFrameDriver::Run(const std::uint32_t frameCount, const float deltaTime)
+{
+    using Clock = std::chrono::steady_clock;
+
+    for (std::uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        mCounter.Reset();
+
+        for (std::size_t i = 0; i < mPhases.size(); ++i)
+        {
+            const Clock::time_point start = Clock::now();
+            mPhases[i](deltaTime, mCounter);
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            PhaseStats& stats = mStats[i];
+            const bool first = stats.Frames == 0;
+            ++stats.Frames;
+            stats.TotalMs += ms;
+            stats.MinMs = first ? ms : std::min(stats.MinMs, ms);
+            stats.MaxMs = first ? ms : std::max(stats.MaxMs, ms);
+        }
+
+        Accumulate(mTotalCalls, mCounter.Calls());
+        Accumulate(mTotalRedundant, mCounter.Redundant());
+        ++mFrameCount;
+    }
+}
+
+void HeadlessFrameDriver::Report(std::ostream& out)const
+{
+    const double frames = std::max<std::uint32_t>(mFrameCount, 1);
+
+    out << mFrameCount << " frames\n";
+    out << std::fixed << std::setprecision(3);
+    out << std::left << std::setw(24) << "phase" << std::right
+        << std::setw(12) << "avg ms" << std::setw(12) << "min ms" << std::setw(12) << "max ms" << '\n';
+
+    double totalMs = 0.0;
+    for (const PhaseStats& stats : mStats)
+    {
+        const double averageMs = stats.TotalMs / std::max<std::uint32_t>(stats.Frames, 1);
+        out << std::left << std::setw(24) << stats.Name << std::right
+            << std::setw(12) << averageMs
+            << std::setw(12) << stats.MinMs
+            << std::setw(12) << stats.MaxMs << '\n';
+        totalMs += averageMs;
+    }
+    out << std::left << std::setw(24) << "frame" << std::right << std::setw(12) << totalMs << '\n';
+
+    const auto perFrame = [frames](const std::uint64_t count) { return count / frames; };
+
+    out << std::setprecision(1);
+    out << "per frame: " << perFrame(mTotalCalls.Draws) << " draws, "
+        << perFrame(mTotalCalls.Binds()) << " binds ("
+        << perFrame(mTotalRedundant.Binds()) << " redundant)\n";
+    out << "  pipeline states " << perFrame(mTotalCalls.PipelineStates)
+        << ", vertex buffers " << perFrame(mTotalCalls.VertexBuffers)
+        << ", index buffers " << perFrame(mTotalCalls.IndexBuffers)
+        << ", topologies " << perFrame(mTotalCalls.PrimitiveTopologies)
+        << ", descriptor tables " << perFrame(mTotalCalls.RootDescriptorTables)
+        << ", root CBVs " << perFrame(mTotalCalls.RootConstantBufferViews) << '\n';
+}
@@ -0,0 +1,62 @@
+//***************************************************************************************
+// HeadlessFrameDriver.h
+//
+// Ticks the phases of a frame (update, culling, draw recording and so on) for a
+// number of frames without a window or a device, and reports the CPU time each phase
+// took and the commands the frames recorded.  The draw phases record into a
+// CommandCounter instead of a command list, so only the CPU side is measured.
+//***************************************************************************************
+
+#pragma once
+
+#include "CommandSink.h"
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class HeadlessFrameDriver final
+{
+public:
+    // One phase of a frame.  deltaTime is the fixed frame time in seconds; commands
+    // go to sink.
+    using Phase = std::function<void(float deltaTime, CommandSink& sink)>;
+
+    // A phase added after a Run only has the frames that ran since.
+    struct PhaseStats final
+    {
+        std::string Name;
+        std::uint32_t Frames = 0;
+        double TotalMs = 0.0;
+        double MinMs = 0.0;
+        double MaxMs = 0.0;
+    };
+
+    void AddPhase(std::string name, Phase phase);
+
+    // Runs every phase, in the order they were added, once per frame.  Each frame
+    // starts with nothing bound, like a freshly reset command list.  Statistics add
+    // up over calls.
+    void Run(std::uint32_t frameCount, float deltaTime = 1.0f / 60.0f);
+
+    std::uint32_t FrameCount()const { return mFrameCount; }
+    const std::vector<PhaseStats>& Stats()const { return mStats; }
+
+    // Commands recorded by all frames, and the binds among them that changed nothing.
+    const CommandCounter::Counts& TotalCalls()const { return mTotalCalls; }
+    const CommandCounter::Counts& TotalRedundant()const { return mTotalRedundant; }
+
+    // Writes per-phase timings and per-frame command counts as a text table.
+    void Report(std::ostream& out)const;
+
+private:
+    std::vector<Phase> mPhases;
+    std::vector<PhaseStats> mStats;
+
+    CommandCounter mCounter;
+    CommandCounter::Counts mTotalCalls;
+    CommandCounter::Counts mTotalRedundant;
+    std::uint32_t mFrameCount = 0;
+};
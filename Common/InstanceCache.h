@@ -0,0 +1,59 @@
+//***************************************************************************************
+// InstanceCache.h
+//
+// Upload-ready copies of the instances of an instanced render item.  The shaders read
+// the world, inverse-transpose world and texture transforms transposed, and culling
+// wants world-space bounds; all of it depends on the instance alone, so it is computed
+// when the instances change rather than every frame.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "FrustumCuller.h"
+#include "MathHelper.h"
+
+namespace InstanceCache
+{
+    // Fills gpuInstances with instances as the shaders read them, and worldBounds with
+    // localBounds moved into the world space of each instance, in the same order.
+    // InstanceT has World, InvTransposeWorld, TexTransform and MaterialIndex members,
+    // as the InstanceData of the instancing demos; BoundsT is a BoundingBox or a
+    // BoundingSphere.
+    template<typename InstanceT, typename BoundsT>
+    void Fill(
+        const std::span<const InstanceT> instances,
+        const BoundsT& localBounds,
+        std::vector<InstanceT>& gpuInstances,
+        FrustumCuller& worldBounds)
+    {
+        using namespace DirectX;
+
+        gpuInstances.resize(instances.size());
+        worldBounds.Clear();
+        worldBounds.Reserve(instances.size());
+
+        for (std::size_t i = 0; i < instances.size(); ++i)
+        {
+            const InstanceT& instance = instances[i];
+            const XMMATRIX world = XMLoadFloat4x4(&instance.World);
+            const XMMATRIX texTransform = XMLoadFloat4x4(&instance.TexTransform);
+
+            InstanceT& gpuData = gpuInstances[i];
+            XMStoreFloat4x4(&gpuData.World, XMMatrixTranspose(world));
+            XMStoreFloat4x4(&gpuData.InvTransposeWorld, XMMatrixTranspose(MathHelper::InverseTranspose(world)));
+            XMStoreFloat4x4(&gpuData.TexTransform, XMMatrixTranspose(texTransform));
+            gpuData.MaterialIndex = instance.MaterialIndex;
+
+            BoundsT bounds;
+            localBounds.Transform(bounds, world);
+            worldBounds.Add(bounds);
+        }
+    }
+}
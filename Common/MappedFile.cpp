@@ -0,0 +1,126 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::~MappedFile()
+{
+    if (mView != nullptr)
+    {
+        UnmapViewOfFile(mView);
+    }
+    if (mMapping != nullptr)
+    {
+        CloseHandle(mMapping);
+    }
+    if (mFile != nullptr)
+    {
+        CloseHandle(mFile);
+    }
+}
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::wstring& filename)
+{
+    auto mapped = std::make_shared<MappedFile>();
+
+    const HANDLE file = CreateFileW(
+        filename.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+    mapped->mFile = file;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        return nullptr;
+    }
+
+    mapped->mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapped->mMapping == nullptr)
+    {
+        return nullptr;
+    }
+
+    mapped->mView = MapViewOfFile(mapped->mMapping, FILE_MAP_READ, 0, 0, 0);
+    if (mapped->mView == nullptr)
+    {
+        return nullptr;
+    }
+
+    mapped->mData = static_cast<const std::byte*>(mapped->mView);
+    mapped->mSize = static_cast<std::uint64_t>(fileSize.QuadPart);
+    return mapped;
+}
+
+#else
+
+MappedFile::~MappedFile()
+{
+    if (mView != nullptr)
+    {
+        munmap(mView, static_cast<std::size_t>(mSize));
+    }
+}
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::wstring& filename)
+{
+    const int file = open(std::filesystem::path(filename).c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return nullptr;
+    }
+
+    // The mapping keeps its own reference to the file.
+    struct stat status = {};
+    void* view = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+
+    if (view == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto mapped = std::make_shared<MappedFile>();
+    mapped->mView = view;
+    mapped->mData = static_cast<const std::byte*>(view);
+    mapped->mSize = static_cast<std::uint64_t>(status.st_size);
+    return mapped;
+}
+
+#endif
+
+std::shared_ptr<MappedFile> MappedFile::FromMemory(std::vector<std::byte>&& image)
+{
+    auto mapped = std::make_shared<MappedFile>();
+    mapped->mHeapCopy = std::move(image);
+    mapped->mData = mapped->mHeapCopy.data();
+    mapped->mSize = mapped->mHeapCopy.size();
+    return mapped;
+}
@@ -0,0 +1,49 @@
+//***************************************************************************************
+// MappedFile.h
+//
+// Read-only view of a whole file.  Opening maps the file into the address space, so
+// parsers can hand out pointers into it instead of reading and copying the contents.
+// Holders share the mapping through std::shared_ptr and it is unmapped with the last
+// of them.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class MappedFile final
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile& operator=(const MappedFile& rhs) = delete;
+    ~MappedFile();
+
+    // Maps filename.  Returns nullptr if the file is missing, empty or can not be mapped.
+    static std::shared_ptr<MappedFile> Open(const std::wstring& filename);
+
+    // Wraps bytes that only exist in memory, so callers do not have to care where the
+    // bytes came from.
+    static std::shared_ptr<MappedFile> FromMemory(std::vector<std::byte>&& image);
+
+    const std::byte* Data()const { return mData; }
+    std::uint64_t Size()const { return mSize; }
+
+    std::span<const std::byte> Bytes()const { return { mData, static_cast<std::size_t>(mSize) }; }
+
+private:
+#ifdef _WIN32
+    void* mFile = nullptr;
+    void* mMapping = nullptr;
+#endif
+    void* mView = nullptr;
+    std::vector<std::byte> mHeapCopy;
+
+    const std::byte* mData = nullptr;
+    std::uint64_t mSize = 0;
+};
@@ -36,7 +36,7 @@ namespace MathHelper
 
 	inline DirectX::XMVECTOR SphericalToCartesian(float radius, float theta, float phi)
 	{
-		const float sinPhi = std::sinf(phi);
+		const float sinPhi = sinf(phi);
 		return DirectX::XMVectorSet(
 			radius*sinPhi*cosf(theta),
 			radius*cosf(phi),
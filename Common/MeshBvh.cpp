@@ -0,0 +1,561 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "MeshBvh.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+using namespace DirectX;
+
+namespace
+{
+    // Leaves never hold more triangles than this, even when the SAH would rather not split.
+    constexpr std::size_t kMaxLeafTriangles = 8;
+
+    // Centroid bins per axis when evaluating split candidates.
+    constexpr int kBinCount = 16;
+
+    // Cost of visiting an interior node relative to one ray/triangle test.
+    constexpr float kTraversalCost = 1.0f;
+
+    // Below this depth splits are chosen by the SAH; from there on ranges are halved,
+    // so no tree over a 32-bit triangle count is deeper than kMaxDepth.
+    constexpr int kMaxSahDepth = 32;
+    constexpr int kMaxDepth = kMaxSahDepth + 32;
+
+    struct Aabb final
+    {
+        XMFLOAT3 Min = XMFLOAT3(
+            std::numeric_limits<float>::max(),
+            std::numeric_limits<float>::max(),
+            std::numeric_limits<float>::max());
+        XMFLOAT3 Max = XMFLOAT3(
+            -std::numeric_limits<float>::max(),
+            -std::numeric_limits<float>::max(),
+            -std::numeric_limits<float>::max());
+
+        void Grow(const XMFLOAT3& p)
+        {
+            Min = XMFLOAT3(std::min(Min.x, p.x), std::min(Min.y, p.y), std::min(Min.z, p.z));
+            Max = XMFLOAT3(std::max(Max.x, p.x), std::max(Max.y, p.y), std::max(Max.z, p.z));
+        }
+
+        void Grow(const Aabb& box)
+        {
+            Grow(box.Min);
+            Grow(box.Max);
+        }
+
+        bool IsEmpty()const { return Min.x > Max.x; }
+
+        float HalfArea()const
+        {
+            if (IsEmpty())
+                return 0.0f;
+
+            const float dx = Max.x - Min.x;
+            const float dy = Max.y - Min.y;
+            const float dz = Max.z - Min.z;
+            return dx * dy + dy * dz + dz * dx;
+        }
+    };
+
+    float Axis(const XMFLOAT3& v, const int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    // Distance at which the ray enters the box, or infinity if it misses the box or
+    // enters it beyond maxDistance.  NaNs from a zero direction component on a slab
+    // boundary fall through the min/max below and leave that axis unconstrained.
+    float EnterDistance(
+        const XMFLOAT3& boxMin,
+        const XMFLOAT3& boxMax,
+        const XMFLOAT3& origin,
+        const XMFLOAT3& invDirection,
+        const float maxDistance)
+    {
+        float tNear = 0.0f;
+        float tFar = maxDistance;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float o = Axis(origin, axis);
+            const float inv = Axis(invDirection, axis);
+            const float t1 = (Axis(boxMin, axis) - o) * inv;
+            const float t2 = (Axis(boxMax, axis) - o) * inv;
+            tNear = std::max(tNear, std::min(t1, t2));
+            tFar = std::min(tFar, std::max(t1, t2));
+        }
+
+        return tNear <= tFar ? tNear : std::numeric_limits<float>::infinity();
+    }
+}
+
+struct MeshBvh::BuildTriangle final
+{
+    Aabb Bounds;
+    XMFLOAT3 Centroid;
+    std::uint32_t Id = 0;
+};
+
+void MeshBvh::Build(
+    const std::span<const std::byte> vertexData,
+    const std::size_t vertexStride,
+    const std::span<const std::uint32_t> indices,
+    const int baseVertex)
+{
+    assert(vertexStride >= sizeof(XMFLOAT3));
+    assert(indices.size() % 3 == 0);
+
+    mNodes.clear();
+    mPackets.clear();
+    mTriangleCount = 0;
+
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    const auto position = [&](const std::uint32_t index)
+    {
+        const std::size_t vertex = static_cast<std::size_t>(static_cast<std::int64_t>(index) + baseVertex);
+        assert((vertex + 1) * vertexStride <= vertexData.size());
+
+        XMFLOAT3 p;
+        std::memcpy(&p, vertexData.data() + vertex * vertexStride, sizeof(p));
+        return p;
+    };
+
+    std::vector<XMFLOAT3> corners(indices.size());
+    std::vector<BuildTriangle> triangles(triangleCount);
+    for (std::size_t i = 0; i < triangleCount; ++i)
+    {
+        BuildTriangle& triangle = triangles[i];
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            corners[i * 3 + k] = position(indices[i * 3 + k]);
+            triangle.Bounds.Grow(corners[i * 3 + k]);
+        }
+
+        triangle.Centroid = XMFLOAT3(
+            0.5f * (triangle.Bounds.Min.x + triangle.Bounds.Max.x),
+            0.5f * (triangle.Bounds.Min.y + triangle.Bounds.Max.y),
+            0.5f * (triangle.Bounds.Min.z + triangle.Bounds.Max.z));
+        triangle.Id = static_cast<std::uint32_t>(i);
+    }
+
+    // A binary tree with at least one triangle per leaf has fewer than 2n nodes.
+    mNodes.reserve(2 * triangleCount);
+    BuildNode(triangles, 0, triangleCount, 0);
+
+    // Pack every leaf's triangles into its own packets, in leaf order, and point the
+    // leaf at them instead of at its triangle range.
+    mPackets.reserve(triangleCount / 4 + mNodes.size());
+    for (Node& node : mNodes)
+    {
+        if (node.TriangleCount == 0)
+            continue;
+
+        const std::uint32_t firstTriangle = node.RightOrFirst;
+        node.RightOrFirst = static_cast<std::uint32_t>(mPackets.size());
+
+        for (std::uint32_t i = 0; i < node.TriangleCount; i += 4)
+        {
+            TrianglePacket& packet = mPackets.emplace_back();
+            for (std::uint32_t lane = 0; lane < 4; ++lane)
+            {
+                XMFLOAT3 v0(0.0f, 0.0f, 0.0f);
+                XMFLOAT3 v1(0.0f, 0.0f, 0.0f);
+                XMFLOAT3 v2(0.0f, 0.0f, 0.0f);
+                std::uint32_t id = 0;
+                if (i + lane < node.TriangleCount)
+                {
+                    id = triangles[firstTriangle + i + lane].Id;
+                    v0 = corners[id * 3 + 0];
+                    v1 = corners[id * 3 + 1];
+                    v2 = corners[id * 3 + 2];
+                }
+
+                packet.V0x[lane] = v0.x;
+                packet.V0y[lane] = v0.y;
+                packet.V0z[lane] = v0.z;
+                packet.E1x[lane] = v1.x - v0.x;
+                packet.E1y[lane] = v1.y - v0.y;
+                packet.E1z[lane] = v1.z - v0.z;
+                packet.E2x[lane] = v2.x - v0.x;
+                packet.E2y[lane] = v2.y - v0.y;
+                packet.E2z[lane] = v2.z - v0.z;
+                packet.Ids[lane] = id;
+            }
+        }
+    }
+
+    mTriangleCount = triangleCount;
+}
+
+void MeshBvh::BuildNode(
+    std::vector<BuildTriangle>& triangles,
+    const std::size_t first,
+    const std::size_t last,
+    const int depth)
+{
+    const std::size_t nodeIndex = mNodes.size();
+    mNodes.emplace_back();
+
+    Aabb bounds;
+    Aabb centroidBounds;
+    for (std::size_t i = first; i < last; ++i)
+    {
+        bounds.Grow(triangles[i].Bounds);
+        centroidBounds.Grow(triangles[i].Centroid);
+    }
+
+    mNodes[nodeIndex].BoundsMin = bounds.Min;
+    mNodes[nodeIndex].BoundsMax = bounds.Max;
+
+    const auto makeLeaf = [&]()
+    {
+        mNodes[nodeIndex].RightOrFirst = static_cast<std::uint32_t>(first);
+        mNodes[nodeIndex].TriangleCount = static_cast<std::uint32_t>(last - first);
+    };
+
+    const std::size_t count = last - first;
+    if (count == 1)
+    {
+        makeLeaf();
+        return;
+    }
+
+    // Find the cheapest binned split over all three axes.
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = std::numeric_limits<float>::max();
+
+    for (int axis = 0; axis < 3 && depth < kMaxSahDepth; ++axis)
+    {
+        const float axisMin = Axis(centroidBounds.Min, axis);
+        const float axisExtent = Axis(centroidBounds.Max, axis) - axisMin;
+        if (axisExtent <= 0.0f)
+            continue;
+
+        Aabb binBounds[kBinCount];
+        std::size_t binCounts[kBinCount] = {};
+        const float binScale = kBinCount / axisExtent;
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const int bin = std::min(kBinCount - 1, static_cast<int>((Axis(triangles[i].Centroid, axis) - axisMin) * binScale));
+            binBounds[bin].Grow(triangles[i].Bounds);
+            ++binCounts[bin];
+        }
+
+        // Sweep from the right to get the cost of everything right of each split.
+        float rightCosts[kBinCount] = {};
+        Aabb right;
+        std::size_t rightCount = 0;
+        for (int bin = kBinCount - 1; bin > 0; --bin)
+        {
+            right.Grow(binBounds[bin]);
+            rightCount += binCounts[bin];
+            rightCosts[bin] = right.HalfArea() * rightCount;
+        }
+
+        Aabb left;
+        std::size_t leftCount = 0;
+        for (int split = 1; split < kBinCount; ++split)
+        {
+            left.Grow(binBounds[split - 1]);
+            leftCount += binCounts[split - 1];
+            const float cost = left.HalfArea() * leftCount + rightCosts[split];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    // All centroids coincide, or the tree is already deep: halve the range along the
+    // longest centroid axis.
+    if (bestAxis < 0)
+    {
+        if (count <= kMaxLeafTriangles)
+        {
+            makeLeaf();
+            return;
+        }
+
+        const float extentX = centroidBounds.Max.x - centroidBounds.Min.x;
+        const float extentY = centroidBounds.Max.y - centroidBounds.Min.y;
+        const float extentZ = centroidBounds.Max.z - centroidBounds.Min.z;
+        bestAxis = extentX >= extentY && extentX >= extentZ ? 0 : (extentY >= extentZ ? 1 : 2);
+        bestSplit = -1;
+    }
+    else
+    {
+        const float splitCost = kTraversalCost + bestCost / bounds.HalfArea();
+        if (splitCost >= static_cast<float>(count) && count <= kMaxLeafTriangles)
+        {
+            makeLeaf();
+            return;
+        }
+    }
+
+    std::size_t middle = first;
+    if (bestSplit > 0)
+    {
+        const float axisMin = Axis(centroidBounds.Min, bestAxis);
+        const float binScale = kBinCount / (Axis(centroidBounds.Max, bestAxis) - axisMin);
+        const auto split = std::partition(
+            triangles.begin() + first,
+            triangles.begin() + last,
+            [&](const BuildTriangle& triangle)
+            {
+                return std::min(kBinCount - 1, static_cast<int>((Axis(triangle.Centroid, bestAxis) - axisMin) * binScale)) < bestSplit;
+            });
+        middle = static_cast<std::size_t>(split - triangles.begin());
+    }
+
+    // Halve the range if there is no binned split or it did not separate anything.
+    if (middle == first || middle == last)
+    {
+        middle = first + count / 2;
+        std::nth_element(
+            triangles.begin() + first,
+            triangles.begin() + middle,
+            triangles.begin() + last,
+            [bestAxis](const BuildTriangle& a, const BuildTriangle& b)
+            {
+                return Axis(a.Centroid, bestAxis) < Axis(b.Centroid, bestAxis);
+            });
+    }
+
+    // The first child is built right after this node; the second one's index is only
+    // known once the first subtree is complete.
+    BuildNode(triangles, first, middle, depth + 1);
+    mNodes[nodeIndex].RightOrFirst = static_cast<std::uint32_t>(mNodes.size());
+    BuildNode(triangles, middle, last, depth + 1);
+}
+
+bool MeshBvh::Intersect(
+    FXMVECTOR origin,
+    FXMVECTOR direction,
+    const float maxDistance,
+    Hit& hit)const
+{
+    if (mNodes.empty())
+        return false;
+
+    XMFLOAT3 o;
+    XMFLOAT3 invDirection;
+    XMStoreFloat3(&o, origin);
+    XMStoreFloat3(&invDirection, XMVectorReciprocal(direction));
+
+    float nearest = maxDistance;
+    bool found = false;
+
+    // Nodes still to visit with the distance at which the ray enters them, so they can
+    // be dropped if a nearer hit has been found by the time they are popped.
+    struct Pending final
+    {
+        std::uint32_t Node;
+        float Enter;
+    };
+    Pending stack[kMaxDepth];
+    int stackSize = 0;
+
+    const Node& root = mNodes[0];
+    if (EnterDistance(root.BoundsMin, root.BoundsMax, o, invDirection, nearest) == std::numeric_limits<float>::infinity())
+        return false;
+
+    std::uint32_t nodeIndex = 0;
+    for (;;)
+    {
+        const Node& node = mNodes[nodeIndex];
+        if (node.TriangleCount > 0)
+        {
+            const std::uint32_t end = node.RightOrFirst + (node.TriangleCount + 3) / 4;
+            for (std::uint32_t i = node.RightOrFirst; i < end; ++i)
+            {
+                float distances[4];
+                const unsigned hitMask = IntersectPacket(origin, direction, mPackets[i], distances);
+                for (unsigned lane = 0; lane < 4; ++lane)
+                {
+                    if ((hitMask & (1u << lane)) != 0 && distances[lane] < nearest)
+                    {
+                        nearest = distances[lane];
+                        hit.Distance = nearest;
+                        hit.Triangle = mPackets[i].Ids[lane];
+                        found = true;
+                    }
+                }
+            }
+        }
+        else
+        {
+            std::uint32_t nearChild = nodeIndex + 1;
+            std::uint32_t farChild = node.RightOrFirst;
+            float nearEnter = EnterDistance(mNodes[nearChild].BoundsMin, mNodes[nearChild].BoundsMax, o, invDirection, nearest);
+            float farEnter = EnterDistance(mNodes[farChild].BoundsMin, mNodes[farChild].BoundsMax, o, invDirection, nearest);
+            if (farEnter < nearEnter)
+            {
+                std::swap(nearChild, farChild);
+                std::swap(nearEnter, farEnter);
+            }
+
+            if (nearEnter != std::numeric_limits<float>::infinity())
+            {
+                if (farEnter != std::numeric_limits<float>::infinity())
+                {
+                    assert(stackSize < kMaxDepth);
+                    stack[stackSize++] = Pending{ farChild, farEnter };
+                }
+
+                nodeIndex = nearChild;
+                continue;
+            }
+        }
+
+        // Pop the next node that may still hold a nearer hit.
+        bool popped = false;
+        while (stackSize > 0)
+        {
+            const Pending pending = stack[--stackSize];
+            if (pending.Enter < nearest)
+            {
+                nodeIndex = pending.Node;
+                popped = true;
+                break;
+            }
+        }
+
+        if (!popped)
+            break;
+    }
+
+    return found;
+}
+
+void MeshBvh::IntersectAll(
+    FXMVECTOR origin,
+    FXMVECTOR direction,
+    const float maxDistance,
+    std::vector<Hit>& hits)const
+{
+    if (mNodes.empty())
+        return;
+
+    XMFLOAT3 o;
+    XMFLOAT3 invDirection;
+    XMStoreFloat3(&o, origin);
+    XMStoreFloat3(&invDirection, XMVectorReciprocal(direction));
+
+    std::uint32_t stack[kMaxDepth + 1];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = mNodes[stack[--stackSize]];
+        if (EnterDistance(node.BoundsMin, node.BoundsMax, o, invDirection, maxDistance) == std::numeric_limits<float>::infinity())
+            continue;
+
+        if (node.TriangleCount == 0)
+        {
+            assert(stackSize + 2 <= kMaxDepth + 1);
+            stack[stackSize++] = node.RightOrFirst;
+            stack[stackSize++] = static_cast<std::uint32_t>(&node - mNodes.data()) + 1;
+            continue;
+        }
+
+        const std::uint32_t end = node.RightOrFirst + (node.TriangleCount + 3) / 4;
+        for (std::uint32_t i = node.RightOrFirst; i < end; ++i)
+        {
+            float distances[4];
+            const unsigned hitMask = IntersectPacket(origin, direction, mPackets[i], distances);
+            for (unsigned lane = 0; lane < 4; ++lane)
+            {
+                if ((hitMask & (1u << lane)) != 0 && distances[lane] <= maxDistance)
+                {
+                    hits.push_back(Hit{ distances[lane], mPackets[i].Ids[lane] });
+                }
+            }
+        }
+    }
+}
+
+unsigned MeshBvh::IntersectPacket(
+    FXMVECTOR origin,
+    FXMVECTOR direction,
+    const TrianglePacket& packet,
+    float distances[4])
+{
+    const auto load = [](const float (&values)[4])
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(values));
+    };
+
+    const XMVECTOR dx = XMVectorSplatX(direction);
+    const XMVECTOR dy = XMVectorSplatY(direction);
+    const XMVECTOR dz = XMVectorSplatZ(direction);
+
+    const XMVECTOR e1x = load(packet.E1x);
+    const XMVECTOR e1y = load(packet.E1y);
+    const XMVECTOR e1z = load(packet.E1z);
+    const XMVECTOR e2x = load(packet.E2x);
+    const XMVECTOR e2y = load(packet.E2y);
+    const XMVECTOR e2z = load(packet.E2z);
+
+    // p = direction x e2, det = e1 . p
+    const XMVECTOR px = XMVectorNegativeMultiplySubtract(dz, e2y, XMVectorMultiply(dy, e2z));
+    const XMVECTOR py = XMVectorNegativeMultiplySubtract(dx, e2z, XMVectorMultiply(dz, e2x));
+    const XMVECTOR pz = XMVectorNegativeMultiplySubtract(dy, e2x, XMVectorMultiply(dx, e2y));
+    const XMVECTOR det = XMVectorMultiplyAdd(e1z, pz, XMVectorMultiplyAdd(e1y, py, XMVectorMultiply(e1x, px)));
+
+    // s = origin - v0, q = s x e1
+    const XMVECTOR sx = XMVectorSubtract(XMVectorSplatX(origin), load(packet.V0x));
+    const XMVECTOR sy = XMVectorSubtract(XMVectorSplatY(origin), load(packet.V0y));
+    const XMVECTOR sz = XMVectorSubtract(XMVectorSplatZ(origin), load(packet.V0z));
+    const XMVECTOR qx = XMVectorNegativeMultiplySubtract(sz, e1y, XMVectorMultiply(sy, e1z));
+    const XMVECTOR qy = XMVectorNegativeMultiplySubtract(sx, e1z, XMVectorMultiply(sz, e1x));
+    const XMVECTOR qz = XMVectorNegativeMultiplySubtract(sy, e1x, XMVectorMultiply(sx, e1y));
+
+    // Barycentrics and distance, all still scaled by det.
+    XMVECTOR u = XMVectorMultiplyAdd(sz, pz, XMVectorMultiplyAdd(sy, py, XMVectorMultiply(sx, px)));
+    XMVECTOR v = XMVectorMultiplyAdd(dz, qz, XMVectorMultiplyAdd(dy, qy, XMVectorMultiply(dx, qx)));
+    XMVECTOR t = XMVectorMultiplyAdd(e2z, qz, XMVectorMultiplyAdd(e2y, qy, XMVectorMultiply(e2x, qx)));
+
+    // TriangleTests::Intersects checks front and back faces with mirrored inequalities;
+    // negating u, v and t where det is negative turns both into the front face case.
+    const XMVECTOR zero = XMVectorZero();
+    const XMVECTOR backFacing = XMVectorLess(det, zero);
+    const XMVECTOR absDet = XMVectorAbs(det);
+    u = XMVectorSelect(u, XMVectorNegate(u), backFacing);
+    v = XMVectorSelect(v, XMVectorNegate(v), backFacing);
+    t = XMVectorSelect(t, XMVectorNegate(t), backFacing);
+
+    // Near-parallel rays are misses, as in DirectXCollision (g_RayEpsilon).
+    XMVECTOR hitMask = XMVectorGreaterOrEqual(absDet, XMVectorReplicate(1e-20f));
+    hitMask = XMVectorAndInt(hitMask, XMVectorGreaterOrEqual(u, zero));
+    hitMask = XMVectorAndInt(hitMask, XMVectorGreaterOrEqual(v, zero));
+    hitMask = XMVectorAndInt(hitMask, XMVectorLessOrEqual(XMVectorAdd(u, v), absDet));
+    hitMask = XMVectorAndInt(hitMask, XMVectorGreaterOrEqual(t, zero));
+
+    std::uint32_t hits[4];
+    XMStoreInt4(hits, hitMask);
+    if ((hits[0] | hits[1] | hits[2] | hits[3]) == 0)
+        return 0;
+
+    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(distances), XMVectorDivide(t, absDet));
+
+    unsigned mask = 0;
+    for (unsigned lane = 0; lane < 4; ++lane)
+    {
+        if (hits[lane] != 0)
+            mask |= 1u << lane;
+    }
+    return mask;
+}
@@ -0,0 +1,100 @@
+//***************************************************************************************
+// MeshBvh.h
+//
+// Bounding volume hierarchy over the triangles of a static mesh, for ray queries
+// such as picking.  It is built once from the CPU copies of the vertex and index
+// buffers with the surface area heuristic, and stored as a flat depth-first node
+// array so a query walks contiguous memory and skips whole subtrees that lie
+// behind the nearest hit found so far.  Leaf triangles are tested four at a time
+// against precomputed structure-of-arrays edge data.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class MeshBvh final
+{
+public:
+    struct Hit final
+    {
+        // Distance along the ray, in units of the ray direction's length.
+        float Distance = 0.0f;
+
+        // Index of the triangle within the indices the BVH was built from.
+        std::uint32_t Triangle = 0;
+    };
+
+    // Builds the hierarchy over indices.size()/3 triangles.  Positions are the first
+    // XMFLOAT3 of each vertexStride-byte vertex in vertexData, and every index is
+    // offset by baseVertex, as in DrawIndexedInstanced.
+    void Build(
+        std::span<const std::byte> vertexData,
+        std::size_t vertexStride,
+        std::span<const std::uint32_t> indices,
+        int baseVertex = 0);
+
+    bool Empty()const { return mNodes.empty(); }
+    std::size_t NodeCount()const { return mNodes.size(); }
+    std::size_t TriangleCount()const { return mTriangleCount; }
+
+    // Finds the nearest triangle hit by the ray within maxDistance.  direction must be
+    // unit length, as for DirectX::TriangleTests::Intersects.
+    bool Intersect(
+        DirectX::FXMVECTOR origin,
+        DirectX::FXMVECTOR direction,
+        float maxDistance,
+        Hit& hit)const;
+
+    // Appends every triangle hit by the ray within maxDistance to hits, in no
+    // particular order.
+    void IntersectAll(
+        DirectX::FXMVECTOR origin,
+        DirectX::FXMVECTOR direction,
+        float maxDistance,
+        std::vector<Hit>& hits)const;
+
+private:
+    // Interior nodes have TriangleCount 0; their first child follows them in the
+    // array and RightOrFirst is the index of the second.  Leaves hold TriangleCount
+    // triangles in the packets starting at RightOrFirst.
+    struct Node final
+    {
+        DirectX::XMFLOAT3 BoundsMin;
+        std::uint32_t RightOrFirst = 0;
+        DirectX::XMFLOAT3 BoundsMax;
+        std::uint32_t TriangleCount = 0;
+    };
+
+    // Four triangles as their first corner and the two edges leaving it, one array
+    // per component.  Unused lanes hold degenerate triangles, which are never hit.
+    struct TrianglePacket final
+    {
+        float V0x[4], V0y[4], V0z[4];
+        float E1x[4], E1y[4], E1z[4];
+        float E2x[4], E2y[4], E2z[4];
+        std::uint32_t Ids[4];
+    };
+
+    struct BuildTriangle;
+
+    void BuildNode(std::vector<BuildTriangle>& triangles, std::size_t first, std::size_t last, int depth);
+
+    // Tests the ray against the four triangles of packet with the same rules as
+    // DirectX::TriangleTests::Intersects.  Returns a mask with bit i set if triangle i
+    // is hit, at distances[i].
+    static unsigned IntersectPacket(
+        DirectX::FXMVECTOR origin,
+        DirectX::FXMVECTOR direction,
+        const TrianglePacket& packet,
+        float distances[4]);
+
+    std::vector<Node> mNodes;
+    std::vector<TrianglePacket> mPackets;
+    std::size_t mTriangleCount = 0;
+};
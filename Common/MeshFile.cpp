@@ -0,0 +1,567 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "MeshFile.h"
+#include "MathHelper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+using Microsoft::WRL::ComPtr;
+using namespace DirectX;
+
+namespace
+{
+    constexpr std::uint32_t MeshFileMagic = 0x48534D42; // "BMSH"
+    constexpr std::uint32_t MeshFileVersion = 1;
+    constexpr std::uint64_t BlobAlignment = 16;
+
+    struct FileHeader final
+    {
+        std::uint32_t Magic;
+        std::uint32_t Version;
+        std::uint32_t VertexCount;
+        std::uint32_t IndexCount;
+        std::uint32_t VertexByteStride;
+        std::uint32_t SubmeshCount;
+
+        // Size and write time of the text model this file was converted from.  Used to
+        // detect a stale conversion.
+        std::uint64_t SourceByteSize;
+        std::int64_t SourceWriteTime;
+
+        std::uint64_t VertexDataOffset;
+        std::uint64_t IndexDataOffset;
+        std::uint64_t SubmeshDataOffset;
+    };
+
+    struct SubmeshRecord final
+    {
+        std::uint32_t IndexCount;
+        std::uint32_t StartIndexLocation;
+        std::int32_t BaseVertexLocation;
+        std::uint32_t Pad0;
+        float BoxCenter[3];
+        float BoxExtents[3];
+        float SphereCenter[3];
+        float SphereRadius;
+        float Pad1[2];
+    };
+
+    static_assert(sizeof(MeshFile::Vertex) == 24);
+    static_assert(sizeof(FileHeader) % BlobAlignment == 0);
+    static_assert(sizeof(SubmeshRecord) % BlobAlignment == 0);
+
+    constexpr std::uint64_t AlignUp(const std::uint64_t value)
+    {
+        return (value + BlobAlignment - 1) & ~(BlobAlignment - 1);
+    }
+
+    struct SourceStamp final
+    {
+        std::uint64_t ByteSize = 0;
+        std::int64_t WriteTime = 0;
+    };
+
+    bool GetSourceStamp(const std::wstring& filename, SourceStamp& stamp)
+    {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(filename, ec);
+        if (ec)
+        {
+            return false;
+        }
+
+        const auto writeTime = std::filesystem::last_write_time(filename, ec);
+        if (ec)
+        {
+            return false;
+        }
+
+        stamp.ByteSize = size;
+        stamp.WriteTime = writeTime.time_since_epoch().count();
+        return true;
+    }
+
+    //
+    // Text model parsing.  The whole file is read at once and tokenized in place with
+    // std::from_chars, which is far cheaper than extracting one float at a time from
+    // an std::ifstream.
+    //
+
+    class TextCursor final
+    {
+    public:
+        explicit TextCursor(std::string_view text) : mText(text) {}
+
+        bool Skip(const std::string_view token)
+        {
+            const std::size_t pos = mText.find(token, mPos);
+            if (pos == std::string_view::npos)
+            {
+                return false;
+            }
+
+            mPos = pos + token.size();
+            return true;
+        }
+
+        template<typename T>
+        bool Read(T& value)
+        {
+            SkipWhitespace();
+            const char* first = mText.data() + mPos;
+            const char* last = mText.data() + mText.size();
+            const auto [ptr, ec] = std::from_chars(first, last, value);
+            if (ec != std::errc{})
+            {
+                return false;
+            }
+
+            mPos += static_cast<std::size_t>(ptr - first);
+            return true;
+        }
+
+    private:
+        void SkipWhitespace()
+        {
+            while (mPos < mText.size() &&
+                (mText[mPos] == ' ' || mText[mPos] == '\t' || mText[mPos] == '\r' || mText[mPos] == '\n'))
+            {
+                ++mPos;
+            }
+        }
+
+        std::string_view mText;
+        std::size_t mPos = 0;
+    };
+
+    bool ParseTextMesh(
+        const std::string_view text,
+        std::vector<MeshFile::Vertex>& vertices,
+        std::vector<std::uint32_t>& indices)
+    {
+        TextCursor cursor(text);
+
+        std::uint32_t vcount = 0;
+        std::uint32_t tcount = 0;
+        if (!cursor.Skip("VertexCount:") || !cursor.Read(vcount) ||
+            !cursor.Skip("TriangleCount:") || !cursor.Read(tcount))
+        {
+            return false;
+        }
+
+        vertices.resize(vcount);
+        if (!cursor.Skip("{"))
+        {
+            return false;
+        }
+
+        for (MeshFile::Vertex& v : vertices)
+        {
+            if (!cursor.Read(v.Position.x) || !cursor.Read(v.Position.y) || !cursor.Read(v.Position.z) ||
+                !cursor.Read(v.Normal.x) || !cursor.Read(v.Normal.y) || !cursor.Read(v.Normal.z))
+            {
+                return false;
+            }
+        }
+
+        indices.resize(3ull * tcount);
+        if (!cursor.Skip("}") || !cursor.Skip("{"))
+        {
+            return false;
+        }
+
+        for (std::uint32_t& index : indices)
+        {
+            if (!cursor.Read(index) || index >= vcount)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Builds the complete .bmesh image in memory.
+    std::vector<std::byte> BuildFileImage(
+        const std::vector<MeshFile::Vertex>& vertices,
+        const std::vector<std::uint32_t>& indices,
+        const SourceStamp& stamp)
+    {
+        XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
+        XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
+        XMVECTOR vMin = XMLoadFloat3(&vMinf3);
+        XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
+        for (const MeshFile::Vertex& v : vertices)
+        {
+            const XMVECTOR P = XMLoadFloat3(&v.Position);
+            vMin = XMVectorMin(vMin, P);
+            vMax = XMVectorMax(vMax, P);
+        }
+        XMStoreFloat3(&vMinf3, vMin);
+        XMStoreFloat3(&vMaxf3, vMax);
+
+        BoundingSphere sphere;
+        if (!vertices.empty())
+        {
+            BoundingSphere::CreateFromPoints(
+                sphere, vertices.size(), &vertices[0].Position, sizeof(MeshFile::Vertex));
+        }
+
+        SubmeshRecord submesh = {};
+        submesh.IndexCount = static_cast<std::uint32_t>(indices.size());
+        submesh.StartIndexLocation = 0;
+        submesh.BaseVertexLocation = 0;
+        submesh.BoxCenter[0] = 0.5f * (vMinf3.x + vMaxf3.x);
+        submesh.BoxCenter[1] = 0.5f * (vMinf3.y + vMaxf3.y);
+        submesh.BoxCenter[2] = 0.5f * (vMinf3.z + vMaxf3.z);
+        submesh.BoxExtents[0] = 0.5f * (vMaxf3.x - vMinf3.x);
+        submesh.BoxExtents[1] = 0.5f * (vMaxf3.y - vMinf3.y);
+        submesh.BoxExtents[2] = 0.5f * (vMaxf3.z - vMinf3.z);
+        submesh.SphereCenter[0] = sphere.Center.x;
+        submesh.SphereCenter[1] = sphere.Center.y;
+        submesh.SphereCenter[2] = sphere.Center.z;
+        submesh.SphereRadius = sphere.Radius;
+
+        FileHeader header = {};
+        header.Magic = MeshFileMagic;
+        header.Version = MeshFileVersion;
+        header.VertexCount = static_cast<std::uint32_t>(vertices.size());
+        header.IndexCount = static_cast<std::uint32_t>(indices.size());
+        header.VertexByteStride = sizeof(MeshFile::Vertex);
+        header.SubmeshCount = 1;
+        header.SourceByteSize = stamp.ByteSize;
+        header.SourceWriteTime = stamp.WriteTime;
+        header.VertexDataOffset = sizeof(FileHeader);
+        header.IndexDataOffset = AlignUp(header.VertexDataOffset + vertices.size() * sizeof(MeshFile::Vertex));
+        header.SubmeshDataOffset = AlignUp(header.IndexDataOffset + indices.size() * sizeof(std::uint32_t));
+
+        std::vector<std::byte> image(header.SubmeshDataOffset + sizeof(SubmeshRecord));
+        std::memcpy(image.data(), &header, sizeof(header));
+        if (!vertices.empty())
+        {
+            std::memcpy(image.data() + header.VertexDataOffset, vertices.data(), vertices.size() * sizeof(MeshFile::Vertex));
+        }
+        if (!indices.empty())
+        {
+            std::memcpy(image.data() + header.IndexDataOffset, indices.data(), indices.size() * sizeof(std::uint32_t));
+        }
+        std::memcpy(image.data() + header.SubmeshDataOffset, &submesh, sizeof(submesh));
+
+        return image;
+    }
+
+    bool ConvertToImage(const std::wstring& textFilename, std::vector<std::byte>& image)
+    {
+        SourceStamp stamp;
+        if (!GetSourceStamp(textFilename, stamp))
+        {
+            return false;
+        }
+
+        std::ifstream fin(std::filesystem::path(textFilename), std::ios::binary);
+        if (!fin)
+        {
+            return false;
+        }
+
+        std::string text(static_cast<std::size_t>(stamp.ByteSize), '\0');
+        fin.read(text.data(), static_cast<std::streamsize>(text.size()));
+        fin.close();
+
+        std::vector<MeshFile::Vertex> vertices;
+        std::vector<std::uint32_t> indices;
+        if (!ParseTextMesh(text, vertices, indices))
+        {
+            return false;
+        }
+
+        image = BuildFileImage(vertices, indices, stamp);
+        return true;
+    }
+
+    bool WriteImage(const std::wstring& filename, const std::vector<std::byte>& image)
+    {
+        std::ofstream fout(std::filesystem::path(filename), std::ios::binary | std::ios::trunc);
+        if (!fout)
+        {
+            return false;
+        }
+
+        fout.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+        fout.close();
+        return !fout.fail();
+    }
+
+    // True if count elements of stride bytes starting at offset lie within size bytes.
+    // count * stride can not overflow (both are at most 32 bits); offset + bytes can.
+    bool RangeWithin(const std::uint64_t offset, const std::uint64_t count, const std::uint64_t stride, const std::uint64_t size)
+    {
+        return offset <= size && count * stride <= size - offset;
+    }
+
+    // True if the submesh's indices lie within the index buffer and every vertex they
+    // refer to, after adding BaseVertexLocation, lies within the vertex buffer.
+    bool ValidateSubmesh(const FileHeader& header, const SubmeshRecord& record, const std::uint32_t* indices)
+    {
+        if (!RangeWithin(record.StartIndexLocation, record.IndexCount, 1, header.IndexCount))
+        {
+            return false;
+        }
+
+        if (record.IndexCount == 0)
+        {
+            return true;
+        }
+
+        const std::uint32_t* first = indices + record.StartIndexLocation;
+        const auto [minIndex, maxIndex] = std::minmax_element(first, first + record.IndexCount);
+        const std::int64_t lowest = std::int64_t(*minIndex) + record.BaseVertexLocation;
+        const std::int64_t highest = std::int64_t(*maxIndex) + record.BaseVertexLocation;
+        return lowest >= 0 && highest < std::int64_t(header.VertexCount);
+    }
+
+    const FileHeader* ValidateHeader(const std::byte* data, const std::uint64_t size)
+    {
+        if (size < sizeof(FileHeader))
+        {
+            return nullptr;
+        }
+
+        const auto* header = reinterpret_cast<const FileHeader*>(data);
+        if (header->Magic != MeshFileMagic ||
+            header->Version != MeshFileVersion ||
+            header->VertexByteStride != sizeof(MeshFile::Vertex))
+        {
+            return nullptr;
+        }
+
+        if (!RangeWithin(header->VertexDataOffset, header->VertexCount, sizeof(MeshFile::Vertex), size) ||
+            !RangeWithin(header->IndexDataOffset, header->IndexCount, sizeof(std::uint32_t), size) ||
+            !RangeWithin(header->SubmeshDataOffset, header->SubmeshCount, sizeof(SubmeshRecord), size) ||
+            header->VertexDataOffset % BlobAlignment != 0 ||
+            header->IndexDataOffset % BlobAlignment != 0 ||
+            header->SubmeshDataOffset % BlobAlignment != 0)
+        {
+            return nullptr;
+        }
+
+        // A bad submesh would have the GPU read past the end of a buffer.
+        const auto* indices = reinterpret_cast<const std::uint32_t*>(data + header->IndexDataOffset);
+        const auto* records = reinterpret_cast<const SubmeshRecord*>(data + header->SubmeshDataOffset);
+        for (std::uint32_t i = 0; i < header->SubmeshCount; ++i)
+        {
+            if (!ValidateSubmesh(*header, records[i], indices))
+            {
+                return nullptr;
+            }
+        }
+
+        return header;
+    }
+
+    // ID3DBlob that aliases a range of a MappedFile instead of owning a copy.
+    class MappedBlob final : public ID3DBlob
+    {
+    public:
+        MappedBlob(std::shared_ptr<const MappedFile> file, const void* data, const SIZE_T size)
+            : mFile(std::move(file)),
+              mData(data),
+              mSize(size)
+        {}
+
+        MappedBlob(const MappedBlob& rhs) = delete;
+        MappedBlob& operator=(const MappedBlob& rhs) = delete;
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+        {
+            if (ppvObject == nullptr)
+            {
+                return E_POINTER;
+            }
+
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D10Blob))
+            {
+                AddRef();
+                *ppvObject = static_cast<ID3DBlob*>(this);
+                return S_OK;
+            }
+
+            *ppvObject = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return ++mRefCount;
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            const ULONG count = --mRefCount;
+            if (count == 0)
+            {
+                delete this;
+            }
+            return count;
+        }
+
+        // ID3DBlob has no notion of read-only memory.  The mapping is read-only, so
+        // callers must treat the pointer as const (MeshGeometry's CPU copies already do).
+        LPVOID STDMETHODCALLTYPE GetBufferPointer() override
+        {
+            return const_cast<void*>(mData);
+        }
+
+        SIZE_T STDMETHODCALLTYPE GetBufferSize() override
+        {
+            return mSize;
+        }
+
+    private:
+        ~MappedBlob() = default;
+
+        std::atomic<ULONG> mRefCount = 1;
+        std::shared_ptr<const MappedFile> mFile;
+        const void* mData = nullptr;
+        SIZE_T mSize = 0;
+    };
+}
+
+ComPtr<ID3DBlob> MeshFile::MappedMesh::VertexBlob()const
+{
+    ComPtr<ID3DBlob> blob;
+    blob.Attach(new MappedBlob(mFile, mVertices.data(), mVertices.size_bytes()));
+    return blob;
+}
+
+ComPtr<ID3DBlob> MeshFile::MappedMesh::IndexBlob()const
+{
+    ComPtr<ID3DBlob> blob;
+    blob.Attach(new MappedBlob(mFile, mIndices.data(), mIndices.size_bytes()));
+    return blob;
+}
+
+std::wstring MeshFile::BinaryFilename(const std::wstring& textFilename)
+{
+    std::filesystem::path path(textFilename);
+    path.replace_extension(L".bmesh");
+    return path.wstring();
+}
+
+bool MeshFile::ConvertTextMesh(const std::wstring& textFilename, const std::wstring& binaryFilename)
+{
+    std::vector<std::byte> image;
+    if (!ConvertToImage(textFilename, image))
+    {
+        return false;
+    }
+
+    return WriteImage(binaryFilename, image);
+}
+
+MeshFile::MappedMesh MeshFile::MappedMesh::FromFile(std::shared_ptr<const MappedFile> file)
+{
+    if (file == nullptr)
+    {
+        return {};
+    }
+
+    const FileHeader* header = ValidateHeader(file->Data(), file->Size());
+    if (header == nullptr)
+    {
+        return {};
+    }
+
+    MappedMesh mesh;
+    mesh.mVertices = std::span<const Vertex>(
+        reinterpret_cast<const Vertex*>(file->Data() + header->VertexDataOffset),
+        header->VertexCount);
+    mesh.mIndices = std::span<const std::uint32_t>(
+        reinterpret_cast<const std::uint32_t*>(file->Data() + header->IndexDataOffset),
+        header->IndexCount);
+
+    const auto* records = reinterpret_cast<const SubmeshRecord*>(file->Data() + header->SubmeshDataOffset);
+    mesh.mSubmeshes.resize(header->SubmeshCount);
+    for (std::uint32_t i = 0; i < header->SubmeshCount; ++i)
+    {
+        const SubmeshRecord& record = records[i];
+        Submesh& submesh = mesh.mSubmeshes[i];
+        submesh.IndexCount = record.IndexCount;
+        submesh.StartIndexLocation = record.StartIndexLocation;
+        submesh.BaseVertexLocation = record.BaseVertexLocation;
+        submesh.Box.Center = XMFLOAT3(record.BoxCenter);
+        submesh.Box.Extents = XMFLOAT3(record.BoxExtents);
+        submesh.Sphere.Center = XMFLOAT3(record.SphereCenter);
+        submesh.Sphere.Radius = record.SphereRadius;
+    }
+
+    mesh.mFile = std::move(file);
+    return mesh;
+}
+
+MeshFile::MappedMesh MeshFile::Load(const std::wstring& binaryFilename)
+{
+    return MappedMesh::FromFile(MappedFile::Open(binaryFilename));
+}
+
+MeshFile::MappedMesh MeshFile::LoadOrConvert(const std::wstring& textFilename)
+{
+    const std::wstring binaryFilename = BinaryFilename(textFilename);
+
+    SourceStamp stamp;
+    const bool hasSource = GetSourceStamp(textFilename, stamp);
+
+    MappedMesh mesh = Load(binaryFilename);
+    if (mesh.IsValid())
+    {
+        // Without the text model the binary file is all we have, so use it as is.
+        if (!hasSource)
+        {
+            return mesh;
+        }
+
+        const auto* header = reinterpret_cast<const FileHeader*>(mesh.mFile->Data());
+        if (header->SourceByteSize == stamp.ByteSize && header->SourceWriteTime == stamp.WriteTime)
+        {
+            return mesh;
+        }
+
+        // Release the mapping so the stale file can be overwritten.
+        mesh = {};
+    }
+
+    std::vector<std::byte> image;
+    if (!hasSource || !ConvertToImage(textFilename, image))
+    {
+        return {};
+    }
+
+    if (WriteImage(binaryFilename, image))
+    {
+        mesh = Load(binaryFilename);
+        if (mesh.IsValid())
+        {
+            return mesh;
+        }
+    }
+
+    // The file could not be written (read-only directory, or another process has the
+    // old version mapped); serve the converted image from memory.
+    return MappedMesh::FromFile(MappedFile::FromMemory(std::move(image)));
+}
+
+AssetCache::Handle<MeshFile::MappedMesh> MeshFile::LoadCached(const std::wstring& textFilename, AssetCache& cache)
+{
+    return cache.Get<MappedMesh>(textFilename, [](const std::wstring& path, MappedMesh& mesh)
+    {
+        mesh = LoadOrConvert(path);
+        return mesh.File();
+    });
+}
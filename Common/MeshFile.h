@@ -0,0 +1,111 @@
+//***************************************************************************************
+// MeshFile.h
+//
+// Compact binary container for the static meshes shipped with the demos (skull.txt,
+// car.txt).  The text models are converted once into a .bmesh file next to them:
+//
+//   FileHeader | Vertex[VertexCount] | uint32[IndexCount] | SubmeshRecord[SubmeshCount]
+//
+// Every blob starts on a 16 byte boundary.  Loading memory-maps the file, so the
+// vertex and index data can be handed to MeshGeometry::VertexBufferCPU/IndexBufferCPU
+// and d3dUtil::CreateDefaultBuffer without parsing or copying each element.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <DirectXCollision.h>
+
+#include "AssetCache.h"
+#include "MappedFile.h"
+
+namespace MeshFile
+{
+    // Layout of a vertex as stored in the text models (pos, normal).
+    struct Vertex final
+    {
+        DirectX::XMFLOAT3 Position;
+        DirectX::XMFLOAT3 Normal;
+    };
+
+    struct Submesh final
+    {
+        UINT IndexCount = 0;
+        UINT StartIndexLocation = 0;
+        INT BaseVertexLocation = 0;
+
+        // Precomputed at conversion time so loading does not need a pass over the vertices.
+        DirectX::BoundingBox Box;
+        DirectX::BoundingSphere Sphere;
+    };
+
+    // Read-only view of a loaded .bmesh file.  Spans and blobs handed out by this
+    // class point into the file mapping, which stays alive as long as any of them do.
+    class MappedMesh final
+    {
+    public:
+        MappedMesh() = default;
+
+        bool IsValid()const { return mFile != nullptr; }
+
+        std::span<const Vertex> Vertices()const { return mVertices; }
+        std::span<const std::uint32_t> Indices()const { return mIndices; }
+        const std::vector<Submesh>& Submeshes()const { return mSubmeshes; }
+
+        UINT VertexBufferByteSize()const { return static_cast<UINT>(mVertices.size_bytes()); }
+        UINT IndexBufferByteSize()const { return static_cast<UINT>(mIndices.size_bytes()); }
+
+        // Blobs aliasing the mapped data.  Suitable for MeshGeometry::VertexBufferCPU and
+        // MeshGeometry::IndexBufferCPU; no copy is made.
+        Microsoft::WRL::ComPtr<ID3DBlob> VertexBlob()const;
+        Microsoft::WRL::ComPtr<ID3DBlob> IndexBlob()const;
+
+        const std::shared_ptr<const MappedFile>& File()const { return mFile; }
+
+    private:
+        friend MappedMesh Load(const std::wstring& binaryFilename);
+        friend MappedMesh LoadOrConvert(const std::wstring& textFilename);
+
+        static MappedMesh FromFile(std::shared_ptr<const MappedFile> file);
+
+        std::shared_ptr<const MappedFile> mFile;
+        std::span<const Vertex> mVertices;
+        std::span<const std::uint32_t> mIndices;
+        std::vector<Submesh> mSubmeshes;
+    };
+
+    // Returns the .bmesh filename used for the given text model.
+    std::wstring BinaryFilename(const std::wstring& textFilename);
+
+    // Parses a text model (VertexCount/TriangleCount/VertexList/TriangleList) and writes
+    // it as a .bmesh file.  Returns false if the source can not be read or is malformed.
+    bool ConvertTextMesh(const std::wstring& textFilename, const std::wstring& binaryFilename);
+
+    // Maps a .bmesh file.  Returns an invalid mesh if the file is missing or corrupt.
+    MappedMesh Load(const std::wstring& binaryFilename);
+
+    // Maps the .bmesh file converted from textFilename, (re)converting it first if it is
+    // missing or older than the text model.  Returns an invalid mesh if neither file exists.
+    MappedMesh LoadOrConvert(const std::wstring& textFilename);
+
+    // LoadOrConvert through cache, so every load of the same model shares one mapping.
+    // Returns nullptr if neither file exists.
+    AssetCache::Handle<MappedMesh> LoadCached(const std::wstring& textFilename,
+        AssetCache& cache = AssetCache::Default());
+}
@@ -0,0 +1,129 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "Picking.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace DirectX;
+
+namespace
+{
+    // The view ray moved into one target's local space.  The direction is renormalized
+    // for the intersection tests; a local distance divided by Scale is the distance
+    // along the view ray.
+    struct LocalRay final
+    {
+        XMVECTOR Origin;
+        XMVECTOR Direction;
+        float Scale;
+    };
+
+    LocalRay ToLocal(FXMMATRIX invView, const Picking::Ray& viewRay, const Picking::Target& target)
+    {
+        const XMMATRIX toLocal = XMMatrixMultiply(invView, XMLoadFloat4x4(&target.InvWorld));
+
+        const XMVECTOR direction = XMVector3TransformNormal(XMLoadFloat3(&viewRay.Direction), toLocal);
+        const float scale = XMVectorGetX(XMVector3Length(direction));
+
+        LocalRay ray;
+        ray.Origin = XMVector3TransformCoord(XMLoadFloat3(&viewRay.Origin), toLocal);
+        ray.Direction = XMVectorScale(direction, 1.0f / scale);
+        ray.Scale = scale;
+        return ray;
+    }
+}
+
+Picking::Ray Picking::ViewSpaceRay(
+    const int sx,
+    const int sy,
+    const int clientWidth,
+    const int clientHeight,
+    const XMFLOAT4X4& proj)
+{
+    // Point on the z = 1 plane that projects to the pixel.
+    const float vx = (+2.0f * sx / clientWidth - 1.0f) / proj(0, 0);
+    const float vy = (-2.0f * sy / clientHeight + 1.0f) / proj(1, 1);
+
+    Ray ray;
+    XMStoreFloat3(&ray.Direction, XMVector3Normalize(XMVectorSet(vx, vy, 1.0f, 0.0f)));
+    return ray;
+}
+
+bool Picking::Nearest(
+    FXMMATRIX invView,
+    const Ray& viewRay,
+    const std::span<const Target> targets,
+    Hit& hit)
+{
+    float nearest = std::numeric_limits<float>::infinity();
+    bool found = false;
+
+    for (std::size_t i = 0; i < targets.size(); ++i)
+    {
+        const Target& target = targets[i];
+        if (target.Bvh == nullptr)
+            continue;
+
+        const LocalRay ray = ToLocal(invView, viewRay, target);
+
+        // Skip the triangles if the box is missed or only entered beyond the nearest hit.
+        float boxDistance = 0.0f;
+        if (!target.Bounds.Intersects(ray.Origin, ray.Direction, boxDistance) ||
+            boxDistance / ray.Scale >= nearest)
+            continue;
+
+        MeshBvh::Hit meshHit;
+        if (target.Bvh->Intersect(ray.Origin, ray.Direction, nearest * ray.Scale, meshHit))
+        {
+            nearest = meshHit.Distance / ray.Scale;
+            hit.Target = i;
+            hit.Triangle = meshHit.Triangle;
+            hit.Distance = nearest;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void Picking::All(
+    FXMMATRIX invView,
+    const Ray& viewRay,
+    const std::span<const Target> targets,
+    std::vector<Hit>& hits)
+{
+    hits.clear();
+
+    std::vector<MeshBvh::Hit> meshHits;
+    for (std::size_t i = 0; i < targets.size(); ++i)
+    {
+        const Target& target = targets[i];
+        if (target.Bvh == nullptr)
+            continue;
+
+        const LocalRay ray = ToLocal(invView, viewRay, target);
+
+        float boxDistance = 0.0f;
+        if (!target.Bounds.Intersects(ray.Origin, ray.Direction, boxDistance))
+            continue;
+
+        meshHits.clear();
+        target.Bvh->IntersectAll(ray.Origin, ray.Direction, std::numeric_limits<float>::infinity(), meshHits);
+        for (const MeshBvh::Hit& meshHit : meshHits)
+        {
+            hits.push_back(Hit{ i, meshHit.Triangle, meshHit.Distance / ray.Scale });
+        }
+    }
+
+    // Ties are broken by target and triangle so the order does not depend on traversal.
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b)
+    {
+        if (a.Distance != b.Distance)
+            return a.Distance < b.Distance;
+        if (a.Target != b.Target)
+            return a.Target < b.Target;
+        return a.Triangle < b.Triangle;
+    });
+}
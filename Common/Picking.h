@@ -0,0 +1,70 @@
+//***************************************************************************************
+// Picking.h
+//
+// Ray picking against several transformed meshes.  The picking ray is built once in
+// view space and never modified; each target gets its own copy moved into its local
+// space through a cached world inverse, and hit distances are reported in view space
+// so hits on differently scaled objects can be compared and sorted.
+//***************************************************************************************
+
+#pragma once
+
+#include "MeshBvh.h"
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Picking
+{
+    // Ray in view space.  Direction is unit length.
+    struct Ray final
+    {
+        DirectX::XMFLOAT3 Origin = { 0.0f, 0.0f, 0.0f };
+        DirectX::XMFLOAT3 Direction = { 0.0f, 0.0f, 1.0f };
+    };
+
+    struct Target final
+    {
+        // World space to the object's local space, i.e. the inverse of its world matrix.
+        DirectX::XMFLOAT4X4 InvWorld;
+
+        // Local space bounds and triangles.
+        DirectX::BoundingBox Bounds;
+        const MeshBvh* Bvh = nullptr;
+    };
+
+    struct Hit final
+    {
+        // Index into the targets the query was given.
+        std::size_t Target = 0;
+
+        // Triangle of the target's MeshBvh.
+        std::uint32_t Triangle = 0;
+
+        // Distance from the ray origin in view space.
+        float Distance = 0.0f;
+    };
+
+    // Ray from the eye through pixel (sx, sy) of a clientWidth x clientHeight view.
+    Ray ViewSpaceRay(int sx, int sy, int clientWidth, int clientHeight, const DirectX::XMFLOAT4X4& proj);
+
+    // Finds the nearest triangle hit over all targets.  invView takes view space to
+    // world space (Camera::GetInvView).
+    bool Nearest(
+        DirectX::FXMMATRIX invView,
+        const Ray& viewRay,
+        std::span<const Target> targets,
+        Hit& hit);
+
+    // Replaces hits with every triangle hit over all targets, nearest first.
+    void All(
+        DirectX::FXMMATRIX invView,
+        const Ray& viewRay,
+        std::span<const Target> targets,
+        std::vector<Hit>& hits);
+}
@@ -0,0 +1,242 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "Profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Zone final
+    {
+        const char* Name = nullptr;
+        std::uint64_t StartUs = 0;
+        std::uint64_t EndUs = 0;
+    };
+
+    // A thread's zones are kept in chunks allocated as it records, so threads that
+    // record little, or never, hold little memory.
+    constexpr std::size_t kZonesPerChunk = 1024;
+    constexpr std::size_t kChunksPerThread = 64;
+    constexpr std::size_t kZonesPerThread = kZonesPerChunk * kChunksPerThread;
+
+    // Zones of one thread.  Only the owning thread writes; it publishes each zone, and
+    // the chunk it went into, by storing the new Count with release order, so a reader
+    // that loads Count with acquire order sees complete zones.  Chunks are allocated in
+    // order and kept across captures; ChunkCount says how many there are, so the memory
+    // held can be read without touching Chunks while the thread records.
+    struct ThreadBuffer final
+    {
+        std::unique_ptr<Zone[]> Chunks[kChunksPerThread];
+        std::atomic<std::size_t> ChunkCount = 0;
+        std::atomic<std::size_t> Count = 0;
+        std::atomic<std::uint64_t> Dropped = 0;
+
+        // Capture the zones belong to.  A thread empties its own buffer when it first
+        // records into a new capture, so starting a capture never writes to the
+        // buffers of other threads.
+        std::atomic<std::uint32_t> Capture = 0;
+
+        // Set when the thread exits.  The buffer is kept until the next capture starts,
+        // so the zones of a finished worker can still be written out.
+        std::atomic<bool> Retired = false;
+
+        std::atomic<const char*> Name = nullptr;
+        std::uint32_t ThreadId = 0;
+
+        const Zone& At(const std::size_t i)const { return Chunks[i / kZonesPerChunk][i % kZonesPerChunk]; }
+    };
+
+    const Clock::time_point gEpoch = Clock::now();
+
+    std::atomic<bool> gCapturing = false;
+    std::atomic<std::uint32_t> gCapture = 0;
+
+    std::mutex gBuffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> gBuffers;
+    std::uint32_t gNextThreadId = 1;
+
+    // Marks the thread's buffer retired when the thread exits.
+    struct BufferOwner final
+    {
+        ThreadBuffer* Buffer = nullptr;
+
+        ~BufferOwner()
+        {
+            if (Buffer != nullptr)
+                Buffer->Retired.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local BufferOwner tOwner;
+
+    ThreadBuffer& LocalBuffer()
+    {
+        if (tOwner.Buffer == nullptr)
+        {
+            auto buffer = std::make_unique<ThreadBuffer>();
+
+            const std::lock_guard lock(gBuffersMutex);
+            buffer->ThreadId = gNextThreadId++;
+            tOwner.Buffer = buffer.get();
+            gBuffers.push_back(std::move(buffer));
+        }
+        return *tOwner.Buffer;
+    }
+
+    void WriteJsonString(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for (; *text != '\0'; ++text)
+        {
+            if (*text == '"' || *text == '\\')
+                out << '\\';
+            out << *text;
+        }
+        out << '"';
+    }
+}
+
+void Profiler::BeginCapture()
+{
+    // The zones of exited threads belong to the capture being dropped, so their
+    // buffers go now.
+    {
+        const std::lock_guard lock(gBuffersMutex);
+        std::erase_if(gBuffers, [](const std::unique_ptr<ThreadBuffer>& buffer)
+        {
+            return buffer->Retired.load(std::memory_order_acquire);
+        });
+    }
+
+    gCapture.fetch_add(1, std::memory_order_relaxed);
+    gCapturing.store(true, std::memory_order_release);
+}
+
+void Profiler::EndCapture()
+{
+    gCapturing.store(false, std::memory_order_release);
+}
+
+bool Profiler::Capturing()
+{
+    return gCapturing.load(std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(const char* const name)
+{
+    LocalBuffer().Name.store(name, std::memory_order_relaxed);
+}
+
+std::uint64_t Profiler::DroppedZones()
+{
+    const std::uint32_t capture = gCapture.load(std::memory_order_relaxed);
+
+    std::uint64_t dropped = 0;
+    const std::lock_guard lock(gBuffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : gBuffers)
+    {
+        if (buffer->Capture.load(std::memory_order_acquire) == capture)
+            dropped += buffer->Dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+std::size_t Profiler::ZoneBufferBytes()
+{
+    std::size_t bytes = 0;
+    const std::lock_guard lock(gBuffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : gBuffers)
+    {
+        bytes += sizeof(ThreadBuffer) + buffer->ChunkCount.load(std::memory_order_relaxed) * kZonesPerChunk * sizeof(Zone);
+    }
+    return bytes;
+}
+
+std::uint64_t Profiler::NowMicroseconds()
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - gEpoch).count());
+}
+
+void Profiler::RecordZone(const char* const name, const std::uint64_t startUs, const std::uint64_t endUs)
+{
+    ThreadBuffer& buffer = LocalBuffer();
+
+    const std::uint32_t capture = gCapture.load(std::memory_order_relaxed);
+    if (buffer.Capture.load(std::memory_order_relaxed) != capture)
+    {
+        buffer.Count.store(0, std::memory_order_relaxed);
+        buffer.Dropped.store(0, std::memory_order_relaxed);
+        buffer.Capture.store(capture, std::memory_order_release);
+    }
+
+    const std::size_t count = buffer.Count.load(std::memory_order_relaxed);
+    if (count == kZonesPerThread)
+    {
+        buffer.Dropped.store(buffer.Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::unique_ptr<Zone[]>& chunk = buffer.Chunks[count / kZonesPerChunk];
+    if (chunk == nullptr)
+    {
+        chunk = std::make_unique<Zone[]>(kZonesPerChunk);
+        buffer.ChunkCount.store(count / kZonesPerChunk + 1, std::memory_order_relaxed);
+    }
+
+    chunk[count % kZonesPerChunk] = Zone{ name, startUs, endUs };
+    buffer.Count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::WriteChromeTrace(std::ostream& out)
+{
+    const std::uint32_t capture = gCapture.load(std::memory_order_relaxed);
+    bool first = true;
+
+    const auto separator = [&first, &out]()
+    {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    const std::lock_guard lock(gBuffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : gBuffers)
+    {
+        if (const char* name = buffer->Name.load(std::memory_order_relaxed))
+        {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ThreadId << ",\"args\":{\"name\":";
+            WriteJsonString(out, name);
+            out << "}}";
+        }
+
+        if (buffer->Capture.load(std::memory_order_acquire) != capture)
+            continue;
+
+        const std::size_t count = buffer->Count.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Zone& zone = buffer->At(i);
+
+            // Complete events: a start time and a duration, in microseconds.
+            separator();
+            out << "{\"name\":";
+            WriteJsonString(out, zone.Name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadId
+                << ",\"ts\":" << zone.StartUs
+                << ",\"dur\":" << zone.EndUs - zone.StartUs << '}';
+        }
+    }
+
+    out << "\n]}\n";
+}
@@ -0,0 +1,90 @@
+//***************************************************************************************
+// Profiler.h
+//
+// Scoped CPU timing zones.  PROFILE_SCOPE("name") times the rest of the enclosing
+// block while a capture is running.  Each thread appends its zones to a buffer of
+// its own, so recording takes no locks; the buffers are read when the capture is
+// written out as Chrome trace JSON, which chrome://tracing and ui.perfetto.dev open.
+// A buffer grows in chunks as its thread records, and the buffers of threads that
+// have exited are freed when the next capture begins.
+//
+// Define ENABLE_PROFILING as 0 to compile every zone out.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#ifndef ENABLE_PROFILING
+#define ENABLE_PROFILING 1
+#endif
+
+namespace Profiler
+{
+    // Starts recording zones, dropping those of the previous capture.  Zones that are
+    // open on other threads at that moment may be lost.
+    void BeginCapture();
+
+    // Stops recording.  Zones still open finish unrecorded.
+    void EndCapture();
+
+    bool Capturing();
+
+    // Names the calling thread in the trace.  name must outlive the profiler.
+    void SetThreadName(const char* name);
+
+    // Zones that did not fit in their thread's buffer during the last capture.
+    std::uint64_t DroppedZones();
+
+    // Memory held by the zone buffers of all threads.  Safe to call while other threads
+    // record.
+    std::size_t ZoneBufferBytes();
+
+    // Writes the zones of the last capture.  Call after EndCapture, once the other
+    // threads have closed their zones.
+    void WriteChromeTrace(std::ostream& out);
+
+    // Microseconds on the profiler's clock.
+    std::uint64_t NowMicroseconds();
+
+    // Records a finished zone on the calling thread.  name must be a string literal
+    // or otherwise outlive the capture.
+    void RecordZone(const char* name, std::uint64_t startUs, std::uint64_t endUs);
+}
+
+class ProfileZone final
+{
+public:
+    explicit ProfileZone(const char* name)
+        : mName(name)
+        , mActive(Profiler::Capturing())
+    {
+        if (mActive)
+            mStartUs = Profiler::NowMicroseconds();
+    }
+
+    ProfileZone(const ProfileZone& rhs) = delete;
+    ProfileZone& operator=(const ProfileZone& rhs) = delete;
+
+    ~ProfileZone()
+    {
+        if (mActive)
+            Profiler::RecordZone(mName, mStartUs, Profiler::NowMicroseconds());
+    }
+
+private:
+    const char* mName = nullptr;
+    std::uint64_t mStartUs = 0;
+    bool mActive = false;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ENABLE_PROFILING
+#define PROFILE_SCOPE(name) const ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
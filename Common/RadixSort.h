@@ -0,0 +1,74 @@
+//***************************************************************************************
+// RadixSort.h
+//
+// Stable least significant digit first radix sort of unsigned integer keys that carry
+// an index each, as used to order draws by sort key and render items by depth.  The
+// digits are bytes; all histograms come from one read of the keys, and the passes over
+// bytes that every key shares are skipped.
+//***************************************************************************************
+
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template<std::unsigned_integral KeyT>
+class RadixSorter final
+{
+public:
+    // Sorts keys ascending and applies the same permutation to indices, which must be
+    // as long as keys.  Equal keys keep their relative order.
+    void Sort(std::vector<KeyT>& keys, std::vector<std::uint32_t>& indices)
+    {
+        const std::size_t count = keys.size();
+        if (count < 2)
+            return;
+
+        std::array<std::array<std::uint32_t, Buckets>, Digits> histograms = {};
+        for (const KeyT key : keys)
+        {
+            for (int digit = 0; digit < Digits; ++digit)
+                ++histograms[digit][(key >> (digit * 8)) & (Buckets - 1)];
+        }
+
+        mScratchKeys.resize(count);
+        mScratchIndices.resize(count);
+
+        for (int digit = 0; digit < Digits; ++digit)
+        {
+            std::array<std::uint32_t, Buckets>& histogram = histograms[digit];
+
+            const int shift = digit * 8;
+            if (histogram[(keys[0] >> shift) & (Buckets - 1)] == count)
+                continue;
+
+            std::uint32_t offset = 0;
+            for (std::uint32_t& bucket : histogram)
+            {
+                const std::uint32_t bucketSize = bucket;
+                bucket = offset;
+                offset += bucketSize;
+            }
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const std::uint32_t destination = histogram[(keys[i] >> shift) & (Buckets - 1)]++;
+                mScratchKeys[destination] = keys[i];
+                mScratchIndices[destination] = indices[i];
+            }
+
+            keys.swap(mScratchKeys);
+            indices.swap(mScratchIndices);
+        }
+    }
+
+private:
+    static constexpr std::size_t Buckets = 256;
+    static constexpr int Digits = sizeof(KeyT);
+
+    std::vector<KeyT> mScratchKeys;
+    std::vector<std::uint32_t> mScratchIndices;
+};
@@ -0,0 +1,94 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "TextureLoader.h"
+#include "Profiler.h"
+
+#include <chrono>
+
+TextureLoader::TextureLoader(ThreadPool& pool)
+    : mPool(pool)
+{
+}
+
+std::shared_future<TextureLoader::TexturePtr> TextureLoader::Load(std::string name, std::wstring filename)
+{
+    auto texture = std::make_shared<LoadedTexture>();
+    texture->Name = std::move(name);
+    texture->Filename = std::move(filename);
+
+    auto promise = std::make_shared<std::promise<TexturePtr>>();
+    std::shared_future<TexturePtr> future = promise->get_future().share();
+
+    {
+        std::lock_guard lock(mState->Mutex);
+        ++mState->Loading;
+    }
+
+    auto job = [state = mState, texture, promise]
+    {
+        PROFILE_SCOPE("TextureLoader::Load");
+
+        const auto start = std::chrono::steady_clock::now();
+        try
+        {
+            texture->Asset = DDSFile::LoadCached(texture->Filename, texture->Result);
+        }
+        catch (...)
+        {
+            // Thrown out of a pool job it would end the process, and WaitIdle would
+            // never see Loading drop.  It goes to the app with the texture instead.
+            texture->Asset = nullptr;
+            texture->Exception = std::current_exception();
+        }
+        texture->LoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard lock(state->Mutex);
+            --state->Loading;
+            state->Ready.push_back(texture);
+        }
+        state->Finished.notify_all();
+
+        promise->set_value(texture);
+    };
+
+    // Without workers nobody would ever pick the job up.
+    if (mPool.WorkerCount() == 0)
+    {
+        job();
+    }
+    else
+    {
+        mPool.Submit(std::move(job));
+    }
+
+    return future;
+}
+
+std::size_t TextureLoader::Poll(const Callback& onReady)
+{
+    std::deque<TexturePtr> ready;
+    {
+        std::lock_guard lock(mState->Mutex);
+        ready.swap(mState->Ready);
+    }
+
+    for (const TexturePtr& texture : ready)
+    {
+        onReady(texture);
+    }
+    return ready.size();
+}
+
+std::size_t TextureLoader::Pending()const
+{
+    std::lock_guard lock(mState->Mutex);
+    return mState->Loading + mState->Ready.size();
+}
+
+void TextureLoader::WaitIdle()const
+{
+    std::unique_lock lock(mState->Mutex);
+    mState->Finished.wait(lock, [this] { return mState->Loading == 0; });
+}
@@ -0,0 +1,89 @@
+//***************************************************************************************
+// TextureLoader.h
+//
+// Maps and parses DDS files on a ThreadPool so an app can start drawing with
+// placeholder textures while the real ones load.  Files go through AssetCache, so a
+// file that is loaded already is not mapped again.  Every request yields a future, and
+// Poll hands the finished textures to a callback on the calling thread, which is where
+// the D3D upload belongs.  Nothing here touches the device.
+//***************************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "DDSFile.h"
+#include "ThreadPool.h"
+
+struct LoadedTexture final
+{
+    std::string Name;
+    std::wstring Filename;
+
+    DDSFile::Result Result = DDSFile::Result::Ok;
+
+    // Set if the load threw, e.g. std::bad_alloc.  The texture is still handed out,
+    // so the app can keep its placeholder.
+    std::exception_ptr Exception;
+
+    // Shared with every other load of the same file through AssetCache::Default();
+    // nullptr unless Succeeded.
+    AssetCache::Handle<DDSFile::Texture> Asset;
+
+    bool Succeeded()const { return Exception == nullptr && Result == DDSFile::Result::Ok && Asset != nullptr; }
+
+    // Subresource views into the mapped file.
+    const DDSFile::Texture& Texture()const { return Asset->Value; }
+
+    // Time spent mapping and parsing on the worker.
+    double LoadMs = 0.0;
+};
+
+class TextureLoader final
+{
+public:
+    using TexturePtr = std::shared_ptr<const LoadedTexture>;
+    using Callback = std::function<void(const TexturePtr&)>;
+
+    explicit TextureLoader(ThreadPool& pool = ThreadPool::Default());
+    TextureLoader(const TextureLoader& rhs) = delete;
+    TextureLoader& operator=(const TextureLoader& rhs) = delete;
+
+    // Queues filename for loading.  The future is ready as soon as a worker has parsed
+    // the file or failed to, whichever way it failed; the texture is also queued for
+    // the next Poll.
+    std::shared_future<TexturePtr> Load(std::string name, std::wstring filename);
+
+    // Calls onReady for each texture finished since the last call, in completion
+    // order, and returns how many there were.  Holding on to the pointer keeps the
+    // file mapped, which is what a streamer that uploads more mips later needs.
+    std::size_t Poll(const Callback& onReady);
+
+    // Requests that have not been handed out by Poll yet, finished or not.
+    std::size_t Pending()const;
+
+    // Blocks until every queued request has finished loading.
+    void WaitIdle()const;
+
+private:
+    struct SharedState final
+    {
+        mutable std::mutex Mutex;
+        mutable std::condition_variable Finished;
+        std::deque<TexturePtr> Ready;
+        std::size_t Loading = 0;
+    };
+
+    ThreadPool& mPool;
+
+    // Shared with the jobs, so the loader may be destroyed with loads in flight.
+    std::shared_ptr<SharedState> mState = std::make_shared<SharedState>();
+};
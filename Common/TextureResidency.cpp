@@ -0,0 +1,160 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cassert>
+
+TextureResidency::TextureResidency(const std::uint64_t budgetBytes)
+    : mBudget(budgetBytes)
+{
+}
+
+TextureResidency::TextureId TextureResidency::Add(std::vector<std::uint64_t> mipBytes, const std::uint32_t tailMip)
+{
+    assert(!mipBytes.empty());
+
+    Entry& entry = mEntries.emplace_back();
+    entry.BytesFrom.assign(mipBytes.size() + 1, 0);
+    for (std::size_t mip = mipBytes.size(); mip-- > 0;)
+    {
+        entry.BytesFrom[mip] = entry.BytesFrom[mip + 1] + mipBytes[mip];
+    }
+
+    entry.TailMip = std::min<std::uint32_t>(tailMip, std::uint32_t(mipBytes.size() - 1));
+    entry.ResidentMip = entry.TailMip;
+    entry.LastUsedFrame = mFrame;
+    mResidentBytes += entry.BytesFrom[entry.TailMip];
+
+    return TextureId(mEntries.size() - 1);
+}
+
+void TextureResidency::Request(const TextureId id, const std::uint32_t mip)
+{
+    Entry& entry = mEntries[id];
+    entry.RequestedMip = std::min(entry.RequestedMip, mip);
+}
+
+void TextureResidency::SetResidentMip(Entry& entry, const std::uint32_t mip)
+{
+    mResidentBytes = mResidentBytes - entry.BytesFrom[entry.ResidentMip] + entry.BytesFrom[mip];
+    entry.ResidentMip = mip;
+}
+
+std::uint32_t TextureResidency::EvictionFloor(const Entry& entry, const bool spareRequested)const
+{
+    // Textures drawn this frame only give up mips finer than they asked for.
+    if (!spareRequested || entry.RequestedMip == NoRequest)
+        return entry.TailMip;
+    return std::max(entry.RequestedMip, entry.ResidentMip);
+}
+
+std::uint64_t TextureResidency::EvictableBytes(const TextureId keep)const
+{
+    std::uint64_t bytes = 0;
+    for (std::size_t i = 0; i < mEntries.size(); ++i)
+    {
+        const Entry& entry = mEntries[i];
+        if (i != keep)
+            bytes += entry.BytesFrom[entry.ResidentMip] - entry.BytesFrom[EvictionFloor(entry, true)];
+    }
+    return bytes;
+}
+
+bool TextureResidency::MakeRoom(const std::uint64_t extraBytes, const TextureId keep, const bool spareRequested)
+{
+    while (mResidentBytes + extraBytes > mBudget)
+    {
+        // Least recently used texture with a mip to spare.  A linear scan is fine for
+        // the handful of textures a demo streams.
+        Entry* victim = nullptr;
+        for (std::size_t i = 0; i < mEntries.size(); ++i)
+        {
+            Entry& entry = mEntries[i];
+            if (i == keep || entry.ResidentMip >= EvictionFloor(entry, spareRequested))
+                continue;
+
+            if (victim == nullptr || entry.LastUsedFrame < victim->LastUsedFrame)
+                victim = &entry;
+        }
+
+        if (victim == nullptr)
+            return false;
+
+        SetResidentMip(*victim, victim->ResidentMip + 1);
+    }
+    return true;
+}
+
+void TextureResidency::EndFrame(std::vector<Change>& changes)
+{
+    std::vector<std::uint32_t> startMips(mEntries.size());
+    for (std::size_t i = 0; i < mEntries.size(); ++i)
+    {
+        Entry& entry = mEntries[i];
+        startMips[i] = entry.ResidentMip;
+
+        if (entry.RequestedMip != NoRequest)
+        {
+            entry.LastUsedFrame = mFrame;
+            entry.RequestedMip = std::min(entry.RequestedMip, entry.TailMip);
+        }
+    }
+
+    // A lowered budget applies before anything new comes in, to textures on screen
+    // too; the promotions below then share out whatever is left.
+    MakeRoom(0, TextureId(mEntries.size()), false);
+
+    std::vector<TextureId> promotions;
+    for (std::size_t i = 0; i < mEntries.size(); ++i)
+    {
+        const Entry& entry = mEntries[i];
+        if (entry.RequestedMip != NoRequest && entry.RequestedMip < entry.ResidentMip)
+            promotions.push_back(TextureId(i));
+    }
+
+    std::stable_sort(promotions.begin(), promotions.end(), [this](TextureId a, TextureId b)
+    {
+        const Entry& ea = mEntries[a];
+        const Entry& eb = mEntries[b];
+        return ea.ResidentMip - ea.RequestedMip > eb.ResidentMip - eb.RequestedMip;
+    });
+
+    // Go for the requested mip, settling for a coarser one if that is all that fits.
+    // Working out what fits first keeps a failed promotion from evicting anything.
+    std::uint32_t promoted = 0;
+    for (const TextureId id : promotions)
+    {
+        if (promoted == mMaxPromotions)
+            break;
+
+        Entry& entry = mEntries[id];
+        const std::uint64_t room = mBudget + EvictableBytes(id);
+        if (mResidentBytes >= room)
+            continue;
+
+        const std::uint64_t current = entry.BytesFrom[entry.ResidentMip];
+        std::uint32_t mip = entry.RequestedMip;
+        while (mip < entry.ResidentMip && entry.BytesFrom[mip] - current > room - mResidentBytes)
+            ++mip;
+
+        if (mip < entry.ResidentMip)
+        {
+            MakeRoom(entry.BytesFrom[mip] - current, id, true);
+            SetResidentMip(entry, mip);
+            ++promoted;
+        }
+    }
+
+    for (std::size_t i = 0; i < mEntries.size(); ++i)
+    {
+        Entry& entry = mEntries[i];
+        if (entry.ResidentMip != startMips[i])
+            changes.push_back({ TextureId(i), startMips[i], entry.ResidentMip });
+
+        entry.RequestedMip = NoRequest;
+    }
+
+    ++mFrame;
+}
@@ -0,0 +1,98 @@
+//***************************************************************************************
+// TextureResidency.h
+//
+// Decides which mips of streamed textures are resident under a memory budget.  Each
+// texture always keeps its mip tail (the small mips at the end of the chain).  Every
+// frame the app reports the most detailed mip it wants from each texture it draws;
+// EndFrame then promotes those textures towards that mip and, when the budget runs
+// out, drops the finest mips of the least recently used textures.  Only bookkeeping
+// lives here: the app applies the returned changes to its GPU resources.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class TextureResidency final
+{
+public:
+    using TextureId = std::uint32_t;
+
+    static constexpr std::uint32_t NoRequest = UINT32_MAX;
+
+    // The most detailed resident mip of Id went from OldMip to NewMip.
+    struct Change final
+    {
+        TextureId Id = 0;
+        std::uint32_t OldMip = 0;
+        std::uint32_t NewMip = 0;
+    };
+
+    explicit TextureResidency(std::uint64_t budgetBytes);
+
+    // Registers a texture with mipBytes[m] bytes in mip m (all array slices together),
+    // most detailed first.  Mips from tailMip on are resident from the start and are
+    // never evicted; they still count against the budget.
+    TextureId Add(std::vector<std::uint64_t> mipBytes, std::uint32_t tailMip);
+
+    // The texture was drawn this frame and wants mip.  Repeated requests keep the
+    // most detailed one.
+    void Request(TextureId id, std::uint32_t mip);
+
+    // Applies the requests of the frame and appends one change per texture whose
+    // resident mip moved.  Promotions go to the textures furthest from what they
+    // asked for first, at most MaxPromotionsPerFrame of them; the rest wait for a
+    // later frame that asks again.  Evictions are not limited, as the budget is.
+    void EndFrame(std::vector<Change>& changes);
+
+    std::uint32_t ResidentMip(TextureId id)const { return mEntries[id].ResidentMip; }
+    std::uint32_t TailMip(TextureId id)const { return mEntries[id].TailMip; }
+
+    // Bytes of the resident mips of every texture.
+    std::uint64_t ResidentBytes()const { return mResidentBytes; }
+
+    std::uint64_t Budget()const { return mBudget; }
+
+    // Takes effect at the next EndFrame, which evicts until the resident mips fit.
+    void SetBudget(std::uint64_t budgetBytes) { mBudget = budgetBytes; }
+
+    // Each promotion recreates a texture, so this bounds the upload work of a frame.
+    std::uint32_t MaxPromotionsPerFrame()const { return mMaxPromotions; }
+    void SetMaxPromotionsPerFrame(std::uint32_t count) { mMaxPromotions = count; }
+
+    std::uint64_t FrameCount()const { return mFrame; }
+
+private:
+    struct Entry final
+    {
+        // BytesFrom[m] is the size of mips m and coarser, so a texture whose most
+        // detailed resident mip is m occupies BytesFrom[m].
+        std::vector<std::uint64_t> BytesFrom;
+
+        std::uint32_t TailMip = 0;
+        std::uint32_t ResidentMip = 0;
+        std::uint32_t RequestedMip = NoRequest;
+        std::uint64_t LastUsedFrame = 0;
+    };
+
+    void SetResidentMip(Entry& entry, std::uint32_t mip);
+
+    // Coarsest mip entry may be demoted to this frame.
+    std::uint32_t EvictionFloor(const Entry& entry, bool spareRequested)const;
+
+    // Bytes MakeRoom could free without touching keep.
+    std::uint64_t EvictableBytes(TextureId keep)const;
+
+    // Evicts mips of textures other than keep, least recently used first, until
+    // extraBytes more fit in the budget.  With spareRequested, textures drawn this
+    // frame keep the mip they asked for.  Returns false if not enough can be evicted.
+    bool MakeRoom(std::uint64_t extraBytes, TextureId keep, bool spareRequested);
+
+    std::vector<Entry> mEntries;
+
+    std::uint64_t mBudget = 0;
+    std::uint64_t mResidentBytes = 0;
+    std::uint64_t mFrame = 0;
+    std::uint32_t mMaxPromotions = UINT32_MAX;
+};
@@ -0,0 +1,172 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace
+{
+    // State of one ParallelFor call.  Helpers that start after the call has
+    // returned find no chunks left, so it is shared rather than on the stack.
+    struct ParallelForState final
+    {
+        std::size_t Begin = 0;
+        std::size_t End = 0;
+        std::size_t GrainSize = 1;
+        std::size_t ChunkCount = 0;
+        const std::function<void(std::size_t, std::size_t)>* Fn = nullptr;
+
+        std::atomic<std::size_t> NextChunk = 0;
+        std::atomic<std::size_t> ChunksDone = 0;
+
+        std::mutex Mutex;
+        std::condition_variable Done;
+
+        // Runs chunks until none are left.
+        void Drain()
+        {
+            std::size_t finished = 0;
+            for (;;)
+            {
+                const std::size_t chunk = NextChunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= ChunkCount)
+                    break;
+
+                const std::size_t first = Begin + chunk * GrainSize;
+                const std::size_t last = std::min(first + GrainSize, End);
+
+                PROFILE_SCOPE("ParallelFor chunk");
+                (*Fn)(first, last);
+                ++finished;
+            }
+
+            if (finished > 0 &&
+                ChunksDone.fetch_add(finished, std::memory_order_acq_rel) + finished == ChunkCount)
+            {
+                std::lock_guard lock(Mutex);
+                Done.notify_all();
+            }
+        }
+    };
+}
+
+ThreadPool::ThreadPool(unsigned workerCount)
+{
+    mWorkers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i)
+    {
+        mWorkers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mWakeUp.notify_all();
+
+    for (std::thread& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::DefaultWorkerCount()
+{
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+ThreadPool& ThreadPool::Default()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(mMutex);
+        mTasks.push_back(std::move(task));
+    }
+    mWakeUp.notify_one();
+}
+
+void ThreadPool::ParallelFor(
+    std::size_t begin,
+    std::size_t end,
+    std::size_t grainSize,
+    const std::function<void(std::size_t, std::size_t)>& fn)
+{
+    if (begin >= end)
+        return;
+
+    PROFILE_SCOPE("ParallelFor");
+
+    grainSize = std::max<std::size_t>(grainSize, 1);
+    const std::size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+
+    // Not worth waking anybody up.
+    if (chunkCount == 1 || mWorkers.empty())
+    {
+        for (std::size_t first = begin; first < end; first += grainSize)
+        {
+            fn(first, std::min(first + grainSize, end));
+        }
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->Begin = begin;
+    state->End = end;
+    state->GrainSize = grainSize;
+    state->ChunkCount = chunkCount;
+    state->Fn = &fn;
+
+    // The calling thread takes part, so one helper fewer than chunks is enough.
+    const std::size_t helperCount = std::min<std::size_t>(mWorkers.size(), chunkCount - 1);
+    {
+        std::lock_guard lock(mMutex);
+        for (std::size_t i = 0; i < helperCount; ++i)
+        {
+            mTasks.push_back([state] { state->Drain(); });
+        }
+    }
+    mWakeUp.notify_all();
+
+    state->Drain();
+
+    std::unique_lock lock(state->Mutex);
+    state->Done.wait(lock, [&state]
+    {
+        return state->ChunksDone.load(std::memory_order_acquire) == state->ChunkCount;
+    });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    Profiler::SetThreadName("ThreadPool worker");
+
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mMutex);
+            mWakeUp.wait(lock, [this] { return mStopping || !mTasks.empty(); });
+
+            if (mStopping && mTasks.empty())
+                return;
+
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,58 @@
+//***************************************************************************************
+// ThreadPool.h
+//
+// Portable fixed-size pool of std::threads.  ParallelFor splits an index range into
+// chunks that the workers and the calling thread pull from a shared counter, so a
+// slow chunk on one thread does not hold up the others.
+//***************************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool final
+{
+public:
+    // Creates workerCount worker threads.  Zero is valid: ParallelFor then runs
+    // everything on the calling thread.
+    explicit ThreadPool(unsigned workerCount = DefaultWorkerCount());
+    ThreadPool(const ThreadPool& rhs) = delete;
+    ThreadPool& operator=(const ThreadPool& rhs) = delete;
+    ~ThreadPool();
+
+    // One worker per hardware thread, minus the thread that submits the work.
+    static unsigned DefaultWorkerCount();
+
+    // Process-wide pool, created on first use.
+    static ThreadPool& Default();
+
+    unsigned WorkerCount()const { return static_cast<unsigned>(mWorkers.size()); }
+
+    // Queues a task to run on a worker.  Tasks must not block on other queued tasks.
+    void Submit(std::function<void()> task);
+
+    // Calls fn(first, last) for consecutive chunks of at most grainSize indices that
+    // cover [begin, end), and returns once all of them are done.  The calling thread
+    // processes chunks too, so this is safe to call from a worker.
+    void ParallelFor(
+        std::size_t begin,
+        std::size_t end,
+        std::size_t grainSize,
+        const std::function<void(std::size_t, std::size_t)>& fn);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::deque<std::function<void()>> mTasks;
+    bool mStopping = false;
+};
@@ -0,0 +1,165 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "TransformHierarchy.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+using namespace DirectX;
+
+void TransformHierarchy::Reserve(const std::size_t count)
+{
+    mParents.reserve(count);
+    mLocal.reserve(count);
+    mWorld.reserve(count);
+    mLocalDirty.reserve(count);
+    mWorldChanged.reserve(count);
+    mDepths.reserve(count);
+}
+
+std::uint32_t TransformHierarchy::Add(FXMMATRIX local, const std::uint32_t parent)
+{
+    assert(parent == NoParent || parent < mParents.size());
+
+    const auto node = static_cast<std::uint32_t>(mParents.size());
+    mParents.push_back(parent);
+    XMStoreFloat4x4A(&mLocal.emplace_back(), local);
+    XMStoreFloat4x4A(&mWorld.emplace_back(), XMMatrixIdentity());
+    mLocalDirty.push_back(1);
+    mWorldChanged.push_back(0);
+    mDepths.push_back(parent == NoParent ? 0 : mDepths[parent] + 1);
+    mLevelsValid = false;
+
+    mFirstDirty = std::min<std::size_t>(mFirstDirty, node);
+    return node;
+}
+
+void TransformHierarchy::SetLocal(const std::uint32_t node, FXMMATRIX local)
+{
+    assert(node < mParents.size());
+
+    XMFLOAT4X4A value;
+    XMStoreFloat4x4A(&value, local);
+    if (std::memcmp(&value, &mLocal[node], sizeof(value)) == 0)
+        return;
+
+    mLocal[node] = value;
+    mLocalDirty[node] = 1;
+    mFirstDirty = std::min<std::size_t>(mFirstDirty, node);
+}
+
+XMMATRIX TransformHierarchy::Local(const std::uint32_t node)const
+{
+    return XMLoadFloat4x4A(&mLocal[node]);
+}
+
+XMMATRIX TransformHierarchy::World(const std::uint32_t node)const
+{
+    return XMLoadFloat4x4A(&mWorld[node]);
+}
+
+bool TransformHierarchy::UpdateNode(const std::size_t node)
+{
+    const std::uint32_t parent = mParents[node];
+    const bool parentChanged = parent != NoParent && mWorldChanged[parent] != 0;
+    if (mLocalDirty[node] == 0 && !parentChanged)
+        return false;
+
+    const XMMATRIX local = XMLoadFloat4x4A(&mLocal[node]);
+    const XMMATRIX world = parent != NoParent
+        ? XMMatrixMultiply(local, XMLoadFloat4x4A(&mWorld[parent]))
+        : local;
+    XMStoreFloat4x4A(&mWorld[node], world);
+
+    mLocalDirty[node] = 0;
+    mWorldChanged[node] = 1;
+    return true;
+}
+
+std::size_t TransformHierarchy::Update()
+{
+    const std::size_t count = mParents.size();
+
+    std::fill(mWorldChanged.begin() + std::min(mFirstChanged, count), mWorldChanged.end(), std::uint8_t(0));
+    mFirstChanged = mFirstDirty;
+
+    // Parents come before their children, so by the time a node is reached its parent's
+    // world matrix and changed flag are final.  Nodes before mFirstDirty are untouched.
+    std::size_t updated = 0;
+    for (std::size_t i = mFirstDirty; i < count; ++i)
+    {
+        if (UpdateNode(i))
+            ++updated;
+    }
+
+    mFirstDirty = count;
+    return updated;
+}
+
+std::size_t TransformHierarchy::Update(ThreadPool& pool)
+{
+    const std::size_t count = mParents.size();
+    if (pool.WorkerCount() == 0 || count - std::min(mFirstDirty, count) < ParallelUpdateMinNodes)
+        return Update();
+
+    if (!mLevelsValid)
+        BuildLevels();
+
+    const std::size_t levelCount = mLevelStarts.size() - 1;
+    if (count < levelCount * ParallelUpdateMinLevelWidth)
+        return Update();
+
+    std::fill(mWorldChanged.begin() + std::min(mFirstChanged, count), mWorldChanged.end(), std::uint8_t(0));
+    mFirstChanged = mFirstDirty;
+
+    // A level only reads the world matrices and changed flags of the level above, which
+    // the previous ParallelFor finished.  Each level is in index order, so its nodes
+    // before mFirstDirty are skipped with a binary search.
+    constexpr std::size_t GrainSize = 1024;
+    std::atomic<std::size_t> updated = 0;
+    for (std::size_t level = 0; level < levelCount; ++level)
+    {
+        const auto levelBegin = mLevelNodes.begin() + mLevelStarts[level];
+        const auto levelEnd = mLevelNodes.begin() + mLevelStarts[level + 1];
+        const auto first = std::lower_bound(levelBegin, levelEnd, mFirstDirty);
+
+        pool.ParallelFor(first - mLevelNodes.begin(), levelEnd - mLevelNodes.begin(), GrainSize,
+            [&](const std::size_t begin, const std::size_t end)
+            {
+                std::size_t chunkUpdated = 0;
+                for (std::size_t k = begin; k < end; ++k)
+                {
+                    if (UpdateNode(mLevelNodes[k]))
+                        ++chunkUpdated;
+                }
+                updated += chunkUpdated;
+            });
+    }
+
+    mFirstDirty = count;
+    return updated;
+}
+
+void TransformHierarchy::BuildLevels()
+{
+    const std::size_t count = mParents.size();
+    const std::uint32_t levelCount = count == 0 ? 0 : *std::max_element(mDepths.begin(), mDepths.end()) + 1;
+
+    // Counting sort by depth, which keeps each level in index order.
+    mLevelStarts.assign(std::size_t(levelCount) + 1, 0);
+    for (const std::uint32_t depth : mDepths)
+        ++mLevelStarts[depth + 1];
+    for (std::size_t level = 1; level < mLevelStarts.size(); ++level)
+        mLevelStarts[level] += mLevelStarts[level - 1];
+
+    mLevelNodes.resize(count);
+    std::vector<std::size_t> next(mLevelStarts);
+    for (std::size_t i = 0; i < count; ++i)
+        mLevelNodes[next[mDepths[i]]++] = static_cast<std::uint32_t>(i);
+
+    mLevelsValid = true;
+}
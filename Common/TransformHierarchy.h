@@ -0,0 +1,98 @@
+//***************************************************************************************
+// TransformHierarchy.h
+//
+// Parent-child transform hierarchy kept as flat arrays (parent index, local matrix,
+// world matrix, dirty flags) in topological order: a node is always added after its
+// parent.  Update can then bring every world matrix under a changed node up to date in
+// one forward pass, multiplying each node's local matrix by its parent's already
+// updated world matrix.
+//
+// Large hierarchies can be updated on a ThreadPool instead.  The nodes are then
+// grouped by depth; the nodes of one depth only read world matrices of the depth
+// above, so each level runs as one ParallelFor.
+//
+// Matrices follow the DirectXMath row-vector convention: world = local * parentWorld.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class ThreadPool;
+
+class TransformHierarchy final
+{
+public:
+    static constexpr std::uint32_t NoParent = std::numeric_limits<std::uint32_t>::max();
+
+    void Reserve(std::size_t count);
+
+    std::size_t Size()const { return mParents.size(); }
+
+    // Adds a node and returns its index.  parent must be an existing node or NoParent.
+    std::uint32_t Add(DirectX::FXMMATRIX local, std::uint32_t parent = NoParent);
+
+    std::uint32_t Parent(std::uint32_t node)const { return mParents[node]; }
+
+    // Replaces the node's local matrix.  Its world matrix and those of its descendants
+    // are recomputed by the next Update.  Setting the matrix the node already has does
+    // nothing, so callers can set their matrices every frame.
+    void SetLocal(std::uint32_t node, DirectX::FXMMATRIX local);
+
+    DirectX::XMMATRIX Local(std::uint32_t node)const;
+
+    // World matrix as of the last Update.
+    DirectX::XMMATRIX World(std::uint32_t node)const;
+
+    // True if the last Update recomputed the node's world matrix.
+    bool WorldChanged(std::uint32_t node)const { return mWorldChanged[node] != 0; }
+
+    // Recomputes the world matrices of all nodes whose local matrix, or an ancestor's,
+    // changed since the previous call.  Returns the number of world matrices recomputed.
+    std::size_t Update();
+
+    // Same result as Update(), with each depth level split across the pool.  Falls back
+    // to Update() when fewer than ParallelUpdateMinNodes nodes could be dirty, or when
+    // the levels average fewer than ParallelUpdateMinLevelWidth nodes, as in long
+    // chains, where one ParallelFor per level costs more than it saves.
+    std::size_t Update(ThreadPool& pool);
+
+    static constexpr std::size_t ParallelUpdateMinNodes = 4096;
+    static constexpr std::size_t ParallelUpdateMinLevelWidth = 64;
+
+private:
+    // Recomputes the node's world matrix if it or its parent changed.  Returns true if
+    // it did.
+    bool UpdateNode(std::size_t node);
+
+    // Sorts the node indices by depth into mLevelNodes/mLevelStarts.
+    void BuildLevels();
+
+    std::vector<std::uint32_t> mParents;
+    std::vector<DirectX::XMFLOAT4X4A> mLocal;
+    std::vector<DirectX::XMFLOAT4X4A> mWorld;
+
+    // Nonzero if SetLocal/Add touched the node since the last Update.
+    std::vector<std::uint8_t> mLocalDirty;
+
+    // Nonzero if the last Update recomputed the node.
+    std::vector<std::uint8_t> mWorldChanged;
+
+    // Distance from the root, and the nodes grouped by it: level d is
+    // mLevelNodes[mLevelStarts[d], mLevelStarts[d + 1]), in index order.  Rebuilt by
+    // the first parallel Update after an Add.
+    std::vector<std::uint32_t> mDepths;
+    std::vector<std::uint32_t> mLevelNodes;
+    std::vector<std::size_t> mLevelStarts;
+    bool mLevelsValid = false;
+
+    // Nodes below these indices are known to be clean/unchanged, so neither the next
+    // Update nor the clearing of mWorldChanged needs to look at them.
+    std::size_t mFirstDirty = 0;
+    std::size_t mFirstChanged = 0;
+};
@@ -1,44 +1,73 @@
 #pragma once
 
+#ifdef _WIN32
 #include "d3dUtil.h"
+#else
+// Off Windows there is no device: only HostUploadAllocation and the buffer logic over
+// it are built, for the Tests project.  Failures throw std::runtime_error in place of
+// DxException.
+#include <cassert>
+#include <stdexcept>
+#include <wsl/winadapter.h>
+#include <d3d12.h>
 
-template<typename T>
-class UploadBuffer final
+#ifndef ThrowIfFailed
+#define ThrowIfFailed(x)                                              \
+{                                                                     \
+    const HRESULT hr__ = (x);                                         \
+    if(FAILED(hr__)) [[unlikely]] { throw std::runtime_error(#x); }   \
+}
+#endif
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Memory an UploadBuffer writes into.  Normally a persistently mapped upload heap
+// resource; HostUploadAllocation is plain memory, so the buffer logic can be
+// exercised and measured without a device.
+class UploadAllocation
 {
 public:
-    UploadBuffer(
-        ID3D12Device* const device, 
-        const UINT elementCount, 
-        const bool isConstantBuffer) 
-        : mIsConstantBuffer(isConstantBuffer)
+    UploadAllocation() = default;
+    UploadAllocation(const UploadAllocation& rhs) = delete;
+    UploadAllocation& operator=(const UploadAllocation& rhs) = delete;
+    virtual ~UploadAllocation() = default;
+
+    virtual BYTE* Data() = 0;
+    virtual UINT64 ByteSize()const = 0;
+
+    // The GPU resource behind the memory, or nullptr if there is none.
+    virtual ID3D12Resource* Resource()const = 0;
+
+    // Write-combined memory is where non-temporal stores pay off.
+    virtual bool IsWriteCombined()const = 0;
+};
+
+#ifdef _WIN32
+class D3D12UploadAllocation final : public UploadAllocation
+{
+public:
+    D3D12UploadAllocation(ID3D12Device* const device, const UINT64 byteSize)
+        : mByteSize(byteSize)
     {
         assert(device != nullptr);
         __assume(device != nullptr);
-        // Constant buffer elements need to be multiples of 256 bytes.
-        // This is because the hardware can only view constant data 
-        // at m*256 byte offsets and of n*256 byte lengths. 
-        // typedef struct D3D12_CONSTANT_BUFFER_VIEW_DESC {
-        // UINT64 OffsetInBytes; // multiple of 256
-        // UINT   SizeInBytes;   // multiple of 256
-        // } D3D12_CONSTANT_BUFFER_VIEW_DESC;
-        if (isConstantBuffer)
-        {
-            mElementByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(T));
-        }
-        else
-        {
-            mElementByteSize = sizeof(T);
-        }
 
         const CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-        const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(
-            UINT64(mElementByteSize * elementCount));
+        const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
 
         ThrowIfFailed(device->CreateCommittedResource(
             &heapProps,
             D3D12_HEAP_FLAG_NONE,
             &bufferDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
+            D3D12_RESOURCE_STATE_GENERIC_READ,
             nullptr,
             IID_PPV_ARGS(&mUploadBuffer)));
 
@@ -49,10 +78,7 @@ public:
         // the resource while it is in use by the GPU (so we must use synchronization techniques).
     }
 
-    UploadBuffer(const UploadBuffer& rhs) = delete;
-    UploadBuffer& operator=(const UploadBuffer& rhs) = delete;
-
-    ~UploadBuffer()
+    ~D3D12UploadAllocation() override
     {
         if (mUploadBuffer != nullptr)
         {
@@ -60,22 +86,280 @@ public:
         }
     }
 
+    BYTE* Data() override { return mMappedData; }
+    UINT64 ByteSize()const override { return mByteSize; }
+    ID3D12Resource* Resource()const override { return mUploadBuffer.Get(); }
+    bool IsWriteCombined()const override { return true; }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
+    BYTE* mMappedData = nullptr;
+    UINT64 mByteSize = 0;
+};
+#endif
+
+class HostUploadAllocation final : public UploadAllocation
+{
+public:
+    explicit HostUploadAllocation(const UINT64 byteSize)
+        : mStorage(static_cast<std::size_t>(byteSize) + Alignment),
+          mByteSize(byteSize)
+    {
+        // Match the placement guarantees of a D3D12 buffer so constant buffer
+        // offsets stay 256-byte aligned.
+        void* data = mStorage.data();
+        std::size_t space = mStorage.size();
+        mData = static_cast<BYTE*>(std::align(Alignment, static_cast<std::size_t>(byteSize), data, space));
+    }
+
+    BYTE* Data() override { return mData; }
+    UINT64 ByteSize()const override { return mByteSize; }
+    ID3D12Resource* Resource()const override { return nullptr; }
+    bool IsWriteCombined()const override { return false; }
+
+private:
+    static constexpr std::size_t Alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
+    std::vector<BYTE> mStorage;
+    BYTE* mData = nullptr;
+    UINT64 mByteSize = 0;
+};
+
+namespace UploadMemory
+{
+    // Size of a constant buffer element holding byteSize bytes, as
+    // d3dUtil::CalcConstantBufferByteSize computes it.
+    constexpr UINT ConstantBufferByteSize(const UINT byteSize)
+    {
+        return (byteSize + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1) &
+            ~UINT(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1);
+    }
+
+    // Below this size the streaming setup costs more than it saves.
+    constexpr std::size_t MinStreamingCopyBytes = 4096;
+
+    // Copies with non-temporal stores, so a large write to write-combined memory goes
+    // out in full lines and does not evict useful data from the cache.
+    inline void StreamingCopy(void* const dst, const void* const src, std::size_t byteSize)
+    {
+        auto* d = static_cast<BYTE*>(dst);
+        auto* s = static_cast<const BYTE*>(src);
+
+        // _mm_stream_si128 needs a 16-byte aligned destination.
+        const std::size_t head = (16 - (reinterpret_cast<std::uintptr_t>(d) & 15)) & 15;
+        if (byteSize < MinStreamingCopyBytes || head >= byteSize)
+        {
+            std::memcpy(d, s, byteSize);
+            return;
+        }
+
+        std::memcpy(d, s, head);
+        d += head;
+        s += head;
+        byteSize -= head;
+
+        for (; byteSize >= 64; d += 64, s += 64, byteSize -= 64)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+            const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+        }
+
+        // Order the streaming stores before anything the caller does next, such as
+        // recording the command list that reads this memory.
+        _mm_sfence();
+
+        std::memcpy(d, s, byteSize);
+    }
+}
+
+// Array view over elements that are stride bytes apart, as in a constant buffer
+// where each element is padded to 256 bytes.
+template<typename T>
+class StridedSpan final
+{
+public:
+    class Iterator final
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        Iterator() = default;
+        Iterator(BYTE* const element, const std::size_t stride) : mElement(element), mStride(stride) {}
+
+        T& operator*()const { return *reinterpret_cast<T*>(mElement); }
+        T* operator->()const { return reinterpret_cast<T*>(mElement); }
+
+        Iterator& operator++()
+        {
+            mElement += mStride;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator& rhs)const { return mElement == rhs.mElement; }
+
+    private:
+        BYTE* mElement = nullptr;
+        std::size_t mStride = 0;
+    };
+
+    StridedSpan() = default;
+    StridedSpan(BYTE* const data, const std::size_t count, const std::size_t stride)
+        : mData(data), mCount(count), mStride(stride)
+    {}
+
+    T& operator[](const std::size_t i)const
+    {
+        assert(i < mCount);
+        return *reinterpret_cast<T*>(mData + i * mStride);
+    }
+
+    std::size_t size()const { return mCount; }
+    std::size_t stride()const { return mStride; }
+    bool empty()const { return mCount == 0; }
+
+    Iterator begin()const { return Iterator(mData, mStride); }
+    Iterator end()const { return Iterator(mData + mCount * mStride, mStride); }
+
+private:
+    BYTE* mData = nullptr;
+    std::size_t mCount = 0;
+    std::size_t mStride = 0;
+};
+
+template<typename T>
+class UploadBuffer final
+{
+public:
+#ifdef _WIN32
+    UploadBuffer(
+        ID3D12Device* const device,
+        const UINT elementCount,
+        const bool isConstantBuffer)
+        : UploadBuffer(
+            std::make_unique<D3D12UploadAllocation>(
+                device, UINT64(CalcElementByteSize(isConstantBuffer)) * elementCount),
+            elementCount,
+            isConstantBuffer)
+    {
+    }
+#endif
+
+    // Uses memory supplied by the caller, which must hold elementCount elements.
+    UploadBuffer(
+        std::unique_ptr<UploadAllocation> allocation,
+        const UINT elementCount,
+        const bool isConstantBuffer)
+        : mAllocation(std::move(allocation)),
+          mElementByteSize(CalcElementByteSize(isConstantBuffer)),
+          mElementCount(elementCount),
+          mIsConstantBuffer(isConstantBuffer)
+    {
+        assert(mAllocation != nullptr);
+        assert(mAllocation->ByteSize() >= UINT64(mElementByteSize) * elementCount);
+        mMappedData = mAllocation->Data();
+    }
+
+    UploadBuffer(const UploadBuffer& rhs) = delete;
+    UploadBuffer& operator=(const UploadBuffer& rhs) = delete;
+
     ID3D12Resource* Resource()const
     {
-        return mUploadBuffer.Get();
+        return mAllocation->Resource();
     }
 
+    UINT ElementCount()const { return mElementCount; }
+
+    // Distance between consecutive elements: sizeof(T), or sizeof(T) rounded up to
+    // 256 bytes for constant buffers.
+    UINT ElementByteSize()const { return mElementByteSize; }
+
     void CopyData(const int elementIndex, const T& data)
     {
         assert(elementIndex >= 0);
+#ifdef _MSC_VER
         __assume(elementIndex >= 0);
+#endif
         memcpy(&mMappedData[elementIndex*mElementByteSize], &data, sizeof(T));
     }
 
+    // Copies data into consecutive elements starting at firstElement.  Packed buffers
+    // are written in one copy, with non-temporal stores when the range is large and
+    // the memory write-combined.
+    void CopyRange(const UINT firstElement, const std::span<const T> data)
+    {
+        assert(firstElement + data.size() <= mElementCount);
+
+        BYTE* dst = &mMappedData[UINT64(firstElement) * mElementByteSize];
+        if (!mIsConstantBuffer)
+        {
+            if (mAllocation->IsWriteCombined())
+            {
+                UploadMemory::StreamingCopy(dst, data.data(), data.size_bytes());
+            }
+            else
+            {
+                memcpy(dst, data.data(), data.size_bytes());
+            }
+            return;
+        }
+
+        for (const T& element : data)
+        {
+            memcpy(dst, &element, sizeof(T));
+            dst += mElementByteSize;
+        }
+    }
+
+    // The mapped elements, for writing many of them in place.  Only for vertex/index
+    // style buffers: constant buffer elements are padded to 256 bytes, so they are not
+    // a contiguous array of T.  Upload heap memory is write-combined: write each element
+    // once and do not read it back.
+    std::span<T> MappedElements()
+    {
+        assert(!mIsConstantBuffer);
+        return std::span<T>(reinterpret_cast<T*>(mMappedData), mElementCount);
+    }
+
+    // The mapped elements of any buffer, stepping over constant buffer padding.
+    StridedSpan<T> MappedStridedElements()
+    {
+        return StridedSpan<T>(mMappedData, mElementCount, mElementByteSize);
+    }
+
 private:
-    Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
+    static constexpr UINT CalcElementByteSize(const bool isConstantBuffer)
+    {
+        // Constant buffer elements need to be multiples of 256 bytes.
+        // This is because the hardware can only view constant data
+        // at m*256 byte offsets and of n*256 byte lengths.
+        // typedef struct D3D12_CONSTANT_BUFFER_VIEW_DESC {
+        // UINT64 OffsetInBytes; // multiple of 256
+        // UINT   SizeInBytes;   // multiple of 256
+        // } D3D12_CONSTANT_BUFFER_VIEW_DESC;
+        return isConstantBuffer ? UploadMemory::ConstantBufferByteSize(sizeof(T)) : UINT(sizeof(T));
+    }
+
+    std::unique_ptr<UploadAllocation> mAllocation;
     BYTE* mMappedData = nullptr;
 
     UINT mElementByteSize = 0;
+    UINT mElementCount = 0;
     bool mIsConstantBuffer = false;
 };
@@ -0,0 +1,71 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "UploadRingBuffer.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+UploadRingBuffer::UploadRingBuffer(ID3D12Device* const device, const UINT64 byteSize)
+    : UploadRingBuffer(std::make_unique<D3D12UploadAllocation>(device, byteSize))
+{
+}
+#endif
+
+UploadRingBuffer::UploadRingBuffer(std::unique_ptr<UploadAllocation> memory)
+    : mMemory(std::move(memory))
+{
+    assert(mMemory != nullptr);
+
+    mCpuBase = mMemory->Data();
+    mCapacity = mMemory->ByteSize();
+
+    ID3D12Resource* const resource = mMemory->Resource();
+    mGpuBase = resource != nullptr ? resource->GetGPUVirtualAddress() : 0;
+}
+
+UploadRingBuffer::Allocation UploadRingBuffer::Allocate(const UINT64 byteSize, const UINT64 alignment)
+{
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+    const UINT64 offset = mHead % mCapacity;
+    UINT64 alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+    UINT64 newHead = mHead + (alignedOffset - offset) + byteSize;
+
+    // An allocation never straddles the end of the ring; skip to the start instead.
+    if (alignedOffset + byteSize > mCapacity)
+    {
+        alignedOffset = 0;
+        newHead = mHead + (mCapacity - offset) + byteSize;
+    }
+
+    if (byteSize > mCapacity || newHead - mTail > mCapacity) [[unlikely]]
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+
+    mHead = newHead;
+    mHighWaterMark = std::max(mHighWaterMark, mHead - mTail);
+
+    Allocation allocation;
+    allocation.CpuAddress = mCpuBase + alignedOffset;
+    allocation.GpuAddress = mGpuBase != 0 ? mGpuBase + alignedOffset : 0;
+    allocation.Offset = alignedOffset;
+    allocation.ByteSize = byteSize;
+    return allocation;
+}
+
+void UploadRingBuffer::FinishFrame(const UINT64 fence)
+{
+    assert(mFinishedFrames.empty() || mFinishedFrames.back().Fence < fence);
+    mFinishedFrames.push_back(FrameMarker{ fence, mHead });
+}
+
+void UploadRingBuffer::Retire(const UINT64 completedFence)
+{
+    while (!mFinishedFrames.empty() && mFinishedFrames.front().Fence <= completedFence)
+    {
+        mTail = mFinishedFrames.front().Head;
+        mFinishedFrames.pop_front();
+    }
+}
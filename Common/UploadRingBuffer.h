@@ -0,0 +1,97 @@
+//***************************************************************************************
+// UploadRingBuffer.h
+//
+// Linear sub-allocator for per-frame upload data (constants and the like) over one
+// persistently mapped upload region used as a ring.  Every allocation made while
+// recording a frame stays alive until the fence signaled after that frame has been
+// reached, so callers allocate what they need each frame instead of sizing one
+// UploadBuffer per FrameResource up front.
+//***************************************************************************************
+
+#pragma once
+
+#include "UploadBuffer.h"
+
+#include <deque>
+#include <memory>
+
+class UploadRingBuffer final
+{
+public:
+    struct Allocation final
+    {
+        BYTE* CpuAddress = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+        UINT64 Offset = 0;
+        UINT64 ByteSize = 0;
+    };
+
+#ifdef _WIN32
+    UploadRingBuffer(ID3D12Device* const device, const UINT64 byteSize);
+#endif
+
+    // Uses memory supplied by the caller, e.g. a HostUploadAllocation.
+    explicit UploadRingBuffer(std::unique_ptr<UploadAllocation> memory);
+
+    UploadRingBuffer(const UploadRingBuffer& rhs) = delete;
+    UploadRingBuffer& operator=(const UploadRingBuffer& rhs) = delete;
+
+    // Returns byteSize bytes aligned to alignment (a power of two).  Throws if the ring
+    // has no room left, i.e. it is too small for the frames in flight.
+    Allocation Allocate(
+        const UINT64 byteSize,
+        const UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+    // Allocates room for count constant buffer elements of type T, each padded to 256
+    // bytes like in UploadBuffer<T>.  Element i lives at GpuAddress + i*ElementByteSize.
+    template<typename T>
+    Allocation AllocateConstants(const UINT count = 1)
+    {
+        return Allocate(UINT64(UploadMemory::ConstantBufferByteSize(sizeof(T))) * count);
+    }
+
+    // Allocates a constant buffer holding data.
+    template<typename T>
+    Allocation PushConstants(const T& data)
+    {
+        const Allocation allocation = AllocateConstants<T>();
+        memcpy(allocation.CpuAddress, &data, sizeof(T));
+        return allocation;
+    }
+
+    // Closes the current frame: its allocations are released by Retire once the GPU
+    // has reached fence.
+    void FinishFrame(const UINT64 fence);
+
+    // Releases the allocations of every finished frame whose fence is <= completedFence.
+    void Retire(const UINT64 completedFence);
+
+    ID3D12Resource* Resource()const { return mMemory->Resource(); }
+
+    UINT64 Capacity()const { return mCapacity; }
+    UINT64 BytesInUse()const { return mHead - mTail; }
+
+    // Most bytes that were ever in use at once, including padding lost when an
+    // allocation wrapped around.  Useful for sizing the ring.
+    UINT64 HighWaterMark()const { return mHighWaterMark; }
+
+private:
+    struct FrameMarker final
+    {
+        UINT64 Fence = 0;
+        UINT64 Head = 0;
+    };
+
+    std::unique_ptr<UploadAllocation> mMemory;
+    BYTE* mCpuBase = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS mGpuBase = 0;
+    UINT64 mCapacity = 0;
+
+    // Running byte counts; the ring offset is the count modulo mCapacity.  Bytes in
+    // [mTail, mHead) may still be read by the GPU.
+    UINT64 mHead = 0;
+    UINT64 mTail = 0;
+    UINT64 mHighWaterMark = 0;
+
+    std::deque<FrameMarker> mFinishedFrames;
+};
@@ -0,0 +1,418 @@
+//***************************************************************************************
+// Waves.cpp by Frank Luna (C) 2011 All Rights Reserved.
+//***************************************************************************************
+
+#include "Waves.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    // Number of grid points evaluated per DirectXMath vector.
+    constexpr int kLanes = 4;
+
+    // Aim for bands of rows whose heights (prev, curr and the rows above and
+    // below) fit comfortably in a per-core L2 cache.
+    constexpr int kBandBytes = 64 * 1024;
+}
+
+Waves::Waves(int m, int n, float dx, float dt, float speed, float damping) :
+    mThreadPool(ThreadPool::Default())
+{
+    mNumRows = m;
+    mNumCols = n;
+
+    mVertexCount = m*n;
+    mTriangleCount = (m - 1)*(n - 1) * 2;
+
+    mTimeStep = dt;
+    mSpatialStep = dx;
+
+    mSpeed = speed;
+    mDamping = damping;
+
+    float d = damping*dt + 2.0f;
+    float e = (speed*speed)*(dt*dt) / (dx*dx);
+    mK1 = (damping*dt - 2.0f) / d;
+    mK2 = (4.0f - 8.0f*e) / d;
+    mK3 = (2.0f*e) / d;
+
+    mPrevHeights.assign(m*n, 0.0f);
+    mCurrHeights.assign(m*n, 0.0f);
+    mNormalX.assign(m*n, 0.0f);
+    mNormalY.assign(m*n, 1.0f);
+    mNormalZ.assign(m*n, 0.0f);
+    mTangentX.assign(m*n, 1.0f);
+    mTangentY.assign(m*n, 0.0f);
+
+    // Generate grid coordinates in system memory.
+
+    float halfWidth = (n - 1)*dx*0.5f;
+    float halfDepth = (m - 1)*dx*0.5f;
+
+    mRowZ.resize(m);
+    for(int i = 0; i < m; ++i)
+        mRowZ[i] = halfDepth - i*dx;
+
+    mColumnX.resize(n);
+    for(int j = 0; j < n; ++j)
+        mColumnX[j] = -halfWidth + j*dx;
+}
+
+int Waves::RowCount()const
+{
+    return mNumRows;
+}
+
+int Waves::ColumnCount()const
+{
+    return mNumCols;
+}
+
+int Waves::VertexCount()const
+{
+    return mVertexCount;
+}
+
+int Waves::TriangleCount()const
+{
+    return mTriangleCount;
+}
+
+float Waves::Width()const
+{
+    return mNumCols*mSpatialStep;
+}
+
+float Waves::Depth()const
+{
+    return mNumRows*mSpatialStep;
+}
+
+void Waves::SetMaxSubsteps(int maxSubsteps)
+{
+    mMaxSubsteps = std::max(1, maxSubsteps);
+}
+
+int Waves::Update(float dt)
+{
+    if(mIsRecording)
+    {
+        InputEvent event;
+        event.Kind = InputEvent::Type::Update;
+        event.Dt = dt;
+        mRecordedEvents.push_back(event);
+    }
+
+    // Accumulate time.
+    mAccumulator += std::max(dt, 0.0f);
+
+    // Only update the simulation at the specified time step, catching up on
+    // as many steps as the frame covered.
+    int steps = 0;
+    while(mAccumulator >= mTimeStep && steps < mMaxSubsteps)
+    {
+        Step();
+
+        mAccumulator -= mTimeStep;
+        ++steps;
+    }
+
+    // Drop whatever backlog is left after a long frame rather than spiralling
+    // further behind on the next one.
+    if(mAccumulator >= mTimeStep)
+        mAccumulator = std::fmod(mAccumulator, mTimeStep);
+
+    mAlpha = mAccumulator / mTimeStep;
+
+    return steps;
+}
+
+void Waves::Step()
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const int rowsPerTask = RowsPerTask();
+
+    // Only update interior points; we use zero boundary conditions.
+    mThreadPool.ParallelFor(1, mNumRows - 1, rowsPerTask, [this](std::size_t first, std::size_t last)
+    {
+        UpdateHeights(int(first), int(last));
+    });
+
+    // We just overwrote the previous buffer with the new data, so
+    // this data needs to become the current solution and the old
+    // current solution becomes the new previous solution.
+    std::swap(mPrevHeights, mCurrHeights);
+
+    //
+    // Compute normals using finite difference scheme.
+    //
+    mThreadPool.ParallelFor(1, mNumRows - 1, rowsPerTask, [this](std::size_t first, std::size_t last)
+    {
+        UpdateNormals(int(first), int(last));
+    });
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if(elapsed.count() > 0.0)
+        mCellsPerSecond = double(mNumRows - 2) * double(mNumCols - 2) / elapsed.count();
+}
+
+int Waves::RowsPerTask()const
+{
+    const int rowBytes = mNumCols * int(sizeof(float));
+    return std::max(1, kBandBytes / (4 * rowBytes));
+}
+
+void Waves::UpdateHeights(int firstRow, int lastRow)
+{
+    const int n = mNumCols;
+    const XMVECTOR k1 = XMVectorReplicate(mK1);
+    const XMVECTOR k2 = XMVectorReplicate(mK2);
+    const XMVECTOR k3 = XMVectorReplicate(mK3);
+
+    for(int i = firstRow; i < lastRow; ++i)
+    {
+        // After this update we will be discarding the old previous
+        // buffer, so overwrite that buffer with the new update.
+        // Note how we can do this inplace (read/write to same element)
+        // because we won't need prev_ij again and the assignment happens last.
+
+        // Note j indexes x and i indexes z: h(x_j, z_i, t_k)
+        // Moreover, our +z axis goes "down"; this is just to
+        // keep consistent with our row indices going down.
+
+        float* prev = &mPrevHeights[i*n];
+        const float* curr = &mCurrHeights[i*n];
+        const float* above = curr - n;
+        const float* below = curr + n;
+
+        int j = 1;
+        for(; j + kLanes <= n - 1; j += kLanes)
+        {
+            const XMVECTOR neighbors =
+                XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(below + j)) +
+                XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(above + j)) +
+                XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(curr + j + 1)) +
+                XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(curr + j - 1));
+
+            XMVECTOR h = XMVectorMultiply(k1, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(prev + j)));
+            h = XMVectorMultiplyAdd(k2, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(curr + j)), h);
+            h = XMVectorMultiplyAdd(k3, neighbors, h);
+
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(prev + j), h);
+        }
+
+        for(; j < n - 1; ++j)
+        {
+            prev[j] =
+                mK1*prev[j] +
+                mK2*curr[j] +
+                mK3*(below[j] + above[j] + curr[j+1] + curr[j-1]);
+        }
+    }
+}
+
+void Waves::UpdateNormals(int firstRow, int lastRow)
+{
+    const int n = mNumCols;
+    const float twoDx = 2.0f*mSpatialStep;
+    const XMVECTOR twoDxV = XMVectorReplicate(twoDx);
+    const XMVECTOR twoDxSq = XMVectorReplicate(twoDx*twoDx);
+
+    for(int i = firstRow; i < lastRow; ++i)
+    {
+        const float* curr = &mCurrHeights[i*n];
+        const float* above = curr - n;
+        const float* below = curr + n;
+
+        float* nx = &mNormalX[i*n];
+        float* ny = &mNormalY[i*n];
+        float* nz = &mNormalZ[i*n];
+        float* tx = &mTangentX[i*n];
+        float* ty = &mTangentY[i*n];
+
+        // normal  = normalize(l - r, 2dx, b - t)
+        // tangent = normalize(2dx, r - l, 0)
+        int j = 1;
+        for(; j + kLanes <= n - 1; j += kLanes)
+        {
+            const XMVECTOR l = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(curr + j - 1));
+            const XMVECTOR r = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(curr + j + 1));
+            const XMVECTOR t = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(above + j));
+            const XMVECTOR b = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(below + j));
+
+            const XMVECTOR dx = XMVectorSubtract(l, r);
+            const XMVECTOR dz = XMVectorSubtract(b, t);
+
+            const XMVECTOR invNormalLength = XMVectorReciprocalSqrt(
+                XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dz, dz, twoDxSq)));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(nx + j), XMVectorMultiply(dx, invNormalLength));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(ny + j), XMVectorMultiply(twoDxV, invNormalLength));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(nz + j), XMVectorMultiply(dz, invNormalLength));
+
+            const XMVECTOR invTangentLength = XMVectorReciprocalSqrt(XMVectorMultiplyAdd(dx, dx, twoDxSq));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(tx + j), XMVectorMultiply(twoDxV, invTangentLength));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(ty + j), XMVectorMultiply(XMVectorNegate(dx), invTangentLength));
+        }
+
+        for(; j < n - 1; ++j)
+        {
+            const float dx = curr[j-1] - curr[j+1];
+            const float dz = below[j] - above[j];
+
+            const float invNormalLength = 1.0f / sqrtf(dx*dx + dz*dz + twoDx*twoDx);
+            nx[j] = dx*invNormalLength;
+            ny[j] = twoDx*invNormalLength;
+            nz[j] = dz*invNormalLength;
+
+            const float invTangentLength = 1.0f / sqrtf(dx*dx + twoDx*twoDx);
+            tx[j] = twoDx*invTangentLength;
+            ty[j] = -dx*invTangentLength;
+        }
+    }
+}
+
+void Waves::WriteVertices(std::span<std::byte> vertices, const VertexLayout& layout)const
+{
+    assert(vertices.size() >= std::size_t(mVertexCount)*layout.Stride);
+
+    const float oneOverWidth = 1.0f / Width();
+    const float oneOverDepth = 1.0f / Depth();
+    const std::size_t rowBytes = std::size_t(mNumCols)*layout.Stride;
+
+    mThreadPool.ParallelFor(0, mNumRows, RowsPerTask(), [&](std::size_t first, std::size_t last)
+    {
+        // With a prototype, rows are put together here and copied out in one piece.
+        // The attributes overwrite the same bytes in every row, so the prototype is
+        // only copied in once.
+        std::vector<std::byte> assembled;
+        if(layout.Prototype != nullptr)
+        {
+            assembled.resize(rowBytes);
+            for(std::size_t offset = 0; offset < rowBytes; offset += layout.Stride)
+                std::memcpy(assembled.data() + offset, layout.Prototype, layout.Stride);
+        }
+
+        for(std::size_t i = first; i < last; ++i)
+        {
+            const float z = mRowZ[i];
+            const std::size_t rowStart = i*mNumCols;
+            std::byte* const row = vertices.data() + rowStart*layout.Stride;
+            std::byte* vertex = assembled.empty() ? row : assembled.data();
+
+            for(int j = 0; j < mNumCols; ++j, vertex += layout.Stride)
+            {
+                const std::size_t k = rowStart + j;
+                const float x = mColumnX[j];
+
+                if(layout.PositionOffset >= 0)
+                {
+                    const float y = mPrevHeights[k] + mAlpha*(mCurrHeights[k] - mPrevHeights[k]);
+                    const XMFLOAT3 pos(x, y, z);
+                    std::memcpy(vertex + layout.PositionOffset, &pos, sizeof(pos));
+                }
+
+                if(layout.NormalOffset >= 0)
+                {
+                    const XMFLOAT3 normal(mNormalX[k], mNormalY[k], mNormalZ[k]);
+                    std::memcpy(vertex + layout.NormalOffset, &normal, sizeof(normal));
+                }
+
+                if(layout.TexCOffset >= 0)
+                {
+                    const XMFLOAT2 texC(0.5f + x*oneOverWidth, 0.5f - z*oneOverDepth);
+                    std::memcpy(vertex + layout.TexCOffset, &texC, sizeof(texC));
+                }
+            }
+
+            if(!assembled.empty())
+                std::memcpy(row, assembled.data(), rowBytes);
+        }
+    });
+}
+
+void Waves::Disturb(int i, int j, float magnitude)
+{
+    // Don't disturb boundaries.
+    assert(i > 1 && i < mNumRows-2);
+    assert(j > 1 && j < mNumCols-2);
+
+    if(mIsRecording)
+    {
+        InputEvent event;
+        event.Kind = InputEvent::Type::Disturb;
+        event.I = i;
+        event.J = j;
+        event.Magnitude = magnitude;
+        mRecordedEvents.push_back(event);
+    }
+
+    float halfMag = 0.5f*magnitude;
+
+    // Disturb the ijth vertex height and its neighbors.
+    mCurrHeights[i*mNumCols+j]     += magnitude;
+    mCurrHeights[i*mNumCols+j+1]   += halfMag;
+    mCurrHeights[i*mNumCols+j-1]   += halfMag;
+    mCurrHeights[(i+1)*mNumCols+j] += halfMag;
+    mCurrHeights[(i-1)*mNumCols+j] += halfMag;
+}
+
+void Waves::StartRecording()
+{
+    mIsRecording = true;
+    mRecordedEvents.clear();
+    mSnapshotPrevHeights = mPrevHeights;
+    mSnapshotCurrHeights = mCurrHeights;
+    mSnapshotAccumulator = mAccumulator;
+}
+
+void Waves::StopRecording()
+{
+    mIsRecording = false;
+}
+
+void Waves::Replay(std::span<const InputEvent> events)
+{
+    for(const InputEvent& event : events)
+    {
+        if(event.Kind == InputEvent::Type::Update)
+            Update(event.Dt);
+        else
+            Disturb(event.I, event.J, event.Magnitude);
+    }
+}
+
+bool Waves::VerifyReplay()const
+{
+    Waves replay(mNumRows, mNumCols, mSpatialStep, mTimeStep, mSpeed, mDamping);
+    replay.mMaxSubsteps = mMaxSubsteps;
+    replay.mPrevHeights = mSnapshotPrevHeights;
+    replay.mCurrHeights = mSnapshotCurrHeights;
+    replay.mAccumulator = mSnapshotAccumulator;
+
+    replay.Replay(mRecordedEvents);
+
+    // Compare bit patterns, not values: -0.0f == 0.0f would hide a divergence.
+    return std::memcmp(replay.mCurrHeights.data(), mCurrHeights.data(), mCurrHeights.size()*sizeof(float)) == 0 &&
+        std::memcmp(replay.mPrevHeights.data(), mPrevHeights.data(), mPrevHeights.size()*sizeof(float)) == 0;
+}
+
+std::uint64_t Waves::HeightFieldHash()const
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(mCurrHeights.data());
+    for(std::size_t k = 0; k < mCurrHeights.size()*sizeof(float); ++k)
+    {
+        hash ^= bytes[k];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,212 @@
+//***************************************************************************************
+// Waves.h by Frank Luna (C) 2011 All Rights Reserved.
+//
+// Performs the calculations for the wave simulation.  After the simulation has been
+// updated, the client must copy the current solution into vertex buffers for rendering.
+// This class only does the calculations, it does not do any drawing.
+//
+// Only the heights change over time, so they are kept in their own float grids and
+// the x/z coordinates of the grid points are stored once per column/row.  The update
+// runs bands of rows on the ThreadPool and evaluates four grid points per
+// DirectXMath vector.
+//
+// Update() advances the simulation in fixed steps of the time step passed to the
+// constructor.  Frame time is accumulated per object; a long frame runs several
+// catch-up steps (at most MaxSubsteps, the rest of the backlog is dropped) and the
+// leftover fraction of a step is exposed as InterpolationAlpha() for rendering.
+//***************************************************************************************
+
+#ifndef WAVES_H
+#define WAVES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <DirectXMath.h>
+
+class ThreadPool;
+
+class Waves final
+{
+public:
+    // One input applied to the simulation, as recorded for replay.
+    struct InputEvent final
+    {
+        enum class Type { Update, Disturb };
+
+        Type Kind = Type::Update;
+        float Dt = 0.0f;
+        int I = 0;
+        int J = 0;
+        float Magnitude = 0.0f;
+    };
+
+    // Where WriteVertices puts each attribute inside one vertex.  Attributes
+    // with a negative offset are not written.
+    //
+    // With a Prototype, every vertex starts as a copy of it and gets its attributes
+    // filled in, and whole rows of vertices are then copied to the destination, so it
+    // only sees complete, sequential writes; that is what write-combined upload memory
+    // wants.  Without one, only the attributes are stored and the rest of each vertex
+    // is left as is.
+    struct VertexLayout final
+    {
+        std::size_t Stride = 0;
+        std::ptrdiff_t PositionOffset = -1;
+        std::ptrdiff_t NormalOffset = -1;
+        std::ptrdiff_t TexCOffset = -1;
+        const std::byte* Prototype = nullptr;
+    };
+
+    static constexpr int DefaultMaxSubsteps = 4;
+
+    Waves(int m, int n, float dx, float dt, float speed, float damping);
+    Waves(const Waves& rhs) = delete;
+    Waves& operator=(const Waves& rhs) = delete;
+
+    int RowCount()const;
+    int ColumnCount()const;
+    int VertexCount()const;
+    int TriangleCount()const;
+    float Width()const;
+    float Depth()const;
+
+    // Returns the solution at the ith grid point.
+    DirectX::XMFLOAT3 Position(int i)const
+    {
+        return DirectX::XMFLOAT3(mColumnX[i % mNumCols], mCurrHeights[i], mRowZ[i / mNumCols]);
+    }
+
+    // Returns the solution normal at the ith grid point.
+    DirectX::XMFLOAT3 Normal(int i)const
+    {
+        return DirectX::XMFLOAT3(mNormalX[i], mNormalY[i], mNormalZ[i]);
+    }
+
+    // Returns the unit tangent vector at the ith grid point in the local x-axis direction.
+    DirectX::XMFLOAT3 TangentX(int i)const
+    {
+        return DirectX::XMFLOAT3(mTangentX[i], mTangentY[i], 0.0f);
+    }
+
+    // Returns the height of the ith grid point.
+    float Height(int i)const { return mCurrHeights[i]; }
+
+    // Returns the solution at the ith grid point, blended between the last two steps
+    // by InterpolationAlpha() so motion stays smooth when frames and steps do not line up.
+    DirectX::XMFLOAT3 InterpolatedPosition(int i)const
+    {
+        const float y = mPrevHeights[i] + mAlpha*(mCurrHeights[i] - mPrevHeights[i]);
+        return DirectX::XMFLOAT3(mColumnX[i % mNumCols], y, mRowZ[i / mNumCols]);
+    }
+
+    // Writes every grid point straight into a vertex array (typically a mapped upload
+    // buffer) in one parallel pass: the interpolated position, the normal and texture
+    // coordinates that map [-w/2,w/2] to [0,1].
+    void WriteVertices(std::span<std::byte> vertices, const VertexLayout& layout)const;
+
+    // Same, with the layout taken from VertexT's Pos and, if present, Normal and TexC
+    // members, and whole vertices written starting from prototype.
+    template<typename VertexT>
+    void WriteVertices(std::span<VertexT> vertices, const VertexT& prototype = VertexT{})const
+    {
+        VertexLayout layout;
+        layout.Stride = sizeof(VertexT);
+        layout.Prototype = reinterpret_cast<const std::byte*>(&prototype);
+        layout.PositionOffset = offsetof(VertexT, Pos);
+        if constexpr (requires(VertexT v) { v.Normal; })
+            layout.NormalOffset = offsetof(VertexT, Normal);
+        if constexpr (requires(VertexT v) { v.TexC; })
+            layout.TexCOffset = offsetof(VertexT, TexC);
+
+        WriteVertices(std::as_writable_bytes(vertices), layout);
+    }
+
+    // Fraction of a time step accumulated but not yet simulated, in [0, 1).
+    float InterpolationAlpha()const { return mAlpha; }
+
+    // Caps the number of steps one Update() call may run.
+    void SetMaxSubsteps(int maxSubsteps);
+    int MaxSubsteps()const { return mMaxSubsteps; }
+
+    // Grid points updated per second by the last simulation step (0 before the first).
+    double CellsPerSecond()const { return mCellsPerSecond; }
+
+    // Returns the number of simulation steps taken.
+    int Update(float dt);
+    void Disturb(int i, int j, float magnitude);
+
+    // Snapshots the current state and records every Update/Disturb from now on.
+    void StartRecording();
+    void StopRecording();
+    const std::vector<InputEvent>& Recording()const { return mRecordedEvents; }
+
+    // Applies recorded inputs in order.
+    void Replay(std::span<const InputEvent> events);
+
+    // Replays the recording on a fresh Waves started from the snapshot and checks that
+    // it ends with a bit-identical height field.
+    bool VerifyReplay()const;
+
+    // FNV-1a hash of the current height field, handy for comparing runs.
+    std::uint64_t HeightFieldHash()const;
+
+private:
+    void Step();
+    void UpdateHeights(int firstRow, int lastRow);
+    void UpdateNormals(int firstRow, int lastRow);
+
+    // Rows handed to one task; sized so a band of rows stays in cache.
+    int RowsPerTask()const;
+
+    int mNumRows = 0;
+    int mNumCols = 0;
+
+    int mVertexCount = 0;
+    int mTriangleCount = 0;
+
+    // Simulation constants we can precompute.
+    float mK1 = 0.0f;
+    float mK2 = 0.0f;
+    float mK3 = 0.0f;
+
+    float mTimeStep = 0.0f;
+    float mSpatialStep = 0.0f;
+
+    // Kept so VerifyReplay() can build an identical simulation.
+    float mSpeed = 0.0f;
+    float mDamping = 0.0f;
+
+    float mAccumulator = 0.0f;
+    float mAlpha = 0.0f;
+    int mMaxSubsteps = DefaultMaxSubsteps;
+
+    double mCellsPerSecond = 0.0;
+
+    ThreadPool& mThreadPool;
+
+    std::vector<float> mColumnX;
+    std::vector<float> mRowZ;
+
+    std::vector<float> mPrevHeights;
+    std::vector<float> mCurrHeights;
+
+    std::vector<float> mNormalX;
+    std::vector<float> mNormalY;
+    std::vector<float> mNormalZ;
+
+    // The tangent lies in the xy-plane.
+    std::vector<float> mTangentX;
+    std::vector<float> mTangentY;
+
+    // Replay support: the inputs seen since StartRecording() and the state they
+    // were applied to.
+    bool mIsRecording = false;
+    std::vector<InputEvent> mRecordedEvents;
+    std::vector<float> mSnapshotPrevHeights;
+    std::vector<float> mSnapshotCurrHeights;
+    float mSnapshotAccumulator = 0.0f;
+};
+
+#endif // WAVES_H
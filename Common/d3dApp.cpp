@@ -5,10 +5,12 @@
 
 #include <string>
 #include <format>
+#include <fstream>
 
 #include <WindowsX.h>
 
 #include "d3dUtil.h"
+#include "Profiler.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace std;
@@ -67,6 +69,7 @@ int D3DApp::Run()
     MSG msg = { 0 };
 
     mTimer.Reset();
+    Profiler::SetThreadName("Main");
 
     while (msg.message != WM_QUIT) [[likely]]
     {
@@ -83,9 +86,17 @@ int D3DApp::Run()
 
             if (!mAppPaused) [[likely]]
             {
+                PROFILE_SCOPE("Frame");
+
                 CalculateFrameStats();
-                Update(mTimer);
-                Draw(mTimer);
+                {
+                    PROFILE_SCOPE("Update");
+                    Update(mTimer);
+                }
+                {
+                    PROFILE_SCOPE("Draw");
+                    Draw(mTimer);
+                }
             }
             else
             {
@@ -363,6 +374,19 @@ LRESULT D3DApp::MsgProc(
         case WM_MOUSEMOVE:
             OnMouseMove(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
             return 0;
+
+            // F8 starts and stops a CPU profiling capture, saved to Trace.json for
+            // chrome://tracing.  F9 saves the recent frame times for offline analysis.
+        case WM_KEYUP:
+            if (wParam == VK_F8)
+            {
+                ToggleProfilerCapture(L"Trace.json");
+            }
+            else if (wParam == VK_F9)
+            {
+                WriteFrameStatsCsv(L"FrameTimes.csv");
+            }
+            return 0;
     }
 
     return DefWindowProc(hwnd, msg, wParam, lParam);
@@ -541,6 +565,8 @@ void D3DApp::CreateSwapChain()
 
 void D3DApp::FlushCommandQueue()
 {
+    PROFILE_SCOPE("FlushCommandQueue");
+
     // Advance the fence value to mark commands up to this fence point.
     ++mCurrentFence;
 
@@ -584,34 +610,73 @@ D3D12_CPU_DESCRIPTOR_HANDLE D3DApp::DepthStencilView()const
 
 void D3DApp::CalculateFrameStats()
 {
-    // Code computes the average frames per second, and also the 
-    // average time it takes to render one frame.  These stats 
-    // are appended to the window caption bar.
+    // Code records the duration of every frame and, once per second, appends the
+    // frames per second and a summary of the recent frame times to the window
+    // caption bar.  The mean hides occasional long frames; p99 and the worst
+    // frame show them.
 
-    static int frameCnt = 0;
-    static float timeElapsed = 0.0f;
+    mFrameStats.AddFrame(mTimer.DeltaTime());
 
-    ++frameCnt;
-
-    // Compute averages over one second period.
-    if ((mTimer.TotalTime() - timeElapsed) >= 1.0f)
+    if ((mTimer.TotalTime() - mFrameStatsTime) >= 1.0f)
     {
-        const float fps = static_cast<float>(frameCnt); // fps = frameCnt / 1
-        const float mspf = 1000.0f / fps;
+        const std::uint64_t frameCnt = mFrameStats.TotalFrames() - mFrameStatsFirstFrame;
+        const FrameStats::Summary summary = mFrameStats.Summarize();
 
         const std::wstring windowText = std::format(
-            L"{}    fps: {}    mspf: {}",
+            L"{}    fps: {}    mspf: {:.2f}    p50: {:.2f}    p95: {:.2f}    p99: {:.2f}    worst: {:.2f}",
             mMainWndCaption,
-            fps,
-            mspf);
+            frameCnt,
+            summary.AvgMs,
+            summary.P50Ms,
+            summary.P95Ms,
+            summary.P99Ms,
+            summary.MaxMs);
         SetWindowTextW(mhMainWnd, windowText.c_str());
 
-        // Reset for next average.
-        frameCnt = 0;
-        timeElapsed += 1.0f;
+        // Reset for next second.
+        mFrameStatsFirstFrame = mFrameStats.TotalFrames();
+        mFrameStatsTime += 1.0f;
     }
 }
 
+void D3DApp::WriteFrameStatsCsv(const wchar_t* const fileName)const
+{
+    std::ofstream file(fileName);
+    if (!file)
+    {
+        OutputDebugStringW(std::format(L"Could not write {}\n", fileName).c_str());
+        return;
+    }
+
+    mFrameStats.WriteCsv(file);
+    OutputDebugStringW(std::format(L"Wrote {} frame times to {}\n", mFrameStats.FrameCount(), fileName).c_str());
+}
+
+void D3DApp::ToggleProfilerCapture(const wchar_t* const fileName)const
+{
+    if (!Profiler::Capturing())
+    {
+        Profiler::BeginCapture();
+        OutputDebugStringW(L"Profiler capture started\n");
+        return;
+    }
+
+    Profiler::EndCapture();
+
+    std::ofstream file(fileName);
+    if (!file)
+    {
+        OutputDebugStringW(std::format(L"Could not write {}\n", fileName).c_str());
+        return;
+    }
+
+    Profiler::WriteChromeTrace(file);
+    OutputDebugStringW(std::format(
+        L"Wrote profiler capture to {} ({} zones dropped)\n",
+        fileName,
+        Profiler::DroppedZones()).c_str());
+}
+
 void D3DApp::LogAdapters()
 {
     OutputDebugStringW(L"ADAPTERS:\n");
@@ -23,6 +23,7 @@
 
 #include "d3dx12.h"
 #include "GameTimer.h"
+#include "FrameStats.h"
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib,"d3dcompiler.lib")
@@ -76,6 +77,8 @@ protected:
     D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView()const;
 
     void CalculateFrameStats();
+    void WriteFrameStatsCsv(const wchar_t* fileName)const;
+    void ToggleProfilerCapture(const wchar_t* fileName)const;
 
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
@@ -96,6 +99,12 @@ protected:
     // Used to keep track of the delta-time and game time (4.4).
     GameTimer mTimer;
 
+    // Durations of the recent frames, and the frame and time the caption was last
+    // updated at.
+    FrameStats mFrameStats;
+    std::uint64_t mFrameStatsFirstFrame = 0;
+    float mFrameStatsTime = 0.0f;
+
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain4> mSwapChain;
     Microsoft::WRL::ComPtr<ID3D12Device> md3dDevice;
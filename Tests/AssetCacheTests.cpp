@@ -0,0 +1,217 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// AssetCache hits and misses by path and by content, reloads of rewritten files, and
+// entries expiring with their last handle.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <fstream>
+#include <vector>
+
+#include "AssetCache.h"
+
+namespace
+{
+    // Scratch directory, emptied for each test.
+    std::filesystem::path ScratchDirectory()
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "AssetCacheTests";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        return directory;
+    }
+
+    std::vector<std::byte> Pattern(const std::size_t size, const unsigned seed)
+    {
+        std::vector<std::byte> bytes(size);
+        for (std::size_t i = 0; i < size; ++i)
+            bytes[i] = std::byte((i * 131 + seed * 7) >> 3);
+        return bytes;
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::vector<std::byte>& bytes)
+    {
+        std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+        fout.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    }
+
+    // Maps the file and counts the calls.  The asset keeps the mapping, as a
+    // DDSFile::Texture or MeshFile::MappedMesh does.
+    using Mapping = std::shared_ptr<const MappedFile>;
+
+    struct Loader final
+    {
+        int Calls = 0;
+
+        AssetCache::Handle<Mapping> operator()(AssetCache& cache, const std::filesystem::path& path)
+        {
+            return cache.Get<Mapping>(path.wstring(), [this](const std::wstring& filename, Mapping& mapping)
+            {
+                ++Calls;
+                mapping = MappedFile::Open(filename);
+                return mapping;
+            });
+        }
+    };
+}
+
+TEST_CASE(AssetCachePathAndContentHits)
+{
+    const std::filesystem::path directory = ScratchDirectory();
+    WriteFile(directory / "a.bin", Pattern(300 * 1024, 1));
+    WriteFile(directory / "copy of a.bin", Pattern(300 * 1024, 1));
+    WriteFile(directory / "b.bin", Pattern(300 * 1024, 2));
+
+    AssetCache cache;
+    Loader load;
+
+    const auto a = load(cache, directory / "a.bin");
+    REQUIRE(a != nullptr);
+    CHECK(a->Value->Size() == 300 * 1024);
+
+    // Same path, spelled differently: no load at all.
+    const auto again = load(cache, directory / "." / "a.bin");
+    CHECK(again == a);
+    CHECK(load.Calls == 1);
+
+    // Same bytes under another name: loaded, then found by content.
+    const auto copy = load(cache, directory / "copy of a.bin");
+    CHECK(copy == a);
+    CHECK(load.Calls == 2);
+
+    const auto b = load(cache, directory / "b.bin");
+    REQUIRE(b != nullptr);
+    CHECK(b != a);
+    CHECK(b->ContentId != a->ContentId);
+
+    CHECK(load(cache, directory / "missing.bin") == nullptr);
+
+    const AssetCache::Stats stats = cache.GetStats();
+    CHECK(stats.PathHits == 1);
+    CHECK(stats.ContentHits == 1);
+    CHECK(stats.Misses == 2);
+    CHECK(stats.BytesLoaded == 2 * 300 * 1024);
+    CHECK(stats.BytesSaved == 2 * 300 * 1024);
+}
+
+TEST_CASE(AssetCacheComparesBytesOfSampleCollisions)
+{
+    // Same size and one byte apart where SampleBytes does not look, so the sampled
+    // hashes collide and only the full comparison tells the files apart.
+    const std::filesystem::path directory = ScratchDirectory();
+    std::vector<std::byte> bytes = Pattern(1024 * 1024, 3);
+    WriteFile(directory / "a.bin", bytes);
+
+    const std::size_t unsampled = 4096 + 1024 + 10;
+    bytes[unsampled] ^= std::byte(0xFF);
+    WriteFile(directory / "b.bin", bytes);
+
+    const auto mappedA = MappedFile::Open((directory / "a.bin").wstring());
+    const auto mappedB = MappedFile::Open((directory / "b.bin").wstring());
+    REQUIRE(mappedA != nullptr && mappedB != nullptr);
+    CHECK(AssetCache::SampleBytes(mappedA->Bytes()) == AssetCache::SampleBytes(mappedB->Bytes()));
+    CHECK(AssetCache::HashBytes(mappedA->Bytes()) != AssetCache::HashBytes(mappedB->Bytes()));
+
+    AssetCache cache;
+    Loader load;
+    const auto a = load(cache, directory / "a.bin");
+    const auto b = load(cache, directory / "b.bin");
+    REQUIRE(a != nullptr && b != nullptr);
+    CHECK(a != b);
+    CHECK(a->ContentId != b->ContentId);
+    CHECK(cache.GetStats().ContentHits == 0);
+    CHECK(cache.GetStats().Misses == 2);
+
+    // A size that differs in the last byte only is not even sampled alike.
+    bytes.pop_back();
+    CHECK(AssetCache::SampleBytes(bytes) != AssetCache::SampleBytes(mappedA->Bytes()));
+}
+
+TEST_CASE(AssetCacheReloadsRewrittenFiles)
+{
+    const std::filesystem::path directory = ScratchDirectory();
+    const std::filesystem::path path = directory / "model.bin";
+    WriteFile(path, Pattern(4096, 1));
+
+    AssetCache cache;
+    Loader load;
+    const auto before = load(cache, path);
+    REQUIRE(before != nullptr);
+
+    // As MeshFile::LoadOrConvert does when it reconverts.  The write time is moved on
+    // explicitly, as two writes can land in the same clock tick.
+    WriteFile(path, Pattern(8192, 2));
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(2));
+
+    const auto after = load(cache, path);
+    REQUIRE(after != nullptr);
+    CHECK(after != before);
+    CHECK(after->Value->Size() == 8192);
+    CHECK(load.Calls == 2);
+
+    // Unchanged from here on, so a plain path hit again.
+    CHECK(load(cache, path) == after);
+    CHECK(load.Calls == 2);
+}
+
+TEST_CASE(AssetCacheEntriesExpireWithTheirHandles)
+{
+    const std::filesystem::path directory = ScratchDirectory();
+    WriteFile(directory / "a.bin", Pattern(4096, 1));
+
+    AssetCache cache;
+    Loader load;
+
+    std::uint64_t firstId = 0;
+    {
+        const auto a = load(cache, directory / "a.bin");
+        REQUIRE(a != nullptr);
+        firstId = a->ContentId;
+    }
+
+    // The cache only held a weak reference, so this loads again.
+    const auto a = load(cache, directory / "a.bin");
+    REQUIRE(a != nullptr);
+    CHECK(load.Calls == 2);
+    CHECK(a->ContentId != firstId);
+    CHECK(cache.GetStats().PathHits == 0);
+
+    // Shared objects the same way.
+    int makes = 0;
+    const auto make = [&makes] { ++makes; return std::make_shared<int>(42); };
+    const int device = 0;
+
+    std::weak_ptr<int> weak;
+    {
+        const std::shared_ptr<int> object = cache.GetShared<int>(&device, a->ContentId, 0, make);
+        CHECK(cache.GetShared<int>(&device, a->ContentId, 0, make) == object);
+        CHECK(makes == 1);
+        weak = object;
+    }
+    CHECK(weak.expired());
+    CHECK(cache.GetShared<int>(&device, a->ContentId, 0, make) != nullptr);
+    CHECK(makes == 2);
+
+    cache.Trim();
+    CHECK(cache.GetStats().SharedHits == 1);
+    CHECK(cache.GetStats().SharedMisses == 2);
+}
+
+TEST_CASE(AssetCacheSharesWithinScopeAndVariant)
+{
+    AssetCache cache;
+    int makes = 0;
+    const auto make = [&makes] { return std::make_shared<int>(++makes); };
+
+    const int device = 0;
+    const int otherDevice = 0;
+    const auto object = cache.GetShared<int>(&device, 1, 7, make);
+    CHECK(cache.GetShared<int>(&device, 1, 7, make) == object);
+    CHECK(cache.GetShared<int>(&otherDevice, 1, 7, make) != object);
+    CHECK(cache.GetShared<int>(&device, 1, 8, make) != object);
+    CHECK(cache.GetShared<int>(&device, 2, 7, make) != object);
+    CHECK(makes == 4);
+}
@@ -0,0 +1,289 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// Checks DDSFile's subresource layout against DirectXTex's ComputePitch rules for every
+// DDS file in Textures, and times the parse.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "DDSFile.h"
+
+namespace
+{
+    constexpr std::uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+    constexpr std::uint32_t DDS_FOURCC = 0x00000004;
+    constexpr std::uint32_t DX10_FOURCC = 0x30315844; // "DX10"
+
+    struct Pitch final
+    {
+        std::size_t Row = 0;
+        std::size_t Slice = 0;
+    };
+
+    // DirectX::ComputePitch with CP_FLAGS_NONE, written out again so that it does
+    // not share code with DDSFile::GetSurfaceInfo.
+    Pitch ComputePitch(const DXGI_FORMAT format, const std::size_t width, const std::size_t height)
+    {
+        Pitch pitch;
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            pitch.Row = std::max<std::size_t>(1, (width + 3) / 4) * 8;
+            pitch.Slice = pitch.Row * std::max<std::size_t>(1, (height + 3) / 4);
+            return pitch;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            pitch.Row = std::max<std::size_t>(1, (width + 3) / 4) * 16;
+            pitch.Slice = pitch.Row * std::max<std::size_t>(1, (height + 3) / 4);
+            return pitch;
+
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_YUY2:
+            pitch.Row = ((width + 1) >> 1) * 4;
+            pitch.Slice = pitch.Row * height;
+            return pitch;
+
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            pitch.Row = ((width + 1) >> 1) * 8;
+            pitch.Slice = pitch.Row * height;
+            return pitch;
+
+        case DXGI_FORMAT_NV12:
+        case DXGI_FORMAT_420_OPAQUE:
+            pitch.Row = ((width + 1) >> 1) * 2;
+            pitch.Slice = pitch.Row * (height + ((height + 1) >> 1));
+            return pitch;
+
+        case DXGI_FORMAT_P010:
+        case DXGI_FORMAT_P016:
+            pitch.Row = ((width + 1) >> 1) * 4;
+            pitch.Slice = pitch.Row * (height + ((height + 1) >> 1));
+            return pitch;
+
+        case DXGI_FORMAT_NV11:
+            pitch.Row = ((width + 3) >> 2) * 4;
+            pitch.Slice = pitch.Row * height * 2;
+            return pitch;
+
+        default:
+            // Bits per pixel is a plain table; the layout rules are what is under test.
+            pitch.Row = (width * DDSFile::BitsPerPixel(format) + 7) / 8;
+            pitch.Slice = pitch.Row * height;
+            return pitch;
+        }
+    }
+
+    std::vector<std::filesystem::path> DDSFiles()
+    {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(Tests::RepoPath("Textures")))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".dds")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    // Header of a DX10 DDS file with no texel data.
+    std::vector<std::byte> MakeDX10Header(const std::uint32_t width, const std::uint32_t height,
+        const DXGI_FORMAT format, const std::uint32_t miscFlag, const std::uint32_t arraySize)
+    {
+        DDSFile::Header header = {};
+        header.size = sizeof(header);
+        header.flags = 0x1 | 0x2 | 0x4 | 0x1000; // caps, height, width, pixel format
+        header.width = width;
+        header.height = height;
+        header.mipMapCount = 1;
+        header.ddspf.size = sizeof(header.ddspf);
+        header.ddspf.flags = DDS_FOURCC;
+        header.ddspf.fourCC = DX10_FOURCC;
+
+        DDSFile::HeaderDXT10 dx10 = {};
+        dx10.dxgiFormat = format;
+        dx10.resourceDimension = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        dx10.miscFlag = miscFlag;
+        dx10.arraySize = arraySize;
+
+        std::vector<std::byte> image(sizeof(DDS_MAGIC) + sizeof(header) + sizeof(dx10));
+        std::memcpy(image.data(), &DDS_MAGIC, sizeof(DDS_MAGIC));
+        std::memcpy(image.data() + sizeof(DDS_MAGIC), &header, sizeof(header));
+        std::memcpy(image.data() + sizeof(DDS_MAGIC) + sizeof(header), &dx10, sizeof(dx10));
+        return image;
+    }
+}
+
+TEST_CASE(DDSFileLayoutMatchesDirectXTex)
+{
+    const std::vector<std::filesystem::path> files = DDSFiles();
+    REQUIRE(!files.empty());
+
+    for (const std::filesystem::path& path : files)
+    {
+        const std::string name = path.filename().string();
+
+        DDSFile::Texture texture;
+        const DDSFile::Result result = DDSFile::Load(path.wstring(), texture);
+        CHECK_MSG(result == DDSFile::Result::Ok, name);
+        if (result != DDSFile::Result::Ok)
+            continue;
+
+        const DDSFile::TextureDesc& desc = texture.Desc();
+        const std::span<const std::byte> image = texture.File()->Bytes();
+
+        // The texel data starts after the magic number, the header and, if the pixel
+        // format says so, the DX10 header.
+        DDSFile::Header header = {};
+        std::memcpy(&header, image.data() + sizeof(DDS_MAGIC), sizeof(header));
+        std::size_t dataOffset = sizeof(DDS_MAGIC) + sizeof(header);
+        if ((header.ddspf.flags & DDS_FOURCC) && header.ddspf.fourCC == DX10_FOURCC)
+            dataOffset += sizeof(DDSFile::HeaderDXT10);
+
+        CHECK_MSG(texture.Subresources().size() == std::size_t(desc.ArraySize) * desc.MipLevels, name);
+
+        // Array items one after the other, each with its full mip chain, each mip
+        // Depth slices, all tightly packed: the layout DirectXTex reads and writes.
+        std::size_t offset = dataOffset;
+        for (std::uint32_t item = 0; item < desc.ArraySize; ++item)
+        {
+            for (std::uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+            {
+                const std::uint32_t width = std::max<std::uint32_t>(desc.Width >> mip, 1);
+                const std::uint32_t height = std::max<std::uint32_t>(desc.Height >> mip, 1);
+                const std::uint32_t depth = std::max<std::uint32_t>(desc.Depth >> mip, 1);
+                const Pitch pitch = ComputePitch(desc.Format, width, height);
+
+                const DDSFile::Subresource& subresource = texture.GetSubresource(mip, item);
+                const std::size_t actualOffset = std::size_t(subresource.Data - image.data());
+                CHECK_MSG(actualOffset == offset, name << " item " << item << " mip " << mip
+                    << ": offset " << actualOffset << ", expected " << offset);
+                CHECK_MSG(subresource.RowPitch == pitch.Row, name << " item " << item << " mip " << mip
+                    << ": row pitch " << subresource.RowPitch << ", expected " << pitch.Row);
+                CHECK_MSG(subresource.SlicePitch == pitch.Slice, name << " item " << item << " mip " << mip
+                    << ": slice pitch " << subresource.SlicePitch << ", expected " << pitch.Slice);
+                CHECK_MSG(subresource.Width == width && subresource.Height == height && subresource.Depth == depth,
+                    name << " item " << item << " mip " << mip);
+
+                offset += pitch.Slice * depth;
+            }
+        }
+
+        CHECK_MSG(texture.DataSize() == offset - dataOffset, name);
+        CHECK_MSG(offset <= image.size(), name << ": data ends at " << offset << " of " << image.size());
+    }
+
+    std::cout << "  " << files.size() << " files\n";
+}
+
+TEST_CASE(DDSFileRejectsTruncatedImages)
+{
+    const std::vector<std::filesystem::path> files = DDSFiles();
+    REQUIRE(!files.empty());
+
+    DDSFile::Texture texture;
+    REQUIRE(DDSFile::Load(files.front().wstring(), texture) == DDSFile::Result::Ok);
+
+    const std::span<const std::byte> image = texture.File()->Bytes();
+    const std::size_t end = std::size_t(texture.Subresources().back().Data - image.data())
+        + texture.Subresources().back().SlicePitch * texture.Subresources().back().Depth;
+
+    DDSFile::Texture truncated;
+    CHECK(DDSFile::Parse(image.first(end - 1), truncated) == DDSFile::Result::Truncated);
+    CHECK(!truncated.IsValid());
+    CHECK(DDSFile::Parse(image.first(64), truncated) == DDSFile::Result::InvalidData);
+}
+
+TEST_CASE(DDSFileRejectsOverflowingCubeArrays)
+{
+    constexpr std::uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+    // 6 * 0x2AAAAAAB wraps around to 2, which would pass every later check.
+    std::vector<std::byte> image = MakeDX10Header(4, 4, DXGI_FORMAT_BC1_UNORM, DDS_RESOURCE_MISC_TEXTURECUBE, 0x2AAAAAAB);
+    DDSFile::Texture texture;
+    CHECK(DDSFile::Parse(image, texture) != DDSFile::Result::Ok);
+
+    // A single cube is fine once its faces are there.
+    image = MakeDX10Header(4, 4, DXGI_FORMAT_BC1_UNORM, DDS_RESOURCE_MISC_TEXTURECUBE, 1);
+    image.resize(image.size() + 6 * 8);
+    REQUIRE(DDSFile::Parse(image, texture) == DDSFile::Result::Ok);
+    CHECK(texture.Desc().IsCubeMap);
+    CHECK(texture.Desc().ArraySize == 6);
+}
+
+BENCHMARK(DDSFileParse)
+{
+    const std::vector<std::filesystem::path> files = DDSFiles();
+    REQUIRE(!files.empty());
+
+    const int repeats = Tests::QuickBenchmarks() ? 2 : 50;
+    const std::uint64_t peakBefore = Tests::PeakMemoryBytes();
+
+    // Load maps the file as well; Parse alone is the header walk over a mapped image.
+    std::size_t subresources = 0;
+    const double loadMs = Tests::BestOf(repeats, [&]
+    {
+        subresources = 0;
+        for (const std::filesystem::path& path : files)
+        {
+            DDSFile::Texture texture;
+            DDSFile::Load(path.wstring(), texture);
+            subresources += texture.Subresources().size();
+        }
+    });
+
+    std::vector<DDSFile::Texture> mapped(files.size());
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        DDSFile::Load(files[i].wstring(), mapped[i]);
+        if (mapped[i].File() != nullptr)
+            bytes += mapped[i].File()->Bytes().size();
+    }
+
+    const double parseMs = Tests::BestOf(repeats, [&]
+    {
+        for (const DDSFile::Texture& source : mapped)
+        {
+            if (source.File() == nullptr)
+                continue;
+            DDSFile::Texture texture;
+            DDSFile::Parse(source.File()->Bytes(), texture);
+            Tests::DoNotOptimize(&texture);
+        }
+    });
+
+    const std::uint64_t peakAfter = Tests::PeakMemoryBytes();
+
+    std::cout << "  " << files.size() << " files, " << bytes / 1024 << " KiB, " << subresources << " subresources\n"
+        << "  map + parse: " << loadMs * 1000.0 / files.size() << " us/file\n"
+        << "  parse only:  " << parseMs * 1000.0 / files.size() << " us/file\n"
+        << "  peak memory: " << peakAfter / 1024 << " KiB (" << (peakAfter - peakBefore) / 1024
+        << " KiB above the start; mapped pages count only once touched)\n";
+}
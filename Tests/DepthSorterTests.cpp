@@ -0,0 +1,191 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// DepthSorter against std::stable_sort on the same quantized depths, its handling of
+// depths that are not finite, render layers ordered as the demos' SortRenderLayer does
+// it while the camera moves around them, and both sorts on 100K items.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "DepthSorter.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // Depths from 1 to 500 with many exact ties, as items on a grid give.
+    std::vector<float> RandomDepths(const std::size_t count, const unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> depth(1.0f, 500.0f);
+        std::vector<float> depths(count);
+        for (float& d : depths)
+            d = random() % 4 == 0 ? std::floor(depth(random) / 50.0f) * 50.0f : depth(random);
+        return depths;
+    }
+
+    // The order DepthSorter should produce: stable by depth quantized as it does it.
+    std::vector<std::uint32_t> ReferenceOrder(const std::vector<float>& depths, const DepthSorter::Order order)
+    {
+        const auto [minDepth, maxDepth] = std::minmax_element(depths.begin(), depths.end());
+        const float scale = 65535.0f / (*maxDepth - *minDepth);
+        std::vector<std::uint16_t> keys(depths.size());
+        for (std::size_t i = 0; i < depths.size(); ++i)
+            keys[i] = static_cast<std::uint16_t>(std::min((depths[i] - *minDepth) * scale, 65535.0f));
+
+        std::vector<std::uint32_t> sorted(depths.size());
+        std::iota(sorted.begin(), sorted.end(), 0u);
+        std::stable_sort(sorted.begin(), sorted.end(), [&](const std::uint32_t a, const std::uint32_t b)
+        {
+            return order == DepthSorter::Order::FrontToBack ? keys[a] < keys[b] : keys[a] > keys[b];
+        });
+        return sorted;
+    }
+}
+
+TEST_CASE(DepthSorterMatchesStableSort)
+{
+    DepthSorter sorter;
+    std::vector<std::uint32_t> sorted;
+    for (const std::size_t count : { std::size_t(0), std::size_t(1), std::size_t(2), std::size_t(1000), std::size_t(70000) })
+    {
+        const std::vector<float> depths = RandomDepths(count, unsigned(count));
+        for (const DepthSorter::Order order : { DepthSorter::Order::FrontToBack, DepthSorter::Order::BackToFront })
+        {
+            sorter.Sort(depths, order, sorted);
+            if (count < 2)
+                CHECK(sorted.size() == count);
+            else
+                CHECK_MSG(sorted == ReferenceOrder(depths, order), count << " depths");
+        }
+    }
+
+    // Equal depths keep the order they came in.
+    const std::vector<float> equal(100, 3.0f);
+    sorter.Sort(equal, DepthSorter::Order::BackToFront, sorted);
+    CHECK(std::is_sorted(sorted.begin(), sorted.end()));
+}
+
+TEST_CASE(DepthSorterHandlesNonFiniteDepths)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<float> depths = { 5.0f, nan, -inf, 2.0f, inf, 9.0f, 7.0f };
+
+    // Infinities sort with the ends of the finite range, NaN with the far end; the
+    // finite depths stay in order among themselves.
+    DepthSorter sorter;
+    std::vector<std::uint32_t> sorted;
+    sorter.Sort(depths, DepthSorter::Order::FrontToBack, sorted);
+    CHECK((sorted == std::vector<std::uint32_t>{ 2, 3, 0, 6, 1, 4, 5 }));
+
+    sorter.Sort(depths, DepthSorter::Order::BackToFront, sorted);
+    CHECK((sorted == std::vector<std::uint32_t>{ 1, 4, 5, 6, 0, 2, 3 }));
+
+    // Nothing finite at all is one tie.
+    sorter.Sort(std::vector<float>{ nan, inf, -inf }, DepthSorter::Order::FrontToBack, sorted);
+    CHECK((sorted == std::vector<std::uint32_t>{ 0, 1, 2 }));
+}
+
+TEST_CASE(DepthSorterViewDepthUsesWorldView)
+{
+    const BoundingBox box(XMFLOAT3(0.0f, 0.0f, 2.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+    const XMMATRIX world = XMMatrixTranslation(0.0f, 0.0f, 10.0f);
+    const XMMATRIX view = XMMatrixTranslation(0.0f, 0.0f, -3.0f);
+    CHECK(DepthSorter::ViewDepth(world * view, box) == 9.0f);
+}
+
+TEST_CASE(DepthSorterOrdersRenderLayersAsTheCameraMoves)
+{
+    // A row of crates and, across it, two panes of water, seen from a camera orbiting
+    // the scene as in the Chapter 10 demos.
+    const BoundingBox crateBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.5f, 1.5f, 1.5f));
+    std::vector<XMFLOAT4X4> crates(6);
+    for (std::size_t i = 0; i < crates.size(); ++i)
+        XMStoreFloat4x4(&crates[i], XMMatrixTranslation(-45.0f + 18.0f * i, 2.0f, 25.0f));
+
+    const BoundingBox paneBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(20.0f, 0.0f, 20.0f));
+    std::vector<XMFLOAT4X4> panes(2);
+    XMStoreFloat4x4(&panes[0], XMMatrixTranslation(-30.0f, -1.0f, 0.0f));
+    XMStoreFloat4x4(&panes[1], XMMatrixTranslation(30.0f, -1.0f, 0.0f));
+
+    DepthSorter sorter;
+    std::vector<float> depths;
+    std::vector<std::uint32_t> sorted;
+    const auto sortLayer = [&](const std::vector<XMFLOAT4X4>& worlds, const BoundingBox& box, FXMMATRIX view,
+        const DepthSorter::Order order)
+    {
+        depths.resize(worlds.size());
+        for (std::size_t i = 0; i < worlds.size(); ++i)
+            depths[i] = DepthSorter::ViewDepth(XMLoadFloat4x4(&worlds[i]) * view, box);
+        sorter.Sort(depths, order, sorted);
+    };
+
+    std::uint32_t nearestCrates[2] = {};
+    std::uint32_t farthestPanes[2] = {};
+    const float thetas[] = { 0.0f, XM_PI };
+    for (int view = 0; view < 2; ++view)
+    {
+        const XMVECTOR eye = XMVectorSet(80.0f * std::cos(thetas[view]), 40.0f, 80.0f * std::sin(thetas[view]), 1.0f);
+        const XMMATRIX viewMatrix = XMMatrixLookAtLH(eye, XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+
+        // Alpha-tested items front to back.
+        sortLayer(crates, crateBox, viewMatrix, DepthSorter::Order::FrontToBack);
+        REQUIRE(sorted.size() == crates.size());
+        for (std::size_t i = 1; i < sorted.size(); ++i)
+            CHECK_MSG(depths[sorted[i - 1]] <= depths[sorted[i]], "view " << view << ", crate " << i);
+        nearestCrates[view] = sorted.front();
+
+        // Transparent items back to front.
+        sortLayer(panes, paneBox, viewMatrix, DepthSorter::Order::BackToFront);
+        REQUIRE(sorted.size() == panes.size());
+        CHECK(depths[sorted[0]] > depths[sorted[1]]);
+        farthestPanes[view] = sorted.front();
+    }
+
+    // From +x the crate at the +x end is nearest and the -x pane farthest; from -x
+    // it is the other way round.
+    CHECK(nearestCrates[0] == 5);
+    CHECK(nearestCrates[1] == 0);
+    CHECK(farthestPanes[0] == 0);
+    CHECK(farthestPanes[1] == 1);
+}
+
+BENCHMARK(DepthSorterThroughput)
+{
+    const std::size_t count = Tests::QuickBenchmarks() ? 10000 : 100000;
+    const int repeats = Tests::QuickBenchmarks() ? 3 : 20;
+    const std::vector<float> depths = RandomDepths(count, 1);
+
+    DepthSorter sorter;
+    std::vector<std::uint32_t> sorted;
+    const double radixMs = Tests::BestOf(repeats, [&]
+    {
+        sorter.Sort(depths, DepthSorter::Order::BackToFront, sorted);
+        Tests::DoNotOptimize(sorted.data());
+    });
+
+    std::vector<std::uint32_t> reference(count);
+    const double stableMs = Tests::BestOf(repeats, [&]
+    {
+        std::iota(reference.begin(), reference.end(), 0u);
+        std::stable_sort(reference.begin(), reference.end(), [&](const std::uint32_t a, const std::uint32_t b)
+        {
+            return depths[a] > depths[b];
+        });
+        Tests::DoNotOptimize(reference.data());
+    });
+
+    std::cout << "  " << count << " depths: DepthSorter " << radixMs << " ms, std::stable_sort "
+        << stableMs << " ms\n";
+}
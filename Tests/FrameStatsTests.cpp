@@ -0,0 +1,161 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// FrameStats: nearest-rank percentiles, the worst frame once the ring has wrapped, Clear,
+// and the CSV dump in frame order.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FrameStats.h"
+
+namespace
+{
+    // Adds frames of 1, 2, ..., count ms in a shuffled order.
+    void AddShuffledFrames(FrameStats& stats, const int count)
+    {
+        std::vector<int> ms(count);
+        for (int i = 0; i < count; ++i)
+            ms[i] = i + 1;
+        std::shuffle(ms.begin(), ms.end(), std::mt19937(5));
+        for (const int frameMs : ms)
+            stats.AddFrame(frameMs / 1000.0f);
+    }
+
+    bool Near(const float a, const float b)
+    {
+        return std::abs(a - b) < 1e-3f;
+    }
+}
+
+TEST_CASE(FrameStatsNearestRankPercentiles)
+{
+    // Nearest rank: the smallest value with at least p% of the frames at or below it.
+    struct Expected final
+    {
+        int Count;
+        float P50;
+        float P95;
+        float P99;
+    };
+    const Expected cases[] =
+    {
+        { 1, 1.0f, 1.0f, 1.0f },
+        { 2, 1.0f, 2.0f, 2.0f },
+        { 10, 5.0f, 10.0f, 10.0f },
+        { 20, 10.0f, 19.0f, 20.0f },
+        { 100, 50.0f, 95.0f, 99.0f },
+        { 101, 51.0f, 96.0f, 100.0f },
+        { 1000, 500.0f, 950.0f, 990.0f },
+    };
+
+    for (const Expected& expected : cases)
+    {
+        FrameStats stats(1000);
+        AddShuffledFrames(stats, expected.Count);
+
+        const FrameStats::Summary summary = stats.Summarize();
+        CHECK(summary.FrameCount == std::size_t(expected.Count));
+        CHECK_MSG(Near(summary.MinMs, 1.0f), expected.Count << ": " << summary.MinMs);
+        CHECK_MSG(Near(summary.MaxMs, float(expected.Count)), expected.Count << ": " << summary.MaxMs);
+        CHECK_MSG(Near(summary.AvgMs, (expected.Count + 1) / 2.0f), expected.Count << ": " << summary.AvgMs);
+        CHECK_MSG(Near(summary.P50Ms, expected.P50), expected.Count << ": p50 " << summary.P50Ms);
+        CHECK_MSG(Near(summary.P95Ms, expected.P95), expected.Count << ": p95 " << summary.P95Ms);
+        CHECK_MSG(Near(summary.P99Ms, expected.P99), expected.Count << ": p99 " << summary.P99Ms);
+    }
+
+    // One stutter in a hundred frames is below rank 99, so only the maximum and the
+    // worst frame show it.
+    FrameStats stats(100);
+    for (int i = 0; i < 100; ++i)
+        stats.AddFrame(i == 37 ? 0.1f : 0.016f);
+    const FrameStats::Summary summary = stats.Summarize();
+    CHECK(Near(summary.P50Ms, 16.0f));
+    CHECK(Near(summary.P95Ms, 16.0f));
+    CHECK(Near(summary.P99Ms, 16.0f));
+    CHECK(Near(summary.MaxMs, 100.0f));
+    CHECK(summary.WorstFrame == 37);
+}
+
+TEST_CASE(FrameStatsWorstFrameAfterWrap)
+{
+    FrameStats stats(8);
+    CHECK(stats.Summarize().FrameCount == 0);
+
+    // Frame 3 is the slowest, then falls out of the ring; frame 12 is the slowest left.
+    for (int frame = 0; frame < 20; ++frame)
+    {
+        const float ms = frame == 3 ? 50.0f : frame == 12 ? 30.0f : 10.0f + frame * 0.1f;
+        stats.AddFrame(ms / 1000.0f);
+
+        const FrameStats::Summary summary = stats.Summarize();
+        CHECK(summary.FrameCount == std::min<std::size_t>(frame + 1, 8));
+        if (frame >= 3 && frame < 11)
+            CHECK_MSG(summary.WorstFrame == 3 && Near(summary.MaxMs, 50.0f), "after frame " << frame);
+        else if (frame >= 12)
+            CHECK_MSG(summary.WorstFrame == 12 && Near(summary.MaxMs, 30.0f), "after frame " << frame);
+    }
+
+    // Once frame 12 has left the ring too, the newest frame is the slowest.
+    for (int frame = 20; frame < 30; ++frame)
+        stats.AddFrame(0.01f + frame * 0.0001f);
+    const FrameStats::Summary summary = stats.Summarize();
+    CHECK(stats.TotalFrames() == 30);
+    CHECK(summary.FrameCount == 8);
+    CHECK(summary.WorstFrame == 29);
+    CHECK(Near(summary.MinMs, 10.0f + 22 * 0.1f));
+}
+
+TEST_CASE(FrameStatsClear)
+{
+    FrameStats stats(16);
+    AddShuffledFrames(stats, 40);
+    REQUIRE(stats.FrameCount() == 16);
+
+    stats.Clear();
+    CHECK(stats.FrameCount() == 0);
+    CHECK(stats.TotalFrames() == 0);
+    CHECK(stats.Capacity() == 16);
+    CHECK(stats.Summarize().FrameCount == 0);
+
+    std::ostringstream csv;
+    stats.WriteCsv(csv);
+    CHECK(csv.str() == "frame,ms\n");
+
+    // Frames are numbered from the Clear, and none of the old ones come back.
+    stats.AddFrame(0.002f);
+    stats.AddFrame(0.001f);
+    const FrameStats::Summary summary = stats.Summarize();
+    CHECK(summary.FrameCount == 2);
+    CHECK(summary.WorstFrame == 0);
+    CHECK(Near(summary.MaxMs, 2.0f));
+    CHECK(Near(summary.MinMs, 1.0f));
+}
+
+TEST_CASE(FrameStatsCsvOldestFirst)
+{
+    FrameStats stats(4);
+    for (int frame = 0; frame < 3; ++frame)
+        stats.AddFrame((frame + 1) / 1000.0f);
+
+    std::ostringstream partial;
+    stats.WriteCsv(partial);
+    CHECK_MSG(partial.str() == "frame,ms\n0,1\n1,2\n2,3\n", partial.str());
+
+    // After wrapping: the last four frames in the order they were added, not in the
+    // order they sit in the ring.
+    for (int frame = 3; frame < 10; ++frame)
+        stats.AddFrame((frame + 1) / 1000.0f);
+
+    std::ostringstream wrapped;
+    stats.WriteCsv(wrapped);
+    CHECK_MSG(wrapped.str() == "frame,ms\n6,7\n7,8\n8,9\n9,10\n", wrapped.str());
+}
@@ -0,0 +1,205 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// FrustumCuller against the same plane test done one volume at a time, and on 100K
+// instances against the per-instance test in local space it replaced in the Chapter 16
+// demos.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "FrustumCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // Instances spread over a 400 x 100 x 400 block around the origin, seen by a
+    // camera looking down +z with a 45 degree field of view, as in InstancingAndCullingDemo.
+    struct Instance final
+    {
+        XMFLOAT4X4 World;
+        BoundingBox LocalBox;
+        BoundingBox WorldBox;
+        BoundingSphere WorldSphere;
+    };
+
+    XMMATRIX ViewProj()
+    {
+        const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 5.0f, -10.0f, 1.0f),
+            XMVectorSet(10.0f, 0.0f, 100.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        return XMMatrixMultiply(view, XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 250.0f));
+    }
+
+    std::vector<Instance> MakeInstances(const std::size_t count, const unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+        std::uniform_real_distribution<float> height(-50.0f, 50.0f);
+        std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+        std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+        std::vector<Instance> instances(count);
+        for (Instance& instance : instances)
+        {
+            const float scale = size(random);
+            const XMMATRIX world = XMMatrixScaling(scale, scale, scale) * XMMatrixRotationY(angle(random)) *
+                XMMatrixTranslation(position(random), height(random), position(random));
+            XMStoreFloat4x4(&instance.World, world);
+
+            // A unit box off its origin, as a model's bounds usually are.
+            instance.LocalBox = BoundingBox(XMFLOAT3(0.0f, 0.5f, 0.0f), XMFLOAT3(1.0f, 0.5f, 0.75f));
+
+            // World-space box enclosing the transformed corners, as the demos compute it.
+            XMVECTOR lo = XMVectorReplicate(1e30f);
+            XMVECTOR hi = XMVectorReplicate(-1e30f);
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                const XMVECTOR local = XMVectorSet(
+                    instance.LocalBox.Center.x + (corner & 1 ? 1.0f : -1.0f) * instance.LocalBox.Extents.x,
+                    instance.LocalBox.Center.y + (corner & 2 ? 1.0f : -1.0f) * instance.LocalBox.Extents.y,
+                    instance.LocalBox.Center.z + (corner & 4 ? 1.0f : -1.0f) * instance.LocalBox.Extents.z, 1.0f);
+                const XMVECTOR p = XMVector3TransformCoord(local, world);
+                lo = XMVectorMin(lo, p);
+                hi = XMVectorMax(hi, p);
+            }
+            XMStoreFloat3(&instance.WorldBox.Center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+            XMStoreFloat3(&instance.WorldBox.Extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+
+            instance.WorldSphere.Center = instance.WorldBox.Center;
+            instance.WorldSphere.Radius = XMVectorGetX(XMVector3Length(XMVectorSubtract(hi, lo))) * 0.5f;
+        }
+        return instances;
+    }
+
+    // Smallest margin of the volume over the six planes; negative means culled.
+    float Margin(const XMFLOAT4 planes[6], const XMFLOAT3& center, const XMFLOAT3& extents, const float radius)
+    {
+        float margin = 1e30f;
+        for (int i = 0; i < 6; ++i)
+        {
+            const XMFLOAT4& p = planes[i];
+            const float distance = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+            const float reach = std::fabs(p.x) * extents.x + std::fabs(p.y) * extents.y + std::fabs(p.z) * extents.z + radius;
+            margin = std::min(margin, distance + reach);
+        }
+        return margin;
+    }
+
+    // What the demos did before: the frustum brought into each instance's local space
+    // (here as the planes of world * viewProj) and tested against the local box.
+    bool VisibleInLocalSpace(const Instance& instance, FXMMATRIX viewProj)
+    {
+        XMFLOAT4 planes[6];
+        FrustumCuller::ExtractPlanes(XMMatrixMultiply(XMLoadFloat4x4(&instance.World), viewProj), planes);
+        return Margin(planes, instance.LocalBox.Center, instance.LocalBox.Extents, 0.0f) >= 0.0f;
+    }
+}
+
+TEST_CASE(FrustumCullerMatchesScalarPlaneTest)
+{
+    const std::vector<Instance> instances = MakeInstances(10003, 1);
+    const XMMATRIX viewProj = ViewProj();
+
+    XMFLOAT4 planes[6];
+    FrustumCuller::ExtractPlanes(viewProj, planes);
+
+    // Every other instance as a sphere, so both kinds share groups of four.
+    FrustumCuller culler;
+    culler.Reserve(instances.size());
+    for (std::size_t i = 0; i < instances.size(); ++i)
+    {
+        if (i % 2 == 0)
+            culler.Add(instances[i].WorldBox);
+        else
+            culler.Add(instances[i].WorldSphere);
+    }
+    REQUIRE(culler.Size() == instances.size());
+
+    std::vector<std::uint32_t> visible;
+    culler.Cull(viewProj, visible);
+
+    // Volumes within rounding of a plane may go either way.
+    std::size_t next = 0;
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < instances.size(); ++i)
+    {
+        const float margin = i % 2 == 0
+            ? Margin(planes, instances[i].WorldBox.Center, instances[i].WorldBox.Extents, 0.0f)
+            : Margin(planes, instances[i].WorldSphere.Center, XMFLOAT3(0.0f, 0.0f, 0.0f), instances[i].WorldSphere.Radius);
+
+        const bool culled = next == visible.size() || visible[next] != i;
+        if (!culled)
+            ++next;
+        if (std::fabs(margin) > 1e-3f && culled != (margin < 0.0f))
+            ++mismatches;
+    }
+    CHECK_MSG(mismatches == 0, mismatches << " volumes");
+    CHECK(next == visible.size());
+    CHECK(!visible.empty() && visible.size() < instances.size() / 2);
+
+    // In chunks, as it would run on several threads.
+    std::vector<std::uint32_t> chunked;
+    for (std::size_t first = 0; first < culler.Size(); first += 1024)
+        culler.Cull(viewProj, first, std::min(first + 1024, culler.Size()), chunked);
+    CHECK(chunked == visible);
+
+    // The world-space boxes enclose the local ones, so nothing the old local-space
+    // test kept is lost.
+    for (std::size_t i = 0; i < instances.size(); i += 2)
+    {
+        if (VisibleInLocalSpace(instances[i], viewProj))
+            CHECK_MSG(std::binary_search(visible.begin(), visible.end(), std::uint32_t(i)), "instance " << i);
+    }
+
+    // Set moves a volume.
+    culler.Set(0, BoundingBox(XMFLOAT3(10.0f, 0.0f, 100.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)));
+    visible.clear();
+    culler.Cull(viewProj, visible);
+    CHECK(!visible.empty() && visible[0] == 0);
+}
+
+BENCHMARK(FrustumCullerInstances)
+{
+    const std::size_t count = Tests::QuickBenchmarks() ? 10000 : 100000;
+    const int repeats = Tests::QuickBenchmarks() ? 3 : 20;
+    const std::vector<Instance> instances = MakeInstances(count, 2);
+    const XMMATRIX viewProj = ViewProj();
+
+    FrustumCuller culler;
+    culler.Reserve(count);
+    for (const Instance& instance : instances)
+        culler.Add(instance.WorldBox);
+
+    std::vector<std::uint32_t> visible;
+    visible.reserve(count);
+    const double soaMs = Tests::BestOf(repeats, [&]
+    {
+        visible.clear();
+        culler.Cull(viewProj, visible);
+        Tests::DoNotOptimize(visible.data());
+    });
+
+    std::size_t localVisible = 0;
+    const double localMs = Tests::BestOf(repeats, [&]
+    {
+        localVisible = 0;
+        for (const Instance& instance : instances)
+        {
+            if (VisibleInLocalSpace(instance, viewProj))
+                ++localVisible;
+        }
+    });
+
+    std::cout << "  " << count << " instances, " << visible.size() << " visible (" << localVisible
+        << " by local boxes)\n"
+        << "  FrustumCuller:            " << soaMs << " ms\n"
+        << "  per instance, local space: " << localMs << " ms (" << localMs / soaMs << "x)\n";
+}
@@ -0,0 +1,350 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// GeometryGenerator meshes: the shape of what the generators build, the welded geosphere
+// against the book's subdivision that gave every triangle its own vertices, and the
+// struct-of-arrays generators against the MeshData ones, both timed on meshes of about
+// a million vertices, through to a demo's vertex layout.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "GeometryGenerator.h"
+
+using namespace DirectX;
+using GeometryGenerator::MeshData;
+using GeometryGenerator::MeshDataSoA;
+
+namespace
+{
+    float TriangleArea(const MeshData& mesh, const std::size_t triangle)
+    {
+        const XMVECTOR a = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[3 * triangle + 0]].Position);
+        const XMVECTOR b = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[3 * triangle + 1]].Position);
+        const XMVECTOR c = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[3 * triangle + 2]].Position);
+        return 0.5f * XMVectorGetX(XMVector3Length(XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a))));
+    }
+
+    // The book's Subdivide, before it was welded: each triangle gets six vertices of
+    // its own, so every vertex is repeated by each triangle around it.
+    void UnweldedSubdivide(MeshData& meshData)
+    {
+        const auto midPoint = [](const GeometryGenerator::Vertex& v0, const GeometryGenerator::Vertex& v1)
+        {
+            GeometryGenerator::Vertex v;
+            XMStoreFloat3(&v.Position, 0.5f * (XMLoadFloat3(&v0.Position) + XMLoadFloat3(&v1.Position)));
+            XMStoreFloat3(&v.Normal, XMVector3Normalize(0.5f * (XMLoadFloat3(&v0.Normal) + XMLoadFloat3(&v1.Normal))));
+            XMStoreFloat3(&v.TangentU, XMVector3Normalize(0.5f * (XMLoadFloat3(&v0.TangentU) + XMLoadFloat3(&v1.TangentU))));
+            XMStoreFloat2(&v.TexC, 0.5f * (XMLoadFloat2(&v0.TexC) + XMLoadFloat2(&v1.TexC)));
+            return v;
+        };
+
+        const std::vector<GeometryGenerator::Vertex> verticesCopy = meshData.Vertices;
+        const std::vector<std::uint32_t> indicesCopy = meshData.Indices32;
+
+        meshData.Vertices.clear();
+        meshData.Indices32.clear();
+
+        const std::uint32_t numTris = std::uint32_t(indicesCopy.size() / 3);
+        meshData.Vertices.reserve(6ull * numTris);
+        meshData.Indices32.reserve(12ull * numTris);
+
+        for (std::uint32_t i = 0; i < numTris; ++i)
+        {
+            const GeometryGenerator::Vertex v0 = verticesCopy[indicesCopy[i * 3 + 0]];
+            const GeometryGenerator::Vertex v1 = verticesCopy[indicesCopy[i * 3 + 1]];
+            const GeometryGenerator::Vertex v2 = verticesCopy[indicesCopy[i * 3 + 2]];
+
+            meshData.Vertices.push_back(v0);
+            meshData.Vertices.push_back(v1);
+            meshData.Vertices.push_back(v2);
+            meshData.Vertices.push_back(midPoint(v0, v1));
+            meshData.Vertices.push_back(midPoint(v1, v2));
+            meshData.Vertices.push_back(midPoint(v0, v2));
+
+            for (const std::uint32_t k : { 0, 3, 5, 3, 4, 5, 5, 4, 2, 3, 1, 4 })
+                meshData.Indices32.push_back(i * 6 + k);
+        }
+    }
+
+    // CreateGeosphere as the book wrote it: the icosahedron subdivided without welding,
+    // then every vertex projected onto the sphere.
+    MeshData UnweldedGeosphere(const float radius, const std::uint32_t numSubdivisions)
+    {
+        MeshData meshData = GeometryGenerator::CreateGeosphere(1.0f, 0);
+        for (std::uint32_t i = 0; i < numSubdivisions; ++i)
+            UnweldedSubdivide(meshData);
+
+        for (GeometryGenerator::Vertex& v : meshData.Vertices)
+        {
+            const XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&v.Position));
+            XMStoreFloat3(&v.Position, radius * n);
+            XMStoreFloat3(&v.Normal, n);
+
+            float theta = atan2f(v.Position.z, v.Position.x);
+            if (theta < 0.0f)
+                theta += XM_2PI;
+            const float phi = acosf(v.Position.y / radius);
+            v.TexC = XMFLOAT2(theta / XM_2PI, phi / XM_PI);
+
+            const XMVECTOR t = XMVectorSet(-radius * sinf(phi) * sinf(theta), 0.0f, radius * sinf(phi) * cosf(theta), 0.0f);
+            XMStoreFloat3(&v.TangentU, XMVector3Normalize(t));
+        }
+        return meshData;
+    }
+
+    std::size_t MeshBytes(const MeshData& mesh)
+    {
+        return mesh.Vertices.size() * sizeof(GeometryGenerator::Vertex) + mesh.Indices32.size() * sizeof(std::uint32_t);
+    }
+
+    // The vertex of the lit demos, with a member Interleave does not know about.
+    struct DemoVertex final
+    {
+        XMFLOAT3 Pos;
+        XMFLOAT3 Normal;
+        XMFLOAT2 TexC;
+        std::uint32_t Color;
+    };
+
+    float MaxDifference(const XMFLOAT3& a, const XMFLOAT3& b)
+    {
+        return std::max({ std::fabs(a.x - b.x), std::fabs(a.y - b.y), std::fabs(a.z - b.z) });
+    }
+
+    float MaxDifference(const XMFLOAT2& a, const XMFLOAT2& b)
+    {
+        return std::max(std::fabs(a.x - b.x), std::fabs(a.y - b.y));
+    }
+
+    // Largest difference of any attribute; infinity if the meshes differ in shape.
+    float Compare(const MeshData& expected, const MeshData& actual)
+    {
+        if (expected.Vertices.size() != actual.Vertices.size() || expected.Indices32 != actual.Indices32)
+            return INFINITY;
+
+        float difference = 0.0f;
+        for (std::size_t i = 0; i < expected.Vertices.size(); ++i)
+        {
+            const GeometryGenerator::Vertex& e = expected.Vertices[i];
+            const GeometryGenerator::Vertex& a = actual.Vertices[i];
+            difference = std::max({ difference, MaxDifference(e.Position, a.Position), MaxDifference(e.Normal, a.Normal),
+                MaxDifference(e.TangentU, a.TangentU), MaxDifference(e.TexC, a.TexC) });
+        }
+        return difference;
+    }
+}
+
+TEST_CASE(CylinderCapsUseTheirOwnRings)
+{
+    constexpr float BottomRadius = 1.0f;
+    constexpr float TopRadius = 0.5f;
+    constexpr float Height = 3.0f;
+    constexpr std::uint32_t SliceCount = 20;
+    constexpr std::uint32_t StackCount = 4;
+
+    const MeshData mesh = GeometryGenerator::CreateCylinder(BottomRadius, TopRadius, Height, SliceCount, StackCount);
+
+    // The stack rings, then each cap's ring and center.
+    const std::size_t ringVertexCount = SliceCount + 1;
+    REQUIRE(mesh.Vertices.size() == (StackCount + 1) * ringVertexCount + 2 * (ringVertexCount + 1));
+    REQUIRE(mesh.Indices32.size() == 3 * (2 * SliceCount * StackCount + 2 * SliceCount));
+
+    // Each cap's triangles use only the cap's vertices: on its plane, on its ring or at
+    // its center, with the cap's normal.  Building the top cap used to leave zeroed
+    // vertices in its place, so its triangles collapsed onto the origin.
+    const std::size_t sideTriangles = 2 * SliceCount * StackCount;
+    for (int cap = 0; cap < 2; ++cap)
+    {
+        const bool top = cap == 0;
+        const float y = (top ? 0.5f : -0.5f) * Height;
+        const float radius = top ? TopRadius : BottomRadius;
+
+        for (std::size_t t = sideTriangles + cap * SliceCount; t < sideTriangles + (cap + 1) * SliceCount; ++t)
+        {
+            CHECK_MSG(TriangleArea(mesh, t) > 1e-3f, "triangle " << t);
+            for (int k = 0; k < 3; ++k)
+            {
+                const GeometryGenerator::Vertex& v = mesh.Vertices[mesh.Indices32[3 * t + k]];
+                const float distance = std::sqrt(v.Position.x * v.Position.x + v.Position.z * v.Position.z);
+                CHECK_MSG(v.Position.y == y && v.Normal.y == (top ? 1.0f : -1.0f), "triangle " << t);
+                CHECK_MSG(distance < 1e-6f || std::fabs(distance - radius) < 1e-5f, "triangle " << t << ": " << distance);
+            }
+        }
+    }
+}
+
+TEST_CASE(GeosphereIsWelded)
+{
+    for (std::uint32_t level = 0; level <= 6; ++level)
+    {
+        const MeshData mesh = GeometryGenerator::CreateGeosphere(2.0f, level);
+
+        // An icosahedron subdivided n times: 20 * 4^n triangles, and by Euler's formula
+        // 10 * 4^n + 2 vertices when every edge midpoint is shared.
+        const std::size_t faces = std::size_t(20) << (2 * level);
+        CHECK_MSG(mesh.Indices32.size() == 3 * faces, "level " << level);
+        CHECK_MSG(mesh.Vertices.size() == faces / 2 + 2, "level " << level << ": " << mesh.Vertices.size());
+
+        // No two vertices in the same place, and none left out.
+        std::vector<std::tuple<float, float, float>> positions;
+        for (const GeometryGenerator::Vertex& v : mesh.Vertices)
+            positions.emplace_back(v.Position.x, v.Position.y, v.Position.z);
+        std::sort(positions.begin(), positions.end());
+        CHECK_MSG(std::adjacent_find(positions.begin(), positions.end()) == positions.end(), "level " << level);
+
+        std::vector<bool> used(mesh.Vertices.size());
+        for (const std::uint32_t index : mesh.Indices32)
+        {
+            REQUIRE(index < mesh.Vertices.size());
+            used[index] = true;
+        }
+        CHECK_MSG(std::find(used.begin(), used.end(), false) == used.end(), "level " << level);
+
+        // The same surface as the book's unwelded subdivision, triangle for triangle.
+        if (level <= 4)
+        {
+            const MeshData unwelded = UnweldedGeosphere(2.0f, level);
+            REQUIRE(unwelded.Indices32.size() == mesh.Indices32.size());
+            float difference = 0.0f;
+            for (std::size_t i = 0; i < mesh.Indices32.size(); ++i)
+            {
+                difference = std::max(difference, MaxDifference(mesh.Vertices[mesh.Indices32[i]].Position,
+                    unwelded.Vertices[unwelded.Indices32[i]].Position));
+            }
+            CHECK_MSG(difference < 1e-5f, "level " << level << ": " << difference);
+        }
+    }
+}
+
+TEST_CASE(SoAGeneratorsMatchMeshData)
+{
+    // Ring sizes that leave 1, 2, 3 and 0 vertices for the last batch of four.
+    for (const std::uint32_t slices : { 20u, 21u, 22u, 23u })
+    {
+        CHECK_MSG(Compare(GeometryGenerator::CreateSphere(2.0f, slices, 13),
+            GeometryGenerator::CreateSphereSoA(2.0f, slices, 13).ToMeshData()) < 1e-5f, slices << " slices");
+        CHECK_MSG(Compare(GeometryGenerator::CreateCylinder(1.5f, 0.5f, 3.0f, slices, 5),
+            GeometryGenerator::CreateCylinderSoA(1.5f, 0.5f, 3.0f, slices, 5).ToMeshData()) < 1e-5f, slices << " slices");
+        CHECK_MSG(Compare(GeometryGenerator::CreateGrid(20.0f, 30.0f, 7, slices),
+            GeometryGenerator::CreateGridSoA(20.0f, 30.0f, 7, slices).ToMeshData()) < 1e-5f, slices << " columns");
+    }
+
+    for (std::uint32_t level = 0; level <= 4; ++level)
+    {
+        CHECK_MSG(Compare(GeometryGenerator::CreateGeosphere(3.0f, level),
+            GeometryGenerator::CreateGeosphereSoA(3.0f, level).ToMeshData()) < 1e-5f, "level " << level);
+    }
+}
+
+TEST_CASE(SoAInterleavesIntoVertexLayouts)
+{
+    const MeshDataSoA soa = GeometryGenerator::CreateSphereSoA(1.0f, 9, 7);
+    const MeshData aos = soa.ToMeshData();
+
+    // A range that starts and ends inside a batch of four, written over stale vertices.
+    constexpr std::size_t First = 5;
+    constexpr std::size_t Count = 11;
+    DemoVertex stale = {};
+    stale.Color = 0xDEADBEEF;
+    std::vector<DemoVertex> vertices(Count + 1, stale);
+    soa.Interleave(std::span(vertices).first(Count), First);
+
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        const GeometryGenerator::Vertex& expected = aos.Vertices[First + i];
+        CHECK_MSG(std::memcmp(&vertices[i].Pos, &expected.Position, sizeof(XMFLOAT3)) == 0, "vertex " << i);
+        CHECK_MSG(std::memcmp(&vertices[i].Normal, &expected.Normal, sizeof(XMFLOAT3)) == 0, "vertex " << i);
+        CHECK_MSG(std::memcmp(&vertices[i].TexC, &expected.TexC, sizeof(XMFLOAT2)) == 0, "vertex " << i);
+        CHECK_MSG(vertices[i].Color == 0xDEADBEEF, "vertex " << i);
+    }
+
+    // Nothing past the range.
+    CHECK(std::memcmp(&vertices[Count], &stale, sizeof(DemoVertex)) == 0);
+}
+
+BENCHMARK(GeosphereLevels)
+{
+    const std::uint32_t maxLevel = Tests::QuickBenchmarks() ? 6 : 8;
+    const int repeats = Tests::QuickBenchmarks() ? 1 : 3;
+
+    for (std::uint32_t level = 0; level <= maxLevel; ++level)
+    {
+        MeshData welded;
+        MeshData unwelded;
+        const double weldedMs = Tests::BestOf(repeats, [&] { welded = GeometryGenerator::CreateGeosphere(1.0f, level); });
+        const double unweldedMs = Tests::BestOf(repeats, [&] { unwelded = UnweldedGeosphere(1.0f, level); });
+
+        std::cout << "  level " << level << ": welded " << welded.Vertices.size() << " vertices, "
+            << MeshBytes(welded) / 1024 << " KB, " << weldedMs << " ms; unwelded " << unwelded.Vertices.size()
+            << " vertices, " << MeshBytes(unwelded) / 1024 << " KB, " << unweldedMs << " ms ("
+            << unweldedMs / weldedMs << "x)\n";
+    }
+}
+
+BENCHMARK(GeometryGeneratorSoA)
+{
+    const std::uint32_t side = Tests::QuickBenchmarks() ? 200 : 1000;
+    const std::uint32_t level = Tests::QuickBenchmarks() ? 5 : 8;
+    const int repeats = Tests::QuickBenchmarks() ? 1 : 3;
+
+    struct Shape final
+    {
+        const char* Name;
+        std::function<MeshData()> Aos;
+        std::function<MeshDataSoA()> Soa;
+    };
+
+    const Shape shapes[] =
+    {
+        { "sphere", [&] { return GeometryGenerator::CreateSphere(1.0f, side, side); },
+            [&] { return GeometryGenerator::CreateSphereSoA(1.0f, side, side); } },
+        { "geosphere", [&] { return GeometryGenerator::CreateGeosphere(1.0f, level); },
+            [&] { return GeometryGenerator::CreateGeosphereSoA(1.0f, level); } },
+        { "cylinder", [&] { return GeometryGenerator::CreateCylinder(1.0f, 0.5f, 2.0f, side, side); },
+            [&] { return GeometryGenerator::CreateCylinderSoA(1.0f, 0.5f, 2.0f, side, side); } },
+        { "grid", [&] { return GeometryGenerator::CreateGrid(100.0f, 100.0f, side, side); },
+            [&] { return GeometryGenerator::CreateGridSoA(100.0f, 100.0f, side, side); } },
+    };
+
+    for (const Shape& shape : shapes)
+    {
+        MeshData aos;
+        MeshDataSoA soa;
+        const double aosMs = Tests::BestOf(repeats, [&] { aos = shape.Aos(); });
+        const double soaMs = Tests::BestOf(repeats, [&] { soa = shape.Soa(); });
+
+        // Into the demos' vertex layout: the loop the demos run over MeshData, against
+        // Interleave from the streams.
+        std::vector<DemoVertex> vertices(aos.Vertices.size());
+        const double copyMs = Tests::BestOf(repeats, [&]
+        {
+            for (std::size_t i = 0; i < aos.Vertices.size(); ++i)
+            {
+                vertices[i].Pos = aos.Vertices[i].Position;
+                vertices[i].Normal = aos.Vertices[i].Normal;
+                vertices[i].TexC = aos.Vertices[i].TexC;
+            }
+            Tests::DoNotOptimize(vertices.data());
+        });
+        const double interleaveMs = Tests::BestOf(repeats, [&]
+        {
+            soa.Interleave(std::span(vertices));
+            Tests::DoNotOptimize(vertices.data());
+        });
+
+        std::cout << "  " << shape.Name << ", " << aos.Vertices.size() << " vertices: MeshData " << aosMs
+            << " ms + copy " << copyMs << " ms, SoA " << soaMs << " ms + Interleave " << interleaveMs << " ms ("
+            << (aosMs + copyMs) / (soaMs + interleaveMs) << "x)\n";
+    }
+}
@@ -0,0 +1,181 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// HeadlessFrameDriver statistics, CommandRecorder replays, and the CPU cost of a
+// demo-shaped frame (update the objects, then record a draw per object) without a
+// device.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "CommandRecorder.h"
+#include "HeadlessFrameDriver.h"
+
+namespace
+{
+    // Stand-ins for the GPU objects a demo binds.  Only their addresses are compared.
+    char gPipelineStates[4];
+
+    ID3D12PipelineState* FakePso(const std::size_t index)
+    {
+        return reinterpret_cast<ID3D12PipelineState*>(&gPipelineStates[index]);
+    }
+
+    struct Object final
+    {
+        float Angle = 0.0f;
+        float Speed = 0.0f;
+        float World[12] = {};
+        ID3D12PipelineState* Pso = nullptr;
+        D3D12_VERTEX_BUFFER_VIEW VertexBuffer = {};
+        D3D12_INDEX_BUFFER_VIEW IndexBuffer = {};
+        D3D12_GPU_VIRTUAL_ADDRESS ObjectCB = 0;
+        D3D12_GPU_DESCRIPTOR_HANDLE Texture = {};
+        UINT IndexCount = 0;
+    };
+
+    // Objects spread over a few pipeline states, meshes and textures, in no order.
+    std::vector<Object> MakeObjects(const std::size_t count)
+    {
+        std::vector<Object> objects(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Object& object = objects[i];
+            const std::size_t mesh = (i * 7) % 5;
+            object.Speed = 0.1f + 0.01f * float(i % 13);
+            object.Pso = FakePso(i % 3);
+            object.VertexBuffer = { 0x10000 * (mesh + 1), 0x8000, 32 };
+            object.IndexBuffer = { 0x100000 + 0x10000 * mesh, 0x4000, DXGI_FORMAT_R16_UINT };
+            object.ObjectCB = 0x1000000 + 256 * i;
+            object.Texture = { 0x2000000 + 32 * ((i * 5) % 8) };
+            object.IndexCount = UINT(36 * (mesh + 1));
+        }
+        return objects;
+    }
+
+    // Spins the objects about y, writing the matrix rows the way a demo fills its
+    // object constants.
+    void Update(std::vector<Object>& objects, const float deltaTime)
+    {
+        for (Object& object : objects)
+        {
+            object.Angle += object.Speed * deltaTime;
+            const float c = std::cos(object.Angle);
+            const float s = std::sin(object.Angle);
+            const float world[12] = { c, 0.0f, -s, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, s, 0.0f, c, 0.0f };
+            std::copy(std::begin(world), std::end(world), object.World);
+        }
+        Tests::DoNotOptimize(objects.data());
+    }
+
+    // Binds everything for every object, as DrawRenderItems does.
+    void Draw(const std::vector<Object>& objects, CommandSink& sink)
+    {
+        for (const Object& object : objects)
+        {
+            sink.SetPipelineState(object.Pso);
+            sink.IASetVertexBuffer(object.VertexBuffer);
+            sink.IASetIndexBuffer(object.IndexBuffer);
+            sink.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            sink.SetGraphicsRootDescriptorTable(0, object.Texture);
+            sink.SetGraphicsRootConstantBufferView(1, object.ObjectCB);
+            sink.DrawIndexedInstanced(object.IndexCount, 1, 0, 0, 0);
+        }
+    }
+}
+
+TEST_CASE(HeadlessFrameDriverCountsEachPhaseFromItsFirstFrame)
+{
+    const std::vector<Object> objects = MakeObjects(10);
+
+    HeadlessFrameDriver driver;
+    driver.AddPhase("draw", [&objects](float, CommandSink& sink) { Draw(objects, sink); });
+    driver.Run(3);
+
+    // Added after the first Run: its statistics start with its own first frame.
+    driver.AddPhase("sleep", [](float, CommandSink&) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+    driver.Run(2);
+
+    REQUIRE(driver.Stats().size() == 2);
+    const HeadlessFrameDriver::PhaseStats& draw = driver.Stats()[0];
+    const HeadlessFrameDriver::PhaseStats& sleep = driver.Stats()[1];
+    CHECK(driver.FrameCount() == 5);
+    CHECK(draw.Frames == 5);
+    CHECK(sleep.Frames == 2);
+    CHECK_MSG(sleep.MinMs >= 1.0, sleep.MinMs << " ms");
+    CHECK(sleep.MinMs <= sleep.MaxMs && sleep.MaxMs <= sleep.TotalMs);
+    CHECK(draw.MinMs <= draw.MaxMs);
+
+    CHECK(driver.TotalCalls().Draws == 5 * objects.size());
+    CHECK(driver.TotalCalls().Binds() == 5 * 6 * objects.size());
+    // Each frame starts with nothing bound, and then at least the topology repeats.
+    CHECK(driver.TotalRedundant().PrimitiveTopologies == 5 * (objects.size() - 1));
+
+    std::ostringstream report;
+    driver.Report(report);
+    CHECK(report.str().find("sleep") != std::string::npos);
+}
+
+TEST_CASE(CommandRecorderReplaysWhatItRecorded)
+{
+    const std::vector<Object> objects = MakeObjects(50);
+
+    CommandCounter direct;
+    Draw(objects, direct);
+
+    CommandRecorder recorder;
+    Draw(objects, recorder);
+    CHECK(recorder.Commands().size() == 7 * objects.size());
+
+    CommandCounter replayed;
+    recorder.Replay(replayed);
+    CHECK(replayed.Calls().Draws == direct.Calls().Draws);
+    CHECK(replayed.Calls().Binds() == direct.Calls().Binds());
+    CHECK(replayed.Redundant().Binds() == direct.Redundant().Binds());
+    CHECK(replayed.Redundant().PipelineStates == direct.Redundant().PipelineStates);
+    CHECK(replayed.Redundant().RootDescriptorTables == direct.Redundant().RootDescriptorTables);
+
+    recorder.Clear();
+    CHECK(recorder.Commands().empty());
+}
+
+BENCHMARK(HeadlessFrame)
+{
+    const std::size_t objectCount = Tests::QuickBenchmarks() ? 1000 : 20000;
+    const std::uint32_t frames = Tests::QuickBenchmarks() ? 10 : 300;
+    std::vector<Object> objects = MakeObjects(objectCount);
+
+    CommandRecorder recorder;
+    NullCommandSink null;
+
+    HeadlessFrameDriver driver;
+    driver.AddPhase("update", [&objects](const float deltaTime, CommandSink&) { Update(objects, deltaTime); });
+    driver.AddPhase("draw (counted)", [&objects](float, CommandSink& sink) { Draw(objects, sink); });
+    driver.AddPhase("draw (null sink)", [&objects, &null](float, CommandSink&)
+    {
+        // Through a pointer the compiler cannot see into, so the calls stay virtual.
+        CommandSink* sink = &null;
+        Tests::DoNotOptimize(&sink);
+        Draw(objects, *sink);
+    });
+    driver.AddPhase("draw (recorded)", [&objects, &recorder](float, CommandSink&)
+    {
+        recorder.Clear();
+        Draw(objects, recorder);
+    });
+    driver.Run(frames);
+
+    std::cout << "  " << objectCount << " objects\n";
+    std::ostringstream report;
+    driver.Report(report);
+    std::istringstream lines(report.str());
+    for (std::string line; std::getline(lines, line);)
+        std::cout << "  " << line << '\n';
+}
@@ -0,0 +1,237 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// MathHelper::InverseTranspose on normals under nonuniform scale, and what the Chapter 16
+// demos save with InstanceCache: the original per-frame loop, which inverted every
+// instance's world matrix to bring the camera frustum into its local space, against
+// culling the cached world-space bounds and copying the cached matrices, for static
+// instances and with the cache rebuilt every frame for animated ones.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "InstanceCache.h"
+#include "MathHelper.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // As InstanceData in the Chapter 16 FrameResource.h.
+    struct InstanceData final
+    {
+        XMFLOAT4X4 World = MathHelper::Identity4x4();
+        XMFLOAT4X4 InvTransposeWorld = MathHelper::Identity4x4();
+        XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+        std::uint32_t MaterialIndex = 0;
+        std::uint32_t InstancePad0 = 0;
+        std::uint32_t InstancePad1 = 0;
+        std::uint32_t InstancePad2 = 0;
+    };
+
+    // Nonuniform scales unless uniformScale, which the per-frame path needs:
+    // BoundingFrustum::Transform takes the scale of a matrix to be uniform.
+    std::vector<InstanceData> MakeInstances(const std::size_t count, const bool uniformScale = false)
+    {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+        std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+        std::uniform_real_distribution<float> scale(0.5f, 4.0f);
+
+        std::vector<InstanceData> instances(count);
+        for (InstanceData& instance : instances)
+        {
+            const float sx = scale(random);
+            const float sy = uniformScale ? sx : scale(random);
+            const float sz = uniformScale ? sx : scale(random);
+            const XMMATRIX world = XMMatrixScaling(sx, sy, sz) *
+                XMMatrixRotationY(angle(random)) * XMMatrixTranslation(position(random), 0.0f, position(random));
+            XMStoreFloat4x4(&instance.World, world);
+            XMStoreFloat4x4(&instance.TexTransform, XMMatrixScaling(2.0f, 2.0f, 1.0f));
+            instance.MaterialIndex = random() % 8;
+        }
+        return instances;
+    }
+
+    // The skull's bounds, roughly, and the camera of the demo looking into the field.
+    const BoundingBox LocalBounds(XMFLOAT3(0.0f, 0.5f, 0.0f), XMFLOAT3(1.0f, 0.5f, 0.75f));
+
+    XMMATRIX View()
+    {
+        return XMMatrixLookAtLH(XMVectorSet(0.0f, 5.0f, -10.0f, 1.0f),
+            XMVectorSet(10.0f, 0.0f, 100.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    }
+
+    XMMATRIX Proj()
+    {
+        return XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 250.0f);
+    }
+
+    // UpdateInstanceData before the cache: the camera frustum brought into each
+    // instance's local space through the inverse of its world matrix, and the visible
+    // instances transposed into the upload buffer.  Returns the number written.
+    std::size_t UploadPerFrame(const std::vector<InstanceData>& instances, const BoundingFrustum& camFrustum,
+        FXMMATRIX view, std::vector<InstanceData>& uploaded)
+    {
+        XMVECTOR viewDeterminant = XMMatrixDeterminant(view);
+        const XMMATRIX invView = XMMatrixInverse(&viewDeterminant, view);
+
+        std::size_t visibleCount = 0;
+        for (const InstanceData& instance : instances)
+        {
+            const XMMATRIX world = XMLoadFloat4x4(&instance.World);
+            XMVECTOR worldDeterminant = XMMatrixDeterminant(world);
+            const XMMATRIX invWorld = XMMatrixInverse(&worldDeterminant, world);
+
+            BoundingFrustum localSpaceFrustum;
+            camFrustum.Transform(localSpaceFrustum, XMMatrixMultiply(invView, invWorld));
+            if (localSpaceFrustum.Contains(LocalBounds) != DirectX::DISJOINT)
+            {
+                InstanceData& data = uploaded[visibleCount++];
+                XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+                XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(XMLoadFloat4x4(&instance.TexTransform)));
+                data.MaterialIndex = instance.MaterialIndex;
+            }
+        }
+        return visibleCount;
+    }
+
+    // UpdateInstanceData with the cache: the world-space bounds culled, and the cached
+    // instances of the visible ones copied.
+    std::size_t UploadCached(const std::vector<InstanceData>& gpuInstances, const FrustumCuller& worldBounds,
+        FXMMATRIX viewProj, std::vector<std::uint32_t>& visible, std::vector<InstanceData>& uploaded)
+    {
+        visible.clear();
+        worldBounds.Cull(viewProj, visible);
+        for (std::size_t i = 0; i < visible.size(); ++i)
+            uploaded[i] = gpuInstances[visible[i]];
+        return visible.size();
+    }
+}
+
+TEST_CASE(InverseTransposeKeepsNormalsPerpendicular)
+{
+    const std::vector<InstanceData> instances = MakeInstances(100);
+    for (std::size_t i = 0; i < instances.size(); ++i)
+    {
+        const XMMATRIX world = XMLoadFloat4x4(&instances[i].World);
+        const XMMATRIX invTranspose = MathHelper::InverseTranspose(world);
+
+        // A tangent of a slanted surface, and its normal.
+        const XMVECTOR tangent = XMVector3TransformNormal(XMVectorSet(1.0f, 1.0f, 0.0f, 0.0f), world);
+        const XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(-1.0f, 1.0f, 0.0f, 0.0f), invTranspose));
+        const float cosine = XMVectorGetX(XMVector3Dot(normal, XMVector3Normalize(tangent)));
+        CHECK_MSG(std::fabs(cosine) < 1e-5f, "instance " << i << ": " << cosine);
+
+        // The translation stays out of it.
+        CHECK(XMVectorGetX(XMVector3LengthSq(invTranspose.r[3])) < 1e-12f);
+    }
+
+    // The world matrix itself bends normals under nonuniform scale.
+    const XMMATRIX world = XMMatrixScaling(1.0f, 3.0f, 1.0f);
+    const XMVECTOR tangent = XMVector3TransformNormal(XMVectorSet(1.0f, 1.0f, 0.0f, 0.0f), world);
+    const XMVECTOR bent = XMVector3TransformNormal(XMVectorSet(-1.0f, 1.0f, 0.0f, 0.0f), world);
+    CHECK(std::fabs(XMVectorGetX(XMVector3Dot(XMVector3Normalize(bent), XMVector3Normalize(tangent)))) > 0.5f);
+}
+
+TEST_CASE(InstanceCacheFillsUploadReadyInstances)
+{
+    const std::vector<InstanceData> instances = MakeInstances(1001, true);
+    std::vector<InstanceData> gpuInstances;
+    FrustumCuller worldBounds;
+    InstanceCache::Fill(std::span<const InstanceData>(instances), LocalBounds, gpuInstances, worldBounds);
+    REQUIRE(gpuInstances.size() == instances.size());
+    REQUIRE(worldBounds.Size() == instances.size());
+
+    for (std::size_t i = 0; i < instances.size(); ++i)
+    {
+        const XMMATRIX world = XMLoadFloat4x4(&instances[i].World);
+        XMFLOAT4X4 expected;
+        XMStoreFloat4x4(&expected, XMMatrixTranspose(world));
+        CHECK_MSG(std::memcmp(&gpuInstances[i].World, &expected, sizeof(expected)) == 0, "instance " << i);
+        XMStoreFloat4x4(&expected, XMMatrixTranspose(MathHelper::InverseTranspose(world)));
+        CHECK_MSG(std::memcmp(&gpuInstances[i].InvTransposeWorld, &expected, sizeof(expected)) == 0, "instance " << i);
+        XMStoreFloat4x4(&expected, XMMatrixTranspose(XMLoadFloat4x4(&instances[i].TexTransform)));
+        CHECK_MSG(std::memcmp(&gpuInstances[i].TexTransform, &expected, sizeof(expected)) == 0, "instance " << i);
+        CHECK(gpuInstances[i].MaterialIndex == instances[i].MaterialIndex);
+    }
+
+    // The world-space boxes enclose the local ones, so every instance the per-frame
+    // local-space test kept is still drawn, with the same matrices.
+    const XMMATRIX view = View();
+    std::vector<InstanceData> perFrame(instances.size());
+    const std::size_t perFrameCount = UploadPerFrame(instances, BoundingFrustum(Proj()), view, perFrame);
+
+    std::vector<std::uint32_t> visible;
+    std::vector<InstanceData> cached(instances.size());
+    const std::size_t cachedCount = UploadCached(gpuInstances, worldBounds, XMMatrixMultiply(view, Proj()), visible, cached);
+    CHECK(perFrameCount > 0 && perFrameCount < instances.size() / 2);
+    CHECK_MSG(cachedCount >= perFrameCount && cachedCount < perFrameCount * 3 / 2, cachedCount << " vs " << perFrameCount);
+
+    // Matched by World, which is unique to each instance.
+    for (std::size_t i = 0; i < perFrameCount; ++i)
+    {
+        const auto sameWorld = [&](const InstanceData& data)
+        {
+            return std::memcmp(&data.World, &perFrame[i].World, sizeof(XMFLOAT4X4)) == 0;
+        };
+        CHECK_MSG(std::any_of(cached.begin(), cached.begin() + cachedCount, sameWorld), "visible instance " << i);
+    }
+}
+
+BENCHMARK(InstanceMatricesCachedAgainstPerFrame)
+{
+    const std::size_t count = Tests::QuickBenchmarks() ? 10000 : 100000;
+    const int repeats = Tests::QuickBenchmarks() ? 3 : 20;
+    const std::vector<InstanceData> instances = MakeInstances(count, true);
+
+    const XMMATRIX view = View();
+    const XMMATRIX viewProj = XMMatrixMultiply(view, Proj());
+    const BoundingFrustum camFrustum(Proj());
+    std::vector<InstanceData> uploaded(count);
+
+    // Before: every instance inverted and the frustum transformed into its local space.
+    std::size_t perFrameVisible = 0;
+    const double perFrameMs = Tests::BestOf(repeats, [&]
+    {
+        perFrameVisible = UploadPerFrame(instances, camFrustum, view, uploaded);
+        Tests::DoNotOptimize(uploaded.data());
+    });
+
+    // Static instances: the cache was filled once; the frame culls and copies.
+    std::vector<InstanceData> gpuInstances;
+    FrustumCuller worldBounds;
+    InstanceCache::Fill(std::span<const InstanceData>(instances), LocalBounds, gpuInstances, worldBounds);
+
+    std::vector<std::uint32_t> visible;
+    visible.reserve(count);
+    std::size_t cachedVisible = 0;
+    const double staticMs = Tests::BestOf(repeats, [&]
+    {
+        cachedVisible = UploadCached(gpuInstances, worldBounds, viewProj, visible, uploaded);
+        Tests::DoNotOptimize(uploaded.data());
+    });
+
+    // Animated instances: World changes every frame, so the cache is filled first.
+    const double animatedMs = Tests::BestOf(repeats, [&]
+    {
+        InstanceCache::Fill(std::span<const InstanceData>(instances), LocalBounds, gpuInstances, worldBounds);
+        UploadCached(gpuInstances, worldBounds, viewProj, visible, uploaded);
+        Tests::DoNotOptimize(uploaded.data());
+    });
+
+    std::cout << "  " << count << " instances, " << perFrameVisible << " visible per frame, " << cachedVisible
+        << " by world-space bounds\n"
+        << "  inverse per instance, every frame: " << perFrameMs << " ms\n"
+        << "  cached, static:                    " << staticMs << " ms (" << perFrameMs / staticMs << "x faster)\n"
+        << "  cached, all animated:              " << animatedMs << " ms (" << animatedMs / perFrameMs << "x the time)\n";
+}
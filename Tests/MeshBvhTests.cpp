@@ -0,0 +1,204 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// MeshBvh against a brute-force loop over DirectX::TriangleTests::Intersects on the
+// skull, and how much faster it is on the skull and on the picking demo's car.
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "TestModels.h"
+
+#include <DirectXCollision.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "MeshBvh.h"
+
+using namespace DirectX;
+
+namespace
+{
+    struct RayCase final
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT3 Direction;
+    };
+
+    struct ModelScene final
+    {
+        Tests::TextModel Model;
+        MeshBvh Bvh;
+        XMFLOAT3 Min;
+        XMFLOAT3 Max;
+    };
+
+    bool LoadScene(const char* path, ModelScene& scene)
+    {
+        if (!Tests::LoadTextModel(Tests::RepoPath(path), scene.Model))
+            return false;
+
+        scene.Min = scene.Max = scene.Model.Positions.front();
+        for (const XMFLOAT3& p : scene.Model.Positions)
+        {
+            scene.Min = { std::min(scene.Min.x, p.x), std::min(scene.Min.y, p.y), std::min(scene.Min.z, p.z) };
+            scene.Max = { std::max(scene.Max.x, p.x), std::max(scene.Max.y, p.y), std::max(scene.Max.z, p.z) };
+        }
+
+        scene.Bvh.Build(std::as_bytes(std::span(scene.Model.Positions)), sizeof(XMFLOAT3), scene.Model.Indices);
+        return true;
+    }
+
+    // Rays from a sphere around the mesh towards random points of its bounds, so most
+    // hit and some graze or miss.
+    std::vector<RayCase> MakeRays(const ModelScene& scene, const std::size_t count)
+    {
+        std::mt19937 random(12345);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        const XMVECTOR boundsMin = XMLoadFloat3(&scene.Min);
+        const XMVECTOR boundsMax = XMLoadFloat3(&scene.Max);
+        const XMVECTOR center = XMVectorScale(XMVectorAdd(boundsMin, boundsMax), 0.5f);
+        const float radius = 1.5f * XMVectorGetX(XMVector3Length(XMVectorSubtract(boundsMax, boundsMin)));
+
+        std::vector<RayCase> rays(count);
+        for (RayCase& ray : rays)
+        {
+            const float z = 2.0f * unit(random) - 1.0f;
+            const float phi = 6.2831853f * unit(random);
+            const float r = std::sqrt(1.0f - z * z);
+            const XMVECTOR origin = XMVectorAdd(center, XMVectorScale(XMVectorSet(r * std::cos(phi), r * std::sin(phi), z, 0.0f), radius));
+
+            // Aim up to 20% past the bounds, so that many rays miss.
+            const XMVECTOR t = XMVectorSet(1.4f * unit(random) - 0.2f, 1.4f * unit(random) - 0.2f, 1.4f * unit(random) - 0.2f, 0.0f);
+            const XMVECTOR target = XMVectorAdd(boundsMin, XMVectorMultiply(t, XMVectorSubtract(boundsMax, boundsMin)));
+
+            XMStoreFloat3(&ray.Origin, origin);
+            XMStoreFloat3(&ray.Direction, XMVector3Normalize(XMVectorSubtract(target, origin)));
+        }
+        return rays;
+    }
+
+    // Nearest hit by testing every triangle; Triangle is UINT32_MAX on a miss.
+    MeshBvh::Hit BruteForce(const Tests::TextModel& model, FXMVECTOR origin, FXMVECTOR direction)
+    {
+        MeshBvh::Hit nearest = { std::numeric_limits<float>::infinity(), UINT32_MAX };
+        for (std::uint32_t t = 0; t < model.Indices.size() / 3; ++t)
+        {
+            const XMVECTOR v0 = XMLoadFloat3(&model.Positions[model.Indices[3 * t + 0]]);
+            const XMVECTOR v1 = XMLoadFloat3(&model.Positions[model.Indices[3 * t + 1]]);
+            const XMVECTOR v2 = XMLoadFloat3(&model.Positions[model.Indices[3 * t + 2]]);
+
+            float distance = 0.0f;
+            if (TriangleTests::Intersects(origin, direction, v0, v1, v2, distance) && distance < nearest.Distance)
+                nearest = { distance, t };
+        }
+        return nearest;
+    }
+
+    // Build time, and time per ray with the BVH and by brute force.
+    void BenchmarkRays(const char* name, const ModelScene& scene)
+    {
+        const double buildMs = Tests::BestOf(Tests::QuickBenchmarks() ? 1 : 5, [&]
+        {
+            MeshBvh bvh;
+            bvh.Build(std::as_bytes(std::span(scene.Model.Positions)), sizeof(XMFLOAT3), scene.Model.Indices);
+            Tests::DoNotOptimize(&bvh);
+        });
+
+        const std::vector<RayCase> rays = MakeRays(scene, Tests::QuickBenchmarks() ? 200 : 10000);
+        const std::size_t bruteRays = Tests::QuickBenchmarks() ? 20 : 500;
+
+        float sum = 0.0f;
+        const double bvhMs = Tests::BestOf(3, [&]
+        {
+            for (const RayCase& ray : rays)
+            {
+                MeshBvh::Hit hit;
+                if (scene.Bvh.Intersect(XMLoadFloat3(&ray.Origin), XMLoadFloat3(&ray.Direction), std::numeric_limits<float>::infinity(), hit))
+                    sum += hit.Distance;
+            }
+        });
+
+        const double bruteMs = Tests::BestOf(1, [&]
+        {
+            for (std::size_t i = 0; i < bruteRays; ++i)
+            {
+                const MeshBvh::Hit hit = BruteForce(scene.Model, XMLoadFloat3(&rays[i].Origin), XMLoadFloat3(&rays[i].Direction));
+                if (hit.Triangle != UINT32_MAX)
+                    sum += hit.Distance;
+            }
+        });
+        Tests::DoNotOptimize(&sum);
+
+        const double bvhUs = bvhMs * 1000.0 / rays.size();
+        const double bruteUs = bruteMs * 1000.0 / bruteRays;
+        std::cout << "  " << name << ": " << scene.Bvh.TriangleCount() << " triangles, " << scene.Bvh.NodeCount()
+            << " nodes, built in " << buildMs << " ms\n"
+            << "  MeshBvh:     " << bvhUs << " us/ray\n"
+            << "  brute force: " << bruteUs << " us/ray (" << bruteUs / bvhUs << "x)\n";
+    }
+}
+
+TEST_CASE(MeshBvhMatchesBruteForceOnSkull)
+{
+    ModelScene scene;
+    REQUIRE(LoadScene("Chapter21-SSAO/SSAO/Models/skull.txt", scene));
+    CHECK(scene.Bvh.TriangleCount() == scene.Model.Indices.size() / 3);
+
+    const std::vector<RayCase> rays = MakeRays(scene, 2000);
+    int hits = 0;
+    for (std::size_t i = 0; i < rays.size(); ++i)
+    {
+        const XMVECTOR origin = XMLoadFloat3(&rays[i].Origin);
+        const XMVECTOR direction = XMLoadFloat3(&rays[i].Direction);
+
+        const MeshBvh::Hit expected = BruteForce(scene.Model, origin, direction);
+        MeshBvh::Hit hit;
+        const bool found = scene.Bvh.Intersect(origin, direction, std::numeric_limits<float>::infinity(), hit);
+
+        CHECK_MSG(found == (expected.Triangle != UINT32_MAX), "ray " << i);
+        if (!found || expected.Triangle == UINT32_MAX)
+            continue;
+
+        ++hits;
+
+        // Triangles sharing an edge can tie, so compare distances rather than ids.
+        CHECK_MSG(std::fabs(hit.Distance - expected.Distance) <= 1e-4f * expected.Distance,
+            "ray " << i << ": " << hit.Distance << " against " << expected.Distance);
+
+        // Every hit, in any order.
+        std::vector<MeshBvh::Hit> all;
+        scene.Bvh.IntersectAll(origin, direction, std::numeric_limits<float>::infinity(), all);
+        std::size_t expectedCount = 0;
+        for (std::uint32_t t = 0; t < scene.Model.Indices.size() / 3; ++t)
+        {
+            float distance = 0.0f;
+            if (TriangleTests::Intersects(origin, direction,
+                XMLoadFloat3(&scene.Model.Positions[scene.Model.Indices[3 * t + 0]]),
+                XMLoadFloat3(&scene.Model.Positions[scene.Model.Indices[3 * t + 1]]),
+                XMLoadFloat3(&scene.Model.Positions[scene.Model.Indices[3 * t + 2]]), distance))
+            {
+                ++expectedCount;
+            }
+        }
+        CHECK_MSG(all.size() == expectedCount, "ray " << i << ": " << all.size() << " hits against " << expectedCount);
+    }
+
+    // About half of the rays hit; a sampling mistake would leave too few to mean much.
+    CHECK_MSG(hits > 500, hits << " hits");
+}
+
+BENCHMARK(MeshBvhRays)
+{
+    for (const char* path : { "Chapter21-SSAO/SSAO/Models/skull.txt", "Chapter17-Picking/PickingDemo/Models/car.txt" })
+    {
+        ModelScene scene;
+        REQUIRE(LoadScene(path, scene));
+        BenchmarkRays(path, scene);
+    }
+}
@@ -0,0 +1,297 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// MeshFile conversions of skull.txt and car.txt against the std::ifstream parse the demos
+// used to do, .bmesh files that are cut short or damaged, and the time to load each model
+// either way.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MeshFile.h"
+
+using namespace DirectX;
+
+namespace
+{
+    const char* const Models[] =
+    {
+        "Chapter16-Instancing&FrustumCulling/InstancingAndCullingDemo/Models/skull.txt",
+        "Chapter17-Picking/PickingDemo/Models/car.txt",
+    };
+
+    // Scratch directory, emptied for each test.
+    std::filesystem::path ScratchDirectory()
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "MeshFileTests";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        return directory;
+    }
+
+    // Copies a model into the scratch directory, so its .bmesh file is converted there.
+    std::filesystem::path ScratchCopy(const std::filesystem::path& directory, const char* model)
+    {
+        const std::filesystem::path source = Tests::RepoPath(model);
+        const std::filesystem::path copy = directory / source.filename();
+        std::filesystem::copy_file(source, copy, std::filesystem::copy_options::overwrite_existing);
+        return copy;
+    }
+
+    std::vector<std::byte> ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream fin(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        std::vector<std::byte> image(bytes.size());
+        std::memcpy(image.data(), bytes.data(), bytes.size());
+        return image;
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::vector<std::byte>& bytes)
+    {
+        std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+        fout.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    }
+
+    template<typename T>
+    T ReadAt(const std::vector<std::byte>& image, const std::size_t offset)
+    {
+        T value;
+        std::memcpy(&value, image.data() + offset, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void WriteAt(std::vector<std::byte>& image, const std::size_t offset, const T value)
+    {
+        std::memcpy(image.data() + offset, &value, sizeof(T));
+    }
+
+    // Where MeshFile.cpp's FileHeader keeps the fields the corruptions below change.
+    constexpr std::size_t MagicOffset = 0;
+    constexpr std::size_t VersionOffset = 4;
+    constexpr std::size_t VertexCountOffset = 8;
+    constexpr std::size_t IndexDataOffsetOffset = 48;
+    constexpr std::size_t SubmeshDataOffsetOffset = 56;
+
+    // The demos' loader before MeshFile: one value at a time from an std::ifstream.
+    bool ParseWithIfstream(const std::filesystem::path& path, std::vector<MeshFile::Vertex>& vertices,
+        std::vector<std::uint32_t>& indices)
+    {
+        std::ifstream fin(path);
+        if (!fin)
+            return false;
+
+        std::uint32_t vcount = 0;
+        std::uint32_t tcount = 0;
+        std::string ignore;
+
+        fin >> ignore >> vcount;
+        fin >> ignore >> tcount;
+        fin >> ignore >> ignore >> ignore >> ignore;
+
+        vertices.resize(vcount);
+        for (MeshFile::Vertex& v : vertices)
+        {
+            fin >> v.Position.x >> v.Position.y >> v.Position.z;
+            fin >> v.Normal.x >> v.Normal.y >> v.Normal.z;
+        }
+
+        fin >> ignore >> ignore >> ignore;
+
+        indices.resize(3 * std::size_t(tcount));
+        for (std::uint32_t& index : indices)
+            fin >> index;
+
+        return !fin.fail();
+    }
+}
+
+TEST_CASE(MeshFileRoundTripsTextModels)
+{
+    const std::filesystem::path directory = ScratchDirectory();
+
+    for (const char* model : Models)
+    {
+        std::vector<MeshFile::Vertex> expectedVertices;
+        std::vector<std::uint32_t> expectedIndices;
+        REQUIRE(ParseWithIfstream(Tests::RepoPath(model), expectedVertices, expectedIndices));
+
+        const std::filesystem::path text = ScratchCopy(directory, model);
+        const std::filesystem::path binary = MeshFile::BinaryFilename(text.wstring());
+        const MeshFile::MappedMesh converted = MeshFile::LoadOrConvert(text.wstring());
+        REQUIRE(converted.IsValid());
+        CHECK_MSG(std::filesystem::exists(binary), model);
+
+        // Mapped back from the file on its own, the same as what the conversion returned.
+        const MeshFile::MappedMesh loaded = MeshFile::Load(binary.wstring());
+        REQUIRE(loaded.IsValid());
+
+        for (const MeshFile::MappedMesh* mesh : { &converted, &loaded })
+        {
+            CHECK_MSG(mesh->Vertices().size() == expectedVertices.size(), model);
+            CHECK_MSG(mesh->Indices().size() == expectedIndices.size(), model);
+            CHECK_MSG(mesh->Vertices().size() == expectedVertices.size() && std::memcmp(mesh->Vertices().data(),
+                expectedVertices.data(), mesh->Vertices().size_bytes()) == 0, model);
+            CHECK_MSG(std::equal(mesh->Indices().begin(), mesh->Indices().end(),
+                expectedIndices.begin(), expectedIndices.end()), model);
+
+            REQUIRE(mesh->Submeshes().size() == 1);
+            const MeshFile::Submesh& submesh = mesh->Submeshes()[0];
+            CHECK(submesh.IndexCount == expectedIndices.size());
+            CHECK(submesh.StartIndexLocation == 0);
+            CHECK(submesh.BaseVertexLocation == 0);
+
+            // The box is the tight bounds of the positions, and the sphere holds them all.
+            XMVECTOR lo = XMVectorReplicate(1e30f);
+            XMVECTOR hi = XMVectorReplicate(-1e30f);
+            float outside = 0.0f;
+            const XMVECTOR sphereCenter = XMLoadFloat3(&submesh.Sphere.Center);
+            for (const MeshFile::Vertex& v : expectedVertices)
+            {
+                const XMVECTOR p = XMLoadFloat3(&v.Position);
+                lo = XMVectorMin(lo, p);
+                hi = XMVectorMax(hi, p);
+                outside = std::max(outside,
+                    XMVectorGetX(XMVector3Length(XMVectorSubtract(p, sphereCenter))) - submesh.Sphere.Radius);
+            }
+            XMFLOAT3 center;
+            XMFLOAT3 extents;
+            XMStoreFloat3(&center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+            XMStoreFloat3(&extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+            CHECK_MSG(std::memcmp(&submesh.Box.Center, &center, sizeof(center)) == 0, model);
+            CHECK_MSG(std::memcmp(&submesh.Box.Extents, &extents, sizeof(extents)) == 0, model);
+            CHECK_MSG(outside < 1e-4f * submesh.Sphere.Radius, model << ": " << outside);
+        }
+
+        // The blobs alias the mapping.
+        CHECK(converted.VertexBlob()->GetBufferPointer() == converted.Vertices().data());
+        CHECK(converted.VertexBlob()->GetBufferSize() == converted.VertexBufferByteSize());
+        CHECK(converted.IndexBlob()->GetBufferPointer() == converted.Indices().data());
+        CHECK(converted.IndexBlob()->GetBufferSize() == converted.IndexBufferByteSize());
+
+        // An up-to-date file is used as it is, not converted again.
+        const auto writeTime = std::filesystem::last_write_time(binary);
+        CHECK(MeshFile::LoadOrConvert(text.wstring()).IsValid());
+        CHECK_MSG(std::filesystem::last_write_time(binary) == writeTime, model);
+    }
+}
+
+TEST_CASE(MeshFileRejectsDamagedFiles)
+{
+    const std::filesystem::path directory = ScratchDirectory();
+    const std::filesystem::path text = ScratchCopy(directory, Models[0]);
+    const std::filesystem::path binary = MeshFile::BinaryFilename(text.wstring());
+    REQUIRE(MeshFile::ConvertTextMesh(text.wstring(), binary.wstring()));
+
+    const std::vector<std::byte> image = ReadFile(binary);
+    REQUIRE(image.size() > 1024);
+    const auto indexDataOffset = ReadAt<std::uint64_t>(image, IndexDataOffsetOffset);
+    const auto submeshDataOffset = ReadAt<std::uint64_t>(image, SubmeshDataOffsetOffset);
+    const auto vertexCount = ReadAt<std::uint32_t>(image, VertexCountOffset);
+
+    struct Damage final
+    {
+        const char* Name;
+        std::vector<std::byte> Image;
+    };
+    std::vector<Damage> damaged;
+
+    // Cut short: inside the header, inside the vertices and inside the submesh records.
+    for (const std::size_t size : { std::size_t(0), std::size_t(40), std::size_t(indexDataOffset / 2), image.size() - 1 })
+        damaged.push_back({ "truncated", std::vector<std::byte>(image.begin(), image.begin() + size) });
+
+    damaged.push_back({ "magic", image });
+    WriteAt<std::uint32_t>(damaged.back().Image, MagicOffset, 0x12345678);
+
+    damaged.push_back({ "version", image });
+    WriteAt<std::uint32_t>(damaged.back().Image, VersionOffset, 2);
+
+    damaged.push_back({ "vertex count", image });
+    WriteAt<std::uint32_t>(damaged.back().Image, VertexCountOffset, 0x7FFFFFFF);
+
+    damaged.push_back({ "submesh offset", image });
+    WriteAt<std::uint64_t>(damaged.back().Image, SubmeshDataOffsetOffset, submeshDataOffset + 4);
+
+    // An index past the last vertex: the GPU would read beyond the vertex buffer.
+    damaged.push_back({ "index", image });
+    WriteAt<std::uint32_t>(damaged.back().Image, indexDataOffset + 4 * 100, vertexCount);
+
+    // A submesh reaching past the last index.
+    damaged.push_back({ "submesh indices", image });
+    WriteAt<std::uint32_t>(damaged.back().Image, submeshDataOffset, ReadAt<std::uint32_t>(image, submeshDataOffset) + 3);
+
+    for (const Damage& damage : damaged)
+    {
+        WriteFile(binary, damage.Image);
+        CHECK_MSG(!MeshFile::Load(binary.wstring()).IsValid(), damage.Name << ", " << damage.Image.size() << " bytes");
+
+        // With the text model next to it the file is converted again.
+        const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(text.wstring());
+        CHECK_MSG(mesh.IsValid() && mesh.Vertices().size() == vertexCount, damage.Name);
+    }
+    CHECK(ReadFile(binary) == image);
+
+    // Nothing to load at all.
+    CHECK(!MeshFile::Load((directory / "missing.bmesh").wstring()).IsValid());
+    CHECK(!MeshFile::LoadOrConvert((directory / "missing.txt").wstring()).IsValid());
+
+    // A malformed text model is not converted.
+    const std::filesystem::path malformed = directory / "malformed.txt";
+    {
+        std::ofstream fout(malformed);
+        fout << "VertexCount: 3\nTriangleCount: 1\nVertexList (pos, normal)\n{\n0 0 0 0 1 0\n}\n";
+    }
+    CHECK(!MeshFile::ConvertTextMesh(malformed.wstring(), (directory / "malformed.bmesh").wstring()));
+    CHECK(!MeshFile::LoadOrConvert(malformed.wstring()).IsValid());
+}
+
+BENCHMARK(MeshFileLoad)
+{
+    const int repeats = Tests::QuickBenchmarks() ? 2 : 10;
+    const std::filesystem::path directory = ScratchDirectory();
+
+    for (const char* model : Models)
+    {
+        const std::filesystem::path text = ScratchCopy(directory, model);
+        const std::filesystem::path binary = MeshFile::BinaryFilename(text.wstring());
+
+        std::vector<MeshFile::Vertex> vertices;
+        std::vector<std::uint32_t> indices;
+        const double ifstreamMs = Tests::BestOf(repeats, [&]
+        {
+            ParseWithIfstream(text, vertices, indices);
+            Tests::DoNotOptimize(vertices.data());
+        });
+
+        // First run of a demo: the text model is parsed and the .bmesh file written.
+        const double convertMs = Tests::BestOf(repeats, [&]
+        {
+            std::filesystem::remove(binary);
+            const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(text.wstring());
+            Tests::DoNotOptimize(mesh.Vertices().data());
+        });
+
+        // Every later run: the .bmesh file is checked against the text model and mapped.
+        std::size_t vertexCount = 0;
+        const double mappedMs = Tests::BestOf(repeats, [&]
+        {
+            const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(text.wstring());
+            vertexCount = mesh.Vertices().size();
+            Tests::DoNotOptimize(mesh.Vertices().data());
+        });
+
+        std::cout << "  " << text.filename().string() << ", " << vertexCount << " vertices:\n"
+            << "    std::ifstream:            " << ifstreamMs << " ms\n"
+            << "    LoadOrConvert, converted: " << convertMs << " ms (" << ifstreamMs / convertMs << "x)\n"
+            << "    LoadOrConvert, mapped:    " << mappedMs << " ms (" << ifstreamMs / mappedMs << "x)\n";
+    }
+}
@@ -0,0 +1,156 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// Picking::Nearest and Picking::All against a brute-force loop over
+// DirectX::TriangleTests::Intersects, on a grid of rays through a view of three
+// transformed copies of the car.  The brute force works in world space, so it shares
+// neither the BVH nor the local-space rays with the code under test.
+//***************************************************************************************
+
+#include "TestFramework.h"
+#include "TestModels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "Picking.h"
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr int ClientWidth = 800;
+    constexpr int ClientHeight = 600;
+
+    struct Object final
+    {
+        XMFLOAT4X4 World;
+        std::vector<XMFLOAT3> WorldPositions;
+    };
+}
+
+TEST_CASE(PickingMatchesBruteForceOnCar)
+{
+    Tests::TextModel car;
+    REQUIRE(Tests::LoadTextModel(Tests::RepoPath("Chapter17-Picking/PickingDemo/Models/car.txt"), car));
+
+    MeshBvh bvh;
+    bvh.Build(std::as_bytes(std::span(car.Positions)), sizeof(XMFLOAT3), car.Indices);
+
+    XMFLOAT3 boundsMin = car.Positions.front();
+    XMFLOAT3 boundsMax = car.Positions.front();
+    for (const XMFLOAT3& p : car.Positions)
+    {
+        boundsMin = { std::min(boundsMin.x, p.x), std::min(boundsMin.y, p.y), std::min(boundsMin.z, p.z) };
+        boundsMax = { std::max(boundsMax.x, p.x), std::max(boundsMax.y, p.y), std::max(boundsMax.z, p.z) };
+    }
+
+    BoundingBox bounds;
+    XMStoreFloat3(&bounds.Center, XMVectorScale(XMVectorAdd(XMLoadFloat3(&boundsMin), XMLoadFloat3(&boundsMax)), 0.5f));
+    XMStoreFloat3(&bounds.Extents, XMVectorScale(XMVectorSubtract(XMLoadFloat3(&boundsMax), XMLoadFloat3(&boundsMin)), 0.5f));
+
+    // Three cars, scaled differently so that local and view distances differ, and
+    // overlapping on screen so that the nearest one matters.
+    const XMMATRIX worlds[] =
+    {
+        XMMatrixTranslation(0.0f, 1.0f, 0.0f),
+        XMMatrixScaling(0.5f, 0.5f, 0.5f) * XMMatrixRotationY(0.8f) * XMMatrixTranslation(-3.0f, 0.5f, -6.0f),
+        XMMatrixScaling(2.0f, 2.0f, 2.0f) * XMMatrixRotationY(-1.2f) * XMMatrixTranslation(5.0f, 2.0f, 12.0f),
+    };
+
+    std::vector<Object> objects;
+    std::vector<Picking::Target> targets;
+    for (const XMMATRIX& world : worlds)
+    {
+        Object& object = objects.emplace_back();
+        XMStoreFloat4x4(&object.World, world);
+        for (const XMFLOAT3& p : car.Positions)
+        {
+            XMStoreFloat3(&object.WorldPositions.emplace_back(), XMVector3TransformCoord(XMLoadFloat3(&p), world));
+        }
+
+        Picking::Target& target = targets.emplace_back();
+        XMStoreFloat4x4(&target.InvWorld, XMMatrixInverse(nullptr, world));
+        target.Bounds = bounds;
+        target.Bvh = &bvh;
+    }
+
+    const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(2.0f, 6.0f, -20.0f, 1.0f),
+        XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    const XMMATRIX invView = XMMatrixInverse(nullptr, view);
+
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&proj, XMMatrixPerspectiveFovLH(0.25f * 3.1415926f, float(ClientWidth) / ClientHeight, 1.0f, 1000.0f));
+
+    int rays = 0;
+    int hits = 0;
+    std::vector<int> hitsPerTarget(targets.size());
+    std::vector<Picking::Hit> allHits;
+    for (int sy = 0; sy < ClientHeight; sy += 10)
+    {
+        for (int sx = 0; sx < ClientWidth; sx += 10)
+        {
+            ++rays;
+            const Picking::Ray viewRay = Picking::ViewSpaceRay(sx, sy, ClientWidth, ClientHeight, proj);
+
+            // The view is rigid, so world distances are view distances.
+            const XMVECTOR origin = XMVector3TransformCoord(XMLoadFloat3(&viewRay.Origin), invView);
+            const XMVECTOR direction = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&viewRay.Direction), invView));
+
+            float expectedDistance = std::numeric_limits<float>::infinity();
+            std::size_t expectedTarget = targets.size();
+            std::size_t expectedCount = 0;
+            for (std::size_t o = 0; o < objects.size(); ++o)
+            {
+                const std::vector<XMFLOAT3>& positions = objects[o].WorldPositions;
+                for (std::size_t t = 0; t < car.Indices.size(); t += 3)
+                {
+                    float distance = 0.0f;
+                    if (TriangleTests::Intersects(origin, direction,
+                        XMLoadFloat3(&positions[car.Indices[t + 0]]),
+                        XMLoadFloat3(&positions[car.Indices[t + 1]]),
+                        XMLoadFloat3(&positions[car.Indices[t + 2]]), distance))
+                    {
+                        ++expectedCount;
+                        if (distance < expectedDistance)
+                        {
+                            expectedDistance = distance;
+                            expectedTarget = o;
+                        }
+                    }
+                }
+            }
+
+            Picking::Hit hit;
+            const bool found = Picking::Nearest(invView, viewRay, targets, hit);
+            CHECK_MSG(found == (expectedTarget != targets.size()), "pixel " << sx << ", " << sy);
+
+            Picking::All(invView, viewRay, targets, allHits);
+            CHECK_MSG(allHits.size() == expectedCount, "pixel " << sx << ", " << sy << ": "
+                << allHits.size() << " hits against " << expectedCount);
+
+            if (!found || expectedTarget == targets.size())
+                continue;
+
+            ++hits;
+            ++hitsPerTarget[hit.Target];
+
+            const float tolerance = 1e-4f * expectedDistance;
+            CHECK_MSG(std::fabs(hit.Distance - expectedDistance) <= tolerance, "pixel " << sx << ", " << sy << ": "
+                << hit.Distance << " against " << expectedDistance);
+            CHECK_MSG(hit.Target == expectedTarget, "pixel " << sx << ", " << sy << ": target "
+                << hit.Target << " against " << expectedTarget);
+            CHECK(!allHits.empty() && allHits.front().Distance == hit.Distance);
+        }
+    }
+
+    // Each car is in view and in front of the others somewhere.
+    for (std::size_t i = 0; i < targets.size(); ++i)
+        CHECK_MSG(hitsPerTarget[i] > 0, "target " << i);
+
+    std::cout << "  " << rays << " rays, " << hits << " hits\n";
+}
@@ -0,0 +1,109 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// Profiler zones recorded on several threads, and the memory their buffers hold
+// before and after the threads exit and while they record.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Profiler.h"
+
+namespace
+{
+    std::size_t CountOf(const std::string& text, const std::string& pattern)
+    {
+        std::size_t count = 0;
+        for (std::size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+            ++count;
+        return count;
+    }
+}
+
+TEST_CASE(ProfilerBuffersGrowWithUseAndGoWithTheirThreads)
+{
+    Profiler::BeginCapture();
+    const std::size_t startBytes = Profiler::ZoneBufferBytes();
+
+    // Threads that only name themselves, as idle pool workers do, cost next to nothing.
+    {
+        std::vector<std::thread> idle;
+        for (int t = 0; t < 8; ++t)
+            idle.emplace_back([] { Profiler::SetThreadName("idle"); });
+        for (std::thread& thread : idle)
+            thread.join();
+    }
+    const std::size_t idleBytes = Profiler::ZoneBufferBytes() - startBytes;
+    CHECK_MSG(idleBytes < 8 * 4096, idleBytes << " bytes");
+
+    // 3000 zones on each of four threads, more than one chunk each.
+    constexpr int ZonesPerThread = 3000;
+    std::vector<std::thread> busy;
+    for (int t = 0; t < 4; ++t)
+    {
+        busy.emplace_back([]
+        {
+            for (int i = 0; i < ZonesPerThread; ++i)
+            {
+                PROFILE_SCOPE("ProfilerTests zone");
+            }
+        });
+    }
+    for (std::thread& thread : busy)
+        thread.join();
+    Profiler::EndCapture();
+
+    const std::size_t busyBytes = Profiler::ZoneBufferBytes();
+    CHECK(busyBytes >= startBytes + 4 * ZonesPerThread * 3 * sizeof(std::uint64_t));
+    CHECK(Profiler::DroppedZones() == 0);
+
+    // The threads are gone, but their zones are still written out.
+    std::ostringstream trace;
+    Profiler::WriteChromeTrace(trace);
+    CHECK(CountOf(trace.str(), "\"ProfilerTests zone\"") == 4 * ZonesPerThread);
+
+    // The next capture frees their buffers.
+    Profiler::BeginCapture();
+    Profiler::EndCapture();
+    CHECK_MSG(Profiler::ZoneBufferBytes() <= startBytes, Profiler::ZoneBufferBytes() << " bytes, " << startBytes
+        << " before");
+}
+
+TEST_CASE(ProfilerBufferBytesReadWhileRecording)
+{
+    Profiler::BeginCapture();
+    const std::size_t startBytes = Profiler::ZoneBufferBytes();
+
+    // One thread fills several chunks while this one keeps reading the total, which
+    // only ever grows as chunks are added.
+    std::atomic<bool> done = false;
+    std::thread recorder([&done]
+    {
+        for (int i = 0; i < 5000; ++i)
+        {
+            PROFILE_SCOPE("ProfilerTests reader");
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::size_t previous = startBytes;
+    while (!done.load(std::memory_order_acquire))
+    {
+        const std::size_t bytes = Profiler::ZoneBufferBytes();
+        CHECK_MSG(bytes >= previous, bytes << " bytes after " << previous);
+        previous = bytes;
+    }
+    recorder.join();
+    Profiler::EndCapture();
+
+    CHECK(Profiler::ZoneBufferBytes() >= previous);
+    CHECK(Profiler::ZoneBufferBytes() >= startBytes + 5000 * 3 * sizeof(std::uint64_t));
+    CHECK(Profiler::DroppedZones() == 0);
+}
@@ -0,0 +1,117 @@
+//***************************************************************************************
+// TestFramework.h
+//
+// Just enough of a test harness for the Common framework code that runs without a
+// device.  TEST_CASE registers a check that runs by default; BENCHMARK registers a
+// measurement that runs with --bench.  A failed CHECK is reported and the test goes
+// on; a failed REQUIRE ends the test.
+//***************************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace Tests
+{
+    using Function = void(*)();
+
+    struct Registration final
+    {
+        Registration(const char* name, Function function, bool benchmark);
+    };
+
+    void ReportFailure(const char* file, int line, const std::string& message);
+
+    // Path of a file relative to the repository root, e.g. "Textures/bricks.dds".
+    std::filesystem::path RepoPath(std::string_view relative);
+
+    // Set by --quick: benchmarks shrink their problem sizes so that ctest can run
+    // them as smoke tests.
+    bool QuickBenchmarks();
+
+    // Peak resident memory of the process so far.
+    std::uint64_t PeakMemoryBytes();
+
+    class Stopwatch final
+    {
+    public:
+        Stopwatch() : mStart(Clock::now()) {}
+
+        void Restart() { mStart = Clock::now(); }
+
+        double Milliseconds()const
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - mStart).count();
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point mStart;
+    };
+
+    // Best of repeats timings of fn, in milliseconds.
+    template <class Fn>
+    double BestOf(const int repeats, Fn&& fn)
+    {
+        double best = 0.0;
+        for (int i = 0; i < repeats; ++i)
+        {
+            const Stopwatch stopwatch;
+            fn();
+            const double ms = stopwatch.Milliseconds();
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    // Keeps the optimizer from dropping a computation whose result is unused.
+    void DoNotOptimize(const void* p);
+}
+
+#define TEST_CONCAT_INNER(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_INNER(a, b)
+
+#define TEST_CASE(name)                                                                 \
+    static void name();                                                                 \
+    static const Tests::Registration TEST_CONCAT(name, Registration)(#name, name, false); \
+    static void name()
+
+#define BENCHMARK(name)                                                                 \
+    static void name();                                                                 \
+    static const Tests::Registration TEST_CONCAT(name, Registration)(#name, name, true);  \
+    static void name()
+
+// CHECK_MSG(bytes == 16, "file " << name) reports the message with the expression.
+#define CHECK_MSG(condition, message)                                                   \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(condition))                                                               \
+        {                                                                               \
+            std::ostringstream testMessage;                                             \
+            testMessage << #condition << " (" << message << ")";                        \
+            Tests::ReportFailure(__FILE__, __LINE__, testMessage.str());                \
+        }                                                                               \
+    } while (false)
+
+#define CHECK(condition)                                                                \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(condition))                                                               \
+            Tests::ReportFailure(__FILE__, __LINE__, #condition);                       \
+    } while (false)
+
+#define REQUIRE(condition)                                                              \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(condition))                                                               \
+        {                                                                               \
+            Tests::ReportFailure(__FILE__, __LINE__, #condition);                       \
+            return;                                                                     \
+        }                                                                               \
+    } while (false)
@@ -0,0 +1,138 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// Runs the registered tests, or with --bench the benchmarks.
+//
+//   Tests [--bench] [--quick] [name ...]
+//
+// Names select the tests or benchmarks whose name contains one of them.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    struct Entry final
+    {
+        const char* Name = nullptr;
+        Tests::Function Run = nullptr;
+        bool Benchmark = false;
+    };
+
+    // Function-static so registrations from other files can run before main.
+    std::vector<Entry>& Registry()
+    {
+        static std::vector<Entry> entries;
+        return entries;
+    }
+
+    int gFailures = 0;
+    bool gQuick = false;
+    const void* volatile gSink = nullptr;
+}
+
+Tests::Registration::Registration(const char* name, const Function function, const bool benchmark)
+{
+    Registry().push_back({ name, function, benchmark });
+}
+
+void Tests::ReportFailure(const char* file, const int line, const std::string& message)
+{
+    ++gFailures;
+    std::cout << "  " << file << '(' << line << "): failed: " << message << '\n';
+}
+
+std::filesystem::path Tests::RepoPath(const std::string_view relative)
+{
+    return std::filesystem::path(REPO_ROOT) / relative;
+}
+
+bool Tests::QuickBenchmarks()
+{
+    return gQuick;
+}
+
+std::uint64_t Tests::PeakMemoryBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return std::uint64_t(usage.ru_maxrss) * 1024;
+#endif
+}
+
+void Tests::DoNotOptimize(const void* p)
+{
+    gSink = p;
+}
+
+int main(int argc, char* argv[])
+{
+    bool benchmarks = false;
+    std::vector<std::string_view> filters;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--bench") == 0)
+            benchmarks = true;
+        else if (std::strcmp(argv[i], "--quick") == 0)
+            gQuick = true;
+        else
+            filters.emplace_back(argv[i]);
+    }
+
+    int run = 0;
+    int failed = 0;
+    for (const Entry& entry : Registry())
+    {
+        if (entry.Benchmark != benchmarks)
+            continue;
+
+        const std::string_view name = entry.Name;
+        if (!filters.empty() && std::none_of(filters.begin(), filters.end(),
+            [name](std::string_view filter) { return name.find(filter) != std::string_view::npos; }))
+        {
+            continue;
+        }
+
+        std::cout << entry.Name << '\n';
+
+        const int failuresBefore = gFailures;
+        try
+        {
+            entry.Run();
+        }
+        catch (const std::exception& e)
+        {
+            Tests::ReportFailure(__FILE__, __LINE__, std::string("exception: ") + e.what());
+        }
+
+        ++run;
+        if (gFailures != failuresBefore)
+            ++failed;
+    }
+
+    std::cout << run << (benchmarks ? " benchmarks" : " tests") << ", " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}
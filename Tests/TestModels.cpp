@@ -0,0 +1,22 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "TestModels.h"
+
+#include "MeshFile.h"
+
+bool Tests::LoadTextModel(const std::filesystem::path& path, TextModel& model)
+{
+    model = {};
+
+    // As the demos load them: through the .bmesh file converted next to the model.
+    const MeshFile::MappedMesh mesh = MeshFile::LoadOrConvert(path.wstring());
+    if (!mesh.IsValid())
+        return false;
+
+    model.Positions.reserve(mesh.Vertices().size());
+    for (const MeshFile::Vertex& vertex : mesh.Vertices())
+        model.Positions.push_back(vertex.Position);
+    model.Indices.assign(mesh.Indices().begin(), mesh.Indices().end());
+    return true;
+}
@@ -0,0 +1,26 @@
+//***************************************************************************************
+// TestModels.h
+//
+// Reads the positions and indices of the demos' text models (Models/skull.txt and
+// friends) through MeshFile, for tests of the code that works on meshes.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Tests
+{
+    struct TextModel final
+    {
+        std::vector<DirectX::XMFLOAT3> Positions;
+        std::vector<std::uint32_t> Indices;
+    };
+
+    // Returns false if the file is missing or malformed.
+    bool LoadTextModel(const std::filesystem::path& path, TextModel& model);
+}
@@ -0,0 +1,182 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// TextureLoader failures, and the CPU side of loading the Textures directory with and
+// without the thread pool.  The benchmark's upload sink copies every subresource row by
+// row into a staging buffer laid out like a D3D12 upload heap, which is the CPU work
+// UpdateSubresources does; the GPU copy is not part of it.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "TextureLoader.h"
+
+namespace
+{
+    std::vector<std::filesystem::path> DDSFiles()
+    {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(Tests::RepoPath("Textures")))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".dds")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    // Stands in for the upload: copies each row to a 256-byte aligned pitch
+    // (D3D12_TEXTURE_DATA_PITCH_ALIGNMENT), as UpdateSubresources does into the
+    // upload heap.
+    class UploadSink final
+    {
+    public:
+        void Upload(const DDSFile::Texture& texture)
+        {
+            for (const DDSFile::Subresource& subresource : texture.Subresources())
+            {
+                const std::size_t rows = subresource.RowPitch == 0 ? 0 : subresource.SlicePitch / subresource.RowPitch;
+                const std::size_t pitch = (subresource.RowPitch + 255) & ~std::size_t(255);
+                const std::size_t size = pitch * rows * subresource.Depth;
+                if (mStaging.size() < size)
+                    mStaging.resize(size);
+
+                std::byte* dest = mStaging.data();
+                const std::byte* src = subresource.Data;
+                for (std::size_t row = 0; row < rows * subresource.Depth; ++row)
+                {
+                    std::memcpy(dest, src, subresource.RowPitch);
+                    dest += pitch;
+                    src += subresource.RowPitch;
+                }
+                mBytes += size;
+            }
+            Tests::DoNotOptimize(mStaging.data());
+        }
+
+        std::uint64_t Bytes()const { return mBytes; }
+
+    private:
+        std::vector<std::byte> mStaging;
+        std::uint64_t mBytes = 0;
+    };
+}
+
+TEST_CASE(TextureLoaderReportsFailures)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "TextureLoaderTests";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // A copy of a real file with its last bytes cut off.
+    const std::filesystem::path good = Tests::RepoPath("Textures/bricks.dds");
+    const std::filesystem::path truncated = directory / "truncated.dds";
+    {
+        std::ifstream fin(good, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        REQUIRE(bytes.size() > 1024);
+        std::ofstream fout(truncated, std::ios::binary);
+        fout.write(bytes.data(), std::streamsize(bytes.size() - 1024));
+    }
+
+    ThreadPool pool(2);
+    TextureLoader loader(pool);
+    auto goodFuture = loader.Load("good", good.wstring());
+    auto missingFuture = loader.Load("missing", (directory / "missing.dds").wstring());
+    auto truncatedFuture = loader.Load("truncated", truncated.wstring());
+
+    // Returns even though two of them failed.
+    loader.WaitIdle();
+    CHECK(loader.Pending() == 3);
+
+    CHECK(goodFuture.get()->Succeeded());
+    CHECK(!missingFuture.get()->Succeeded());
+    CHECK(missingFuture.get()->Result == DDSFile::Result::OpenFailed);
+    CHECK(missingFuture.get()->Asset == nullptr);
+    CHECK(!truncatedFuture.get()->Succeeded());
+    CHECK(truncatedFuture.get()->Result == DDSFile::Result::Truncated);
+
+    int succeeded = 0;
+    int failed = 0;
+    CHECK(loader.Poll([&](const TextureLoader::TexturePtr& texture)
+    {
+        if (texture->Succeeded())
+            ++succeeded;
+        else
+            ++failed;
+    }) == 3);
+    CHECK(succeeded == 1 && failed == 2);
+    CHECK(loader.Pending() == 0);
+}
+
+BENCHMARK(TextureLoaderCpuStage)
+{
+    const std::vector<std::filesystem::path> files = DDSFiles();
+    REQUIRE(!files.empty());
+
+    const int rounds = Tests::QuickBenchmarks() ? 1 : 20;
+    const unsigned workers = std::max(2u, std::thread::hardware_concurrency() - 1);
+
+    // On the main thread, one file after the other, as DDSTextureLoader does.
+    UploadSink syncSink;
+    const double syncMs = Tests::BestOf(rounds, [&]
+    {
+        for (const std::filesystem::path& path : files)
+        {
+            DDSFile::Texture texture;
+            if (DDSFile::Load(path.wstring(), texture) == DDSFile::Result::Ok)
+                syncSink.Upload(texture);
+        }
+    });
+
+    // Parsed on the pool; the main thread only queues, polls and copies.  Each round
+    // drops its textures so the next one maps the files again.
+    ThreadPool pool(workers);
+    UploadSink asyncSink;
+    double mainThreadMs = 0.0;
+    const double asyncMs = Tests::BestOf(rounds, [&]
+    {
+        TextureLoader loader(pool);
+        std::vector<TextureLoader::TexturePtr> kept;
+
+        Tests::Stopwatch busy;
+        double roundMainMs = 0.0;
+        for (const std::filesystem::path& path : files)
+        {
+            loader.Load(path.filename().string(), path.wstring());
+        }
+        roundMainMs += busy.Milliseconds();
+
+        while (loader.Pending() != 0)
+        {
+            busy.Restart();
+            const std::size_t count = loader.Poll([&](const TextureLoader::TexturePtr& texture)
+            {
+                if (texture->Succeeded())
+                    asyncSink.Upload(texture->Texture());
+                kept.push_back(texture);
+            });
+            roundMainMs += busy.Milliseconds();
+
+            if (count == 0)
+                std::this_thread::yield();
+        }
+
+        mainThreadMs = mainThreadMs == 0.0 ? roundMainMs : std::min(mainThreadMs, roundMainMs);
+    });
+
+    CHECK(asyncSink.Bytes() == syncSink.Bytes());
+
+    std::cout << "  " << files.size() << " files, " << syncSink.Bytes() / rounds / 1024 << " KiB staged a round, "
+        << workers << " workers\n"
+        << "  main thread only:     " << syncMs << " ms\n"
+        << "  thread pool:          " << asyncMs << " ms until all are staged, "
+        << mainThreadMs << " ms of it on the main thread\n";
+}
@@ -0,0 +1,197 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// Drives TextureResidency along a simulated camera path the way the SSAO demo does,
+// and checks the budget, the promotion limit and that the requests are met once the
+// camera stops.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "TextureResidency.h"
+
+namespace
+{
+    // Mip sizes of a BC1 texture of extent x extent texels.
+    std::vector<std::uint64_t> BC1MipBytes(std::uint32_t extent)
+    {
+        std::vector<std::uint64_t> mipBytes;
+        for (;; extent /= 2)
+        {
+            const std::uint64_t blocks = std::max<std::uint32_t>(1, (extent + 3) / 4);
+            mipBytes.push_back(blocks * blocks * 8);
+            if (extent == 1)
+                break;
+        }
+        return mipBytes;
+    }
+
+    struct Item final
+    {
+        float X = 0.0f;
+        float Z = 0.0f;
+        float Radius = 0.0f;
+        TextureResidency::TextureId Texture = 0;
+        std::uint32_t Extent = 0;
+    };
+
+    // The mip the demo asks for: texels closest to one per pixel over the item.
+    std::uint32_t WantedMip(const Item& item, const float eyeX, const float eyeZ)
+    {
+        constexpr float PixelsPerUnit = 720.0f / (2.0f * 0.41421356f); // 45 degree fov, 720 rows
+        const float distance = std::max(std::hypot(item.X - eyeX, item.Z - eyeZ) - item.Radius, 1.0f);
+        const float pixels = std::max(2.0f * item.Radius * PixelsPerUnit / distance, 1.0f);
+        const float mip = std::floor(std::log2(item.Extent / pixels));
+        return mip > 0.0f ? std::uint32_t(mip) : 0;
+    }
+
+    struct Scene final
+    {
+        TextureResidency Residency{ 1536 * 1024 };
+        std::vector<Item> Items;
+        std::vector<std::uint32_t> Extents;
+    };
+
+    // A row of items down the z axis, every one with its own texture.
+    void BuildScene(Scene& scene, const int itemCount)
+    {
+        for (int i = 0; i < itemCount; ++i)
+        {
+            const std::uint32_t extent = i % 3 == 0 ? 1024 : 512;
+            const std::vector<std::uint64_t> mipBytes = BC1MipBytes(extent);
+
+            // The tail starts at the first mip of at most 64 texels, as in the demo.
+            std::uint32_t tailMip = 0;
+            while ((extent >> tailMip) > 64)
+                ++tailMip;
+
+            Item item;
+            item.X = i % 2 == 0 ? -4.0f : 4.0f;
+            item.Z = 10.0f * i;
+            item.Radius = 2.0f;
+            item.Texture = scene.Residency.Add(mipBytes, tailMip);
+            item.Extent = extent;
+            scene.Items.push_back(item);
+            scene.Extents.push_back(extent);
+        }
+    }
+
+    struct FrameStats final
+    {
+        std::size_t Promotions = 0;
+        std::size_t Evictions = 0;
+    };
+
+    // Requests what a camera at (eyeX, eyeZ) looking down +z sees, ends the frame and
+    // checks what came back against residentMips, which it keeps up to date.
+    FrameStats RunFrame(Scene& scene, const float eyeX, const float eyeZ, std::vector<std::uint32_t>& residentMips)
+    {
+        for (const Item& item : scene.Items)
+        {
+            if (item.Z + item.Radius > eyeZ && item.Z - eyeZ < 200.0f)
+                scene.Residency.Request(item.Texture, WantedMip(item, eyeX, eyeZ));
+        }
+
+        std::vector<TextureResidency::Change> changes;
+        scene.Residency.EndFrame(changes);
+
+        FrameStats stats;
+        for (const TextureResidency::Change& change : changes)
+        {
+            CHECK(change.OldMip == residentMips[change.Id]);
+            CHECK(change.NewMip != change.OldMip);
+            CHECK(change.NewMip <= scene.Residency.TailMip(change.Id));
+            residentMips[change.Id] = change.NewMip;
+            if (change.NewMip < change.OldMip)
+                ++stats.Promotions;
+            else
+                ++stats.Evictions;
+        }
+
+        CHECK_MSG(stats.Promotions <= scene.Residency.MaxPromotionsPerFrame(), stats.Promotions << " promotions");
+        CHECK_MSG(scene.Residency.ResidentBytes() <= scene.Residency.Budget(),
+            scene.Residency.ResidentBytes() << " of " << scene.Residency.Budget() << " bytes");
+        return stats;
+    }
+}
+
+TEST_CASE(TextureResidencyCameraPath)
+{
+    Scene scene;
+    BuildScene(scene, 24);
+    scene.Residency.SetMaxPromotionsPerFrame(2);
+
+    std::vector<std::uint32_t> residentMips(scene.Items.size());
+    for (std::size_t i = 0; i < scene.Items.size(); ++i)
+        residentMips[i] = scene.Residency.TailMip(TextureResidency::TextureId(i));
+
+    // Fly down the row at 0.25 units a frame, then stop and let the streaming settle.
+    std::size_t promotions = 0;
+    std::size_t evictions = 0;
+    std::size_t busiestFrame = 0;
+    float eyeZ = -20.0f;
+    for (; eyeZ < 200.0f; eyeZ += 0.25f)
+    {
+        const FrameStats stats = RunFrame(scene, 0.0f, eyeZ, residentMips);
+        promotions += stats.Promotions;
+        evictions += stats.Evictions;
+        busiestFrame = std::max(busiestFrame, stats.Promotions + stats.Evictions);
+    }
+
+    int settleFrames = 0;
+    for (; settleFrames < 100; ++settleFrames)
+    {
+        const FrameStats stats = RunFrame(scene, 0.0f, eyeZ, residentMips);
+        if (stats.Promotions == 0 && stats.Evictions == 0)
+            break;
+    }
+    CHECK_MSG(settleFrames < 100, "still streaming after the camera stopped");
+
+    // Whatever the camera sees now fits, so each visible texture has what it asked for.
+    for (const Item& item : scene.Items)
+    {
+        if (item.Z + item.Radius > eyeZ && item.Z - eyeZ < 200.0f)
+        {
+            CHECK_MSG(scene.Residency.ResidentMip(item.Texture) <= WantedMip(item, 0.0f, eyeZ),
+                "texture " << item.Texture << " at mip " << scene.Residency.ResidentMip(item.Texture));
+        }
+    }
+
+    CHECK(promotions > 0);
+    CHECK(evictions > 0);
+    std::cout << "  " << promotions << " promotions, " << evictions << " evictions, at most "
+        << busiestFrame << " changes a frame, settled in " << settleFrames << " frames\n";
+}
+
+TEST_CASE(TextureResidencyLimitsPromotions)
+{
+    Scene scene;
+    BuildScene(scene, 6);
+    scene.Residency.SetBudget(64 * 1024 * 1024);
+    scene.Residency.SetMaxPromotionsPerFrame(2);
+
+    std::vector<std::uint32_t> residentMips(scene.Items.size());
+    for (std::size_t i = 0; i < scene.Items.size(); ++i)
+        residentMips[i] = scene.Residency.TailMip(TextureResidency::TextureId(i));
+
+    // Every texture wants mip 0 at once: two a frame get it, most starved first.
+    std::vector<std::size_t> perFrame;
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        for (const Item& item : scene.Items)
+            scene.Residency.Request(item.Texture, 0);
+
+        std::vector<TextureResidency::Change> changes;
+        scene.Residency.EndFrame(changes);
+        perFrame.push_back(changes.size());
+    }
+
+    CHECK(perFrame[0] == 2 && perFrame[1] == 2 && perFrame[2] == 2 && perFrame[3] == 0);
+    for (const Item& item : scene.Items)
+        CHECK(scene.Residency.ResidentMip(item.Texture) == 0);
+}
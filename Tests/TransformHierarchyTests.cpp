@@ -0,0 +1,168 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// TransformHierarchy updated level by level on the thread pool against the serial
+// forward pass, and both on a 100K-node hierarchy.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "TransformHierarchy.h"
+
+using namespace DirectX;
+
+namespace
+{
+    XMMATRIX RandomLocal(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+        std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+        return XMMatrixRotationY(angle(random)) * XMMatrixTranslation(offset(random), offset(random), offset(random));
+    }
+
+    // A scene-like hierarchy: a few roots, then every node hangs off a random earlier
+    // node, which gives a wide tree about a dozen levels deep.
+    void AddNodes(TransformHierarchy& hierarchy, const std::size_t count, const unsigned seed)
+    {
+        std::mt19937 random(seed);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const std::size_t size = hierarchy.Size();
+            std::uint32_t parent = TransformHierarchy::NoParent;
+            if (size >= 16)
+                parent = std::uniform_int_distribution<std::uint32_t>(0, std::uint32_t(size - 1))(random);
+            hierarchy.Add(RandomLocal(random), parent);
+        }
+    }
+
+    bool SameWorlds(const TransformHierarchy& a, const TransformHierarchy& b)
+    {
+        for (std::uint32_t i = 0; i < a.Size(); ++i)
+        {
+            XMFLOAT4X4 worldA;
+            XMFLOAT4X4 worldB;
+            XMStoreFloat4x4(&worldA, a.World(i));
+            XMStoreFloat4x4(&worldB, b.World(i));
+            if (std::memcmp(&worldA, &worldB, sizeof(worldA)) != 0 || a.WorldChanged(i) != b.WorldChanged(i))
+                return false;
+        }
+        return true;
+    }
+
+    // Number of levels.
+    std::uint32_t Depth(const TransformHierarchy& hierarchy)
+    {
+        std::vector<std::uint32_t> depths(hierarchy.Size());
+        std::uint32_t deepest = 0;
+        for (std::uint32_t i = 0; i < hierarchy.Size(); ++i)
+        {
+            const std::uint32_t parent = hierarchy.Parent(i);
+            depths[i] = parent == TransformHierarchy::NoParent ? 0 : depths[parent] + 1;
+            deepest = std::max(deepest, depths[i]);
+        }
+        return deepest + 1;
+    }
+}
+
+TEST_CASE(TransformHierarchyParallelMatchesSerial)
+{
+    ThreadPool pool(3);
+    TransformHierarchy serial;
+    TransformHierarchy parallel;
+    AddNodes(serial, 3 * TransformHierarchy::ParallelUpdateMinNodes, 1);
+    AddNodes(parallel, 3 * TransformHierarchy::ParallelUpdateMinNodes, 1);
+
+    // Wide enough for the level by level pass rather than the serial fallback.
+    REQUIRE(Depth(parallel) * TransformHierarchy::ParallelUpdateMinLevelWidth <= parallel.Size());
+
+    CHECK(serial.Update() == serial.Size());
+    CHECK(parallel.Update(pool) == parallel.Size());
+    CHECK(SameWorlds(serial, parallel));
+
+    std::mt19937 random(2);
+    for (int frame = 0; frame < 20; ++frame)
+    {
+        // A handful of changed nodes anywhere, or none at all.
+        const int changes = frame % 5 == 4 ? 0 : 1 + frame * 3;
+        for (int c = 0; c < changes; ++c)
+        {
+            const auto node = std::uniform_int_distribution<std::uint32_t>(0, std::uint32_t(serial.Size() - 1))(random);
+            const XMMATRIX local = RandomLocal(random);
+            serial.SetLocal(node, local);
+            parallel.SetLocal(node, local);
+        }
+
+        // New nodes halfway through, so the levels are rebuilt.
+        if (frame == 10)
+        {
+            AddNodes(serial, 500, 3);
+            AddNodes(parallel, 500, 3);
+        }
+
+        const std::size_t serialUpdated = serial.Update();
+        CHECK(parallel.Update(pool) == serialUpdated);
+        CHECK_MSG(SameWorlds(serial, parallel), "frame " << frame);
+    }
+
+    // One long chain takes the serial fallback and still gets every node.
+    TransformHierarchy chain;
+    std::uint32_t parent = TransformHierarchy::NoParent;
+    for (std::size_t i = 0; i < 2 * TransformHierarchy::ParallelUpdateMinNodes; ++i)
+        parent = chain.Add(RandomLocal(random), parent);
+    CHECK(chain.Update(pool) == chain.Size());
+    chain.SetLocal(0, XMMatrixIdentity());
+    CHECK(chain.Update(pool) == chain.Size());
+}
+
+BENCHMARK(TransformHierarchyUpdate)
+{
+    const std::size_t nodeCount = Tests::QuickBenchmarks() ? 20000 : 100000;
+    const int repeats = Tests::QuickBenchmarks() ? 3 : 20;
+
+    TransformHierarchy hierarchy;
+    hierarchy.Reserve(nodeCount);
+    AddNodes(hierarchy, nodeCount, 1);
+    hierarchy.Update();
+
+    std::cout << "  " << nodeCount << " nodes in " << Depth(hierarchy) << " levels\n";
+
+    // At least one worker, so that a single core measures the level by level pass too.
+    ThreadPool pool(std::max(ThreadPool::DefaultWorkerCount(), 1u));
+    std::mt19937 random(4);
+    const XMMATRIX roots[2] = { RandomLocal(random), RandomLocal(random) };
+
+    // Moving the roots dirties everything; moving every 100th node dirties the
+    // subtrees below them.
+    for (const std::size_t stride : { std::size_t(1), std::size_t(100) })
+    {
+        const auto touch = [&](const int round)
+        {
+            for (std::size_t i = stride == 1 ? 0 : 16; i < (stride == 1 ? 16 : nodeCount); i += stride)
+                hierarchy.SetLocal(std::uint32_t(i), roots[round & 1]);
+        };
+
+        int round = 0;
+        std::size_t updated = 0;
+        const double serialMs = Tests::BestOf(repeats, [&]
+        {
+            touch(round++);
+            updated = hierarchy.Update();
+        });
+        const double poolMs = Tests::BestOf(repeats, [&]
+        {
+            touch(round++);
+            hierarchy.Update(pool);
+        });
+
+        std::cout << "  " << (stride == 1 ? "roots moved: " : "every 100th moved: ") << updated
+            << " world matrices, serial " << serialMs << " ms, " << pool.WorkerCount() + 1
+            << " threads " << poolMs << " ms\n";
+    }
+}
@@ -0,0 +1,243 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// UploadBuffer over HostUploadAllocation: CopyRange staying within its elements, the
+// 256-byte stride of constant buffers, UploadMemory::StreamingCopy on either side of its
+// threshold and at every misalignment, and the three ways of filling a buffer timed.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "UploadBuffer.h"
+
+namespace
+{
+    // A vertex of the lit demos.
+    struct TestVertex final
+    {
+        float Pos[3];
+        float Normal[3];
+        float TexC[2];
+    };
+
+    // Less than 256 bytes, so each constant buffer element is padded.
+    struct TestConstants final
+    {
+        float World[16];
+        std::uint32_t MaterialIndex;
+    };
+
+    TestVertex MakeVertex(const std::size_t i)
+    {
+        TestVertex v = {};
+        for (int k = 0; k < 3; ++k)
+        {
+            v.Pos[k] = float(i * 3 + k);
+            v.Normal[k] = -float(i * 3 + k);
+        }
+        v.TexC[0] = float(i) * 0.5f;
+        v.TexC[1] = float(i) * 0.25f;
+        return v;
+    }
+
+    constexpr BYTE Untouched = 0xCD;
+
+    // An upload buffer of count elements over host memory filled with Untouched, with
+    // room for one more element past the end to catch overruns.
+    template<typename T>
+    UploadBuffer<T> MakeBuffer(const UINT count, const bool isConstantBuffer, BYTE*& data, UINT64& byteSize)
+    {
+        const UINT64 elementByteSize = isConstantBuffer ? UploadMemory::ConstantBufferByteSize(sizeof(T)) : sizeof(T);
+        auto allocation = std::make_unique<HostUploadAllocation>(elementByteSize * (count + 1));
+        data = allocation->Data();
+        byteSize = allocation->ByteSize();
+        std::memset(data, Untouched, static_cast<std::size_t>(byteSize));
+        return UploadBuffer<T>(std::move(allocation), count, isConstantBuffer);
+    }
+
+    bool AllUntouched(const BYTE* first, const BYTE* last)
+    {
+        for (; first != last; ++first)
+        {
+            if (*first != Untouched)
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST_CASE(UploadBufferCopyRangeStaysInItsElements)
+{
+    constexpr UINT Count = 40;
+    std::vector<TestVertex> vertices(Count);
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+        vertices[i] = MakeVertex(i);
+
+    // A range in the middle, one at the start and one ending on the last element.
+    const UINT ranges[][2] = { { 7, 13 }, { 0, 1 }, { 25, Count - 25 }, { Count, 0 } };
+    for (const auto& [first, count] : ranges)
+    {
+        BYTE* data = nullptr;
+        UINT64 byteSize = 0;
+        UploadBuffer<TestVertex> buffer = MakeBuffer<TestVertex>(Count, false, data, byteSize);
+        buffer.CopyRange(first, std::span<const TestVertex>(vertices).subspan(first, count));
+
+        const BYTE* begin = data + std::size_t(first) * sizeof(TestVertex);
+        const BYTE* end = begin + std::size_t(count) * sizeof(TestVertex);
+        CHECK_MSG(std::memcmp(begin, &vertices[first], end - begin) == 0, first << "+" << count);
+        CHECK_MSG(AllUntouched(data, begin), first << "+" << count);
+        CHECK_MSG(AllUntouched(end, data + byteSize), first << "+" << count);
+    }
+
+    // The same range through the mapped elements.
+    BYTE* data = nullptr;
+    UINT64 byteSize = 0;
+    UploadBuffer<TestVertex> buffer = MakeBuffer<TestVertex>(Count, false, data, byteSize);
+    const std::span<TestVertex> mapped = buffer.MappedElements();
+    CHECK(reinterpret_cast<BYTE*>(mapped.data()) == data);
+    CHECK(mapped.size() == Count);
+    std::copy(vertices.begin() + 7, vertices.begin() + 20, mapped.begin() + 7);
+    CHECK(std::memcmp(data + 7 * sizeof(TestVertex), &vertices[7], 13 * sizeof(TestVertex)) == 0);
+    CHECK(AllUntouched(data + 20 * sizeof(TestVertex), data + byteSize));
+}
+
+TEST_CASE(UploadBufferConstantsAre256BytesApart)
+{
+    static_assert(sizeof(TestConstants) < 256);
+    CHECK(UploadMemory::ConstantBufferByteSize(1) == 256);
+    CHECK(UploadMemory::ConstantBufferByteSize(256) == 256);
+    CHECK(UploadMemory::ConstantBufferByteSize(257) == 512);
+
+    constexpr UINT Count = 9;
+    BYTE* data = nullptr;
+    UINT64 byteSize = 0;
+    UploadBuffer<TestConstants> buffer = MakeBuffer<TestConstants>(Count, true, data, byteSize);
+    CHECK(buffer.ElementByteSize() == 256);
+    CHECK(reinterpret_cast<std::uintptr_t>(data) % 256 == 0);
+
+    std::vector<TestConstants> constants(Count);
+    for (UINT i = 0; i < Count; ++i)
+    {
+        std::iota(std::begin(constants[i].World), std::end(constants[i].World), float(i * 16));
+        constants[i].MaterialIndex = i;
+    }
+
+    // Elements 2..7: each at i * 256, the padding after it left alone.
+    buffer.CopyRange(2, std::span<const TestConstants>(constants).subspan(2, 6));
+    for (UINT i = 0; i < Count + 1; ++i)
+    {
+        const BYTE* element = data + std::size_t(i) * 256;
+        if (i >= 2 && i < 8)
+        {
+            CHECK_MSG(std::memcmp(element, &constants[i], sizeof(TestConstants)) == 0, "element " << i);
+            CHECK_MSG(AllUntouched(element + sizeof(TestConstants), element + 256), "element " << i);
+        }
+        else
+        {
+            CHECK_MSG(AllUntouched(element, element + 256), "element " << i);
+        }
+    }
+
+    // The strided view walks the same elements, and CopyData writes where it reads.
+    const StridedSpan<TestConstants> strided = buffer.MappedStridedElements();
+    CHECK(strided.size() == Count);
+    CHECK(strided.stride() == 256);
+    UINT visited = 0;
+    for (const TestConstants& element : strided)
+    {
+        CHECK_MSG(reinterpret_cast<const BYTE*>(&element) == data + std::size_t(visited) * 256, "element " << visited);
+        ++visited;
+    }
+    CHECK(visited == Count);
+
+    buffer.CopyData(8, constants[8]);
+    CHECK(strided[8].MaterialIndex == 8);
+    CHECK(reinterpret_cast<BYTE*>(&strided[8]) == data + 8 * 256);
+    CHECK(AllUntouched(data + Count * 256, data + byteSize));
+}
+
+TEST_CASE(StreamingCopyMatchesMemcpy)
+{
+    constexpr std::size_t Guard = 64;
+    std::vector<BYTE> source(3 * UploadMemory::MinStreamingCopyBytes + 100);
+    for (std::size_t i = 0; i < source.size(); ++i)
+        source[i] = BYTE(i * 7 + 3);
+
+    // Around the threshold, sizes that leave a tail after the 64-byte blocks, and
+    // destinations at every offset from a 16-byte boundary.
+    const std::size_t threshold = UploadMemory::MinStreamingCopyBytes;
+    const std::size_t sizes[] = { 0, 1, 15, 63, 64, 100, threshold - 1, threshold, threshold + 1,
+        threshold + 63, 2 * threshold + 17, source.size() - 16 };
+
+    std::vector<BYTE> destination(source.size() + 2 * Guard);
+    for (const std::size_t size : sizes)
+    {
+        for (std::size_t misalignment = 0; misalignment < 16; ++misalignment)
+        {
+            for (const std::size_t sourceOffset : { std::size_t(0), std::size_t(3) })
+            {
+                std::fill(destination.begin(), destination.end(), Untouched);
+                BYTE* base = destination.data() + Guard;
+                base += (16 - reinterpret_cast<std::uintptr_t>(base) % 16) % 16;
+                BYTE* dst = base + misalignment;
+                UploadMemory::StreamingCopy(dst, source.data() + sourceOffset, size);
+
+                CHECK_MSG(std::memcmp(dst, source.data() + sourceOffset, size) == 0,
+                    size << " bytes at +" << misalignment << " from +" << sourceOffset);
+                CHECK_MSG(AllUntouched(destination.data(), dst) &&
+                    AllUntouched(dst + size, destination.data() + destination.size()),
+                    size << " bytes at +" << misalignment << " from +" << sourceOffset);
+            }
+        }
+    }
+}
+
+BENCHMARK(UploadBufferCopies)
+{
+    const UINT count = Tests::QuickBenchmarks() ? 100000 : 1000000;
+    const int repeats = Tests::QuickBenchmarks() ? 3 : 20;
+
+    std::vector<TestVertex> vertices(count);
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+        vertices[i] = MakeVertex(i);
+
+    BYTE* data = nullptr;
+    UINT64 byteSize = 0;
+    UploadBuffer<TestVertex> buffer = MakeBuffer<TestVertex>(count, false, data, byteSize);
+
+    // Before: one CopyData per element, as the demos filled their dynamic vertex buffers.
+    const double copyDataMs = Tests::BestOf(repeats, [&]
+    {
+        for (UINT i = 0; i < count; ++i)
+            buffer.CopyData(int(i), vertices[i]);
+        Tests::DoNotOptimize(data);
+    });
+
+    // One copy of the range.  Host memory is not write-combined, so this is a memcpy.
+    const double copyRangeMs = Tests::BestOf(repeats, [&]
+    {
+        buffer.CopyRange(0, vertices);
+        Tests::DoNotOptimize(data);
+    });
+
+    // What CopyRange does on an upload heap: non-temporal stores.  On ordinary memory
+    // they skip the cache, so expect no gain here; the point is the write-combined case.
+    const double streamingMs = Tests::BestOf(repeats, [&]
+    {
+        UploadMemory::StreamingCopy(data, vertices.data(), vertices.size() * sizeof(TestVertex));
+        Tests::DoNotOptimize(data);
+    });
+
+    const double megabytes = double(count) * sizeof(TestVertex) / (1024.0 * 1024.0);
+    std::cout << "  " << count << " vertices, " << megabytes << " MB\n"
+        << "  CopyData per element: " << copyDataMs << " ms\n"
+        << "  CopyRange:            " << copyRangeMs << " ms (" << copyDataMs / copyRangeMs << "x)\n"
+        << "  StreamingCopy:        " << streamingMs << " ms (" << copyDataMs / streamingMs << "x)\n";
+}
@@ -0,0 +1,214 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// UploadRingBuffer over HostUploadAllocation: constant buffer alignment, frames wrapping
+// around the ring as their fences are reached, running out of room when too many frames
+// are in flight, and the high-water mark.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "UploadRingBuffer.h"
+
+namespace
+{
+    // Less than 256 bytes, so AllocateConstants pads each element.
+    struct TestConstants final
+    {
+        float World[16];
+        std::uint32_t MaterialIndex;
+    };
+
+    UploadRingBuffer MakeRing(const UINT64 byteSize)
+    {
+        return UploadRingBuffer(std::make_unique<HostUploadAllocation>(byteSize));
+    }
+
+    bool Overlaps(const UploadRingBuffer::Allocation& a, const UploadRingBuffer::Allocation& b)
+    {
+        return a.Offset < b.Offset + b.ByteSize && b.Offset < a.Offset + a.ByteSize;
+    }
+
+    bool Throws(UploadRingBuffer& ring, const UINT64 byteSize)
+    {
+        try
+        {
+            ring.Allocate(byteSize);
+        }
+        catch (...)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+TEST_CASE(UploadRingBufferAlignsConstants)
+{
+    UploadRingBuffer ring = MakeRing(64 * 1024);
+    REQUIRE(ring.Capacity() == 64 * 1024);
+    REQUIRE(ring.Resource() == nullptr);
+
+    // Odd-sized allocations in between, so each constant buffer has to be realigned.
+    const BYTE* base = ring.Allocate(1, 1).CpuAddress;
+    for (UINT count = 1; count <= 5; ++count)
+    {
+        const UploadRingBuffer::Allocation packed = ring.Allocate(13 * count, 4);
+        CHECK(packed.Offset % 4 == 0);
+
+        const UploadRingBuffer::Allocation constants = ring.AllocateConstants<TestConstants>(count);
+        CHECK_MSG(constants.Offset % 256 == 0, count << ": " << constants.Offset);
+        CHECK_MSG(reinterpret_cast<std::uintptr_t>(constants.CpuAddress) % 256 == 0, count);
+        CHECK(constants.CpuAddress == base + constants.Offset);
+        CHECK(constants.ByteSize == 256 * count);
+        CHECK(constants.GpuAddress == 0);
+        CHECK(!Overlaps(packed, constants));
+    }
+
+    TestConstants data = {};
+    data.World[0] = 2.0f;
+    data.MaterialIndex = 7;
+    const UploadRingBuffer::Allocation pushed = ring.PushConstants(data);
+    CHECK(pushed.Offset % 256 == 0);
+    CHECK(pushed.ByteSize == 256);
+    CHECK(std::memcmp(pushed.CpuAddress, &data, sizeof(data)) == 0);
+}
+
+TEST_CASE(UploadRingBufferWrapsAroundRetiredFrames)
+{
+    // Three frames in flight, each a little over a quarter of the ring, so frames keep
+    // landing on different offsets and now and then have to skip the end of the ring.
+    constexpr UINT64 Capacity = 16 * 1024;
+    constexpr UINT64 FramesInFlight = 3;
+    UploadRingBuffer ring = MakeRing(Capacity);
+
+    struct Frame final
+    {
+        UINT64 Fence = 0;
+        std::vector<UploadRingBuffer::Allocation> Allocations;
+    };
+    std::deque<Frame> inFlight;
+
+    int wraps = 0;
+    UINT64 previousOffset = 0;
+    for (UINT64 fence = 1; fence <= 200; ++fence)
+    {
+        // The GPU has finished every frame but the last FramesInFlight - 1.
+        if (fence > FramesInFlight - 1)
+            ring.Retire(fence - (FramesInFlight - 1) - 1);
+        while (!inFlight.empty() && inFlight.front().Fence + FramesInFlight - 1 < fence)
+            inFlight.pop_front();
+
+        Frame frame;
+        frame.Fence = fence;
+        for (const UINT64 byteSize : { UINT64(1500), UINT64(256 * 9), UINT64(700) })
+        {
+            const UploadRingBuffer::Allocation allocation = ring.Allocate(byteSize);
+            CHECK(allocation.Offset + allocation.ByteSize <= Capacity);
+            if (allocation.Offset < previousOffset)
+                ++wraps;
+            previousOffset = allocation.Offset;
+
+            // Nothing the GPU may still read is handed out again.
+            for (const Frame& other : inFlight)
+            {
+                for (const UploadRingBuffer::Allocation& live : other.Allocations)
+                    CHECK_MSG(!Overlaps(allocation, live), "fence " << fence << " over fence " << other.Fence);
+            }
+            for (const UploadRingBuffer::Allocation& live : frame.Allocations)
+                CHECK(!Overlaps(allocation, live));
+
+            frame.Allocations.push_back(allocation);
+        }
+
+        ring.FinishFrame(fence);
+        inFlight.push_back(std::move(frame));
+        CHECK(ring.BytesInUse() <= Capacity);
+    }
+    CHECK(wraps > 10);
+
+    // Once the GPU has caught up nothing is in use.
+    ring.Retire(200);
+    CHECK(ring.BytesInUse() == 0);
+}
+
+TEST_CASE(UploadRingBufferRefusesTooManyFramesInFlight)
+{
+    constexpr UINT64 Capacity = 4096;
+    UploadRingBuffer ring = MakeRing(Capacity);
+
+    // More than the whole ring is never possible.
+    CHECK(Throws(ring, Capacity + 1));
+    CHECK(ring.BytesInUse() == 0);
+
+    // Frames of 1 KiB with no fence reached: the fifth does not fit.
+    for (UINT64 fence = 1; fence <= 4; ++fence)
+    {
+        CHECK(!Throws(ring, 1024));
+        ring.FinishFrame(fence);
+    }
+    CHECK(ring.BytesInUse() == Capacity);
+    CHECK(Throws(ring, 1));
+    CHECK(ring.BytesInUse() == Capacity);
+
+    // A fence that has not been reached releases nothing; the first frame's does.
+    ring.Retire(0);
+    CHECK(Throws(ring, 1));
+    ring.Retire(1);
+    CHECK(ring.BytesInUse() == 3 * 1024);
+    CHECK(!Throws(ring, 1024));
+    CHECK(Throws(ring, 1));
+
+    // Free space split between the end and the start of the ring is not enough for an
+    // allocation that fits in neither: an allocation never straddles the end.
+    UploadRingBuffer split = MakeRing(Capacity);
+    split.Allocate(1000, 1);
+    split.FinishFrame(1);
+    split.Allocate(2000, 1);
+    split.FinishFrame(2);
+    split.Retire(1);
+    CHECK(Capacity - split.BytesInUse() >= 1500);
+    CHECK(Throws(split, 1500));
+    CHECK(!Throws(split, 1000));
+}
+
+TEST_CASE(UploadRingBufferTracksHighWaterMark)
+{
+    constexpr UINT64 Capacity = 8192;
+    UploadRingBuffer ring = MakeRing(Capacity);
+    CHECK(ring.HighWaterMark() == 0);
+
+    ring.Allocate(1000, 1);
+    ring.Allocate(1000, 1);
+    ring.FinishFrame(1);
+    CHECK(ring.HighWaterMark() == 2000);
+
+    ring.Allocate(3000, 1);
+    ring.FinishFrame(2);
+    CHECK(ring.HighWaterMark() == 5000);
+
+    // Retiring lowers the bytes in use, not the mark.
+    ring.Retire(2);
+    CHECK(ring.BytesInUse() == 0);
+    CHECK(ring.HighWaterMark() == 5000);
+
+    // Alignment padding counts: after 1 byte at offset 5000, the constants start at 5120.
+    CHECK(ring.Allocate(1, 1).Offset == 5000);
+    CHECK(ring.Allocate(256).Offset == 5120);
+    CHECK(ring.BytesInUse() == 1 + (5120 - 5001) + 256);
+    ring.FinishFrame(3);
+    ring.Retire(3);
+
+    // So does the end of the ring skipped by an allocation that would straddle it.
+    const UINT64 offset = ring.Allocate(1, 1).Offset;
+    const UINT64 skipped = Capacity - (offset + 1);
+    ring.Allocate(skipped + 1, 1);
+    CHECK(ring.BytesInUse() == 1 + skipped + skipped + 1);
+    CHECK(ring.HighWaterMark() == std::max<UINT64>(5000, 2 * skipped + 2));
+}
@@ -0,0 +1,338 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// The vectorized, banded Waves solver against the scalar stencil it replaced, the
+// fixed time step and its replay, the vertices it writes, and the step rate in cells
+// per second from 256x256 to 4096x4096 and the vertex write rate.
+//***************************************************************************************
+
+#include "TestFramework.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Waves.h"
+
+namespace
+{
+    constexpr float SpatialStep = 1.0f;
+    constexpr float TimeStep = 0.03f;
+    constexpr float Speed = 4.0f;
+    constexpr float Damping = 0.2f;
+
+    // LandAndWaves' vertex, and the one of the lit and textured demos.
+    struct ColorVertex final
+    {
+        DirectX::XMFLOAT3 Pos;
+        DirectX::XMFLOAT4 Color;
+    };
+
+    struct TexturedVertex final
+    {
+        DirectX::XMFLOAT3 Pos;
+        DirectX::XMFLOAT3 Normal;
+        DirectX::XMFLOAT2 TexC;
+    };
+
+    // The solver as Waves.cpp had it before, one grid point at a time.
+    class ReferenceWaves final
+    {
+    public:
+        ReferenceWaves(const int m, const int n) :
+            mRows(m), mCols(n), mPrev(std::size_t(m) * n, 0.0f), mCurr(std::size_t(m) * n, 0.0f),
+            mNormals(std::size_t(m) * n * 3, 0.0f)
+        {
+            const float d = Damping * TimeStep + 2.0f;
+            const float e = (Speed * Speed) * (TimeStep * TimeStep) / (SpatialStep * SpatialStep);
+            mK1 = (Damping * TimeStep - 2.0f) / d;
+            mK2 = (4.0f - 8.0f * e) / d;
+            mK3 = (2.0f * e) / d;
+        }
+
+        void Disturb(const int i, const int j, const float magnitude)
+        {
+            mCurr[i * mCols + j] += magnitude;
+            mCurr[i * mCols + j + 1] += 0.5f * magnitude;
+            mCurr[i * mCols + j - 1] += 0.5f * magnitude;
+            mCurr[(i + 1) * mCols + j] += 0.5f * magnitude;
+            mCurr[(i - 1) * mCols + j] += 0.5f * magnitude;
+        }
+
+        void Step()
+        {
+            const int n = mCols;
+            for (int i = 1; i < mRows - 1; ++i)
+            {
+                for (int j = 1; j < n - 1; ++j)
+                {
+                    mPrev[i * n + j] = mK1 * mPrev[i * n + j] + mK2 * mCurr[i * n + j] +
+                        mK3 * (mCurr[(i + 1) * n + j] + mCurr[(i - 1) * n + j] + mCurr[i * n + j + 1] + mCurr[i * n + j - 1]);
+                }
+            }
+            std::swap(mPrev, mCurr);
+
+            for (int i = 1; i < mRows - 1; ++i)
+            {
+                for (int j = 1; j < n - 1; ++j)
+                {
+                    const float l = mCurr[i * n + j - 1];
+                    const float r = mCurr[i * n + j + 1];
+                    const float t = mCurr[(i - 1) * n + j];
+                    const float b = mCurr[(i + 1) * n + j];
+                    const float x = l - r;
+                    const float y = 2.0f * SpatialStep;
+                    const float z = b - t;
+                    const float length = std::sqrt(x * x + y * y + z * z);
+                    float* normal = &mNormals[(std::size_t(i) * n + j) * 3];
+                    normal[0] = x / length;
+                    normal[1] = y / length;
+                    normal[2] = z / length;
+                }
+            }
+        }
+
+        float Height(const int k)const { return mCurr[k]; }
+        const float* Normal(const int k)const { return &mNormals[std::size_t(k) * 3]; }
+
+    private:
+        int mRows = 0;
+        int mCols = 0;
+        float mK1 = 0.0f;
+        float mK2 = 0.0f;
+        float mK3 = 0.0f;
+        std::vector<float> mPrev;
+        std::vector<float> mCurr;
+        std::vector<float> mNormals;
+    };
+}
+
+TEST_CASE(WavesMatchesScalarStencil)
+{
+    // Odd sizes, so every row ends in a scalar tail after the vector loop.
+    const int rows = 67;
+    const int cols = 53;
+    Waves waves(rows, cols, SpatialStep, TimeStep, Speed, Damping);
+    ReferenceWaves reference(rows, cols);
+
+    const int disturbances[][2] = { { 10, 10 }, { 33, 26 }, { 60, 47 }, { 5, 48 } };
+    for (int step = 0; step < 200; ++step)
+    {
+        if (step % 50 == 0)
+        {
+            for (const auto& d : disturbances)
+            {
+                waves.Disturb(d[0], d[1], 1.5f);
+                reference.Disturb(d[0], d[1], 1.5f);
+            }
+        }
+
+        REQUIRE(waves.Update(TimeStep) == 1);
+        reference.Step();
+    }
+
+    float maxHeight = 0.0f;
+    float maxHeightError = 0.0f;
+    float maxNormalError = 0.0f;
+    for (int i = 1; i < rows - 1; ++i)
+    {
+        for (int j = 1; j < cols - 1; ++j)
+        {
+            const int k = i * cols + j;
+            maxHeight = std::max(maxHeight, std::fabs(reference.Height(k)));
+            maxHeightError = std::max(maxHeightError, std::fabs(waves.Height(k) - reference.Height(k)));
+
+            const DirectX::XMFLOAT3 normal = waves.Normal(k);
+            const float* expected = reference.Normal(k);
+            maxNormalError = std::max({ maxNormalError, std::fabs(normal.x - expected[0]),
+                std::fabs(normal.y - expected[1]), std::fabs(normal.z - expected[2]) });
+        }
+    }
+
+    // The vector path may fuse multiply-adds, so allow for rounding, not more.
+    CHECK(maxHeight > 0.01f);
+    CHECK_MSG(maxHeightError <= 1e-4f * std::max(maxHeight, 1.0f), maxHeightError);
+    CHECK_MSG(maxNormalError <= 1e-4f, maxNormalError);
+}
+
+TEST_CASE(WavesFixedStepAndReplay)
+{
+    // Frame times around 60 Hz with the odd long frame, as the demos see them.
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> frameTime(0.008f, 0.025f);
+    std::uniform_int_distribution<int> point(2, 60);
+
+    Waves waves(64, 64, SpatialStep, TimeStep, Speed, Damping);
+    waves.Disturb(32, 32, 1.0f);
+    waves.StartRecording();
+
+    Waves twin(64, 64, SpatialStep, TimeStep, Speed, Damping);
+    twin.Disturb(32, 32, 1.0f);
+
+    int steps = 0;
+    for (int frame = 0; frame < 600; ++frame)
+    {
+        const float dt = frame % 97 == 0 ? 0.5f : frameTime(random);
+        if (frame % 15 == 0)
+        {
+            const int i = point(random);
+            const int j = point(random);
+            waves.Disturb(i, j, 0.4f);
+            twin.Disturb(i, j, 0.4f);
+        }
+
+        const int taken = waves.Update(dt);
+        CHECK(twin.Update(dt) == taken);
+        CHECK(taken <= waves.MaxSubsteps());
+        CHECK(waves.InterpolationAlpha() >= 0.0f && waves.InterpolationAlpha() < 1.0f);
+        steps += taken;
+    }
+    waves.StopRecording();
+
+    CHECK(steps > 0);
+    CHECK(waves.Recording().size() == 600 + 40);
+    CHECK(waves.HeightFieldHash() == twin.HeightFieldHash());
+
+    // Replayed from the snapshot the result is bit for bit the same.
+    CHECK(waves.VerifyReplay());
+    Waves recorded(64, 64, SpatialStep, TimeStep, Speed, Damping);
+    recorded.Disturb(32, 32, 1.0f);
+    recorded.Replay(waves.Recording());
+    CHECK(recorded.HeightFieldHash() == waves.HeightFieldHash());
+
+    // A spike runs MaxSubsteps catch-up steps and drops the rest of the backlog.
+    CHECK(waves.Update(1.0f) == Waves::DefaultMaxSubsteps);
+    CHECK(waves.Update(0.0f) == 0);
+    waves.SetMaxSubsteps(0);
+    CHECK(waves.MaxSubsteps() == 1);
+    CHECK(waves.Update(1.0f) == 1);
+    CHECK(waves.HeightFieldHash() != twin.HeightFieldHash());
+
+    // A changed input shows up in the hash.
+    Waves other(64, 64, SpatialStep, TimeStep, Speed, Damping);
+    other.Disturb(32, 32, 1.0f);
+    std::vector<Waves::InputEvent> events = waves.Recording();
+    for (Waves::InputEvent& event : events)
+    {
+        if (event.Kind == Waves::InputEvent::Type::Disturb)
+        {
+            event.Magnitude *= 2.0f;
+            break;
+        }
+    }
+    other.Replay(events);
+    CHECK(other.HeightFieldHash() != recorded.HeightFieldHash());
+}
+
+TEST_CASE(WavesWritesWholeVertices)
+{
+    Waves waves(33, 17, SpatialStep, TimeStep, Speed, Damping);
+    waves.Disturb(10, 8, 1.0f);
+    waves.Update(2.5f * TimeStep);
+
+    ColorVertex prototype = {};
+    prototype.Color = DirectX::XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+    ColorVertex stale = {};
+    stale.Pos = DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f);
+    stale.Color = DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 0.0f);
+    std::vector<ColorVertex> colored(waves.VertexCount(), stale);
+    waves.WriteVertices(std::span<ColorVertex>(colored), prototype);
+
+    std::vector<TexturedVertex> textured(waves.VertexCount());
+    waves.WriteVertices(std::span<TexturedVertex>(textured));
+
+    bool positionsMatch = true;
+    bool colorsMatch = true;
+    bool normalsMatch = true;
+    for (int k = 0; k < waves.VertexCount(); ++k)
+    {
+        const DirectX::XMFLOAT3 expected = waves.InterpolatedPosition(k);
+        positionsMatch &= std::memcmp(&colored[k].Pos, &expected, sizeof(expected)) == 0 &&
+            std::memcmp(&textured[k].Pos, &expected, sizeof(expected)) == 0;
+        colorsMatch &= std::memcmp(&colored[k].Color, &prototype.Color, sizeof(prototype.Color)) == 0;
+
+        const DirectX::XMFLOAT3 normal = waves.Normal(k);
+        normalsMatch &= std::memcmp(&textured[k].Normal, &normal, sizeof(normal)) == 0;
+    }
+    CHECK(positionsMatch);
+    CHECK(colorsMatch);
+    CHECK(normalsMatch);
+}
+
+BENCHMARK(WavesStepRate)
+{
+    const std::vector<int> sizes = Tests::QuickBenchmarks() ?
+        std::vector<int>{ 256, 512 } : std::vector<int>{ 256, 512, 1024, 2048, 4096 };
+
+    for (const int size : sizes)
+    {
+        Waves waves(size, size, SpatialStep, TimeStep, Speed, Damping);
+        waves.Disturb(size / 2, size / 2, 1.0f);
+
+        // Enough steps for about the same work at every size.
+        const int steps = std::max(2, (Tests::QuickBenchmarks() ? 1 << 19 : 1 << 25) / (size * size));
+        const double ms = Tests::BestOf(3, [&]
+        {
+            for (int step = 0; step < steps; ++step)
+                waves.Update(TimeStep);
+        });
+
+        const double cells = double(size - 2) * double(size - 2) * steps;
+        std::cout << "  " << size << "x" << size << ": " << cells / (ms / 1000.0) / 1e6 << " M cells/s, "
+            << ms / steps << " ms a step\n";
+    }
+}
+
+BENCHMARK(WavesVertexWrite)
+{
+    // LandAndWaves' 128x128 grid and a large one.  The destination is ordinary cached
+    // memory here, not a write-combined upload heap, where partial writes cost more.
+    for (const int size : { 128, 1024 })
+    {
+        Waves waves(size, size, SpatialStep, TimeStep, Speed, Damping);
+        waves.Disturb(size / 2, size / 2, 1.0f);
+        waves.Update(1.5f * TimeStep);
+
+        std::vector<ColorVertex> vertices(waves.VertexCount());
+        const std::span<std::byte> bytes = std::as_writable_bytes(std::span<ColorVertex>(vertices));
+        ColorVertex prototype = {};
+        prototype.Color = DirectX::XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        const int repeats = Tests::QuickBenchmarks() ? 3 : 20;
+
+        // As the book does it: one vertex at a time through the accessor.
+        const double perVertexMs = Tests::BestOf(repeats, [&]
+        {
+            for (int k = 0; k < waves.VertexCount(); ++k)
+            {
+                ColorVertex v;
+                v.Pos = waves.InterpolatedPosition(k);
+                v.Color = prototype.Color;
+                std::memcpy(&vertices[k], &v, sizeof(v));
+            }
+            Tests::DoNotOptimize(vertices.data());
+        });
+
+        // Only the positions, into vertices whose color was written before.
+        Waves::VertexLayout positionsOnly;
+        positionsOnly.Stride = sizeof(ColorVertex);
+        positionsOnly.PositionOffset = offsetof(ColorVertex, Pos);
+        const double positionsMs = Tests::BestOf(repeats, [&]
+        {
+            waves.WriteVertices(bytes, positionsOnly);
+            Tests::DoNotOptimize(vertices.data());
+        });
+
+        const double wholeMs = Tests::BestOf(repeats, [&]
+        {
+            waves.WriteVertices(std::span<ColorVertex>(vertices), prototype);
+            Tests::DoNotOptimize(vertices.data());
+        });
+
+        std::cout << "  " << size << "x" << size << ": one at a time " << perVertexMs << " ms, positions only "
+            << positionsMs << " ms, whole vertices " << wholeMs << " ms\n";
+    }
+}
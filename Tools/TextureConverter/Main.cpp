@@ -0,0 +1,154 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+//***************************************************************************************
+// Converts the .bmp sprites in Textures to block-compressed DDS files with a mip chain,
+// e.g.
+//
+//   TextureConverter Textures/tree0.bmp
+//   TextureConverter --format bc3 --quality fast Textures/tree1.bmp tree1.dds
+//
+// Without --format, images whose alpha is only ever 0 or 255 become BC1 (its 1-bit
+// alpha keeps the cutout) and others BC3.
+//***************************************************************************************
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "BCEncoder.h"
+#include "BitmapFile.h"
+
+namespace
+{
+    struct Options final
+    {
+        std::filesystem::path Input;
+        std::filesystem::path Output;
+        std::optional<BCEncoder::Format> Format;
+        BCEncoder::Quality Quality = BCEncoder::Quality::High;
+        bool GenerateMips = true;
+        bool Srgb = false;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "usage: TextureConverter [--format bc1|bc3|bc5] [--quality fast|high] [--no-mips] [--srgb]\n"
+            "                        input.bmp [output.dds]\n";
+    }
+
+    bool ParseOptions(const int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--format" && hasValue)
+            {
+                const std::string_view value = argv[++i];
+                if (value == "bc1")
+                    options.Format = BCEncoder::Format::BC1;
+                else if (value == "bc3")
+                    options.Format = BCEncoder::Format::BC3;
+                else if (value == "bc5")
+                    options.Format = BCEncoder::Format::BC5;
+                else
+                    return false;
+            }
+            else if (arg == "--quality" && hasValue)
+            {
+                const std::string_view value = argv[++i];
+                if (value == "fast")
+                    options.Quality = BCEncoder::Quality::Fast;
+                else if (value == "high")
+                    options.Quality = BCEncoder::Quality::High;
+                else
+                    return false;
+            }
+            else if (arg == "--no-mips")
+                options.GenerateMips = false;
+            else if (arg == "--srgb")
+                options.Srgb = true;
+            else if (arg.starts_with("--"))
+                return false;
+            else if (options.Input.empty())
+                options.Input = arg;
+            else if (options.Output.empty())
+                options.Output = arg;
+            else
+                return false;
+        }
+
+        if (options.Input.empty())
+            return false;
+
+        if (options.Output.empty())
+            options.Output = std::filesystem::path(options.Input).replace_extension(".dds");
+
+        return true;
+    }
+
+    // BC1 if every texel is either opaque or fully transparent.
+    BCEncoder::Format ChooseFormat(const BitmapFile::Image& image)
+    {
+        for (std::size_t i = 3; i < image.Texels.size(); i += 4)
+        {
+            const std::uint8_t alpha = std::to_integer<std::uint8_t>(image.Texels[i]);
+            if (alpha != 0 && alpha != 255)
+                return BCEncoder::Format::BC3;
+        }
+        return BCEncoder::Format::BC1;
+    }
+
+    const char* FormatName(const BCEncoder::Format format)
+    {
+        switch (format)
+        {
+            case BCEncoder::Format::BC1: return "BC1";
+            case BCEncoder::Format::BC3: return "BC3";
+            case BCEncoder::Format::BC5: return "BC5";
+        }
+        return "";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    BitmapFile::Image image;
+    if (!BitmapFile::Load(options.Input.wstring(), image))
+    {
+        std::cerr << options.Input.string() << ": not a 24- or 32-bit uncompressed bitmap\n";
+        return 1;
+    }
+
+    const BCEncoder::Format format = options.Format.value_or(ChooseFormat(image));
+    const BCEncoder::Surface surface = { image.Texels.data(), image.Width, image.Height, std::size_t(image.Width) * 4 };
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::byte> dds = BCEncoder::EncodeDDS(surface, format, options.Quality,
+        options.GenerateMips, options.Srgb);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (dds.empty() || !BCEncoder::WriteDDSFile(options.Output.wstring(), dds))
+    {
+        std::cerr << options.Output.string() << ": could not be written\n";
+        return 1;
+    }
+
+    std::cout << options.Input.string() << " -> " << options.Output.string() << ": "
+        << image.Width << "x" << image.Height << ' ' << FormatName(format)
+        << (options.Quality == BCEncoder::Quality::Fast ? " fast" : " high")
+        << (options.GenerateMips ? " with mips, " : ", ")
+        << dds.size() / 1024 << " KiB in " << ms << " ms\n";
+    return 0;
+}